@@ -0,0 +1,431 @@
+// Portable benchmark of the bitset operations against std::bitset, std::vector<bool> and boost::dynamic_bitset (when available)
+// at sizes fitting in L1, L2, the last level cache and DRAM.
+//
+// build: g++ -std=c++17 -O2 -march=native -pthread Benchmarks/benchmark.cpp -o benchmark
+// usage: benchmark [--format=csv|json] [--filter=<substring>] [--min-time=<seconds>] [--max-level=l1|l2|llc|dram]
+//
+// Every result is one line (CSV with a header, or one JSON object per line), so runs can be diffed or loaded into a spreadsheet.
+// ns_per_op is the best time of one call over several repetitions, bits_per_ns is the throughput for whole bitset operations.
+
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../C++/BitSet.hpp"
+
+#if defined(__has_include)
+#if __has_include(<boost/dynamic_bitset.hpp>)
+#include <boost/dynamic_bitset.hpp>
+#define BENCHMARK_BOOST 1
+#endif
+#endif
+
+// sizes of the bitsets (in bytes) for each memory level, override at compile time to match the machine
+
+#ifndef BENCHMARK_L1_BYTES
+#define BENCHMARK_L1_BYTES (16ull << 10)
+#endif
+
+#ifndef BENCHMARK_L2_BYTES
+#define BENCHMARK_L2_BYTES (512ull << 10)
+#endif
+
+#ifndef BENCHMARK_LLC_BYTES
+#define BENCHMARK_LLC_BYTES (16ull << 20)
+#endif
+
+#ifndef BENCHMARK_DRAM_BYTES
+#define BENCHMARK_DRAM_BYTES (256ull << 20)
+#endif
+
+/**
+ * Number of precomputed random indices for the single bit operations
+ */
+constexpr uint64_t random_index_count = 1u << 16;
+
+/**
+ * Step of the strided fill
+ */
+constexpr uint64_t fill_step = 7;
+
+/**
+ * Keeps the compiler from optimizing the value (and the computation of it) away
+ */
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile T sink;
+    sink = value;
+#endif
+}
+
+/**
+ * Options of the run
+ */
+struct Options
+{
+    bool json = false;
+    std::string filter;
+    double min_time = 0.05;
+    int max_level = 3;
+};
+
+/**
+ * Input shared by the benchmarks of one size
+ */
+struct Input
+{
+    const char* level;
+    uint64_t bits;
+    std::vector<uint64_t> indices;
+};
+
+/**
+ * Prints one result line
+ */
+inline void report(const Options& options, const char* const operation, const char* const implementation, const Input& input, const double ns, const uint64_t bits_touched)
+{
+    const double throughput = bits_touched ? bits_touched / ns : 0.0;
+    if (options.json)
+        std::printf("{\"operation\":\"%s\",\"implementation\":\"%s\",\"level\":\"%s\",\"bits\":%llu,\"ns_per_op\":%.3f,\"bits_per_ns\":%.3f}\n",
+                    operation, implementation, input.level, static_cast<unsigned long long>(input.bits), ns, throughput);
+    else
+        std::printf("%s,%s,%s,%llu,%.3f,%.3f\n", operation, implementation, input.level, static_cast<unsigned long long>(input.bits), ns, throughput);
+    std::fflush(stdout);
+}
+
+/**
+ * Measures the best time of one call, the number of calls per repetition doubles until a repetition takes min_time
+ * @param setup Called before every repetition (not measured), e.g. to reset the bitset
+ * @param body The measured operation
+ * @return Best time per call in nanoseconds
+ */
+template <typename Setup, typename Body>
+inline double measure(const Options& options, Setup&& setup, Body&& body)
+{
+    using clock = std::chrono::steady_clock;
+    double best = 1e300;
+    uint64_t calls = 1;
+    for (int repetition = 0; repetition < 5;)
+    {
+        setup();
+        const clock::time_point start = clock::now();
+        for (uint64_t i = 0; i < calls; ++i)
+            body();
+        const double elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        if (elapsed < options.min_time * 1e9 / 5 && calls < (1ull << 40))
+        {
+            calls *= 2;
+            continue;
+        }
+        best = std::min(best, elapsed / calls);
+        ++repetition;
+    }
+    return best;
+}
+
+// adapters, each one exposes the same operations, the ones missing in a library are written as loops over single bits
+
+/**
+ * C API (DynamicBitSet)
+ */
+struct CApi
+{
+    static constexpr const char* name = "c_api";
+    DynamicBitSet bitset;
+    explicit CApi(const uint64_t bits) { bitset_dynamic_init(&bitset, bits); }
+    ~CApi() { bitset_dynamic_destroy(&bitset); }
+    BitSet* universal() { return UNIVERSAL_BITSET(&bitset); }
+    const BitSet* universal() const { return UNIVERSAL_BITSET(&bitset); }
+    bool get(const uint64_t index) const { return bitset_get(universal(), index); }
+    void set(const uint64_t index) { bitset_set(universal(), index); }
+    void clear(const uint64_t index) { bitset_clear(universal(), index); }
+    void fill_range(const uint64_t begin, const uint64_t end) { bitset_set_in_range_begin_end(universal(), begin, end); }
+    void fill_step(const uint64_t begin, const uint64_t end, const uint64_t step) { bitset_set_in_range_begin_end_step(universal(), begin, end, step); }
+    void clear_all() { bitset_clear_all(universal()); }
+    uint64_t count() const { return bitset_count(universal()); }
+    bool any() const { return bitset_any(universal()); }
+    bool all() const { return bitset_all(universal()); }
+    bool none() const { return bitset_none(universal()); }
+    void push_back(const bool value) { bitset_dynamic_push_back(&bitset, value); }
+    void resize(const uint64_t bits) { bitset_dynamic_resize(&bitset, bits); }
+    void and_with(const CApi& other) { bitset_and_in_place(universal(), other.universal()); }
+    void or_with(const CApi& other) { bitset_or_in_place(universal(), other.universal()); }
+    void xor_with(const CApi& other) { bitset_xor_in_place(universal(), other.universal()); }
+};
+
+/**
+ * C++ API (CDynamicBitSet<uint64_t>)
+ */
+struct CppApi
+{
+    static constexpr const char* name = "cpp_api";
+    CDynamicBitSet<uint64_t> bitset;
+    explicit CppApi(const uint64_t bits) : bitset(bits) {}
+    bool get(const uint64_t index) const { return bitset.get(index); }
+    void set(const uint64_t index) { bitset.set(index); }
+    void clear(const uint64_t index) { bitset.clear(index); }
+    void fill_range(const uint64_t begin, const uint64_t end) { bitset.set_in_range(begin, end); }
+    void fill_step(const uint64_t begin, const uint64_t end, const uint64_t step) { bitset.set_in_range(begin, end, step); }
+    void clear_all() { bitset.clear_all(); }
+    uint64_t count() const { return bitset.count(); }
+    bool any() const { return bitset.any(); }
+    bool all() const { return bitset.all(); }
+    bool none() const { return bitset.none(); }
+    void push_back(const bool value) { bitset.push_back(value); }
+    void resize(const uint64_t bits) { bitset.resize(bits); }
+    void and_with(const CppApi& other) { bitset &= other.bitset; }
+    void or_with(const CppApi& other) { bitset |= other.bitset; }
+    void xor_with(const CppApi& other) { bitset ^= other.bitset; }
+};
+
+/**
+ * std::bitset<N> (heap allocated, fixed size so push_back and resize are not measured)
+ */
+template <uint64_t N>
+struct StdBitset
+{
+    static constexpr const char* name = "std_bitset";
+    std::unique_ptr<std::bitset<N>> bitset;
+    explicit StdBitset(uint64_t) : bitset(new std::bitset<N>()) {}
+    bool get(const uint64_t index) const { return (*bitset)[index]; }
+    void set(const uint64_t index) { bitset->set(index); }
+    void clear(const uint64_t index) { bitset->reset(index); }
+    void fill_range(const uint64_t begin, const uint64_t end) { for (uint64_t i = begin; i < end; ++i) bitset->set(i); }
+    void fill_step(const uint64_t begin, const uint64_t end, const uint64_t step) { for (uint64_t i = begin; i < end; i += step) bitset->set(i); }
+    void clear_all() { bitset->reset(); }
+    uint64_t count() const { return bitset->count(); }
+    bool any() const { return bitset->any(); }
+    bool all() const { return bitset->all(); }
+    bool none() const { return bitset->none(); }
+    void push_back(bool) {}
+    void resize(uint64_t) {}
+    void and_with(const StdBitset& other) { *bitset &= *other.bitset; }
+    void or_with(const StdBitset& other) { *bitset |= *other.bitset; }
+    void xor_with(const StdBitset& other) { *bitset ^= *other.bitset; }
+};
+
+/**
+ * std::vector<bool>
+ */
+struct StdVectorBool
+{
+    static constexpr const char* name = "std_vector_bool";
+    std::vector<bool> bitset;
+    explicit StdVectorBool(const uint64_t bits) : bitset(bits) {}
+    bool get(const uint64_t index) const { return bitset[index]; }
+    void set(const uint64_t index) { bitset[index] = true; }
+    void clear(const uint64_t index) { bitset[index] = false; }
+    void fill_range(const uint64_t begin, const uint64_t end) { std::fill(bitset.begin() + begin, bitset.begin() + end, true); }
+    void fill_step(const uint64_t begin, const uint64_t end, const uint64_t step) { for (uint64_t i = begin; i < end; i += step) bitset[i] = true; }
+    void clear_all() { std::fill(bitset.begin(), bitset.end(), false); }
+    uint64_t count() const { return static_cast<uint64_t>(std::count(bitset.begin(), bitset.end(), true)); }
+    bool any() const { return std::find(bitset.begin(), bitset.end(), true) != bitset.end(); }
+    bool all() const { return std::find(bitset.begin(), bitset.end(), false) == bitset.end(); }
+    bool none() const { return !any(); }
+    void push_back(const bool value) { bitset.push_back(value); }
+    void resize(const uint64_t bits) { bitset.resize(bits); }
+    void and_with(const StdVectorBool& other) { for (uint64_t i = 0; i < bitset.size(); ++i) bitset[i] = bitset[i] && other.bitset[i]; }
+    void or_with(const StdVectorBool& other) { for (uint64_t i = 0; i < bitset.size(); ++i) bitset[i] = bitset[i] || other.bitset[i]; }
+    void xor_with(const StdVectorBool& other) { for (uint64_t i = 0; i < bitset.size(); ++i) bitset[i] = bitset[i] != other.bitset[i]; }
+};
+
+#ifdef BENCHMARK_BOOST
+/**
+ * boost::dynamic_bitset<uint64_t>
+ */
+struct BoostDynamicBitset
+{
+    static constexpr const char* name = "boost_dynamic_bitset";
+    boost::dynamic_bitset<uint64_t> bitset;
+    explicit BoostDynamicBitset(const uint64_t bits) : bitset(bits) {}
+    bool get(const uint64_t index) const { return bitset.test(index); }
+    void set(const uint64_t index) { bitset.set(index); }
+    void clear(const uint64_t index) { bitset.reset(index); }
+    void fill_range(const uint64_t begin, const uint64_t end) { bitset.set(begin, end - begin, true); }
+    void fill_step(const uint64_t begin, const uint64_t end, const uint64_t step) { for (uint64_t i = begin; i < end; i += step) bitset.set(i); }
+    void clear_all() { bitset.reset(); }
+    uint64_t count() const { return bitset.count(); }
+    bool any() const { return bitset.any(); }
+    bool all() const { return bitset.all(); }
+    bool none() const { return bitset.none(); }
+    void push_back(const bool value) { bitset.push_back(value); }
+    void resize(const uint64_t bits) { bitset.resize(bits); }
+    void and_with(const BoostDynamicBitset& other) { bitset &= other.bitset; }
+    void or_with(const BoostDynamicBitset& other) { bitset |= other.bitset; }
+    void xor_with(const BoostDynamicBitset& other) { bitset ^= other.bitset; }
+};
+#endif
+
+template <typename T>
+struct is_dynamic : std::true_type {};
+
+template <uint64_t N>
+struct is_dynamic<StdBitset<N>> : std::false_type {};
+
+/**
+ * Checks if the benchmark passes the filter (substring of "operation/implementation/level")
+ */
+inline bool selected(const Options& options, const char* const operation, const char* const implementation, const Input& input)
+{
+    if (options.filter.empty())
+        return true;
+    const std::string name = std::string(operation) + "/" + implementation + "/" + input.level;
+    return name.find(options.filter) != std::string::npos;
+}
+
+/**
+ * Runs every operation for one implementation and one size
+ */
+template <typename Adapter>
+void run_suite(const Options& options, const Input& input)
+{
+    const char* const name = Adapter::name;
+    const uint64_t bits = input.bits;
+    Adapter first(bits), second(bits);
+    for (uint64_t i = 0; i < bits; i += 3)
+        second.set(i);
+    const std::vector<uint64_t>& indices = input.indices;
+    const auto nothing = [] {};
+
+    if (selected(options, "get", name, input))
+    {
+        uint64_t position = 0;
+        report(options, "get", name, input, measure(options, nothing, [&] {
+            do_not_optimize(first.get(indices[position++ % random_index_count]));
+        }), 0);
+    }
+    if (selected(options, "set", name, input))
+    {
+        uint64_t position = 0;
+        report(options, "set", name, input, measure(options, nothing, [&] {
+            first.set(indices[position++ % random_index_count]);
+            do_not_optimize(first);
+        }), 0);
+    }
+    if (selected(options, "fill_range", name, input))
+        report(options, "fill_range", name, input, measure(options, nothing, [&] {
+            first.fill_range(1, bits - 1);
+            do_not_optimize(first);
+        }), bits);
+    if (selected(options, "fill_step", name, input))
+        report(options, "fill_step", name, input, measure(options, nothing, [&] {
+            first.fill_step(1, bits, fill_step);
+            do_not_optimize(first);
+        }), bits);
+    first.clear_all();
+    first.set(bits - 1);
+    if (selected(options, "count", name, input))
+        report(options, "count", name, input, measure(options, nothing, [&] { do_not_optimize(first.count()); }), bits);
+    // the predicates see a bitset with only the last bit set, so they have to scan the whole storage
+    if (selected(options, "any", name, input))
+        report(options, "any", name, input, measure(options, nothing, [&] { do_not_optimize(first.any()); }), bits);
+    if (selected(options, "none", name, input))
+        report(options, "none", name, input, measure(options, nothing, [&] { do_not_optimize(first.none()); }), bits);
+    // and all sees a bitset with only the last bit cleared
+    first.fill_range(0, bits);
+    first.clear(bits - 1);
+    if (selected(options, "all", name, input))
+        report(options, "all", name, input, measure(options, nothing, [&] { do_not_optimize(first.all()); }), bits);
+    if (selected(options, "and", name, input))
+        report(options, "and", name, input, measure(options, nothing, [&] { first.and_with(second); do_not_optimize(first); }), bits);
+    if (selected(options, "or", name, input))
+        report(options, "or", name, input, measure(options, nothing, [&] { first.or_with(second); do_not_optimize(first); }), bits);
+    if (selected(options, "xor", name, input))
+        report(options, "xor", name, input, measure(options, nothing, [&] { first.xor_with(second); do_not_optimize(first); }), bits);
+
+    if constexpr (is_dynamic<Adapter>::value)
+    {
+        if (selected(options, "push_back", name, input))
+        {
+            std::unique_ptr<Adapter> grown;
+            report(options, "push_back", name, input, measure(options, [&] { grown.reset(); }, [&] {
+                grown.reset(new Adapter(0));
+                for (uint64_t i = 0; i < bits; ++i)
+                    grown->push_back(i & 1u);
+                do_not_optimize(*grown);
+            }), bits);
+        }
+        if (selected(options, "resize", name, input))
+        {
+            std::unique_ptr<Adapter> grown;
+            report(options, "resize", name, input, measure(options, [&] { grown.reset(); }, [&] {
+                grown.reset(new Adapter(0));
+                // doubling sizes, so every resize reallocates and clears the new bits
+                for (uint64_t size = 64; size < bits; size *= 2)
+                    grown->resize(size);
+                grown->resize(bits);
+                do_not_optimize(*grown);
+            }), bits);
+        }
+    }
+}
+
+/**
+ * Runs every implementation for one size, std::bitset needs the size at compile time
+ */
+template <uint64_t Bytes>
+void run_level(const Options& options, const char* const level)
+{
+    constexpr uint64_t bits = Bytes * 8u;
+    Input input{ level, bits, std::vector<uint64_t>(random_index_count) };
+    std::mt19937_64 random(bits);
+    for (uint64_t& index : input.indices)
+        index = random() % bits;
+
+    run_suite<CApi>(options, input);
+    run_suite<CppApi>(options, input);
+    run_suite<StdBitset<bits>>(options, input);
+    run_suite<StdVectorBool>(options, input);
+#ifdef BENCHMARK_BOOST
+    run_suite<BoostDynamicBitset>(options, input);
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = *(argv + i);
+        if (argument == "--format=json")
+            options.json = true;
+        else if (argument == "--format=csv")
+            options.json = false;
+        else if (argument.rfind("--filter=", 0) == 0)
+            options.filter = argument.substr(9);
+        else if (argument.rfind("--min-time=", 0) == 0)
+            options.min_time = std::stod(argument.substr(11));
+        else if (argument.rfind("--max-level=", 0) == 0)
+        {
+            const std::string level = argument.substr(12);
+            options.max_level = level == "l1" ? 0 : level == "l2" ? 1 : level == "llc" ? 2 : 3;
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--format=csv|json] [--filter=<substring>] [--min-time=<seconds>] [--max-level=l1|l2|llc|dram]\n", *argv);
+            return 1;
+        }
+    }
+
+    if (!options.json)
+        std::printf("operation,implementation,level,bits,ns_per_op,bits_per_ns\n");
+    run_level<BENCHMARK_L1_BYTES>(options, "l1");
+    if (options.max_level >= 1)
+        run_level<BENCHMARK_L2_BYTES>(options, "l2");
+    if (options.max_level >= 2)
+        run_level<BENCHMARK_LLC_BYTES>(options, "llc");
+    if (options.max_level >= 3)
+        run_level<BENCHMARK_DRAM_BYTES>(options, "dram");
+    return 0;
+}
@@ -0,0 +1,1650 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "../C/BitSet.h"
+
+/**
+ * C++ layer of the bitset library: CDynamicBitSet<Block> (growable, owns its storage) and CBitSet<N, Block> (fixed size, constexpr).
+ * Any unsigned integer type can be used as the block type, independently of BITSET_BLOCK_TYPE of the C API.
+ * The bulk operations (count, set algebra, searches) run on the byte kernels of BitSetKernels.h shared with the C API,
+ * the fixed size bitset uses constexpr loops instead so operations on small constant sizes unroll completely.
+ * Data members are public like in the C API.
+ */
+
+namespace bitset_detail
+{
+    /**
+     * Number of bits in a block of the specified type
+     */
+    template <typename Block>
+    constexpr uint64_t block_bits = sizeof(Block) * 8u;
+
+    /**
+     * Block with all the bits set
+     */
+    template <typename Block>
+    constexpr Block block_full = static_cast<Block>(~static_cast<Block>(0u));
+
+    /**
+     * Calculates the number of blocks needed to store the specified number of bits
+     * @param size The number of bits (bit size)
+     * @return The number of blocks
+     */
+    template <typename Block>
+    constexpr uint64_t storage_size(const uint64_t size)
+    {
+        return size / block_bits<Block> + (size % block_bits<Block> ? 1u : 0u);
+    }
+
+    /**
+     * Creates a block with the bits in the specified range set
+     * @param begin Begin of the range (bit index inside the block)
+     * @param end End of the range (bit index inside the block, greater than begin)
+     * @return The block with the range set
+     */
+    template <typename Block>
+    constexpr Block range_block(const uint64_t begin, const uint64_t end)
+    {
+        return static_cast<Block>(static_cast<Block>(block_full<Block> >> (block_bits<Block> - (end - begin))) << begin);
+    }
+
+    /**
+     * Creates a mask of the bits used in the last block of a bitset
+     * @param size The size of the bitset (bit size)
+     * @return The block with the bits belonging to the bitset set
+     */
+    template <typename Block>
+    constexpr Block tail_block(const uint64_t size)
+    {
+        return size % block_bits<Block> ? range_block<Block>(0, size % block_bits<Block>) : block_full<Block>;
+    }
+
+    /**
+     * Counts the set bits in a 64-bit word (constexpr)
+     */
+    constexpr uint64_t popcount64(uint64_t word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint64_t>(__builtin_popcountll(word));
+#else
+        word = word - ((word >> 1) & 0x5555555555555555ull);
+        word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+        return (word * 0x0101010101010101ull) >> 56;
+#endif
+    }
+
+    /**
+     * Finds the lowest set bit of a 64-bit word (constexpr, the word must not be zero)
+     */
+    constexpr uint64_t ctz64(uint64_t word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint64_t>(__builtin_ctzll(word));
+#else
+        uint64_t index = 0;
+        for (; !(word & 1u); word >>= 1)
+            ++index;
+        return index;
+#endif
+    }
+
+    /**
+     * Finds the highest set bit of a 64-bit word (constexpr, the word must not be zero)
+     */
+    constexpr uint64_t highest64(uint64_t word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63u - static_cast<uint64_t>(__builtin_clzll(word));
+#else
+        uint64_t index = 0;
+        while (word >>= 1)
+            ++index;
+        return index;
+#endif
+    }
+
+    /**
+     * Counts the set bits in a block
+     */
+    template <typename Block>
+    constexpr uint64_t block_popcount(const Block block)
+    {
+        if constexpr (sizeof(Block) > 8)
+            return popcount64(static_cast<uint64_t>(block)) + popcount64(static_cast<uint64_t>(block >> 64));
+        else
+            return popcount64(static_cast<uint64_t>(block));
+    }
+
+    /**
+     * Finds the lowest set bit of a block (the block must not be zero)
+     */
+    template <typename Block>
+    constexpr uint64_t block_lowest_bit(const Block block)
+    {
+        if constexpr (sizeof(Block) > 8)
+            return static_cast<uint64_t>(block) ? ctz64(static_cast<uint64_t>(block)) : 64u + ctz64(static_cast<uint64_t>(block >> 64));
+        else
+            return ctz64(static_cast<uint64_t>(block));
+    }
+
+    /**
+     * Finds the highest set bit of a block (the block must not be zero)
+     */
+    template <typename Block>
+    constexpr uint64_t block_highest_bit(const Block block)
+    {
+        if constexpr (sizeof(Block) > 8)
+            return static_cast<uint64_t>(block >> 64) ? 64u + highest64(static_cast<uint64_t>(block >> 64)) : highest64(static_cast<uint64_t>(block));
+        else
+            return highest64(static_cast<uint64_t>(block));
+    }
+
+    /**
+     * Applies a bitwise operation to two blocks
+     */
+    template <typename Block>
+    constexpr Block apply_operation_block(const Block first, const Block second, const BitSetOperation operation)
+    {
+        switch (operation)
+        {
+        case BITSET_AND:
+            return first & second;
+        case BITSET_OR:
+            return first | second;
+        case BITSET_XOR:
+            return first ^ second;
+        default:
+            return static_cast<Block>(first & ~second);
+        }
+    }
+
+    /**
+     * Fills the bits in the specified range of a block array (constexpr loop, CDynamicBitSet fills the whole blocks in the middle with memset first)
+     */
+    template <typename Block>
+    constexpr void fill_in_range(Block* const data, const bool value, const uint64_t begin, const uint64_t end)
+    {
+        if (begin >= end)
+            return;
+        const uint64_t begin_block = begin / block_bits<Block>, end_block = (end - 1) / block_bits<Block>;
+        Block begin_mask = range_block<Block>(begin % block_bits<Block>, block_bits<Block>);
+        const Block end_mask = range_block<Block>(0, (end - 1) % block_bits<Block> + 1);
+        if (begin_block == end_block)
+            begin_mask &= end_mask;
+        if (value)
+            *(data + begin_block) |= begin_mask;
+        else
+            *(data + begin_block) &= static_cast<Block>(~begin_mask);
+        if (begin_block == end_block)
+            return;
+        for (uint64_t i = begin_block + 1; i < end_block; ++i)
+            *(data + i) = value ? block_full<Block> : static_cast<Block>(0u);
+        if (value)
+            *(data + end_block) |= end_mask;
+        else
+            *(data + end_block) &= static_cast<Block>(~end_mask);
+    }
+
+    /**
+     * Flips the bits in the specified range of a block array
+     */
+    template <typename Block>
+    constexpr void flip_in_range(Block* const data, const uint64_t begin, const uint64_t end)
+    {
+        if (begin >= end)
+            return;
+        const uint64_t begin_block = begin / block_bits<Block>, end_block = (end - 1) / block_bits<Block>;
+        Block begin_mask = range_block<Block>(begin % block_bits<Block>, block_bits<Block>);
+        const Block end_mask = range_block<Block>(0, (end - 1) % block_bits<Block> + 1);
+        if (begin_block == end_block)
+            begin_mask &= end_mask;
+        *(data + begin_block) ^= begin_mask;
+        if (begin_block == end_block)
+            return;
+        for (uint64_t i = begin_block + 1; i < end_block; ++i)
+            *(data + i) = static_cast<Block>(~*(data + i));
+        *(data + end_block) ^= end_mask;
+    }
+
+    /**
+     * Counts the set bits in the specified range of a block array (the whole blocks in the middle are counted by the
+     * popcount kernel when not constant evaluated)
+     */
+    template <typename Block>
+    constexpr uint64_t count_in_range(const Block* const data, const uint64_t begin, const uint64_t end, const bool use_kernel)
+    {
+        if (begin >= end)
+            return 0;
+        const uint64_t begin_block = begin / block_bits<Block>, end_block = (end - 1) / block_bits<Block>;
+        const Block begin_mask = range_block<Block>(begin % block_bits<Block>, block_bits<Block>);
+        const Block end_mask = range_block<Block>(0, (end - 1) % block_bits<Block> + 1);
+        if (begin_block == end_block)
+            return block_popcount(static_cast<Block>(*(data + begin_block) & begin_mask & end_mask));
+        uint64_t count = block_popcount(static_cast<Block>(*(data + begin_block) & begin_mask)) + block_popcount(static_cast<Block>(*(data + end_block) & end_mask));
+        if (use_kernel)
+            return count + bitset_popcount_buffer(data + begin_block + 1, (end_block - begin_block - 1) * sizeof(Block));
+        for (uint64_t i = begin_block + 1; i < end_block; ++i)
+            count += block_popcount(*(data + i));
+        return count;
+    }
+
+    /**
+     * Finds the first bit with the specified value in the specified range of a block array (searching in the whole blocks
+     * in the middle uses the mismatch kernel when not constant evaluated)
+     * @return Index of the found bit or BITSET_NPOS
+     */
+    template <typename Block>
+    constexpr uint64_t find_in_range(const Block* const data, const bool value, const uint64_t begin, const uint64_t end, const bool use_kernel)
+    {
+        if (begin >= end)
+            return BITSET_NPOS;
+        const Block invert = value ? static_cast<Block>(0u) : block_full<Block>;
+        const uint64_t begin_block = begin / block_bits<Block>, end_block = (end - 1) / block_bits<Block>;
+        Block begin_mask = range_block<Block>(begin % block_bits<Block>, block_bits<Block>);
+        const Block end_mask = range_block<Block>(0, (end - 1) % block_bits<Block> + 1);
+        if (begin_block == end_block)
+            begin_mask &= end_mask;
+        Block block = (*(data + begin_block) ^ invert) & begin_mask;
+        if (block)
+            return begin_block * block_bits<Block> + block_lowest_bit(block);
+        if (begin_block == end_block)
+            return BITSET_NPOS;
+        uint64_t i = begin_block + 1;
+        if (use_kernel)
+            i += bitset_find_mismatch_buffer(data + i, (end_block - i) * sizeof(Block), value ? 0u : 255u) / sizeof(Block);
+        else
+        {
+            while (i < end_block && *(data + i) == invert)
+                ++i;
+        }
+        if (i < end_block)
+            return i * block_bits<Block> + block_lowest_bit(static_cast<Block>(*(data + i) ^ invert));
+        block = (*(data + end_block) ^ invert) & end_mask;
+        return block ? end_block * block_bits<Block> + block_lowest_bit(block) : BITSET_NPOS;
+    }
+
+    /**
+     * Finds the last bit with the specified value before the specified index of a block array
+     * @return Index of the found bit or BITSET_NPOS
+     */
+    template <typename Block>
+    constexpr uint64_t find_before(const Block* const data, const bool value, const uint64_t end)
+    {
+        if (!end)
+            return BITSET_NPOS;
+        const Block invert = value ? static_cast<Block>(0u) : block_full<Block>;
+        uint64_t block_index = (end - 1) / block_bits<Block>;
+        Block block = (*(data + block_index) ^ invert) & range_block<Block>(0, (end - 1) % block_bits<Block> + 1);
+        while (!block)
+        {
+            if (!block_index--)
+                return BITSET_NPOS;
+            block = *(data + block_index) ^ invert;
+        }
+        return block_index * block_bits<Block> + block_highest_bit(block);
+    }
+
+    /**
+     * Shifts the bits of a block array towards higher indices in place (bit i moves to i + shift), the vacated bits are cleared
+     * @param data The blocks
+     * @param storage_size Number of blocks
+     * @param shift Number of bits to shift by (less than storage_size blocks)
+     */
+    template <typename Block>
+    constexpr void shift_left(Block* const data, const uint64_t storage_size, const uint64_t shift)
+    {
+        const uint64_t block_shift = shift / block_bits<Block>, bit_shift = shift % block_bits<Block>;
+        for (uint64_t i = storage_size - 1; i > block_shift; --i)
+            *(data + i) = bit_shift ? static_cast<Block>(*(data + i - block_shift) << bit_shift | *(data + i - block_shift - 1) >> (block_bits<Block> - bit_shift))
+                                    : *(data + i - block_shift);
+        *(data + block_shift) = static_cast<Block>(*data << bit_shift);
+        for (uint64_t i = 0; i < block_shift; ++i)
+            *(data + i) = 0u;
+    }
+
+    /**
+     * Shifts the bits of a block array towards lower indices in place (bit i moves to i - shift), the vacated bits are cleared
+     * @param data The blocks, the bits past the size have to be cleared
+     * @param storage_size Number of blocks
+     * @param shift Number of bits to shift by (less than storage_size blocks)
+     */
+    template <typename Block>
+    constexpr void shift_right(Block* const data, const uint64_t storage_size, const uint64_t shift)
+    {
+        const uint64_t block_shift = shift / block_bits<Block>, bit_shift = shift % block_bits<Block>;
+        const uint64_t moved = storage_size - block_shift;
+        for (uint64_t i = 0; i + 1 < moved; ++i)
+            *(data + i) = bit_shift ? static_cast<Block>(*(data + i + block_shift) >> bit_shift | *(data + i + block_shift + 1) << (block_bits<Block> - bit_shift))
+                                    : *(data + i + block_shift);
+        *(data + moved - 1) = static_cast<Block>(*(data + storage_size - 1) >> bit_shift);
+        for (uint64_t i = moved; i < storage_size; ++i)
+            *(data + i) = 0u;
+    }
+
+    /**
+     * Applies an operation to the bits at the indices of a block array, the blocks are prefetched BITSET_PREFETCH_DISTANCE indices ahead
+     */
+    template <typename Block>
+    void modify_many(Block* const data, const uint64_t* const indices, const uint64_t count, const BitSetOperation operation)
+    {
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (i + BITSET_PREFETCH_DISTANCE < count)
+                BITSET_PREFETCH(data + *(indices + i + BITSET_PREFETCH_DISTANCE) / block_bits<Block>, 1);
+            Block* const block = data + *(indices + i) / block_bits<Block>;
+            *block = apply_operation_block(*block, static_cast<Block>(static_cast<Block>(1u) << *(indices + i) % block_bits<Block>), operation);
+        }
+    }
+
+    /**
+     * Applies an operation to the bits at the indices of a block array, consecutive indices within one block are merged into a single update
+     */
+    template <typename Block>
+    constexpr void modify_many_sorted(Block* const data, const uint64_t* const indices, const uint64_t count, const BitSetOperation operation)
+    {
+        for (uint64_t i = 0; i < count;)
+        {
+            const uint64_t index = *(indices + i) / block_bits<Block>;
+            Block mask = 0u;
+            for (; i < count && *(indices + i) / block_bits<Block> == index; ++i)
+            {
+                const Block bit = static_cast<Block>(static_cast<Block>(1u) << *(indices + i) % block_bits<Block>);
+                mask = static_cast<Block>(operation == BITSET_XOR ? mask ^ bit : mask | bit);
+            }
+            *(data + index) = apply_operation_block(*(data + index), mask, operation);
+        }
+    }
+}
+
+/**
+ * A dynamic bitset class, owns its storage (allocated with malloc/realloc, so growing does not copy when not needed)
+ * Movable (moving only transfers the storage), copying is explicit via the copy constructor / assignment
+ * @tparam Block Type of a single storage block (any unsigned integer type)
+ */
+template <typename Block = uint64_t>
+class CDynamicBitSet
+{
+    static_assert(std::is_trivially_copyable_v<Block> && static_cast<Block>(~static_cast<Block>(0u)) > static_cast<Block>(0u), "Block has to be an unsigned integer type");
+
+public:
+    /**
+     * Type of a single storage block
+     */
+    using block_type = Block;
+
+    /**
+     * Number of bits in a single block
+     */
+    static constexpr uint64_t block_bits = bitset_detail::block_bits<Block>;
+
+    /**
+     * Block with all the bits set
+     */
+    static constexpr Block block_full = bitset_detail::block_full<Block>;
+
+    /**
+     * Pointer to the blocks
+     */
+    Block* data;
+    /**
+     * Number of bits in the bitset (bit size)
+     */
+    uint64_t size;
+    /**
+     * Number of blocks in use (block size)
+     */
+    uint64_t storage_size;
+    /**
+     * Number of allocated blocks (block size)
+     */
+    uint64_t capacity;
+
+    /**
+     * Empty initialization, nothing is allocated
+     */
+    CDynamicBitSet() noexcept : data(nullptr), size(0), storage_size(0), capacity(0) {}
+
+    /**
+     * Size initialization, all the bits are cleared
+     * @param size The size of the bitset (bit size)
+     */
+    explicit CDynamicBitSet(const uint64_t size) : size(size), storage_size(bitset_detail::storage_size<Block>(size)), capacity(storage_size)
+    {
+        data = static_cast<Block*>(std::calloc(capacity ? capacity : 1u, sizeof(Block)));
+    }
+
+    /**
+     * Size and value initialization
+     * @param size The size of the bitset (bit size)
+     * @param value Value to fill the bits with (bit value)
+     */
+    CDynamicBitSet(const uint64_t size, const bool value) : size(size), storage_size(bitset_detail::storage_size<Block>(size)), capacity(storage_size)
+    {
+        data = static_cast<Block*>(std::malloc((capacity ? capacity : 1u) * sizeof(Block)));
+        fill_all(value);
+    }
+
+    /**
+     * Copy initialization, the storage is duplicated (only storage_size blocks are allocated)
+     * @param other The bitset to copy
+     */
+    CDynamicBitSet(const CDynamicBitSet& other) : size(other.size), storage_size(other.storage_size), capacity(other.storage_size)
+    {
+        data = static_cast<Block*>(std::malloc((capacity ? capacity : 1u) * sizeof(Block)));
+        if (storage_size)
+            std::memcpy(data, other.data, storage_size * sizeof(Block));
+    }
+
+    /**
+     * Move initialization, the storage is taken over and the other bitset is left empty
+     * @param other The bitset to move from
+     */
+    CDynamicBitSet(CDynamicBitSet&& other) noexcept : data(other.data), size(other.size), storage_size(other.storage_size), capacity(other.capacity)
+    {
+        other.data = nullptr;
+        other.size = other.storage_size = other.capacity = 0;
+    }
+
+    ~CDynamicBitSet()
+    {
+        std::free(data);
+    }
+
+    /**
+     * Copy assignment, the existing storage is reused when it is large enough
+     * @param other The bitset to copy
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& operator=(const CDynamicBitSet& other)
+    {
+        if (this == &other)
+            return *this;
+        if (capacity < other.storage_size)
+            reallocate(other.storage_size);
+        size = other.size;
+        storage_size = other.storage_size;
+        if (storage_size)
+            std::memcpy(data, other.data, storage_size * sizeof(Block));
+        return *this;
+    }
+
+    /**
+     * Move assignment, the storage is swapped with the other bitset (released when the other bitset is destroyed)
+     * @param other The bitset to move from
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& operator=(CDynamicBitSet&& other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    /**
+     * Swaps the contents of two bitsets
+     * @param other The bitset to swap with
+     */
+    void swap(CDynamicBitSet& other) noexcept
+    {
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        std::swap(storage_size, other.storage_size);
+        std::swap(capacity, other.capacity);
+    }
+
+    /**
+     * Non-owning view of the bitset for the C API (only when Block is the C block type), e.g. bitset_count(UNIVERSAL_BITSET(&view))
+     * The view must not be destroyed and is invalidated when the bitset reallocates
+     * @return The view
+     */
+    template <typename B = Block, std::enable_if_t<std::is_same_v<B, bitset_block_t>, int> = 0>
+    DynamicBitSet c_view() const noexcept
+    {
+        DynamicBitSet view;
+        view.data = data;
+        view.size = size;
+        view.storage_size = storage_size;
+        view.capacity = capacity;
+        view.mapping = nullptr;
+        view.mapping_size = 0;
+        view.allocator = nullptr;
+        view.alignment = BITSET_MALLOC_ALIGNMENT;
+        return view;
+    }
+
+    /**
+     * Gets the value of the bit at the specified index
+     * @param index Index of the bit (bit index)
+     * @return The value of the bit
+     */
+    bool get(const uint64_t index) const noexcept
+    {
+        return *(data + index / block_bits) >> (index % block_bits) & 1u;
+    }
+
+    /**
+     * Gets the value of the bit at the specified index
+     * @param index Index of the bit (bit index)
+     * @return The value of the bit
+     */
+    bool operator[](const uint64_t index) const noexcept
+    {
+        return get(index);
+    }
+
+    /**
+     * Sets the bit at the specified index to the specified value
+     * @param value Value to set the bit to (bit value)
+     * @param index Index of the bit (bit index)
+     */
+    void set_value(const bool value, const uint64_t index) noexcept
+    {
+        *(data + index / block_bits) = static_cast<Block>((*(data + index / block_bits) & ~(static_cast<Block>(1u) << index % block_bits))
+            | static_cast<Block>(value) << index % block_bits);
+    }
+
+    /**
+     * Sets the bit at the specified index to 1 (true)
+     * @param index Index of the bit (bit index)
+     */
+    void set(const uint64_t index) noexcept
+    {
+        *(data + index / block_bits) |= static_cast<Block>(static_cast<Block>(1u) << index % block_bits);
+    }
+
+    /**
+     * Sets the bit at the specified index to 0 (false)
+     * @param index Index of the bit (bit index)
+     */
+    void clear(const uint64_t index) noexcept
+    {
+        *(data + index / block_bits) &= static_cast<Block>(~(static_cast<Block>(1u) << index % block_bits));
+    }
+
+    /**
+     * Flips the bit at the specified index
+     * @param index Index of the bit (bit index)
+     */
+    void flip(const uint64_t index) noexcept
+    {
+        *(data + index / block_bits) ^= static_cast<Block>(static_cast<Block>(1u) << index % block_bits);
+    }
+
+    /**
+     * Sets the bits at the indices to 1 (true), the blocks are prefetched ahead
+     * @param indices Indices of the bits to set (bit index)
+     * @param count Number of indices
+     */
+    void set_many(const uint64_t* const indices, const uint64_t count) noexcept
+    {
+        bitset_detail::modify_many(data, indices, count, BITSET_OR);
+    }
+
+    /**
+     * Sets the bits at the indices to 0 (false), the blocks are prefetched ahead
+     * @param indices Indices of the bits to clear (bit index)
+     * @param count Number of indices
+     */
+    void clear_many(const uint64_t* const indices, const uint64_t count) noexcept
+    {
+        bitset_detail::modify_many(data, indices, count, BITSET_ANDNOT);
+    }
+
+    /**
+     * Flips the bits at the indices, the blocks are prefetched ahead
+     * @param indices Indices of the bits to flip (bit index)
+     * @param count Number of indices
+     */
+    void flip_many(const uint64_t* const indices, const uint64_t count) noexcept
+    {
+        bitset_detail::modify_many(data, indices, count, BITSET_XOR);
+    }
+
+    /**
+     * Sets the bits at the sorted indices to 1 (true), updates to the same block are merged
+     * @param indices Indices of the bits to set, ascending (bit index)
+     * @param count Number of indices
+     */
+    void set_many_sorted(const uint64_t* const indices, const uint64_t count) noexcept
+    {
+        bitset_detail::modify_many_sorted(data, indices, count, BITSET_OR);
+    }
+
+    /**
+     * Sets the bits at the sorted indices to 0 (false), updates to the same block are merged
+     * @param indices Indices of the bits to clear, ascending (bit index)
+     * @param count Number of indices
+     */
+    void clear_many_sorted(const uint64_t* const indices, const uint64_t count) noexcept
+    {
+        bitset_detail::modify_many_sorted(data, indices, count, BITSET_ANDNOT);
+    }
+
+    /**
+     * Flips the bits at the sorted indices, updates to the same block are merged
+     * @param indices Indices of the bits to flip, ascending (bit index)
+     * @param count Number of indices
+     */
+    void flip_many_sorted(const uint64_t* const indices, const uint64_t count) noexcept
+    {
+        bitset_detail::modify_many_sorted(data, indices, count, BITSET_XOR);
+    }
+
+    /**
+     * Gets the values of the bits at the indices, with 64-bit blocks AVX-512 gathers are used when supported
+     * @param indices Indices of the bits to read (bit index)
+     * @param count Number of indices
+     * @param values Array receiving the values of the bits
+     */
+    void get_many(const uint64_t* const indices, const uint64_t count, bool* const values) const noexcept
+    {
+        if constexpr (std::is_same_v<Block, uint64_t>)
+            bitset_gather_bits_buffer(data, indices, count, values);
+        else
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                if (i + BITSET_PREFETCH_DISTANCE < count)
+                    BITSET_PREFETCH(data + *(indices + i + BITSET_PREFETCH_DISTANCE) / block_bits, 0);
+                *(values + i) = get(*(indices + i));
+            }
+    }
+
+    /**
+     * Writes the indices of all the set bits in increasing order, with 64-bit blocks the AVX-512 compress kernel is used when supported
+     * @tparam Index uint64_t or uint32_t (base + size has to fit)
+     * @param indices Array receiving the indices, room for count() indices
+     * @param base Value added to every index
+     * @return The number of indices written
+     */
+    template <typename Index>
+    uint64_t to_indices(Index* const indices, const Index base = 0) const noexcept
+    {
+        static_assert(std::is_same_v<Index, uint64_t> || std::is_same_v<Index, uint32_t>, "Index has to be uint64_t or uint32_t");
+        if (!size)
+            return 0;
+        uint64_t written = 0;
+        if constexpr (std::is_same_v<Block, uint64_t> && std::is_same_v<Index, uint64_t>)
+            written = bitset_extract_indices_buffer(data, storage_size - 1, base, indices);
+        else if constexpr (std::is_same_v<Block, uint64_t>)
+            written = bitset_extract_indices32_buffer(data, storage_size - 1, base, indices);
+        else
+            for (uint64_t i = 0; i + 1 < storage_size; ++i)
+                for (Block block = *(data + i); block; block &= static_cast<Block>(block - 1u))
+                    *(indices + written++) = static_cast<Index>(base + i * block_bits + bitset_detail::block_lowest_bit(block));
+        for (Block block = static_cast<Block>(*(data + storage_size - 1) & bitset_detail::tail_block<Block>(size)); block; block &= static_cast<Block>(block - 1u))
+            *(indices + written++) = static_cast<Index>(base + (storage_size - 1) * block_bits + bitset_detail::block_lowest_bit(block));
+        return written;
+    }
+
+    /**
+     * Sets exactly the bits at the indices and clears all the others, every block is written once (sorted indices are the fastest, any order works)
+     * @tparam Index uint64_t or uint32_t
+     * @param indices Indices of the bits to set (bit index, lower than the size)
+     * @param count Number of indices
+     */
+    template <typename Index>
+    void from_sorted_indices(const Index* const indices, const uint64_t count) noexcept
+    {
+        uint64_t next = 0;
+        for (uint64_t i = 0; i < count;)
+        {
+            const uint64_t index = *(indices + i) / block_bits;
+            Block block = 0u;
+            for (; i < count && *(indices + i) / block_bits == index; ++i)
+                block |= static_cast<Block>(static_cast<Block>(1u) << *(indices + i) % block_bits);
+            if (index < next)
+            {
+                *(data + index) |= block;
+                continue;
+            }
+            std::memset(data + next, 0, (index - next) * sizeof(Block));
+            *(data + index) = block;
+            next = index + 1;
+        }
+        if (storage_size > next)
+            std::memset(data + next, 0, (storage_size - next) * sizeof(Block));
+    }
+
+    /**
+     * Fills all the bits with the specified value
+     * @param value Value to fill the bits with (bit value)
+     */
+    void fill_all(const bool value) noexcept
+    {
+        if (storage_size)
+            std::memset(data, value ? 255 : 0, storage_size * sizeof(Block));
+    }
+
+    /**
+     * Sets all the bits to 1 (true)
+     */
+    void set_all() noexcept
+    {
+        fill_all(true);
+    }
+
+    /**
+     * Sets all the bits to 0 (false)
+     */
+    void clear_all() noexcept
+    {
+        fill_all(false);
+    }
+
+    /**
+     * Flips all the bits
+     */
+    void flip_all() noexcept
+    {
+        for (uint64_t i = 0; i < storage_size; ++i)
+            *(data + i) = static_cast<Block>(~*(data + i));
+    }
+
+    /**
+     * Fills all the bits in the specified range with the specified value
+     * @param value Value to fill the bits with (bit value)
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     */
+    void fill_in_range(const bool value, const uint64_t begin, const uint64_t end) noexcept
+    {
+        if (begin >= end)
+            return;
+        const uint64_t begin_block = begin / block_bits, end_block = (end - 1) / block_bits;
+        if (end_block > begin_block + 1)
+        {
+            // whole blocks in the middle of the range
+            std::memset(data + begin_block + 1, value ? 255 : 0, (end_block - begin_block - 1) * sizeof(Block));
+            bitset_detail::fill_in_range(data, value, begin, (begin_block + 1) * block_bits);
+            bitset_detail::fill_in_range(data, value, end_block * block_bits, end);
+        }
+        else
+            bitset_detail::fill_in_range(data, value, begin, end);
+    }
+
+    /**
+     * Fills every step-th bit in the specified range with the specified value
+     * With the C block type this uses the repeating pattern fill of the C API
+     * @param value Value to fill the bits with (bit value)
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     * @param step Step between the bits (bit step)
+     */
+    void fill_in_range(const bool value, const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        if constexpr (std::is_same_v<Block, bitset_block_t>)
+        {
+            DynamicBitSet view = c_view();
+            bitset_fill_in_range_begin_end_step(UNIVERSAL_BITSET(&view), value, begin, end, step);
+        }
+        else if (value)
+        {
+            for (uint64_t i = begin; i < end; i += step)
+                set(i);
+        }
+        else
+        {
+            for (uint64_t i = begin; i < end; i += step)
+                clear(i);
+        }
+    }
+
+    /**
+     * Sets all the bits in the specified range to 1 (true)
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     */
+    void set_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        fill_in_range(true, begin, end);
+    }
+
+    /**
+     * Sets every step-th bit in the specified range to 1 (true)
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     * @param step Step between the bits (bit step)
+     */
+    void set_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        fill_in_range(true, begin, end, step);
+    }
+
+    /**
+     * Sets all the bits in the specified range to 0 (false)
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     */
+    void clear_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        fill_in_range(false, begin, end);
+    }
+
+    /**
+     * Sets every step-th bit in the specified range to 0 (false)
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     * @param step Step between the bits (bit step)
+     */
+    void clear_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        fill_in_range(false, begin, end, step);
+    }
+
+    /**
+     * Flips all the bits in the specified range
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     */
+    void flip_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        bitset_detail::flip_in_range(data, begin, end);
+    }
+
+    /**
+     * Flips every step-th bit in the specified range
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     * @param step Step between the bits (bit step)
+     */
+    void flip_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        for (uint64_t i = begin; i < end; i += step)
+            flip(i);
+    }
+
+    /**
+     * Gets the block at the specified index
+     * @param index Index of the block (block index)
+     * @return The block
+     */
+    Block get_block(const uint64_t index) const noexcept
+    {
+        return *(data + index);
+    }
+
+    /**
+     * Sets the block at the specified index
+     * @param block The block to set (block value)
+     * @param index Index of the block (block index)
+     */
+    void set_block(const Block block, const uint64_t index) noexcept
+    {
+        *(data + index) = block;
+    }
+
+    /**
+     * Sets every block to the specified block
+     * @param block The block to fill the storage with (block value)
+     */
+    void fill_all_blocks(const Block block) noexcept
+    {
+        fill_block_in_range(block, 0, storage_size);
+    }
+
+    /**
+     * Sets the blocks in the specified range to the specified block
+     * @param block The block to fill with (block value)
+     * @param begin Begin of the range (block index)
+     * @param end End of the range (block index)
+     */
+    void fill_block_in_range(const Block block, const uint64_t begin, const uint64_t end) noexcept
+    {
+        for (uint64_t i = begin; i < end; ++i)
+            *(data + i) = block;
+    }
+
+    /**
+     * Checks if all the bits are set
+     * @return True if all the bits are set (true for an empty bitset)
+     */
+    bool all() const noexcept
+    {
+        return all_in_range(0, size);
+    }
+
+    /**
+     * Checks if any of the bits are set
+     * @return True if any of the bits are set
+     */
+    bool any() const noexcept
+    {
+        return any_in_range(0, size);
+    }
+
+    /**
+     * Checks if none of the bits are set
+     * @return True if none of the bits are set
+     */
+    bool none() const noexcept
+    {
+        return !any();
+    }
+
+    /**
+     * Checks if the bitset is empty
+     * @return True if the size is 0
+     */
+    bool empty() const noexcept
+    {
+        return !size;
+    }
+
+    /**
+     * Counts the set bits (popcount kernel of BitSetKernels.h)
+     * @return The number of set bits
+     */
+    uint64_t count() const noexcept
+    {
+        if (!size)
+            return 0;
+        return bitset_popcount_buffer(data, (storage_size - 1) * sizeof(Block))
+            + bitset_detail::block_popcount(static_cast<Block>(*(data + storage_size - 1) & bitset_detail::tail_block<Block>(size)));
+    }
+
+    /**
+     * Counts the set bits in the specified range
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     * @return The number of set bits in the range
+     */
+    uint64_t count_in_range(const uint64_t begin, const uint64_t end) const noexcept
+    {
+        return bitset_detail::count_in_range(data, begin, end, true);
+    }
+
+    /**
+     * Checks if any of the bits in the specified range are set
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     * @return True if any of the bits in the range are set
+     */
+    bool any_in_range(const uint64_t begin, const uint64_t end) const noexcept
+    {
+        return bitset_detail::find_in_range(data, true, begin, end, true) != BITSET_NPOS;
+    }
+
+    /**
+     * Checks if all the bits in the specified range are set
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     * @return True if all the bits in the range are set (true for an empty range)
+     */
+    bool all_in_range(const uint64_t begin, const uint64_t end) const noexcept
+    {
+        return bitset_detail::find_in_range(data, false, begin, end, true) == BITSET_NPOS;
+    }
+
+    /**
+     * Finds the first bit with the specified value in the specified range
+     * @param value Value of the bit to find (bit value)
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     * @return Index of the found bit or BITSET_NPOS
+     */
+    uint64_t find_in_range(const bool value, const uint64_t begin, const uint64_t end) const noexcept
+    {
+        return bitset_detail::find_in_range(data, value, begin, end, true);
+    }
+
+    /**
+     * Finds the first set bit
+     * @return Index of the found bit or BITSET_NPOS
+     */
+    uint64_t find_first() const noexcept
+    {
+        return find_in_range(true, 0, size);
+    }
+
+    /**
+     * Finds the first set bit after the specified index
+     * @param index Index to search after (bit index)
+     * @return Index of the found bit or BITSET_NPOS
+     */
+    uint64_t find_next(const uint64_t index) const noexcept
+    {
+        return find_in_range(true, index + 1, size);
+    }
+
+    /**
+     * Finds the last set bit
+     * @return Index of the found bit or BITSET_NPOS
+     */
+    uint64_t find_last() const noexcept
+    {
+        return bitset_detail::find_before(data, true, size);
+    }
+
+    /**
+     * Finds the last set bit before the specified index
+     * @param index Index to search before (bit index)
+     * @return Index of the found bit or BITSET_NPOS
+     */
+    uint64_t find_prev(const uint64_t index) const noexcept
+    {
+        return bitset_detail::find_before(data, true, index < size ? index : size);
+    }
+
+    /**
+     * Finds the first cleared bit
+     * @return Index of the found bit or BITSET_NPOS
+     */
+    uint64_t find_first_cleared() const noexcept
+    {
+        return find_in_range(false, 0, size);
+    }
+
+    /**
+     * Finds the first cleared bit after the specified index
+     * @param index Index to search after (bit index)
+     * @return Index of the found bit or BITSET_NPOS
+     */
+    uint64_t find_next_cleared(const uint64_t index) const noexcept
+    {
+        return find_in_range(false, index + 1, size);
+    }
+
+    /**
+     * Appends a bit, amortized O(1)
+     * @param value Value of the bit to append (bit value)
+     */
+    void push_back(const bool value)
+    {
+        if (!(size % block_bits))
+        {
+            grow(storage_size + 1);
+            *(data + storage_size++) = 0u;
+        }
+        set_value(value, size++);
+    }
+
+    /**
+     * Removes the last bit, the capacity is kept
+     */
+    void pop_back() noexcept
+    {
+        if (size && !(--size % block_bits))
+            --storage_size;
+    }
+
+    /**
+     * Appends a block, rounding the size up to a multiple of the block size
+     * @param block The block to append (block value)
+     */
+    void push_back_block(const Block block)
+    {
+        grow(storage_size + 1);
+        *(data + storage_size++) = block;
+        size = storage_size * block_bits;
+    }
+
+    /**
+     * Removes the last block, rounding the size down to a multiple of the block size
+     */
+    void pop_back_block() noexcept
+    {
+        if (!storage_size)
+            return;
+        size = size % block_bits ? size / block_bits * block_bits : size - block_bits;
+        storage_size = bitset_detail::storage_size<Block>(size);
+    }
+
+    /**
+     * Changes the size of the bitset, new bits are cleared
+     * @param new_size The new size (bit size)
+     */
+    void resize(const uint64_t new_size)
+    {
+        if (new_size == size)
+            return;
+        const uint64_t new_storage_size = bitset_detail::storage_size<Block>(new_size);
+        if (new_size > size)
+        {
+            grow(new_storage_size);
+            if (size % block_bits)
+                *(data + size / block_bits) &= bitset_detail::tail_block<Block>(size);
+            if (new_storage_size > storage_size)
+                std::memset(data + storage_size, 0, (new_storage_size - storage_size) * sizeof(Block));
+        }
+        storage_size = new_storage_size;
+        size = new_size;
+    }
+
+    /**
+     * Makes sure the bitset can hold the specified number of bits without reallocating
+     * @param bits The number of bits to reserve the memory for (bit size)
+     */
+    void reserve(const uint64_t bits)
+    {
+        const uint64_t new_capacity = bitset_detail::storage_size<Block>(bits);
+        if (new_capacity > capacity)
+            reallocate(new_capacity);
+    }
+
+    /**
+     * Releases the unused capacity
+     */
+    void shrink_to_fit()
+    {
+        if (capacity > storage_size)
+            reallocate(storage_size);
+    }
+
+    /**
+     * Changes the number of allocated blocks
+     * @param new_capacity The number of blocks to allocate (block size)
+     */
+    void reallocate(const uint64_t new_capacity)
+    {
+        data = static_cast<Block*>(std::realloc(data, (new_capacity ? new_capacity : 1u) * sizeof(Block)));
+        capacity = new_capacity;
+    }
+
+    /**
+     * Grows the capacity geometrically (by BITSET_GROWTH_FACTOR) to fit the specified number of blocks
+     * @param new_storage_size The number of blocks to fit (block size)
+     */
+    void grow(const uint64_t new_storage_size)
+    {
+        if (new_storage_size <= capacity)
+            return;
+        const uint64_t grown_capacity = capacity * BITSET_GROWTH_FACTOR;
+        reallocate(grown_capacity > new_storage_size ? grown_capacity : new_storage_size);
+    }
+
+    /**
+     * Applies a bitwise operation with another bitset in place (operation kernel of BitSetKernels.h)
+     * @param other The second operand (same size)
+     * @param operation The operation to apply
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& apply_operation(const CDynamicBitSet& other, const BitSetOperation operation) noexcept
+    {
+        const uint64_t blocks = storage_size < other.storage_size ? storage_size : other.storage_size;
+        bitset_operation_buffer(data, data, other.data, blocks * sizeof(Block), operation);
+        return *this;
+    }
+
+    /**
+     * Counts the set bits of a bitwise operation with another bitset without storing it
+     * @param other The second operand (same size)
+     * @param operation The operation to apply
+     * @return The number of set bits in the result
+     */
+    uint64_t apply_operation_count(const CDynamicBitSet& other, const BitSetOperation operation) const noexcept
+    {
+        const uint64_t blocks = storage_size < other.storage_size ? storage_size : other.storage_size;
+        if (!blocks)
+            return 0;
+        const Block last = bitset_detail::apply_operation_block(*(data + blocks - 1), *(other.data + blocks - 1), operation);
+        return bitset_operation_count_buffer(data, other.data, (blocks - 1) * sizeof(Block), operation)
+            + bitset_detail::block_popcount(static_cast<Block>(last & bitset_detail::tail_block<Block>(size < other.size ? size : other.size)));
+    }
+
+    CDynamicBitSet& operator&=(const CDynamicBitSet& other) noexcept
+    {
+        return apply_operation(other, BITSET_AND);
+    }
+
+    CDynamicBitSet& operator|=(const CDynamicBitSet& other) noexcept
+    {
+        return apply_operation(other, BITSET_OR);
+    }
+
+    CDynamicBitSet& operator^=(const CDynamicBitSet& other) noexcept
+    {
+        return apply_operation(other, BITSET_XOR);
+    }
+
+    /**
+     * Shifts the bits towards higher indices (bit i moves to i + shift)
+     * @param shift Number of bits to shift by
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& operator<<=(const uint64_t shift) noexcept
+    {
+        if (shift >= size)
+            fill_all(false);
+        else
+            bitset_detail::shift_left(data, storage_size, shift);
+        return *this;
+    }
+
+    /**
+     * Shifts the bits towards lower indices (bit i moves to i - shift)
+     * @param shift Number of bits to shift by
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& operator>>=(const uint64_t shift) noexcept
+    {
+        if (shift >= size)
+            fill_all(false);
+        else
+        {
+            *(data + storage_size - 1) &= bitset_detail::tail_block<Block>(size);
+            bitset_detail::shift_right(data, storage_size, shift);
+        }
+        return *this;
+    }
+
+    /**
+     * Flipped copy of the bitset
+     */
+    CDynamicBitSet operator~() const
+    {
+        CDynamicBitSet result(*this);
+        result.flip_all();
+        return result;
+    }
+
+    /**
+     * Compares the bits of two bitsets (the bits past the size are ignored)
+     */
+    bool operator==(const CDynamicBitSet& other) const noexcept
+    {
+        if (size != other.size)
+            return false;
+        if (!size)
+            return true;
+        if (storage_size > 1 && std::memcmp(data, other.data, (storage_size - 1) * sizeof(Block)))
+            return false;
+        return !((*(data + storage_size - 1) ^ *(other.data + storage_size - 1)) & bitset_detail::tail_block<Block>(size));
+    }
+
+    bool operator!=(const CDynamicBitSet& other) const noexcept
+    {
+        return !(*this == other);
+    }
+};
+
+// binary operators take the left operand by value, so temporaries are moved into the result instead of copied
+
+template <typename Block>
+CDynamicBitSet<Block> operator&(CDynamicBitSet<Block> first, const CDynamicBitSet<Block>& second)
+{
+    first &= second;
+    return first;
+}
+
+template <typename Block>
+CDynamicBitSet<Block> operator|(CDynamicBitSet<Block> first, const CDynamicBitSet<Block>& second)
+{
+    first |= second;
+    return first;
+}
+
+template <typename Block>
+CDynamicBitSet<Block> operator^(CDynamicBitSet<Block> first, const CDynamicBitSet<Block>& second)
+{
+    first ^= second;
+    return first;
+}
+
+template <typename Block>
+CDynamicBitSet<Block> operator<<(CDynamicBitSet<Block> bitset, const uint64_t shift)
+{
+    bitset <<= shift;
+    return bitset;
+}
+
+template <typename Block>
+CDynamicBitSet<Block> operator>>(CDynamicBitSet<Block> bitset, const uint64_t shift)
+{
+    bitset >>= shift;
+    return bitset;
+}
+
+/**
+ * A fixed size bitset class, the size and the storage size are compile time constants so every operation is constexpr
+ * and the loops over the blocks unroll for small sizes. Unlike the C fixed size BitSet (one BITSET_SIZE per translation unit)
+ * any number of sizes can be used at once.
+ * The bits past N are kept cleared by every operation.
+ * @tparam N Size of the bitset (bit size)
+ * @tparam Block Type of a single storage block (any unsigned integer type)
+ */
+template <uint64_t N, typename Block = uint64_t>
+class CBitSet
+{
+    static_assert(std::is_trivially_copyable_v<Block> && static_cast<Block>(~static_cast<Block>(0u)) > static_cast<Block>(0u), "Block has to be an unsigned integer type");
+
+public:
+    /**
+     * Type of a single storage block
+     */
+    using block_type = Block;
+
+    /**
+     * Number of bits in a single block
+     */
+    static constexpr uint64_t block_bits = bitset_detail::block_bits<Block>;
+
+    /**
+     * Block with all the bits set
+     */
+    static constexpr Block block_full = bitset_detail::block_full<Block>;
+
+    /**
+     * Size of the bitset (bit size)
+     */
+    static constexpr uint64_t size = N;
+
+    /**
+     * Number of blocks (block size), at least one so the storage is never a zero sized array
+     */
+    static constexpr uint64_t storage_size = N ? bitset_detail::storage_size<Block>(N) : 1u;
+
+    /**
+     * Mask of the bits used in the last block
+     */
+    static constexpr Block tail_mask = N ? bitset_detail::tail_block<Block>(N) : static_cast<Block>(0u);
+
+    /**
+     * The blocks
+     */
+    Block data[storage_size];
+
+    /**
+     * Initialization with all the bits cleared
+     */
+    constexpr CBitSet() noexcept : data{} {}
+
+    /**
+     * Value initialization
+     * @param value Value to fill the bits with (bit value)
+     */
+    constexpr explicit CBitSet(const bool value) noexcept : data{}
+    {
+        fill_all(value);
+    }
+
+    constexpr bool get(const uint64_t index) const noexcept
+    {
+        return data[index / block_bits] >> (index % block_bits) & 1u;
+    }
+
+    constexpr bool operator[](const uint64_t index) const noexcept
+    {
+        return get(index);
+    }
+
+    constexpr void set_value(const bool value, const uint64_t index) noexcept
+    {
+        data[index / block_bits] = static_cast<Block>((data[index / block_bits] & ~(static_cast<Block>(1u) << index % block_bits))
+            | static_cast<Block>(value) << index % block_bits);
+    }
+
+    constexpr void set(const uint64_t index) noexcept
+    {
+        data[index / block_bits] |= static_cast<Block>(static_cast<Block>(1u) << index % block_bits);
+    }
+
+    constexpr void clear(const uint64_t index) noexcept
+    {
+        data[index / block_bits] &= static_cast<Block>(~(static_cast<Block>(1u) << index % block_bits));
+    }
+
+    constexpr void flip(const uint64_t index) noexcept
+    {
+        data[index / block_bits] ^= static_cast<Block>(static_cast<Block>(1u) << index % block_bits);
+    }
+
+    constexpr void fill_all(const bool value) noexcept
+    {
+        for (uint64_t i = 0; i < storage_size; ++i)
+            data[i] = value ? block_full : static_cast<Block>(0u);
+        data[storage_size - 1] &= tail_mask;
+    }
+
+    constexpr void set_all() noexcept
+    {
+        fill_all(true);
+    }
+
+    constexpr void clear_all() noexcept
+    {
+        fill_all(false);
+    }
+
+    constexpr void flip_all() noexcept
+    {
+        for (uint64_t i = 0; i < storage_size; ++i)
+            data[i] = static_cast<Block>(~data[i]);
+        data[storage_size - 1] &= tail_mask;
+    }
+
+    /**
+     * Fills all the bits in the specified range with the specified value
+     * @param value Value to fill the bits with (bit value)
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index, at most N)
+     */
+    constexpr void fill_in_range(const bool value, const uint64_t begin, const uint64_t end) noexcept
+    {
+        bitset_detail::fill_in_range(data, value, begin, end);
+    }
+
+    /**
+     * Fills every step-th bit in the specified range with the specified value
+     * @param value Value to fill the bits with (bit value)
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index, at most N)
+     * @param step Step between the bits (bit step)
+     */
+    constexpr void fill_in_range(const bool value, const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        for (uint64_t i = begin; i < end; i += step)
+            set_value(value, i);
+    }
+
+    constexpr void set_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        fill_in_range(true, begin, end);
+    }
+
+    constexpr void set_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        fill_in_range(true, begin, end, step);
+    }
+
+    constexpr void clear_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        fill_in_range(false, begin, end);
+    }
+
+    constexpr void clear_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        fill_in_range(false, begin, end, step);
+    }
+
+    constexpr void flip_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        bitset_detail::flip_in_range(data, begin, end);
+    }
+
+    constexpr Block get_block(const uint64_t index) const noexcept
+    {
+        return data[index];
+    }
+
+    /**
+     * Sets the block at the specified index (the bits past N are cleared)
+     * @param block The block to set (block value)
+     * @param index Index of the block (block index)
+     */
+    constexpr void set_block(const Block block, const uint64_t index) noexcept
+    {
+        data[index] = index == storage_size - 1 ? static_cast<Block>(block & tail_mask) : block;
+    }
+
+    constexpr bool all() const noexcept
+    {
+        for (uint64_t i = 0; i + 1 < storage_size; ++i)
+        {
+            if (data[i] != block_full)
+                return false;
+        }
+        return data[storage_size - 1] == tail_mask;
+    }
+
+    constexpr bool any() const noexcept
+    {
+        for (uint64_t i = 0; i < storage_size; ++i)
+        {
+            if (data[i])
+                return true;
+        }
+        return false;
+    }
+
+    constexpr bool none() const noexcept
+    {
+        return !any();
+    }
+
+    constexpr uint64_t count() const noexcept
+    {
+        uint64_t count = 0;
+        for (uint64_t i = 0; i < storage_size; ++i)
+            count += bitset_detail::block_popcount(data[i]);
+        return count;
+    }
+
+    constexpr uint64_t count_in_range(const uint64_t begin, const uint64_t end) const noexcept
+    {
+        return bitset_detail::count_in_range(data, begin, end, false);
+    }
+
+    constexpr bool any_in_range(const uint64_t begin, const uint64_t end) const noexcept
+    {
+        return bitset_detail::find_in_range(data, true, begin, end, false) != BITSET_NPOS;
+    }
+
+    constexpr bool all_in_range(const uint64_t begin, const uint64_t end) const noexcept
+    {
+        return bitset_detail::find_in_range(data, false, begin, end, false) == BITSET_NPOS;
+    }
+
+    constexpr uint64_t find_in_range(const bool value, const uint64_t begin, const uint64_t end) const noexcept
+    {
+        return bitset_detail::find_in_range(data, value, begin, end, false);
+    }
+
+    constexpr uint64_t find_first() const noexcept
+    {
+        return find_in_range(true, 0, N);
+    }
+
+    constexpr uint64_t find_next(const uint64_t index) const noexcept
+    {
+        return find_in_range(true, index + 1, N);
+    }
+
+    constexpr uint64_t find_last() const noexcept
+    {
+        return bitset_detail::find_before(data, true, N);
+    }
+
+    constexpr uint64_t find_prev(const uint64_t index) const noexcept
+    {
+        return bitset_detail::find_before(data, true, index < N ? index : N);
+    }
+
+    constexpr uint64_t find_first_cleared() const noexcept
+    {
+        return find_in_range(false, 0, N);
+    }
+
+    constexpr CBitSet& operator&=(const CBitSet& other) noexcept
+    {
+        for (uint64_t i = 0; i < storage_size; ++i)
+            data[i] &= other.data[i];
+        return *this;
+    }
+
+    constexpr CBitSet& operator|=(const CBitSet& other) noexcept
+    {
+        for (uint64_t i = 0; i < storage_size; ++i)
+            data[i] |= other.data[i];
+        return *this;
+    }
+
+    constexpr CBitSet& operator^=(const CBitSet& other) noexcept
+    {
+        for (uint64_t i = 0; i < storage_size; ++i)
+            data[i] ^= other.data[i];
+        return *this;
+    }
+
+    constexpr CBitSet& operator<<=(const uint64_t shift) noexcept
+    {
+        if (shift >= N)
+            fill_all(false);
+        else
+        {
+            bitset_detail::shift_left(data, storage_size, shift);
+            data[storage_size - 1] &= tail_mask;
+        }
+        return *this;
+    }
+
+    constexpr CBitSet& operator>>=(const uint64_t shift) noexcept
+    {
+        if (shift >= N)
+            fill_all(false);
+        else
+            bitset_detail::shift_right(data, storage_size, shift);
+        return *this;
+    }
+
+    constexpr CBitSet operator~() const noexcept
+    {
+        CBitSet result(*this);
+        result.flip_all();
+        return result;
+    }
+
+    constexpr CBitSet operator&(const CBitSet& other) const noexcept
+    {
+        return CBitSet(*this) &= other;
+    }
+
+    constexpr CBitSet operator|(const CBitSet& other) const noexcept
+    {
+        return CBitSet(*this) |= other;
+    }
+
+    constexpr CBitSet operator^(const CBitSet& other) const noexcept
+    {
+        return CBitSet(*this) ^= other;
+    }
+
+    constexpr CBitSet operator<<(const uint64_t shift) const noexcept
+    {
+        return CBitSet(*this) <<= shift;
+    }
+
+    constexpr CBitSet operator>>(const uint64_t shift) const noexcept
+    {
+        return CBitSet(*this) >>= shift;
+    }
+
+    constexpr bool operator==(const CBitSet& other) const noexcept
+    {
+        for (uint64_t i = 0; i < storage_size; ++i)
+        {
+            if (data[i] != other.data[i])
+                return false;
+        }
+        return true;
+    }
+
+    constexpr bool operator!=(const CBitSet& other) const noexcept
+    {
+        return !(*this == other);
+    }
+};
@@ -0,0 +1,371 @@
+#pragma once
+
+#include "BitSet.hpp"
+#include "../C/BitSetExpr.h"
+
+/**
+ * Expression templates over CDynamicBitSet and CBitSet: bitset_expr::ref(a) & b | ~bitset_expr::ref(c) builds a tree of
+ * lightweight nodes instead of materializing intermediate bitsets. Evaluating the tree computes one block of the result
+ * at a time straight from the operands (so every operand is read once, in a single pass), reductions collect the blocks
+ * into a tile of BITSET_EXPR_TILE_BYTES (kept in the L1 cache) and count or search it with the kernels of BitSetKernels.h.
+ * The operators only apply when one of the operands is an expression, the operators of the bitset classes are unchanged.
+ * Nodes hold pointers to the bitsets, which have to outlive the expression.
+ */
+
+namespace bitset_expr
+{
+    /**
+     * Base of every node (CRTP), provides the evaluation of the whole expression
+     * @tparam Derived Type of the node
+     */
+    template <typename Derived>
+    class Expression
+    {
+    public:
+        /**
+         * The node as its real type
+         */
+        const Derived& derived() const noexcept
+        {
+            return static_cast<const Derived&>(*this);
+        }
+
+        /**
+         * Counts the set bits of the result without storing it
+         * @return The number of set bits in the result
+         */
+        uint64_t count() const noexcept;
+
+        /**
+         * Checks if any of the bits of the result are set, stops at the first tile containing one
+         * @return True if any of the bits are set
+         */
+        bool any() const noexcept
+        {
+            return find_first() != BITSET_NPOS;
+        }
+
+        /**
+         * Checks if none of the bits of the result are set
+         * @return True if none of the bits are set
+         */
+        bool none() const noexcept
+        {
+            return !any();
+        }
+
+        /**
+         * Finds the first set bit of the result, stops at the first tile containing one
+         * @return Index of the found bit or BITSET_NPOS
+         */
+        uint64_t find_first() const noexcept;
+
+        /**
+         * Stores the result in a new bitset
+         * @return The result
+         */
+        auto evaluate() const;
+    };
+
+    /**
+     * Checks if a type is a node of an expression
+     */
+    template <typename T>
+    constexpr bool is_expression = std::is_base_of_v<Expression<T>, T>;
+
+    /**
+     * Checks if a type is a bitset which can be used as an operand
+     */
+    template <typename T>
+    struct is_bitset : std::false_type {};
+
+    template <typename Block>
+    struct is_bitset<CDynamicBitSet<Block>> : std::true_type {};
+
+    template <uint64_t N, typename Block>
+    struct is_bitset<CBitSet<N, Block>> : std::true_type {};
+
+    /**
+     * Leaf referring to the blocks of a bitset
+     * @tparam Block Type of a single storage block
+     */
+    template <typename Block>
+    class Ref : public Expression<Ref<Block>>
+    {
+    public:
+        using block_type = Block;
+
+        /**
+         * Pointer to the blocks
+         */
+        const Block* data;
+        /**
+         * Number of bits (bit size)
+         */
+        uint64_t bits;
+
+        constexpr Ref(const Block* const data, const uint64_t bits) noexcept : data(data), bits(bits) {}
+
+        constexpr uint64_t size() const noexcept
+        {
+            return bits;
+        }
+
+        constexpr Block block(const uint64_t index) const noexcept
+        {
+            return *(data + index);
+        }
+    };
+
+    /**
+     * Node flipping its operand
+     * @tparam Operand Type of the operand node
+     */
+    template <typename Operand>
+    class Not : public Expression<Not<Operand>>
+    {
+    public:
+        using block_type = typename Operand::block_type;
+
+        /**
+         * The operand
+         */
+        Operand operand;
+
+        constexpr explicit Not(const Operand& operand) noexcept : operand(operand) {}
+
+        constexpr uint64_t size() const noexcept
+        {
+            return operand.size();
+        }
+
+        constexpr block_type block(const uint64_t index) const noexcept
+        {
+            return static_cast<block_type>(~operand.block(index));
+        }
+    };
+
+    /**
+     * Node combining two operands, the result has the size of the smaller one
+     * @tparam Operation The operation (a constant, so the switch of apply_operation_block folds away)
+     * @tparam First Type of the first operand node
+     * @tparam Second Type of the second operand node
+     */
+    template <BitSetOperation Operation, typename First, typename Second>
+    class Binary : public Expression<Binary<Operation, First, Second>>
+    {
+        static_assert(std::is_same_v<typename First::block_type, typename Second::block_type>, "Operands have to use the same block type");
+
+    public:
+        using block_type = typename First::block_type;
+
+        /**
+         * The first operand
+         */
+        First first;
+        /**
+         * The second operand
+         */
+        Second second;
+
+        constexpr Binary(const First& first, const Second& second) noexcept : first(first), second(second) {}
+
+        constexpr uint64_t size() const noexcept
+        {
+            return first.size() < second.size() ? first.size() : second.size();
+        }
+
+        constexpr block_type block(const uint64_t index) const noexcept
+        {
+            return bitset_detail::apply_operation_block<block_type>(first.block(index), second.block(index), Operation);
+        }
+    };
+
+    /**
+     * Creates a leaf referring to a dynamic bitset
+     */
+    template <typename Block>
+    constexpr Ref<Block> ref(const CDynamicBitSet<Block>& bitset) noexcept
+    {
+        return Ref<Block>(bitset.data, bitset.size);
+    }
+
+    /**
+     * Creates a leaf referring to a fixed size bitset
+     */
+    template <uint64_t N, typename Block>
+    constexpr Ref<Block> ref(const CBitSet<N, Block>& bitset) noexcept
+    {
+        return Ref<Block>(bitset.data, N);
+    }
+
+    /**
+     * Turns an operand of an operator into a node (bitsets become leaves, nodes are kept)
+     */
+    template <typename T>
+    constexpr auto as_expression(const T& operand) noexcept
+    {
+        if constexpr (is_expression<T>)
+            return operand;
+        else
+            return ref(operand);
+    }
+
+    /**
+     * Checks if a type can be an operand of an expression (a node or a bitset)
+     */
+    template <typename T>
+    constexpr bool is_operand = is_expression<T> || is_bitset<T>::value;
+
+    /**
+     * Checks if the operands of a binary operator form an expression (at least one is a node, the other a node or a bitset)
+     */
+    template <typename First, typename Second>
+    constexpr bool is_operator_pair = (is_expression<First> || is_expression<Second>) && is_operand<First> && is_operand<Second>;
+
+    /**
+     * Evaluates an expression tile by tile, the bits past the size are cleared in the last tile
+     * @param expression The expression
+     * @param sink Called with (tile, first block index, number of blocks), returns false to stop
+     * @return False if the sink stopped the evaluation
+     */
+    template <typename E, typename Sink>
+    bool for_each_tile(const E& expression, Sink&& sink)
+    {
+        using Block = typename E::block_type;
+        constexpr uint64_t tile_blocks = BITSET_EXPR_TILE_BYTES / sizeof(Block) ? BITSET_EXPR_TILE_BYTES / sizeof(Block) : 1u;
+        Block tile[tile_blocks];
+        const uint64_t storage_size = bitset_detail::storage_size<Block>(expression.size());
+        for (uint64_t begin = 0; begin < storage_size; begin += tile_blocks)
+        {
+            const uint64_t blocks = storage_size - begin < tile_blocks ? storage_size - begin : tile_blocks;
+            for (uint64_t i = 0; i < blocks; ++i)
+                tile[i] = expression.block(begin + i);
+            if (begin + blocks == storage_size)
+                tile[blocks - 1] &= bitset_detail::tail_block<Block>(expression.size());
+            if (!sink(static_cast<const Block*>(tile), begin, blocks))
+                return false;
+        }
+        return true;
+    }
+
+    template <typename Derived>
+    uint64_t Expression<Derived>::count() const noexcept
+    {
+        using Block = typename Derived::block_type;
+        uint64_t count = 0;
+        for_each_tile(derived(), [&count](const Block* const tile, const uint64_t, const uint64_t blocks) {
+            count += bitset_popcount_buffer(tile, blocks * sizeof(Block));
+            return true;
+        });
+        return count;
+    }
+
+    template <typename Derived>
+    uint64_t Expression<Derived>::find_first() const noexcept
+    {
+        using Block = typename Derived::block_type;
+        uint64_t found = BITSET_NPOS;
+        for_each_tile(derived(), [&found](const Block* const tile, const uint64_t begin, const uint64_t blocks) {
+            const uint64_t index = bitset_find_mismatch_buffer(tile, blocks * sizeof(Block), 0u) / sizeof(Block);
+            if (index == blocks)
+                return true;
+            found = (begin + index) * bitset_detail::block_bits<Block> + bitset_detail::block_lowest_bit(*(tile + index));
+            return false;
+        });
+        return found;
+    }
+
+    /**
+     * Stores the result of an expression in a bitset in one pass, the bitset is resized to the size of the result and
+     * may be one of the operands (every block of the result depends only on the same blocks of the operands)
+     * @param destination The bitset to store the result in
+     * @param expression The expression
+     * @return Reference to the destination
+     */
+    template <typename Block, typename E>
+    CDynamicBitSet<Block>& assign(CDynamicBitSet<Block>& destination, const Expression<E>& expression)
+    {
+        const E& node = expression.derived();
+        if (destination.size != node.size())
+            destination.resize(node.size());
+        for (uint64_t i = 0; i < destination.storage_size; ++i)
+            *(destination.data + i) = node.block(i);
+        if (destination.storage_size)
+            *(destination.data + destination.storage_size - 1) &= bitset_detail::tail_block<Block>(destination.size);
+        return destination;
+    }
+
+    template <typename Derived>
+    auto Expression<Derived>::evaluate() const
+    {
+        CDynamicBitSet<typename Derived::block_type> result;
+        assign(result, *this);
+        return result;
+    }
+
+    /**
+     * Combines a bitset with an expression in place in one pass (destination = destination op expression), only the blocks
+     * shared by both are modified
+     */
+    template <BitSetOperation Operation, typename Block, typename E>
+    CDynamicBitSet<Block>& apply_assign(CDynamicBitSet<Block>& destination, const Expression<E>& expression)
+    {
+        const E& node = expression.derived();
+        const uint64_t blocks = bitset_detail::storage_size<Block>(destination.size < node.size() ? destination.size : node.size());
+        for (uint64_t i = 0; i < blocks; ++i)
+            *(destination.data + i) = bitset_detail::apply_operation_block<Block>(*(destination.data + i), node.block(i), Operation);
+        return destination;
+    }
+
+    template <typename First, typename Second, std::enable_if_t<is_operator_pair<First, Second>, int> = 0>
+    constexpr auto operator&(const First& first, const Second& second) noexcept
+    {
+        return Binary<BITSET_AND, decltype(as_expression(first)), decltype(as_expression(second))>(as_expression(first), as_expression(second));
+    }
+
+    template <typename First, typename Second, std::enable_if_t<is_operator_pair<First, Second>, int> = 0>
+    constexpr auto operator|(const First& first, const Second& second) noexcept
+    {
+        return Binary<BITSET_OR, decltype(as_expression(first)), decltype(as_expression(second))>(as_expression(first), as_expression(second));
+    }
+
+    template <typename First, typename Second, std::enable_if_t<is_operator_pair<First, Second>, int> = 0>
+    constexpr auto operator^(const First& first, const Second& second) noexcept
+    {
+        return Binary<BITSET_XOR, decltype(as_expression(first)), decltype(as_expression(second))>(as_expression(first), as_expression(second));
+    }
+
+    /**
+     * Difference of two operands (first & ~second), the operands can also both be bitsets
+     */
+    template <typename First, typename Second, std::enable_if_t<is_operand<First> && is_operand<Second>, int> = 0>
+    constexpr auto andnot(const First& first, const Second& second) noexcept
+    {
+        return Binary<BITSET_ANDNOT, decltype(as_expression(first)), decltype(as_expression(second))>(as_expression(first), as_expression(second));
+    }
+
+    template <typename E>
+    constexpr Not<E> operator~(const Expression<E>& expression) noexcept
+    {
+        return Not<E>(expression.derived());
+    }
+
+    template <typename Block, typename E>
+    CDynamicBitSet<Block>& operator&=(CDynamicBitSet<Block>& destination, const Expression<E>& expression)
+    {
+        return apply_assign<BITSET_AND>(destination, expression);
+    }
+
+    template <typename Block, typename E>
+    CDynamicBitSet<Block>& operator|=(CDynamicBitSet<Block>& destination, const Expression<E>& expression)
+    {
+        return apply_assign<BITSET_OR>(destination, expression);
+    }
+
+    template <typename Block, typename E>
+    CDynamicBitSet<Block>& operator^=(CDynamicBitSet<Block>& destination, const Expression<E>& expression)
+    {
+        return apply_assign<BITSET_XOR>(destination, expression);
+    }
+}
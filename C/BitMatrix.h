@@ -0,0 +1,397 @@
+#pragma once
+
+#include "BitSet.h"
+
+/**
+ * Alignment of the rows of a bit matrix in bytes (a cache line), rows are padded to a multiple of it
+ */
+#define BITSET_MATRIX_ALIGNMENT 64u
+
+/**
+ * Number of words of a row column tile processed at once by the multiplication and the closure
+ * A lookup table of 256 combinations of 8 rows then takes 256 * BITSET_MATRIX_TILE_WORDS * 8 bytes (256 KiB, a few fit L2)
+ */
+#ifndef BITSET_MATRIX_TILE_WORDS
+#define BITSET_MATRIX_TILE_WORDS 128u
+#endif
+
+/**
+ * Number of lookup tables the closure uses per pass, every pass over the matrix handles 8 * BITSET_MATRIX_TABLES pivots
+ */
+#ifndef BITSET_MATRIX_TABLES
+#define BITSET_MATRIX_TABLES 4u
+#endif
+
+/**
+ * Number of rows of the result processed per lookup table of the multiplication (the table is rebuilt for every row tile)
+ */
+#ifndef BITSET_MATRIX_TILE_ROWS
+#define BITSET_MATRIX_TILE_ROWS 2048u
+#endif
+
+/**
+ * A dense boolean matrix (for C API bit matrix)
+ * Every row is a contiguous array of 64-bit words laid out like bitset_load_words reads a bitset, padded with cleared bits to a multiple of
+ * BITSET_MATRIX_ALIGNMENT bytes and aligned to it, so rows never share a cache line
+ */
+typedef struct
+{
+    /**
+     * Words of the rows, row r starts at data + r * stride (bit c of the row is bit c % 64 of word c / 64)
+     */
+    uint64_t* data;
+    /**
+     * Number of rows
+     */
+    uint64_t rows;
+    /**
+     * Number of columns (bits per row)
+     */
+    uint64_t columns;
+    /**
+     * Number of words per row including the padding
+     */
+    uint64_t stride;
+} BitMatrix;
+
+inline void bitset_matrix_init(BitMatrix* const matrix, const uint64_t rows, const uint64_t columns);
+inline void bitset_matrix_destroy(BitMatrix* const matrix);
+inline void bitset_matrix_copy(BitMatrix* const destination, const BitMatrix* const source);
+inline uint64_t* bitset_matrix_row(const BitMatrix* const matrix, const uint64_t row);
+inline bool bitset_matrix_get(const BitMatrix* const matrix, const uint64_t row, const uint64_t column);
+inline void bitset_matrix_set_value(BitMatrix* const matrix, const bool value, const uint64_t row, const uint64_t column);
+inline void bitset_matrix_set(BitMatrix* const matrix, const uint64_t row, const uint64_t column);
+inline void bitset_matrix_clear(BitMatrix* const matrix, const uint64_t row, const uint64_t column);
+inline void bitset_matrix_clear_all(BitMatrix* const matrix);
+inline void bitset_matrix_set_identity(BitMatrix* const matrix);
+inline uint64_t bitset_matrix_count(const BitMatrix* const matrix);
+inline bool bitset_matrix_equal(const BitMatrix* const first, const BitMatrix* const second);
+inline void bitset_matrix_load_row(BitMatrix* const matrix, const uint64_t row, const BitSet* const source);
+inline void bitset_matrix_store_row(const BitMatrix* const matrix, const uint64_t row, BitSet* const destination);
+inline void bitset_matrix_transpose_block(uint64_t* const block);
+inline void bitset_matrix_transpose(BitMatrix* const destination, const BitMatrix* const source);
+inline void bitset_matrix_build_table(uint64_t* const table, const uint64_t* const* const rows, const uint64_t count, const uint64_t begin, const uint64_t words);
+inline void bitset_matrix_multiply(BitMatrix* const destination, const BitMatrix* const first, const BitMatrix* const second);
+inline void bitset_matrix_transitive_closure(BitMatrix* const matrix);
+
+/**
+ * Size initialization, every bit is cleared
+ * @param matrix Pointer to matrix to initialize
+ * @param rows Number of rows
+ * @param columns Number of columns
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_init(BitMatrix* const matrix, const uint64_t rows, const uint64_t columns)
+{
+    const uint64_t line = BITSET_MATRIX_ALIGNMENT / sizeof(uint64_t);
+    matrix->rows = rows;
+    matrix->columns = columns;
+    matrix->stride = (columns / 64 + (columns % 64 != 0) + line - 1) / line * line;
+    matrix->data = (uint64_t*)bitset_allocate(NULL, rows * matrix->stride * sizeof(uint64_t), BITSET_MATRIX_ALIGNMENT);
+    bitset_matrix_clear_all(matrix);
+}
+
+/**
+ * Destroys the matrix (frees the memory)
+ * @param matrix Pointer to matrix to destroy
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_destroy(BitMatrix* const matrix)
+{
+    bitset_deallocate(NULL, matrix->data, matrix->rows * matrix->stride * sizeof(uint64_t), BITSET_MATRIX_ALIGNMENT);
+    matrix->data = NULL;
+    matrix->rows = matrix->columns = matrix->stride = 0;
+}
+
+/**
+ * Copy initialization
+ * @param destination Pointer to matrix to initialize
+ * @param source Pointer to matrix to copy
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_copy(BitMatrix* const destination, const BitMatrix* const source)
+{
+    bitset_matrix_init(destination, source->rows, source->columns);
+    if (source->rows)
+        memcpy(destination->data, source->data, source->rows * source->stride * sizeof(uint64_t));
+}
+
+/**
+ * Returns the words of a row (stride words, the bits past columns are cleared and have to stay cleared)
+ * @param matrix Pointer to matrix
+ * @param row Index of the row
+ * @return Pointer to the first word of the row
+ * @memberof BitMatrix
+ */
+inline uint64_t* bitset_matrix_row(const BitMatrix* const matrix, const uint64_t row)
+{
+    return matrix->data + row * matrix->stride;
+}
+
+/**
+ * Gets the value of a bit
+ * @param matrix Pointer to matrix to read from
+ * @param row Index of the row
+ * @param column Index of the column
+ * @return The value of the bit
+ * @memberof BitMatrix
+ */
+inline bool bitset_matrix_get(const BitMatrix* const matrix, const uint64_t row, const uint64_t column)
+{
+    return *(bitset_matrix_row(matrix, row) + column / 64) >> column % 64 & 1u;
+}
+
+/**
+ * Sets the value of a bit
+ * @param matrix Pointer to matrix to modify
+ * @param value The value to set the bit to
+ * @param row Index of the row
+ * @param column Index of the column
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_set_value(BitMatrix* const matrix, const bool value, const uint64_t row, const uint64_t column)
+{
+    uint64_t* const word = bitset_matrix_row(matrix, row) + column / 64;
+    *word = (*word & ~((uint64_t)1u << column % 64)) | (uint64_t)value << column % 64;
+}
+
+/**
+ * Sets a bit to 1 (true)
+ * @param matrix Pointer to matrix to modify
+ * @param row Index of the row
+ * @param column Index of the column
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_set(BitMatrix* const matrix, const uint64_t row, const uint64_t column)
+{
+    *(bitset_matrix_row(matrix, row) + column / 64) |= (uint64_t)1u << column % 64;
+}
+
+/**
+ * Sets a bit to 0 (false)
+ * @param matrix Pointer to matrix to modify
+ * @param row Index of the row
+ * @param column Index of the column
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_clear(BitMatrix* const matrix, const uint64_t row, const uint64_t column)
+{
+    *(bitset_matrix_row(matrix, row) + column / 64) &= ~((uint64_t)1u << column % 64);
+}
+
+/**
+ * Sets every bit to 0 (false)
+ * @param matrix Pointer to matrix to modify
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_clear_all(BitMatrix* const matrix)
+{
+    if (matrix->rows)
+        memset(matrix->data, 0, matrix->rows * matrix->stride * sizeof(uint64_t));
+}
+
+/**
+ * Sets the diagonal bits and clears the others (the diagonal ends at the smaller of rows and columns)
+ * @param matrix Pointer to matrix to modify
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_set_identity(BitMatrix* const matrix)
+{
+    bitset_matrix_clear_all(matrix);
+    for (uint64_t i = 0; i < matrix->rows && i < matrix->columns; ++i)
+        bitset_matrix_set(matrix, i, i);
+}
+
+/**
+ * Counts the set bits
+ * @param matrix Pointer to matrix to count the bits of
+ * @return The number of set bits
+ * @memberof BitMatrix
+ */
+inline uint64_t bitset_matrix_count(const BitMatrix* const matrix)
+{
+    return bitset_popcount_buffer(matrix->data, matrix->rows * matrix->stride * sizeof(uint64_t));
+}
+
+/**
+ * Checks if two matrices have the same dimensions and bits
+ * @param first Pointer to the first matrix
+ * @param second Pointer to the second matrix
+ * @return true if the matrices are equal
+ * @memberof BitMatrix
+ */
+inline bool bitset_matrix_equal(const BitMatrix* const first, const BitMatrix* const second)
+{
+    return first->rows == second->rows && first->columns == second->columns
+        && (!first->rows || !memcmp(first->data, second->data, first->rows * first->stride * sizeof(uint64_t)));
+}
+
+/**
+ * Copies a bitset into a row, bits past the columns are dropped and missing bits are cleared
+ * @param matrix Pointer to matrix to modify
+ * @param row Index of the row
+ * @param source Pointer to bitset to copy (BitSet or DynamicBitSet)
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_load_row(BitMatrix* const matrix, const uint64_t row, const BitSet* const source)
+{
+    uint64_t* const words = bitset_matrix_row(matrix, row);
+    const uint64_t count = matrix->columns / 64 + (matrix->columns % 64 != 0);
+    bitset_load_words(source, 0, words, count);
+    if (matrix->columns % 64)
+        *(words + count - 1) &= ((uint64_t)1u << matrix->columns % 64) - 1;
+}
+
+/**
+ * Copies a row into a bitset, bits past the size of the bitset are dropped
+ * @param matrix Pointer to matrix to read from
+ * @param row Index of the row
+ * @param destination Pointer to bitset to modify (BitSet or DynamicBitSet)
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_store_row(const BitMatrix* const matrix, const uint64_t row, BitSet* const destination)
+{
+    bitset_store_words(destination, 0, bitset_matrix_row(matrix, row), matrix->stride);
+}
+
+/**
+ * Transposes a 64x64 block in place, bit c of word r becomes bit r of word c
+ * Swaps the off-diagonal halves, then quarters... (6 rounds of 32 masked word swaps)
+ * @param block The 64 words of the block
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_transpose_block(uint64_t* const block)
+{
+    uint64_t mask = 0x00000000FFFFFFFFull;
+    for (uint64_t width = 32; width; width >>= 1, mask ^= mask << width)
+        for (uint64_t k = 0; k < 64; k = ((k | width) + 1) & ~width)
+        {
+            const uint64_t swap = (*(block + k) >> width ^ *(block + (k | width))) & mask;
+            *(block + k) ^= swap << width;
+            *(block + (k | width)) ^= swap;
+        }
+}
+
+/**
+ * Transposes a matrix one 64x64 block at a time
+ * @param destination Pointer to matrix receiving the result (source->columns rows, source->rows columns, must not be the source)
+ * @param source Pointer to matrix to transpose
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_transpose(BitMatrix* const destination, const BitMatrix* const source)
+{
+    uint64_t block[64];
+    for (uint64_t row = 0; row < source->rows; row += 64)
+        for (uint64_t column = 0; column < source->columns; column += 64)
+        {
+            for (uint64_t i = 0; i < 64; ++i)
+                *(block + i) = row + i < source->rows ? *(bitset_matrix_row(source, row + i) + column / 64) : 0;
+            bitset_matrix_transpose_block(block);
+            for (uint64_t i = 0; i < 64 && column + i < source->columns; ++i)
+                *(bitset_matrix_row(destination, column + i) + row / 64) = *(block + i);
+        }
+}
+
+/**
+ * Builds the lookup table of the method of Four Russians: entry x is the OR of the rows selected by the bits of x
+ * @param table Array of (1 << count) * words words receiving the table
+ * @param rows Rows to combine
+ * @param count Number of rows (at most 8)
+ * @param begin Index of the first word of the rows to combine
+ * @param words Number of words to combine
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_build_table(uint64_t* const table, const uint64_t* const* const rows, const uint64_t count, const uint64_t begin, const uint64_t words)
+{
+    memset(table, 0, words * sizeof(uint64_t));
+    for (uint64_t x = 1; x < (uint64_t)1u << count; ++x)
+        bitset_operation_buffer(table + x * words, table + (x & (x - 1)) * words, *(rows + bitset_ctz64(x)) + begin, words * sizeof(uint64_t), BITSET_OR);
+}
+
+/**
+ * Multiplies two boolean matrices (AND as product, OR as sum) with the method of Four Russians
+ * The columns of the result are processed in tiles of BITSET_MATRIX_TILE_WORDS words and the rows in tiles of BITSET_MATRIX_TILE_ROWS,
+ * every 8 rows of the second matrix are combined into a lookup table once per tile, so every row of the result takes one OR per 8 columns of the first matrix
+ * @param destination Pointer to matrix receiving the result (first->rows rows, second->columns columns, must not be an operand)
+ * @param first Pointer to the left operand
+ * @param second Pointer to the right operand (first->columns rows)
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_multiply(BitMatrix* const destination, const BitMatrix* const first, const BitMatrix* const second)
+{
+    bitset_matrix_clear_all(destination);
+    uint64_t* const table = (uint64_t*)bitset_allocate(NULL, 256 * BITSET_MATRIX_TILE_WORDS * sizeof(uint64_t), BITSET_MATRIX_ALIGNMENT);
+    const uint64_t* rows[8];
+    for (uint64_t column = 0; column < second->stride; column += BITSET_MATRIX_TILE_WORDS)
+    {
+        const uint64_t words = second->stride - column < BITSET_MATRIX_TILE_WORDS ? second->stride - column : BITSET_MATRIX_TILE_WORDS;
+        for (uint64_t row = 0; row < first->rows; row += BITSET_MATRIX_TILE_ROWS)
+        {
+            const uint64_t row_end = first->rows - row < BITSET_MATRIX_TILE_ROWS ? first->rows : row + BITSET_MATRIX_TILE_ROWS;
+            for (uint64_t k = 0; k < first->columns; k += 8)
+            {
+                const uint64_t count = first->columns - k < 8 ? first->columns - k : 8;
+                for (uint64_t i = 0; i < count; ++i)
+                    *(rows + i) = bitset_matrix_row(second, k + i);
+                bitset_matrix_build_table(table, rows, count, column, words);
+                for (uint64_t i = row; i < row_end; ++i)
+                {
+                    const uint64_t selection = *(bitset_matrix_row(first, i) + k / 64) >> k % 64 & 0xFFu;
+                    if (selection)
+                        bitset_operation_buffer(bitset_matrix_row(destination, i) + column, bitset_matrix_row(destination, i) + column, table + selection * words, words * sizeof(uint64_t), BITSET_OR);
+                }
+            }
+        }
+    }
+    bitset_deallocate(NULL, table, 256 * BITSET_MATRIX_TILE_WORDS * sizeof(uint64_t), BITSET_MATRIX_ALIGNMENT);
+}
+
+/**
+ * Replaces a square matrix with its transitive closure (bit (i, j) is set if j can be reached from i by one or more steps)
+ * Warshall's algorithm 8 * BITSET_MATRIX_TABLES pivots at a time: the pivot rows are closed among themselves, combined into lookup tables of 8 rows
+ * and every row receives the combinations selected by its pivot bits with one OR per table and column tile (rows without pivot bits are skipped)
+ * @param matrix Pointer to matrix to modify (rows == columns)
+ * @memberof BitMatrix
+ */
+inline void bitset_matrix_transitive_closure(BitMatrix* const matrix)
+{
+    const uint64_t n = matrix->rows, pivots = 8 * BITSET_MATRIX_TABLES;
+    const uint64_t table_words = 256 * BITSET_MATRIX_TILE_WORDS;
+    uint64_t* const tables = (uint64_t*)bitset_allocate(NULL, BITSET_MATRIX_TABLES * table_words * sizeof(uint64_t), BITSET_MATRIX_ALIGNMENT);
+    uint8_t* const selections = (uint8_t*)malloc(n * BITSET_MATRIX_TABLES + 1);
+    const uint64_t* rows[8 * BITSET_MATRIX_TABLES];
+    for (uint64_t k = 0; k < n; k += pivots)
+    {
+        const uint64_t count = n - k < pivots ? n - k : pivots;
+        // Warshall's algorithm on the pivot rows only, afterwards every pivot row contains everything reachable through the other pivots
+        for (uint64_t j = 0; j < count; ++j)
+            for (uint64_t i = 0; i < count; ++i)
+                if (bitset_matrix_get(matrix, k + i, k + j))
+                    bitset_operation_buffer(bitset_matrix_row(matrix, k + i), bitset_matrix_row(matrix, k + i), bitset_matrix_row(matrix, k + j), matrix->stride * sizeof(uint64_t), BITSET_OR);
+        for (uint64_t i = 0; i < count; ++i)
+            *(rows + i) = bitset_matrix_row(matrix, k + i);
+        // the pivot bits are read before any tile is updated, the tile holding them changes them
+        bool any = false;
+        for (uint64_t i = 0; i < n; ++i)
+            for (uint64_t t = 0; t < BITSET_MATRIX_TABLES; ++t)
+            {
+                const uint64_t bit = k + t * 8;
+                *(selections + i * BITSET_MATRIX_TABLES + t) = i - k < count || bit >= n ? 0 : (uint8_t)(*(bitset_matrix_row(matrix, i) + bit / 64) >> bit % 64 & 0xFFu);
+                any = any || *(selections + i * BITSET_MATRIX_TABLES + t);
+            }
+        if (!any)
+            continue;
+        for (uint64_t column = 0; column < matrix->stride; column += BITSET_MATRIX_TILE_WORDS)
+        {
+            const uint64_t words = matrix->stride - column < BITSET_MATRIX_TILE_WORDS ? matrix->stride - column : BITSET_MATRIX_TILE_WORDS;
+            for (uint64_t t = 0; t * 8 < count; ++t)
+                bitset_matrix_build_table(tables + t * table_words, rows + t * 8, count - t * 8 < 8 ? count - t * 8 : 8, column, words);
+            for (uint64_t i = 0; i < n; ++i)
+                for (uint64_t t = 0; t < BITSET_MATRIX_TABLES; ++t)
+                    if (*(selections + i * BITSET_MATRIX_TABLES + t))
+                        bitset_operation_buffer(bitset_matrix_row(matrix, i) + column, bitset_matrix_row(matrix, i) + column, tables + t * table_words + *(selections + i * BITSET_MATRIX_TABLES + t) * words, words * sizeof(uint64_t), BITSET_OR);
+        }
+    }
+    free(selections);
+    bitset_deallocate(NULL, tables, BITSET_MATRIX_TABLES * table_words * sizeof(uint64_t), BITSET_MATRIX_ALIGNMENT);
+}
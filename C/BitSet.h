@@ -4,48 +4,214 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "BitSetKernels.h"
+#include "BitSetStats.h"
 
 #ifndef BITSET_SIZE
 #define BITSET_SIZE 1 // to avoid compilation errors
 #endif
 
+/**
+ * Type of a single storage block. Define BITSET_BLOCK_TYPE before including this header to select it:
+ * uint8_t, uint16_t, uint32_t, uint64_t (default) or, on GCC/Clang, unsigned __int128.
+ * Every range operation, predicate and count works one block at a time, so wider blocks mean fewer iterations.
+ */
+#ifndef BITSET_BLOCK_TYPE
+#define BITSET_BLOCK_TYPE uint64_t
+#endif
+
+/**
+ * Storage block type (for C API bitset)
+ */
+typedef BITSET_BLOCK_TYPE bitset_block_t;
+
+// the block type has to be an unsigned integer of 1, 2, 4, 8 or 16 bytes
+typedef char bitset_block_type_check[((bitset_block_t)-1 > 0 && (sizeof(bitset_block_t) == 1 || sizeof(bitset_block_t) == 2 || sizeof(bitset_block_t) == 4 || sizeof(bitset_block_t) == 8 || sizeof(bitset_block_t) == 16)) ? 1 : -1];
+
+/**
+ * Number of bits in a single block
+ */
+#define BITSET_BLOCK_BITS (sizeof(bitset_block_t) * 8u)
+
+/**
+ * Block with all the bits set
+ */
+#define BITSET_BLOCK_FULL ((bitset_block_t)~(bitset_block_t)0u)
+
+/**
+ * Factor by which the capacity of a dynamic bitset grows when it runs out of blocks
+ */
+#ifndef BITSET_GROWTH_FACTOR
+#define BITSET_GROWTH_FACTOR 2u
+#endif
+
+/**
+ * Largest step for which the step range functions apply a precomputed periodic block pattern instead of setting bit by bit
+ */
+#ifndef BITSET_STEP_PATTERN_THRESHOLD
+#define BITSET_STEP_PATTERN_THRESHOLD 128u
+#endif
+
+/**
+ * Minimal length of the periodic block pattern (in blocks), short periods are repeated so the apply loop can be vectorized
+ */
+#define BITSET_STEP_PATTERN_MIN_BLOCKS 64u
+
+/**
+ * Lets a BitSet* point at a DynamicBitSet (UNIVERSAL_BITSET) without breaking the strict aliasing rules
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define BITSET_MAY_ALIAS __attribute__((__may_alias__))
+#else
+#define BITSET_MAY_ALIAS
+#endif
+
+/**
+ * Index returned by the search functions when no bit is found
+ */
+#define BITSET_NPOS UINT64_MAX
+
+/**
+ * Alignment guaranteed by malloc, larger alignments are allocated with aligned_alloc
+ */
+#define BITSET_MALLOC_ALIGNMENT (2u * sizeof(void*))
+
+/**
+ * Size of a transparent huge page, huge page allocations are aligned to it
+ */
+#ifndef BITSET_HUGE_PAGE_SIZE
+#define BITSET_HUGE_PAGE_SIZE (2u << 20)
+#endif
+
+/**
+ * Smallest allocation (in bytes) the huge page allocator backs with huge pages, smaller ones use the default allocator
+ */
+#ifndef BITSET_HUGE_PAGE_THRESHOLD
+#define BITSET_HUGE_PAGE_THRESHOLD (4u << 20)
+#endif
+
+/**
+ * Identifies bitset files, the first bytes of every file
+ */
+#define BITSET_FILE_MAGIC "BITSET\0\0"
+
+/**
+ * Version of the bitset file format
+ */
+#define BITSET_FILE_VERSION 1u
+
+/**
+ * Byte order marker of bitset files, read back as a different value on a machine with a different byte order
+ */
+#define BITSET_FILE_BYTE_ORDER 0x01020304u
+
+/**
+ * Size of the bitset file header in bytes, the blocks follow it (keeps the mapped blocks cache line aligned)
+ */
+#define BITSET_FILE_HEADER_SIZE 64u
+
+/**
+ * Number of blocks used by the fixed size bitset
+ */
+#define BITSET_STORAGE_SIZE (BITSET_SIZE / BITSET_BLOCK_BITS + (BITSET_SIZE % BITSET_BLOCK_BITS ? 1 : 0))
+
+/**
+ * Memory allocator used by a dynamic bitset (for C API bitset)
+ * Every function gets the context and the alignment the bitset was created with, sizes are in bytes
+ */
+typedef struct
+{
+    /**
+     * Allocates memory aligned to at least alignment, returns NULL on failure
+     */
+    void* (*allocate)(void* context, uint64_t size, uint64_t alignment);
+    /**
+     * Resizes memory returned by allocate keeping the first min(old_size, new_size) bytes, returns NULL on failure
+     */
+    void* (*reallocate)(void* context, void* memory, uint64_t old_size, uint64_t new_size, uint64_t alignment);
+    /**
+     * Frees memory returned by allocate or reallocate (memory may be NULL)
+     */
+    void (*deallocate)(void* context, void* memory, uint64_t size, uint64_t alignment);
+    /**
+     * User context passed to the functions (e.g. an arena)
+     */
+    void* context;
+} BitSetAllocator;
+
 /**
  * A dynamic bitset structure (for C API bitset)
  */
-typedef struct 
+typedef struct
 {
-	/**
-	 * Underlying array of bytes containing the bits
-	 */
-	uint8_t* data;
+    /**
+     * Underlying array of blocks containing the bits
+     */
+    bitset_block_t* data;
     /**
      * Size of bitset in bits
      */
     uint64_t size;
     /**
-     * Size of bitset in bytes
+     * Size of bitset in blocks
+     */
+    uint64_t storage_size;
+    /**
+     * Number of blocks allocated (at least storage_size), growth is geometric so appending is amortized O(1)
+     */
+    uint64_t capacity;
+    /**
+     * Start of the file mapping holding the blocks, NULL if the blocks are allocated on the heap (decides how destroy releases them)
+     */
+    void* mapping;
+    /**
+     * Size of the file mapping in bytes
+     */
+    uint64_t mapping_size;
+    /**
+     * Allocator of the blocks, NULL for malloc / aligned_alloc
+     */
+    const BitSetAllocator* allocator;
+    /**
+     * Alignment of the blocks in bytes (power of two)
      */
-	uint64_t storage_size;
+    uint64_t alignment;
 } DynamicBitSet;
 
 /**
  * A bitset structure (for C API bitset)
- * To use, define BITSET_SIZE to the size of the bitset you want to use
+ * To use, define BITSET_SIZE to the size of the bitset you want to use (bit size)
+ * The first members match DynamicBitSet, so both can be passed wherever BitSet* is expected
  */
-typedef struct
+typedef struct BITSET_MAY_ALIAS
 {
     /**
-     * Underlying array of bytes containing the bits
+     * Pointer to the blocks containing the bits (points to blocks after bitset_init)
      */
-    uint8_t data[BITSET_SIZE];
+    bitset_block_t* data;
     /**
      * Size of bitset in bits
      */
     uint64_t size;
     /**
-     * Size of bitset in bytes
-    */
+     * Size of bitset in blocks
+     */
     uint64_t storage_size;
+    /**
+     * Underlying array of blocks containing the bits
+     */
+    bitset_block_t blocks[BITSET_STORAGE_SIZE];
 } BitSet;
 
 /**
@@ -54,16 +220,77 @@ typedef struct
  */
 #define UNIVERSAL_BITSET(bitset) (BitSet*)(bitset)
 
+/**
+ * Header of a bitset file (BITSET_FILE_HEADER_SIZE bytes, stored in the byte order of the machine that wrote it)
+ */
+typedef struct
+{
+    /**
+     * BITSET_FILE_MAGIC
+     */
+    char magic[8];
+    /**
+     * BITSET_FILE_VERSION
+     */
+    uint32_t version;
+    /**
+     * Number of bits in a block of the file (BITSET_BLOCK_BITS of the writer)
+     */
+    uint32_t block_bits;
+    /**
+     * BITSET_FILE_BYTE_ORDER
+     */
+    uint32_t byte_order;
+    /**
+     * Reserved, 0
+     */
+    uint32_t reserved;
+    /**
+     * Size of bitset in bits
+     */
+    uint64_t size;
+    /**
+     * Size of bitset in blocks
+     */
+    uint64_t storage_size;
+    /**
+     * bitset_checksum of the blocks
+     */
+    uint64_t checksum;
+    /**
+     * Zeros up to BITSET_FILE_HEADER_SIZE
+     */
+    uint8_t padding[BITSET_FILE_HEADER_SIZE - 48];
+} BitSetFileHeader;
+
+typedef char bitset_file_header_check[sizeof(BitSetFileHeader) == BITSET_FILE_HEADER_SIZE ? 1 : -1];
+
+/**
+ * How a bitset file is mapped
+ */
+typedef enum
+{
+    /**
+     * The blocks can only be read, the pages are shared with every other process mapping the file
+     */
+    BITSET_MAP_READ_ONLY,
+    /**
+     * The blocks can be modified, modified pages become private copies and the file is never written
+     */
+    BITSET_MAP_COPY_ON_WRITE
+} BitSetMapMode;
+
 inline void bitset_dynamic_init(DynamicBitSet* const bitset, const uint64_t size);
+inline void bitset_dynamic_init_allocator(DynamicBitSet* const bitset, const uint64_t size, const BitSetAllocator* const allocator, const uint64_t alignment);
 inline void bitset_init(BitSet* const bitset);
-inline void bitset_dynamic_init_block(DynamicBitSet* const bitset, const uint64_t size, const uint8_t block);
-inline void bitset_init_block(BitSet* const bitset, const uint8_t block);
-inline void bitset_dynamic_destroy(const DynamicBitSet* const bitset);
-inline void bitset_copy_from(BitSet* const destination, const BitSet* const source);
-inline void bitset_dynamic_move_from(DynamicBitSet* const destination, DynamicBitSet* const source);
+inline void bitset_dynamic_init_block(DynamicBitSet* const bitset, const uint64_t size, const bitset_block_t block);
+inline void bitset_init_block(BitSet* const bitset, const bitset_block_t block);
+inline void bitset_dynamic_destroy(DynamicBitSet* const bitset);
+inline void bitset_copy(BitSet* const destination, const BitSet* const source);
+inline void bitset_dynamic_move(DynamicBitSet* const destination, DynamicBitSet* const source);
 inline bool bitset_get(const BitSet* const bitset, const uint64_t index);
 inline void bitset_set_value(BitSet* const bitset, const uint64_t value, const uint64_t index);
-inline void bitset_set(BitSet* const bitset, const uint64_t index); 
+inline void bitset_set(BitSet* const bitset, const uint64_t index);
 inline void bitset_clear(BitSet* const bitset, const uint64_t index);
 inline void bitset_fill_all(BitSet* const bitset, const bool value);
 inline void bitset_clear_all(BitSet* const bitset);
@@ -77,35 +304,116 @@ inline void bitset_set_in_range_begin_end(BitSet* const bitset, const uint64_t b
 inline void bitset_fill_in_range_begin_end_step(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end, const uint64_t step);
 inline void bitset_clear_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
 inline void bitset_set_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
-inline void bitset_set_block(BitSet* const bitset, const uint8_t block, const uint64_t index);
-inline void bitset_fill_block(BitSet* const bitset, const uint8_t value);
-inline void bitset_fill_block_in_range_end(BitSet* const bitset, const uint8_t block, const uint64_t end);
-inline void bitset_fill_block_in_range_begin_end(BitSet* const bitset, const uint8_t block, const uint64_t begin, const uint64_t end);
-inline void bitset_fill_block_in_range_begin_end_step(BitSet* const bitset, const uint8_t block, const uint64_t begin, const uint64_t end, const uint64_t step);
-inline void bitset_flip(BitSet* const bitset, const uint64_t index);
+inline void bitset_set_block(BitSet* const bitset, const bitset_block_t block, const uint64_t index);
+inline void bitset_fill_all_blocks(BitSet* const bitset, const bitset_block_t value);
+inline void bitset_fill_block_in_range_end(BitSet* const bitset, const bitset_block_t block, const uint64_t end);
+inline void bitset_fill_block_in_range_begin_end(BitSet* const bitset, const bitset_block_t block, const uint64_t begin, const uint64_t end);
+inline void bitset_fill_block_in_range_begin_end_step(BitSet* const bitset, const bitset_block_t block, const uint64_t begin, const uint64_t end, const uint64_t step);
+inline void bitset_flip_bit(BitSet* const bitset, const uint64_t index);
+inline void bitset_modify_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count, const BitSetOperation operation);
+inline void bitset_modify_many_sorted(BitSet* const bitset, const uint64_t* const indices, const uint64_t count, const BitSetOperation operation);
+inline void bitset_set_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count);
+inline void bitset_clear_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count);
+inline void bitset_flip_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count);
+inline void bitset_set_many_sorted(BitSet* const bitset, const uint64_t* const indices, const uint64_t count);
+inline void bitset_clear_many_sorted(BitSet* const bitset, const uint64_t* const indices, const uint64_t count);
+inline void bitset_flip_many_sorted(BitSet* const bitset, const uint64_t* const indices, const uint64_t count);
+inline void bitset_get_many(const BitSet* const bitset, const uint64_t* const indices, const uint64_t count, bool* const values);
+inline uint64_t bitset_to_indices(const BitSet* const bitset, uint64_t* const indices, const uint64_t base);
+inline uint64_t bitset_to_indices32(const BitSet* const bitset, uint32_t* const indices, const uint32_t base);
+inline void bitset_from_sorted_indices(BitSet* const bitset, const uint64_t* const indices, const uint64_t count);
+inline void bitset_from_sorted_indices32(BitSet* const bitset, const uint32_t* const indices, const uint64_t count);
 inline void bitset_flip_all(BitSet* const bitset);
 inline void bitset_flip_in_range_end(BitSet* const bitset, const uint64_t end);
 inline void bitset_flip_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end);
 inline void bitset_flip_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
 inline void bitset_flip_block(BitSet* const bitset, const uint64_t index);
-inline void bitset_flip_all_blocks(BitSet* const bitset);
+inline void bitset_flip_block_all(BitSet* const bitset);
 inline void bitset_flip_block_in_range_end(BitSet* const bitset, const uint64_t end);
 inline void bitset_flip_block_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end);
 inline void bitset_flip_block_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
-inline uint8_t bitset_get_block(const BitSet* const bitset, const uint64_t index);
+inline uint64_t bitset_step_pattern_size(const uint64_t step);
+inline bool bitset_use_step_pattern(const uint64_t begin, const uint64_t end, const uint64_t step);
+inline void bitset_apply_step_pattern(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step, const BitSetOperation operation);
+inline bitset_block_t bitset_get_block(const BitSet* const bitset, const uint64_t index);
 inline bool bitset_all(const BitSet* const bitset);
 inline bool bitset_any(const BitSet* const bitset);
 inline bool bitset_none(const BitSet* const bitset);
 inline bool bitset_all_cleared(const BitSet* const bitset);
 inline uint64_t bitset_count(const BitSet* const bitset);
 inline bool bitset_empty(const BitSet* const bitset);
+inline uint64_t bitset_count_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline uint64_t bitset_find_value_in_range_begin_end(const BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end);
+inline uint64_t bitset_find_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline uint64_t bitset_find_cleared_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline bool bitset_any_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline bool bitset_all_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline bool bitset_none_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end);
 inline void bitset_dynamic_push_back(DynamicBitSet* const bitset, const bool value);
 inline void bitset_dynamic_pop_back(DynamicBitSet* const bitset);
-inline void bitset_dynamic_push_back_block(DynamicBitSet* const bitset, const uint8_t block);
+inline void bitset_dynamic_push_back_block(DynamicBitSet* const bitset, const bitset_block_t block);
 inline void bitset_dynamic_pop_back_block(DynamicBitSet* const bitset);
 inline void bitset_dynamic_resize(DynamicBitSet* const bitset, const uint64_t new_size);
+inline void bitset_dynamic_reserve(DynamicBitSet* const bitset, const uint64_t capacity);
+inline void bitset_dynamic_shrink_to_fit(DynamicBitSet* const bitset);
+inline void bitset_dynamic_reallocate(DynamicBitSet* const bitset, const uint64_t capacity);
+inline void bitset_dynamic_grow(DynamicBitSet* const bitset, const uint64_t storage_size);
 inline const uint64_t bitset_calculate_storage_size(const uint64_t size);
-inline const uint8_t bitset_create_filled_block(const bool value);
+inline const bitset_block_t bitset_create_filled_block(const bool value);
+inline const bitset_block_t bitset_create_range_block(const uint64_t begin, const uint64_t end);
+inline const bitset_block_t bitset_create_tail_block(const uint64_t size);
+inline uint64_t bitset_block_popcount(bitset_block_t block);
+inline bitset_block_t bitset_apply_operation_block(const bitset_block_t first, const bitset_block_t second, const BitSetOperation operation);
+inline void bitset_apply_operation(BitSet* const destination, const BitSet* const first, const BitSet* const second, const BitSetOperation operation);
+inline uint64_t bitset_apply_operation_count(const BitSet* const first, const BitSet* const second, const BitSetOperation operation);
+inline void bitset_and(BitSet* const destination, const BitSet* const first, const BitSet* const second);
+inline void bitset_or(BitSet* const destination, const BitSet* const first, const BitSet* const second);
+inline void bitset_xor(BitSet* const destination, const BitSet* const first, const BitSet* const second);
+inline void bitset_andnot(BitSet* const destination, const BitSet* const first, const BitSet* const second);
+inline void bitset_and_in_place(BitSet* const destination, const BitSet* const source);
+inline void bitset_or_in_place(BitSet* const destination, const BitSet* const source);
+inline void bitset_xor_in_place(BitSet* const destination, const BitSet* const source);
+inline void bitset_andnot_in_place(BitSet* const destination, const BitSet* const source);
+inline uint64_t bitset_and_count(const BitSet* const first, const BitSet* const second);
+inline uint64_t bitset_or_count(const BitSet* const first, const BitSet* const second);
+inline uint64_t bitset_xor_count(const BitSet* const first, const BitSet* const second);
+inline uint64_t bitset_andnot_count(const BitSet* const first, const BitSet* const second);
+inline void bitset_shift_right_blocks(bitset_block_t* const destination, const uint64_t count, const BitSet* const source, const uint64_t shift);
+inline void bitset_shift_left(BitSet* const destination, const BitSet* const source, const uint64_t shift);
+inline void bitset_shift_right(BitSet* const destination, const BitSet* const source, const uint64_t shift);
+inline void bitset_shift_left_in_place(BitSet* const bitset, const uint64_t shift);
+inline void bitset_shift_right_in_place(BitSet* const bitset, const uint64_t shift);
+inline void bitset_rotate_left(BitSet* const destination, const BitSet* const source, const uint64_t shift);
+inline void bitset_rotate_right(BitSet* const destination, const BitSet* const source, const uint64_t shift);
+inline void bitset_rotate_left_in_place(BitSet* const bitset, const uint64_t shift);
+inline void bitset_rotate_right_in_place(BitSet* const bitset, const uint64_t shift);
+inline uint64_t bitset_block_lowest_bit(bitset_block_t block);
+inline uint64_t bitset_block_highest_bit(bitset_block_t block);
+inline uint64_t bitset_find_value_from(const BitSet* const bitset, const bool value, const uint64_t begin);
+inline uint64_t bitset_find_value_before(const BitSet* const bitset, const bool value, const uint64_t end);
+inline uint64_t bitset_find_first(const BitSet* const bitset);
+inline uint64_t bitset_find_next(const BitSet* const bitset, const uint64_t index);
+inline uint64_t bitset_find_last(const BitSet* const bitset);
+inline uint64_t bitset_find_prev(const BitSet* const bitset, const uint64_t index);
+inline uint64_t bitset_find_first_cleared(const BitSet* const bitset);
+inline uint64_t bitset_find_next_cleared(const BitSet* const bitset, const uint64_t index);
+inline uint64_t bitset_find_last_cleared(const BitSet* const bitset);
+inline uint64_t bitset_find_prev_cleared(const BitSet* const bitset, const uint64_t index);
+inline void bitset_load_words(const BitSet* const bitset, const uint64_t first, uint64_t* const words, const uint64_t count);
+inline void bitset_store_words(BitSet* const bitset, const uint64_t first, const uint64_t* const words, const uint64_t count);
+inline uint64_t bitset_checksum(const BitSet* const bitset);
+inline void bitset_unmap_memory(void* const mapping, const uint64_t size);
+inline bool bitset_dynamic_save(const DynamicBitSet* const bitset, const char* const path);
+inline bool bitset_dynamic_map_file(DynamicBitSet* const bitset, const char* const path, const BitSetMapMode mode, const bool verify);
+inline void* bitset_default_allocate(void* const context, const uint64_t size, const uint64_t alignment);
+inline void* bitset_default_reallocate(void* const context, void* const memory, const uint64_t old_size, const uint64_t new_size, const uint64_t alignment);
+inline void bitset_default_deallocate(void* const context, void* const memory, const uint64_t size, const uint64_t alignment);
+inline void* bitset_huge_page_allocate(void* const context, const uint64_t size, const uint64_t alignment);
+inline void* bitset_huge_page_reallocate(void* const context, void* const memory, const uint64_t old_size, const uint64_t new_size, const uint64_t alignment);
+inline void bitset_huge_page_deallocate(void* const context, void* const memory, const uint64_t size, const uint64_t alignment);
+inline void* bitset_allocate(const BitSetAllocator* const allocator, const uint64_t size, const uint64_t alignment);
+inline void* bitset_reallocate_memory(const BitSetAllocator* const allocator, void* const memory, const uint64_t old_size, const uint64_t new_size, const uint64_t alignment);
+inline void bitset_deallocate(const BitSetAllocator* const allocator, void* const memory, const uint64_t size, const uint64_t alignment);
 
 /**
  * Size initialization
@@ -113,24 +421,51 @@ inline const uint8_t bitset_create_filled_block(const bool value);
  * @param size The size of the bitset to be initialized
  * @memberof DynamicBitSet
  */
-inline void bitset_dynamic_init(DynamicBitSet* const bitset, const uint64_t size) 
+inline void bitset_dynamic_init(DynamicBitSet* const bitset, const uint64_t size)
 {
     bitset->size = size;
-    bitset->storage_size = size / 8u + (size % 8u ? 1 : 0);
-    bitset->data = (uint8_t*)calloc(bitset->storage_size * sizeof(uint8_t), sizeof(uint8_t));
+    bitset->storage_size = bitset->capacity = bitset_calculate_storage_size(size);
+    bitset->data = (bitset_block_t*)calloc(bitset->storage_size, sizeof(bitset_block_t));
+    BITSET_STATS_ALLOCATION(bitset->storage_size * sizeof(bitset_block_t));
+    bitset->mapping = NULL;
+    bitset->mapping_size = 0;
+    bitset->allocator = NULL;
+    bitset->alignment = BITSET_MALLOC_ALIGNMENT;
 }
 
 /**
- * Size initialization
+ * Size initialization with a custom allocator and alignment, the blocks (and every reallocation of them) come from the allocator
  * @param bitset Pointer to bitset to initialize
  * @param size The size of the bitset to be initialized
+ * @param allocator Pointer to allocator to use, it has to outlive the bitset (NULL for malloc / aligned_alloc, &bitset_huge_page_allocator for huge pages)
+ * @param alignment Alignment of the blocks in bytes, a power of two (e.g. 64 for cache lines, 0 for the malloc alignment)
+ * @memberof DynamicBitSet
+ */
+inline void bitset_dynamic_init_allocator(DynamicBitSet* const bitset, const uint64_t size, const BitSetAllocator* const allocator, const uint64_t alignment)
+{
+    bitset->size = size;
+    bitset->storage_size = bitset->capacity = bitset_calculate_storage_size(size);
+    bitset->mapping = NULL;
+    bitset->mapping_size = 0;
+    bitset->allocator = allocator;
+    bitset->alignment = alignment > sizeof(bitset_block_t) ? alignment : sizeof(bitset_block_t);
+    if (bitset->alignment < BITSET_MALLOC_ALIGNMENT)
+        bitset->alignment = BITSET_MALLOC_ALIGNMENT;
+    bitset->data = (bitset_block_t*)bitset_allocate(allocator, bitset->storage_size * sizeof(bitset_block_t), bitset->alignment);
+    memset(bitset->data, 0, bitset->storage_size * sizeof(bitset_block_t));
+}
+
+/**
+ * Size initialization
+ * @param bitset Pointer to bitset to initialize
  * @memberof BitSet
  */
 inline void bitset_init(BitSet* const bitset)
 {
+    bitset->data = bitset->blocks;
     bitset->size = BITSET_SIZE;
-    bitset->storage_size = BITSET_SIZE / 8u + (BITSET_SIZE % 8u ? 1 : 0);
-    memset(bitset->data, 0, BITSET_SIZE * sizeof(uint8_t));
+    bitset->storage_size = BITSET_STORAGE_SIZE;
+    memset(bitset->blocks, 0, BITSET_STORAGE_SIZE * sizeof(bitset_block_t));
 }
 
 /**
@@ -140,36 +475,44 @@ inline void bitset_init(BitSet* const bitset)
  * @param block The block to fill the bitset with (block value)
  * @memberof DynamicBitSet
  */
-inline void bitset_dynamic_init_block(DynamicBitSet* const bitset, const uint64_t size, const uint8_t block) 
+inline void bitset_dynamic_init_block(DynamicBitSet* const bitset, const uint64_t size, const bitset_block_t block)
 {
     bitset->size = size;
-    bitset->storage_size = size / 8u + (size % 8u ? 1 : 0);
-    bitset->data = (uint8_t*)malloc(bitset->storage_size * sizeof(uint8_t));
-    memset(bitset->data, block, bitset->storage_size * sizeof(uint8_t));
+    bitset->storage_size = bitset->capacity = bitset_calculate_storage_size(size);
+    bitset->data = (bitset_block_t*)malloc(bitset->storage_size * sizeof(bitset_block_t));
+    BITSET_STATS_ALLOCATION(bitset->storage_size * sizeof(bitset_block_t));
+    bitset->mapping = NULL;
+    bitset->mapping_size = 0;
+    bitset->allocator = NULL;
+    bitset->alignment = BITSET_MALLOC_ALIGNMENT;
+    bitset_fill_all_blocks(UNIVERSAL_BITSET(bitset), block);
 }
 
 /**
  * Size and value initialization
  * @param bitset Pointer to bitset to initialize
- * @param size The size of the bitset to be initialized
  * @param block The block to fill the bitset with (block value)
  * @memberof BitSet
  */
-inline void bitset_init_block(BitSet* const bitset, const uint8_t block)
+inline void bitset_init_block(BitSet* const bitset, const bitset_block_t block)
 {
+    bitset->data = bitset->blocks;
     bitset->size = BITSET_SIZE;
-    bitset->storage_size = BITSET_SIZE / 8u + (BITSET_SIZE % 8u ? 1 : 0);
-    memset(bitset->data, block, BITSET_SIZE * sizeof(uint8_t));
+    bitset->storage_size = BITSET_STORAGE_SIZE;
+    bitset_fill_all_blocks(bitset, block);
 }
 
 /**
- * Destroys the bitset (frees the memory)
+ * Destroys the bitset (frees the memory or unmaps the file)
  * @param bitset Pointer to bitset to destroy
- * @memberof BitSet
+ * @memberof DynamicBitSet
  */
-inline void bitset_dynamic_destroy(DynamicBitSet* bitset) 
+inline void bitset_dynamic_destroy(DynamicBitSet* const bitset)
 {
-    free(bitset->data);
+    if (bitset->mapping)
+        bitset_unmap_memory(bitset->mapping, bitset->mapping_size);
+    else
+        bitset_deallocate(bitset->allocator, bitset->data, bitset->capacity * sizeof(bitset_block_t), bitset->alignment);
 }
 
 /**
@@ -178,24 +521,38 @@ inline void bitset_dynamic_destroy(DynamicBitSet* bitset)
  * @param source Pointer to bitset to copy from
  * @memberof BitSet
  */
-inline void bitset_copy(BitSet* const destination, const BitSet* const source) 
+inline void bitset_copy(BitSet* const destination, const BitSet* const source)
 {
-    for (uint64_t i = 0; i < destination->size; ++i)
-        *(destination->data + i) = *(source->data + i);
+    const uint64_t storage_size = destination->storage_size < source->storage_size ? destination->storage_size : source->storage_size;
+    BITSET_STATS_CALL(BITSET_STATS_COPY, storage_size * BITSET_BLOCK_BITS);
+    BITSET_STATS_COPY_BYTES(storage_size * sizeof(bitset_block_t));
+    BITSET_STATS_TIMER_BEGIN(timer);
+    memcpy(destination->data, source->data, storage_size * sizeof(bitset_block_t));
+    BITSET_STATS_TIMER_END(BITSET_STATS_COPY, timer);
 }
 
 /**
  * Moves the data from one bitset to another
  * @param destination Pointer to bitset to move to
  * @param source Pointer to bitset to move from
- * @memberof BitSet
+ * @memberof DynamicBitSet
  */
-inline void bitset_dynamic_move(DynamicBitSet* const destination, DynamicBitSet* const source) 
+inline void bitset_dynamic_move(DynamicBitSet* const destination, DynamicBitSet* const source)
 {
     destination->size = source->size;
+    destination->storage_size = source->storage_size;
+    destination->capacity = source->capacity;
     destination->data = source->data;
+    destination->mapping = source->mapping;
+    destination->mapping_size = source->mapping_size;
+    destination->allocator = source->allocator;
+    destination->alignment = source->alignment;
     source->size = 0;
+    source->storage_size = 0;
+    source->capacity = 0;
     source->data = NULL;
+    source->mapping = NULL;
+    source->mapping_size = 0;
 }
 
 /**
@@ -205,12 +562,13 @@ inline void bitset_dynamic_move(DynamicBitSet* const destination, DynamicBitSet*
  * @param index The index of the bit to modify (bit index)
  * @memberof BitSet
  */
-inline void bitset_set_value(BitSet* const bitset, const uint64_t value, const uint64_t index) 
+inline void bitset_set_value(BitSet* const bitset, const uint64_t value, const uint64_t index)
 {
+    BITSET_STATS_CALL(BITSET_STATS_SINGLE_BIT, 1u);
     if (value)
-        *(bitset->data + index / 8) |= (uint8_t)1u << index % sizeof(uint8_t);
+        *(bitset->data + index / BITSET_BLOCK_BITS) |= (bitset_block_t)1u << index % BITSET_BLOCK_BITS;
     else
-        *(bitset->data + index / 8) &= ~((uint8_t)1u << index % sizeof(uint8_t));
+        *(bitset->data + index / BITSET_BLOCK_BITS) &= ~((bitset_block_t)1u << index % BITSET_BLOCK_BITS);
 }
 
 /**
@@ -221,7 +579,8 @@ inline void bitset_set_value(BitSet* const bitset, const uint64_t value, const u
  * @memberof BitSet
  */
 inline bool bitset_get(const BitSet* const bitset, const uint64_t index) {
-    return (*(bitset->data + index / 8u) & (uint8_t)1u << index % 8u);
+    BITSET_STATS_CALL(BITSET_STATS_SINGLE_BIT, 1u);
+    return (*(bitset->data + index / BITSET_BLOCK_BITS) >> index % BITSET_BLOCK_BITS) & 1u;
 }
 
 /**
@@ -231,7 +590,8 @@ inline bool bitset_get(const BitSet* const bitset, const uint64_t index) {
  * @memberof BitSet
  */
 inline void bitset_set(BitSet* const bitset, const uint64_t index) {
-    *(bitset->data + index / 8) |= (uint8_t)(uint8_t)1u << index % 8;
+    BITSET_STATS_CALL(BITSET_STATS_SINGLE_BIT, 1u);
+    *(bitset->data + index / BITSET_BLOCK_BITS) |= (bitset_block_t)1u << index % BITSET_BLOCK_BITS;
 }
 
 /**
@@ -241,7 +601,8 @@ inline void bitset_set(BitSet* const bitset, const uint64_t index) {
  * @memberof BitSet
  */
 inline void bitset_clear(BitSet* const bitset, const uint64_t index) {
-    *(bitset->data + index / 8) &= ~((uint8_t)1u << index % 8);
+    BITSET_STATS_CALL(BITSET_STATS_SINGLE_BIT, 1u);
+    *(bitset->data + index / BITSET_BLOCK_BITS) &= ~((bitset_block_t)1u << index % BITSET_BLOCK_BITS);
 }
 
 /**
@@ -251,7 +612,8 @@ inline void bitset_clear(BitSet* const bitset, const uint64_t index) {
  * @memberof BitSet
  */
 inline void bitset_fill_all(BitSet* const bitset, const bool value) {
-    memset(bitset->data, value ? 255u : 0u, bitset->size);
+    BITSET_STATS_CALL(BITSET_STATS_FILL_RANGE, bitset->size);
+    memset(bitset->data, value ? 255u : 0u, bitset->storage_size * sizeof(bitset_block_t));
 }
 
 /**
@@ -260,7 +622,7 @@ inline void bitset_fill_all(BitSet* const bitset, const bool value) {
  * @memberof BitSet
  */
 inline void bitset_clear_all(BitSet* const bitset) {
-    memset(bitset->data, 0, bitset->storage_size);
+    bitset_fill_all(bitset, false);
 }
 
 /**
@@ -269,19 +631,18 @@ inline void bitset_clear_all(BitSet* const bitset) {
  * @memberof BitSet
  */
 inline void bitset_set_all(BitSet* const bitset) {
-    memset(bitset->data, 255, bitset->storage_size);
+    bitset_fill_all(bitset, true);
 }
 
 /**
- * Fills all the bits in the specified range with 1 (true)
+ * Fills all the bits in the specified range with the specified value
  * @param bitset Pointer to bitset to modify
  * @param value The value to fill the bits with (bit value)
  * @param end End of the range to fill (bit index)
  * @memberof BitSet
  */
 inline void bitset_fill_in_range_end(BitSet* const bitset, const bool value, const uint64_t end) {
-    for (uint64_t i = 0; i < end; ++i)
-        *(bitset->data + i) = value ? 255u : 0u;
+    bitset_fill_in_range_begin_end(bitset, value, 0, end);
 }
 
 /**
@@ -292,12 +653,7 @@ inline void bitset_fill_in_range_end(BitSet* const bitset, const bool value, con
  */
 inline void bitset_clear_in_range_end(BitSet* const bitset, const uint64_t end)
 {
-    memset(bitset->data, 0, end / 8u);
-    if (end % 8u)
-    {
-        for (uint16_t i = 0; i < end % 8u; ++i)
-            *(bitset->data + end / 8u) &= ~((uint8_t)1u << i);
-    }
+    bitset_fill_in_range_begin_end(bitset, false, 0, end);
 }
 
 /**
@@ -308,12 +664,7 @@ inline void bitset_clear_in_range_end(BitSet* const bitset, const uint64_t end)
  */
 inline void bitset_set_in_range_end(BitSet* const bitset, const uint64_t end)
 {
-    memset(bitset->data, 255u, end / 8u);
-    if (end % 8u)
-    {
-        for (uint16_t i = 0; i < end % 8u; ++i)
-            *(bitset->data + end / 8u) |= (uint8_t)1u << i;
-    }
+    bitset_fill_in_range_begin_end(bitset, true, 0, end);
 }
 
 /**
@@ -326,41 +677,33 @@ inline void bitset_set_in_range_end(BitSet* const bitset, const uint64_t end)
  */
 inline void bitset_fill_in_range_begin_end(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end)
 {
-    uint8_t to_add = 1, to_sub = 1;
-    // create begin_block and fill the first byte with it
-    if (begin % 8)
-    {
-        const uint16_t end_bit = (begin / 8 == end / 8) ? end % 8 : 8;
-        if (value)
-        {
-            for (uint16_t i = begin % 8; i < end_bit; ++i)
-                *(bitset->data + begin / 8) |= 1 << i;
-        }
-        else
-        {
-            for (uint16_t i = begin % 8; i < end_bit; ++i)
-                *(bitset->data + begin / 8) &= ~(1 << i);
-        }
-    }
-    else
-        to_add = 0;
-    if (end % 8 && begin / 8 != end / 8)
-    {
-        if (value)
-        {
-            for (uint16_t i = 0; i < end % 8; ++i)
-                *(bitset->data + end / 8) |= (uint8_t)1u << i;
-        }
-        else
-        {
-            for (uint16_t i = 0; i < end % 8; ++i)
-                *(bitset->data + end / 8) &= ~((uint8_t)1u << i);
-        }
-    }
+    BITSET_STATS_CALL(BITSET_STATS_FILL_RANGE, begin < end ? end - begin : 0u);
+    if (begin >= end)
+        return;
+
+    const uint64_t begin_block = begin / BITSET_BLOCK_BITS, end_block = (end - 1) / BITSET_BLOCK_BITS;
+    // masks of the affected bits in the first and the last block
+    bitset_block_t begin_mask = bitset_create_range_block(begin % BITSET_BLOCK_BITS, BITSET_BLOCK_BITS);
+    const bitset_block_t end_mask = bitset_create_range_block(0, (end - 1) % BITSET_BLOCK_BITS + 1);
+
+    if (begin_block == end_block)
+        begin_mask &= end_mask;
+
+    if (value)
+        *(bitset->data + begin_block) |= begin_mask;
     else
-        to_sub = 0;
+        *(bitset->data + begin_block) &= ~begin_mask;
+
+    if (begin_block == end_block)
+        return;
+
+    // whole blocks in the middle of the range
+    memset(bitset->data + begin_block + 1, value ? 255u : 0u, (end_block - begin_block - 1) * sizeof(bitset_block_t));
 
-    memset(bitset->data + begin / 8 + to_add, value ? 255u : 0u, (end - begin) / 8u - to_sub);
+    if (value)
+        *(bitset->data + end_block) |= end_mask;
+    else
+        *(bitset->data + end_block) &= ~end_mask;
 }
 
 /**
@@ -372,27 +715,7 @@ inline void bitset_fill_in_range_begin_end(BitSet* const bitset, const bool valu
  */
 inline void bitset_clear_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
 {
-    uint8_t to_add = 1, to_sub = 1;
-    // create begin_block and fill the first byte with it
-    if (begin % 8u)
-    {
-        const uint16_t end_bit = begin / 8u == end / 8u ? end % 8u : 8u;
-        for (uint16_t i = begin % 8u; i < end_bit; ++i)
-            *(bitset->data + begin / 8u) &= ~((uint8_t)1u << i);
-    }
-    else
-        to_add = 0;
-
-    // set the end block if the end is not aligned with the block size
-    if (end % 8 && begin / 8 != end / 8)
-    {
-        for (uint16_t i = 0; i < end % 8; ++i)
-            *(bitset->data + end / 8) &= ~((uint8_t)1u << i);
-    }
-    else
-        to_sub = 0;
-
-    memset(bitset->data + begin / 8u + to_add, 0u, (end - begin) / 8u - to_sub);
+    bitset_fill_in_range_begin_end(bitset, false, begin, end);
 }
 
 /**
@@ -404,27 +727,7 @@ inline void bitset_clear_in_range_begin_end(BitSet* const bitset, const uint64_t
  */
 inline void bitset_set_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
 {
-    uint8_t to_add = 1, to_sub = 1;
-    // create begin_block and fill the first byte with it
-    if (begin % 8u)
-    {
-        const uint16_t end_bit = begin / 8u == end / 8u ? end % 8u : 8u;
-        for (uint16_t i = begin % 8u; i < end_bit; ++i)
-            *(bitset->data + begin / 8u) |= (uint8_t)1u << i;
-    }
-    else
-        to_add = 0;
-
-    // set the end block if the end is not aligned with the block size
-    if (end % 8 && begin / 8 != end / 8)
-    {
-        for (uint16_t i = 0; i < end % 8; ++i)
-            *(bitset->data + end / 8) |= (uint8_t)1u << i;
-    }
-    else
-        to_sub = 0;
-
-    memset(bitset->data + begin / 8u + to_add, 255u, (end - begin) / 8u - to_sub);
+    bitset_fill_in_range_begin_end(bitset, true, begin, end);
 }
 
 /**
@@ -438,17 +741,25 @@ inline void bitset_set_in_range_begin_end(BitSet* const bitset, const uint64_t b
  */
 inline void bitset_fill_in_range_begin_end_step(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end, const uint64_t step)
 {
-    for (uint64_t i = begin; i < end; i += step)
+    BITSET_STATS_CALL(BITSET_STATS_FILL_STEP, begin < end ? (end - begin - 1) / step + 1 : 0u);
+    BITSET_STATS_TIMER_BEGIN(timer);
+    if (bitset_use_step_pattern(begin, end, step))
+        bitset_apply_step_pattern(bitset, begin, end, step, value ? BITSET_OR : BITSET_ANDNOT);
+    else
     {
-        if (value)
-            *(bitset->data + i / 8) |= (uint8_t)1u << i % 8;
-        else
-            *(bitset->data + i / 8) &= ~((uint8_t)1u << i % 8);
+        for (uint64_t i = begin; i < end; i += step)
+        {
+            if (value)
+                *(bitset->data + i / BITSET_BLOCK_BITS) |= (bitset_block_t)1u << i % BITSET_BLOCK_BITS;
+            else
+                *(bitset->data + i / BITSET_BLOCK_BITS) &= ~((bitset_block_t)1u << i % BITSET_BLOCK_BITS);
+        }
     }
+    BITSET_STATS_TIMER_END(BITSET_STATS_FILL_STEP, timer);
 }
 
 /**
- * Fills all the bits in the specified range with 0 (false
+ * Fills all the bits in the specified range with 0 (false)
  * @param bitset Pointer to bitset to modify
  * @param begin Begin of the range to fill (bit index)
  * @param end End of the range to fill (bit index)
@@ -457,14 +768,12 @@ inline void bitset_fill_in_range_begin_end_step(BitSet* const bitset, const bool
  */
 inline void bitset_clear_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
 {
-    for (uint64_t i = begin; i < end; i += step)
-        *(bitset->data + i / 8) &= ~((uint8_t)1u << i % 8);
+    bitset_fill_in_range_begin_end_step(bitset, false, begin, end, step);
 }
 
 /**
  * Fills all the bits in the specified range with 1 (true)
  * @param bitset Pointer to bitset to modify
- * @param value Value to fill the bits with (bit value)
  * @param begin Begin of the range to fill (bit index)
  * @param end End of the range to fill (bit index)
  * @param step Step size between the bits to fill (bit step)
@@ -472,8 +781,7 @@ inline void bitset_clear_in_range_begin_end_step(BitSet* const bitset, const uin
  */
 inline void bitset_set_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
 {
-    for (uint64_t i = begin; i < end; i += step)
-        *(bitset->data + i / 8) |= (uint8_t)1u << i % 8;
+    bitset_fill_in_range_begin_end_step(bitset, true, begin, end, step);
 }
 
 /**
@@ -483,18 +791,18 @@ inline void bitset_set_in_range_begin_end_step(BitSet* const bitset, const uint6
  * @param index The index of the block to set (block index)
  * @memberof BitSet
  */
-inline void bitset_set_block(BitSet* const bitset, const uint8_t block, const uint64_t index)
+inline void bitset_set_block(BitSet* const bitset, const bitset_block_t block, const uint64_t index)
 {
     *(bitset->data + index) = block;
 }
 
 /**
- * Fills all the blocks in the specified range with the specified value
+ * Fills all the blocks with the specified value
  * @param bitset Pointer to bitset to modify
  * @param value The value to fill the bits with (block value)
  * @memberof BitSet
  */
-inline void bitset_fill_all_blocks(BitSet* const bitset, const uint8_t value)
+inline void bitset_fill_all_blocks(BitSet* const bitset, const bitset_block_t value)
 {
     for (uint64_t i = 0; i < bitset->storage_size; ++i)
         *(bitset->data + i) = value;
@@ -507,7 +815,7 @@ inline void bitset_fill_all_blocks(BitSet* const bitset, const uint8_t value)
  * @param end End of the range to fill (block index)
  * @memberof BitSet
  */
-inline void bitset_fill_block_in_range_end(BitSet* const bitset, const uint8_t block, const uint64_t end)
+inline void bitset_fill_block_in_range_end(BitSet* const bitset, const bitset_block_t block, const uint64_t end)
 {
     for (uint64_t i = 0; i < end; ++i)
         *(bitset->data + i) = block;
@@ -521,7 +829,7 @@ inline void bitset_fill_block_in_range_end(BitSet* const bitset, const uint8_t b
  * @param end End of the range to fill (block index)
  * @memberof BitSet
  */
-inline void bitset_fill_block_in_range_begin_end(BitSet* const bitset, const uint8_t block, const uint64_t begin, const uint64_t end)
+inline void bitset_fill_block_in_range_begin_end(BitSet* const bitset, const bitset_block_t block, const uint64_t begin, const uint64_t end)
 {
     for (uint64_t i = begin; i < end; ++i)
         *(bitset->data + i) = block;
@@ -536,7 +844,7 @@ inline void bitset_fill_block_in_range_begin_end(BitSet* const bitset, const uin
  * @param step Step size between the bits to fill (block step)
  * @memberof BitSet
  */
-inline void bitset_fill_block_in_range_begin_end_step(BitSet* const bitset, const uint8_t block, const uint64_t begin, const uint64_t end, const uint64_t step)
+inline void bitset_fill_block_in_range_begin_end_step(BitSet* const bitset, const bitset_block_t block, const uint64_t begin, const uint64_t end, const uint64_t step)
 {
     for (uint64_t i = begin; i < end; i += step)
         *(bitset->data + i) = block;
@@ -550,119 +858,506 @@ inline void bitset_fill_block_in_range_begin_end_step(BitSet* const bitset, cons
  */
 inline void bitset_flip_bit(BitSet* const bitset, const uint64_t index)
 {
-    *(bitset->data + index / sizeof(uint8_t)) ^= (uint8_t)1u << index % sizeof(uint8_t);
+    BITSET_STATS_CALL(BITSET_STATS_SINGLE_BIT, 1u);
+    *(bitset->data + index / BITSET_BLOCK_BITS) ^= (bitset_block_t)1u << index % BITSET_BLOCK_BITS;
 }
 
 /**
- * Flips all the bits
+ * Applies an operation to the bits at the indices, the blocks are prefetched BITSET_PREFETCH_DISTANCE indices ahead
  * @param bitset Pointer to bitset to modify
+ * @param indices Indices of the bits to modify (bit index)
+ * @param count Number of indices
+ * @param operation BITSET_OR to set, BITSET_ANDNOT to clear, BITSET_XOR to flip the bits
  * @memberof BitSet
  */
-inline void bitset_flip_all(BitSet* const bitset)
+inline void bitset_modify_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count, const BitSetOperation operation)
 {
-    for (uint64_t i = 0; i < bitset->storage_size; ++i)
-        *(bitset->data + i) = ~*(bitset->data + i);
+    BITSET_STATS_CALL(BITSET_STATS_SINGLE_BIT, count);
+    uint64_t i = 0;
+    for (; i + BITSET_PREFETCH_DISTANCE < count; ++i)
+    {
+        BITSET_PREFETCH(bitset->data + *(indices + i + BITSET_PREFETCH_DISTANCE) / BITSET_BLOCK_BITS, 1);
+        bitset_block_t* const block = bitset->data + *(indices + i) / BITSET_BLOCK_BITS;
+        *block = bitset_apply_operation_block(*block, (bitset_block_t)1u << *(indices + i) % BITSET_BLOCK_BITS, operation);
+    }
+    for (; i < count; ++i)
+    {
+        bitset_block_t* const block = bitset->data + *(indices + i) / BITSET_BLOCK_BITS;
+        *block = bitset_apply_operation_block(*block, (bitset_block_t)1u << *(indices + i) % BITSET_BLOCK_BITS, operation);
+    }
 }
 
 /**
- * Flips all the bits in the specified range
+ * Applies an operation to the bits at the indices, consecutive indices within one block are merged into a single update
+ * The result does not depend on the order of the indices, sorted indices are the fastest
  * @param bitset Pointer to bitset to modify
- * @param end End of the range to flip (bit index)
+ * @param indices Indices of the bits to modify (bit index)
+ * @param count Number of indices
+ * @param operation BITSET_OR to set, BITSET_ANDNOT to clear, BITSET_XOR to flip the bits (indices flipped twice stay unchanged)
  * @memberof BitSet
  */
-inline void bitset_flip_in_range_end(BitSet* const bitset, const uint64_t end)
+inline void bitset_modify_many_sorted(BitSet* const bitset, const uint64_t* const indices, const uint64_t count, const BitSetOperation operation)
 {
-    for (uint64_t i = 0; i < end; ++i)
-        *(bitset->data + i) = ~*(bitset->data + i);
+    BITSET_STATS_CALL(BITSET_STATS_SINGLE_BIT, count);
+    for (uint64_t i = 0; i < count;)
+    {
+        const uint64_t index = *(indices + i) / BITSET_BLOCK_BITS;
+        bitset_block_t mask = 0;
+        for (; i < count && *(indices + i) / BITSET_BLOCK_BITS == index; ++i)
+            mask = operation == BITSET_XOR ? mask ^ (bitset_block_t)1u << *(indices + i) % BITSET_BLOCK_BITS : mask | (bitset_block_t)1u << *(indices + i) % BITSET_BLOCK_BITS;
+        *(bitset->data + index) = bitset_apply_operation_block(*(bitset->data + index), mask, operation);
+    }
 }
 
 /**
- * Flips all the bits in the specified range
+ * Sets the bits at the indices to 1 (true)
  * @param bitset Pointer to bitset to modify
- * @param begin Begin of the range to flip (bit index)
- * @param end End of the range to flip (bit index)
+ * @param indices Indices of the bits to set (bit index)
+ * @param count Number of indices
  * @memberof BitSet
  */
-inline void bitset_flip_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+inline void bitset_set_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count)
 {
-    for (uint64_t i = begin; i < end; ++i)
-        *(bitset->data + i) = ~*(bitset->data + i);
+    bitset_modify_many(bitset, indices, count, BITSET_OR);
 }
 
 /**
- * Flips all the bits in the specified range
+ * Sets the bits at the indices to 0 (false)
  * @param bitset Pointer to bitset to modify
- * @param begin Begin of the range to flip (bit index)
- * @param end End of the range to flip (bit index)
- * @param step Step size between the bits to flip (bit step)
+ * @param indices Indices of the bits to clear (bit index)
+ * @param count Number of indices
  * @memberof BitSet
  */
-inline void bitset_flip_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+inline void bitset_clear_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count)
 {
-    for (uint64_t i = begin; i < end; i += step)
-        *(bitset->data + i / sizeof(uint8_t)) ^= (uint8_t)1u << i % sizeof(uint8_t);
+    bitset_modify_many(bitset, indices, count, BITSET_ANDNOT);
 }
 
 /**
- * Flips the block at the specified index
+ * Flips the bits at the indices (an index present twice is flipped twice)
  * @param bitset Pointer to bitset to modify
- * @param index Index of the block to flip (block index)
+ * @param indices Indices of the bits to flip (bit index)
+ * @param count Number of indices
  * @memberof BitSet
  */
-inline void bitset_flip_block(BitSet* const bitset, const uint64_t index)
+inline void bitset_flip_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count)
 {
-    *(bitset->data + index) = ~*(bitset->data + index);
+    bitset_modify_many(bitset, indices, count, BITSET_XOR);
 }
 
 /**
- * Flips all the blocks (exactly the same as bitset_flip_all, just alias)
+ * Sets the bits at the sorted indices to 1 (true), updates to the same block are merged
  * @param bitset Pointer to bitset to modify
+ * @param indices Indices of the bits to set, ascending (bit index)
+ * @param count Number of indices
  * @memberof BitSet
  */
-inline void bitset_flip_block_all(BitSet* const bitset)
+inline void bitset_set_many_sorted(BitSet* const bitset, const uint64_t* const indices, const uint64_t count)
 {
-    bitset_flip_all(bitset);
+    bitset_modify_many_sorted(bitset, indices, count, BITSET_OR);
 }
 
 /**
- * Flips all the blocks in the specified range
+ * Sets the bits at the sorted indices to 0 (false), updates to the same block are merged
  * @param bitset Pointer to bitset to modify
- * @param end End of the range to flip (block index)
+ * @param indices Indices of the bits to clear, ascending (bit index)
+ * @param count Number of indices
  * @memberof BitSet
  */
-inline void bitset_flip_block_in_range_end(BitSet* const bitset, const uint64_t end)
+inline void bitset_clear_many_sorted(BitSet* const bitset, const uint64_t* const indices, const uint64_t count)
 {
-    for (uint64_t i = 0; i < end; ++i)
-        *(bitset->data + i) = ~*(bitset->data + i);
+    bitset_modify_many_sorted(bitset, indices, count, BITSET_ANDNOT);
 }
 
 /**
- * Flips all the blocks in the specified range
+ * Flips the bits at the sorted indices, updates to the same block are merged
  * @param bitset Pointer to bitset to modify
- * @param begin Begin of the range to flip (block index)
- * @param end End of the range to flip (block index)
+ * @param indices Indices of the bits to flip, ascending (bit index)
+ * @param count Number of indices
  * @memberof BitSet
  */
-inline void bitset_flip_block_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+inline void bitset_flip_many_sorted(BitSet* const bitset, const uint64_t* const indices, const uint64_t count)
 {
-    for (uint64_t i = begin; i < end; ++i)
-        *(bitset->data + i) = ~*(bitset->data + i);
+    bitset_modify_many_sorted(bitset, indices, count, BITSET_XOR);
 }
 
 /**
- * Flips all the blocks in the specified range
- * @param bitset Pointer to bitset to modify
- * @param begin Begin of the range to flip (block index)
- * @param end End of the range to flip (block index)
- * @param step Step size between the blocks to flip (block step)
+ * Gets the values of the bits at the indices, with 64-bit blocks AVX-512 gathers are used when supported
+ * @param bitset Pointer to bitset to read from
+ * @param indices Indices of the bits to read (bit index)
+ * @param count Number of indices
+ * @param values Array receiving the values of the bits
  * @memberof BitSet
  */
-inline void bitset_flip_block_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+inline void bitset_get_many(const BitSet* const bitset, const uint64_t* const indices, const uint64_t count, bool* const values)
 {
-    for (uint64_t i = begin; i < end; i += step)
-        *(bitset->data + i) = ~*(bitset->data + i);
-}
-
+    BITSET_STATS_CALL(BITSET_STATS_SINGLE_BIT, count);
+    if (BITSET_BLOCK_BITS == 64)
+    {
+        bitset_gather_bits_buffer((const uint64_t*)bitset->data, indices, count, values);
+        return;
+    }
+    uint64_t i = 0;
+    for (; i + BITSET_PREFETCH_DISTANCE < count; ++i)
+    {
+        BITSET_PREFETCH(bitset->data + *(indices + i + BITSET_PREFETCH_DISTANCE) / BITSET_BLOCK_BITS, 0);
+        *(values + i) = *(bitset->data + *(indices + i) / BITSET_BLOCK_BITS) >> *(indices + i) % BITSET_BLOCK_BITS & 1u;
+    }
+    for (; i < count; ++i)
+        *(values + i) = *(bitset->data + *(indices + i) / BITSET_BLOCK_BITS) >> *(indices + i) % BITSET_BLOCK_BITS & 1u;
+}
+
+/**
+ * Writes the indices of all the set bits in increasing order, whole words are decoded by the AVX-512 compress kernel when supported
+ * @param bitset Pointer to bitset to read from
+ * @param indices Array receiving the indices, room for bitset_count(bitset) indices
+ * @param base Value added to every index
+ * @return The number of indices written
+ * @memberof BitSet
+ */
+inline uint64_t bitset_to_indices(const BitSet* const bitset, uint64_t* const indices, const uint64_t base)
+{
+    BITSET_STATS_CALL(BITSET_STATS_FIND, bitset->size);
+    const uint64_t full = bitset->size / 64;
+    uint64_t written = 0;
+    if (BITSET_BLOCK_BITS == 64)
+        written = bitset_extract_indices_buffer((const uint64_t*)bitset->data, full, base, indices);
+    else
+    {
+        // other block types go through a small buffer of 64-bit words
+        uint64_t words[64];
+        for (uint64_t first = 0; first < full; first += 64)
+        {
+            const uint64_t count = full - first < 64 ? full - first : 64;
+            bitset_load_words(bitset, first, words, count);
+            written += bitset_extract_indices_buffer(words, count, base + first * 64, indices + written);
+        }
+    }
+    if (bitset->size % 64)
+    {
+        uint64_t word;
+        bitset_load_words(bitset, full, &word, 1);
+        written += bitset_extract_indices_buffer_portable(&word, 1, base + full * 64, indices + written);
+    }
+    return written;
+}
+
+/**
+ * Writes the indices of all the set bits in increasing order as 32-bit values
+ * @param bitset Pointer to bitset to read from
+ * @param indices Array receiving the indices, room for bitset_count(bitset) indices
+ * @param base Value added to every index (base + size has to fit in 32 bits)
+ * @return The number of indices written
+ * @memberof BitSet
+ */
+inline uint64_t bitset_to_indices32(const BitSet* const bitset, uint32_t* const indices, const uint32_t base)
+{
+    BITSET_STATS_CALL(BITSET_STATS_FIND, bitset->size);
+    const uint64_t full = bitset->size / 64;
+    uint64_t written = 0;
+    if (BITSET_BLOCK_BITS == 64)
+        written = bitset_extract_indices32_buffer((const uint64_t*)bitset->data, full, base, indices);
+    else
+    {
+        uint64_t words[64];
+        for (uint64_t first = 0; first < full; first += 64)
+        {
+            const uint64_t count = full - first < 64 ? full - first : 64;
+            bitset_load_words(bitset, first, words, count);
+            written += bitset_extract_indices32_buffer(words, count, (uint32_t)(base + first * 64), indices + written);
+        }
+    }
+    if (bitset->size % 64)
+    {
+        uint64_t word;
+        bitset_load_words(bitset, full, &word, 1);
+        written += bitset_extract_indices32_buffer_portable(&word, 1, (uint32_t)(base + full * 64), indices + written);
+    }
+    return written;
+}
+
+/**
+ * Sets exactly the bits at the indices and clears all the others in one pass, consecutive indices within one block are
+ * merged and every block is written once. Sorted indices are the fastest, any order (and duplicates) gives the same result
+ * @param bitset Pointer to bitset to modify
+ * @param indices Indices of the bits to set (bit index, lower than the size)
+ * @param count Number of indices
+ * @memberof BitSet
+ */
+inline void bitset_from_sorted_indices(BitSet* const bitset, const uint64_t* const indices, const uint64_t count)
+{
+    BITSET_STATS_CALL(BITSET_STATS_SINGLE_BIT, count);
+    // blocks below next are already written, the ones from next on still hold the old bits
+    uint64_t next = 0;
+    for (uint64_t i = 0; i < count;)
+    {
+        const uint64_t index = *(indices + i) / BITSET_BLOCK_BITS;
+        bitset_block_t block = 0;
+        for (; i < count && *(indices + i) / BITSET_BLOCK_BITS == index; ++i)
+            block |= (bitset_block_t)1u << *(indices + i) % BITSET_BLOCK_BITS;
+        if (index < next)
+        {
+            *(bitset->data + index) |= block;
+            continue;
+        }
+        memset(bitset->data + next, 0, (index - next) * sizeof(bitset_block_t));
+        *(bitset->data + index) = block;
+        next = index + 1;
+    }
+    memset(bitset->data + next, 0, (bitset->storage_size - next) * sizeof(bitset_block_t));
+}
+
+/**
+ * Sets exactly the bits at the 32-bit indices and clears all the others in one pass (see bitset_from_sorted_indices)
+ * @param bitset Pointer to bitset to modify
+ * @param indices Indices of the bits to set (bit index, lower than the size)
+ * @param count Number of indices
+ * @memberof BitSet
+ */
+inline void bitset_from_sorted_indices32(BitSet* const bitset, const uint32_t* const indices, const uint64_t count)
+{
+    BITSET_STATS_CALL(BITSET_STATS_SINGLE_BIT, count);
+    uint64_t next = 0;
+    for (uint64_t i = 0; i < count;)
+    {
+        const uint64_t index = *(indices + i) / BITSET_BLOCK_BITS;
+        bitset_block_t block = 0;
+        for (; i < count && *(indices + i) / BITSET_BLOCK_BITS == index; ++i)
+            block |= (bitset_block_t)1u << *(indices + i) % BITSET_BLOCK_BITS;
+        if (index < next)
+        {
+            *(bitset->data + index) |= block;
+            continue;
+        }
+        memset(bitset->data + next, 0, (index - next) * sizeof(bitset_block_t));
+        *(bitset->data + index) = block;
+        next = index + 1;
+    }
+    memset(bitset->data + next, 0, (bitset->storage_size - next) * sizeof(bitset_block_t));
+}
+
+/**
+ * Flips all the bits
+ * @param bitset Pointer to bitset to modify
+ * @memberof BitSet
+ */
+inline void bitset_flip_all(BitSet* const bitset)
+{
+    BITSET_STATS_CALL(BITSET_STATS_FLIP_RANGE, bitset->size);
+    for (uint64_t i = 0; i < bitset->storage_size; ++i)
+        *(bitset->data + i) = ~*(bitset->data + i);
+}
+
+/**
+ * Flips all the bits in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param end End of the range to flip (bit index)
+ * @memberof BitSet
+ */
+inline void bitset_flip_in_range_end(BitSet* const bitset, const uint64_t end)
+{
+    bitset_flip_in_range_begin_end(bitset, 0, end);
+}
+
+/**
+ * Flips all the bits in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to flip (bit index)
+ * @param end End of the range to flip (bit index)
+ * @memberof BitSet
+ */
+inline void bitset_flip_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    BITSET_STATS_CALL(BITSET_STATS_FLIP_RANGE, begin < end ? end - begin : 0u);
+    if (begin >= end)
+        return;
+
+    const uint64_t begin_block = begin / BITSET_BLOCK_BITS, end_block = (end - 1) / BITSET_BLOCK_BITS;
+    bitset_block_t begin_mask = bitset_create_range_block(begin % BITSET_BLOCK_BITS, BITSET_BLOCK_BITS);
+    const bitset_block_t end_mask = bitset_create_range_block(0, (end - 1) % BITSET_BLOCK_BITS + 1);
+
+    if (begin_block == end_block)
+    {
+        *(bitset->data + begin_block) ^= begin_mask & end_mask;
+        return;
+    }
+
+    *(bitset->data + begin_block) ^= begin_mask;
+    for (uint64_t i = begin_block + 1; i < end_block; ++i)
+        *(bitset->data + i) = ~*(bitset->data + i);
+    *(bitset->data + end_block) ^= end_mask;
+}
+
+/**
+ * Flips all the bits in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to flip (bit index)
+ * @param end End of the range to flip (bit index)
+ * @param step Step size between the bits to flip (bit step)
+ * @memberof BitSet
+ */
+inline void bitset_flip_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+{
+    BITSET_STATS_CALL(BITSET_STATS_FLIP_RANGE, begin < end ? (end - begin - 1) / step + 1 : 0u);
+    BITSET_STATS_TIMER_BEGIN(timer);
+    if (bitset_use_step_pattern(begin, end, step))
+        bitset_apply_step_pattern(bitset, begin, end, step, BITSET_XOR);
+    else
+    {
+        for (uint64_t i = begin; i < end; i += step)
+            *(bitset->data + i / BITSET_BLOCK_BITS) ^= (bitset_block_t)1u << i % BITSET_BLOCK_BITS;
+    }
+    BITSET_STATS_TIMER_END(BITSET_STATS_FLIP_RANGE, timer);
+}
+
+/**
+ * Flips the block at the specified index
+ * @param bitset Pointer to bitset to modify
+ * @param index Index of the block to flip (block index)
+ * @memberof BitSet
+ */
+inline void bitset_flip_block(BitSet* const bitset, const uint64_t index)
+{
+    *(bitset->data + index) = ~*(bitset->data + index);
+}
+
+/**
+ * Flips all the blocks (exactly the same as bitset_flip_all, just alias)
+ * @param bitset Pointer to bitset to modify
+ * @memberof BitSet
+ */
+inline void bitset_flip_block_all(BitSet* const bitset)
+{
+    bitset_flip_all(bitset);
+}
+
+/**
+ * Flips all the blocks in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param end End of the range to flip (block index)
+ * @memberof BitSet
+ */
+inline void bitset_flip_block_in_range_end(BitSet* const bitset, const uint64_t end)
+{
+    for (uint64_t i = 0; i < end; ++i)
+        *(bitset->data + i) = ~*(bitset->data + i);
+}
+
+/**
+ * Flips all the blocks in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to flip (block index)
+ * @param end End of the range to flip (block index)
+ * @memberof BitSet
+ */
+inline void bitset_flip_block_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    for (uint64_t i = begin; i < end; ++i)
+        *(bitset->data + i) = ~*(bitset->data + i);
+}
+
+/**
+ * Flips all the blocks in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to flip (block index)
+ * @param end End of the range to flip (block index)
+ * @param step Step size between the blocks to flip (block step)
+ * @memberof BitSet
+ */
+inline void bitset_flip_block_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+{
+    for (uint64_t i = begin; i < end; i += step)
+        *(bitset->data + i) = ~*(bitset->data + i);
+}
+
+/**
+ * Calculates the length of the periodic block pattern used for the specified step
+ * The positions of the bits repeat every step / gcd(step, BITSET_BLOCK_BITS) blocks, the period is repeated up to BITSET_STEP_PATTERN_MIN_BLOCKS
+ * @param step Step size between the bits (bit step)
+ * @return The length of the pattern (block size)
+ */
+inline uint64_t bitset_step_pattern_size(const uint64_t step)
+{
+    uint64_t a = step, b = BITSET_BLOCK_BITS;
+    while (b)
+    {
+        const uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    const uint64_t period = step / a;
+    return period * ((BITSET_STEP_PATTERN_MIN_BLOCKS + period - 1) / period);
+}
+
+/**
+ * Checks if the step range functions should apply a periodic block pattern (small step, long range) instead of going bit by bit
+ * @param begin Begin of the range (bit index)
+ * @param end End of the range (bit index)
+ * @param step Step size between the bits (bit step)
+ * @return True if the pattern should be used
+ */
+inline bool bitset_use_step_pattern(const uint64_t begin, const uint64_t end, const uint64_t step)
+{
+    return step && step <= BITSET_STEP_PATTERN_THRESHOLD && begin < end
+        && (end - begin) / BITSET_BLOCK_BITS >= 2 * bitset_step_pattern_size(step);
+}
+
+/**
+ * Applies the bitwise operation with a periodic mask of every step-th bit in the range, whole blocks at a time
+ * The mask is built once for one period of blocks and then combined with the bitset block by block
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range (bit index)
+ * @param end End of the range (bit index)
+ * @param step Step size between the bits, at most BITSET_STEP_PATTERN_THRESHOLD (bit step)
+ * @param operation BITSET_OR to set, BITSET_ANDNOT to clear or BITSET_XOR to flip the bits
+ * @memberof BitSet
+ */
+inline void bitset_apply_step_pattern(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step, const BitSetOperation operation)
+{
+    // the block containing begin is done bit by bit (the range is long enough, so it's never the last block)
+    const uint64_t first_block_end = (begin / BITSET_BLOCK_BITS + 1) * BITSET_BLOCK_BITS;
+    uint64_t bit = begin;
+    for (; bit < first_block_end; bit += step)
+        *(bitset->data + bit / BITSET_BLOCK_BITS) = bitset_apply_operation_block(*(bitset->data + bit / BITSET_BLOCK_BITS), (bitset_block_t)1u << bit % BITSET_BLOCK_BITS, operation);
+
+    // the pattern starts at the next block, with the first bit at offset bit - first_block_end (lower than step)
+    bitset_block_t pattern[BITSET_STEP_PATTERN_THRESHOLD + BITSET_STEP_PATTERN_MIN_BLOCKS];
+    const uint64_t pattern_size = bitset_step_pattern_size(step);
+    memset(pattern, 0, pattern_size * sizeof(bitset_block_t));
+    for (uint64_t i = bit - first_block_end; i < pattern_size * BITSET_BLOCK_BITS; i += step)
+        pattern[i / BITSET_BLOCK_BITS] |= (bitset_block_t)1u << i % BITSET_BLOCK_BITS;
+
+    bitset_block_t* data = bitset->data + first_block_end / BITSET_BLOCK_BITS;
+    bitset_block_t* const last = bitset->data + (end - 1) / BITSET_BLOCK_BITS;
+
+    // whole periods before the last block
+    switch (operation)
+    {
+    case BITSET_OR:
+        for (; data + pattern_size <= last; data += pattern_size)
+            for (uint64_t i = 0; i < pattern_size; ++i)
+                *(data + i) |= pattern[i];
+        break;
+    case BITSET_XOR:
+        for (; data + pattern_size <= last; data += pattern_size)
+            for (uint64_t i = 0; i < pattern_size; ++i)
+                *(data + i) ^= pattern[i];
+        break;
+    default:
+        for (; data + pattern_size <= last; data += pattern_size)
+            for (uint64_t i = 0; i < pattern_size; ++i)
+                *(data + i) &= ~pattern[i];
+        break;
+    }
+
+    // rest of the period, the last block is masked at end
+    for (uint64_t i = 0; data <= last; ++data, ++i)
+    {
+        const bitset_block_t mask = data == last ? pattern[i] & bitset_create_range_block(0, (end - 1) % BITSET_BLOCK_BITS + 1) : pattern[i];
+        *data = bitset_apply_operation_block(*data, mask, operation);
+    }
+}
+
 /**
  * Retrieves the block at the specified index
  * @memberof BitSet
@@ -670,7 +1365,7 @@ inline void bitset_flip_block_in_range_begin_end_step(BitSet* const bitset, cons
  * @param index Index of the block to read (block index)
  * @return The block at the specified index
  */
-inline uint8_t bitset_get_block(const BitSet* const bitset, const uint64_t index)
+inline bitset_block_t bitset_get_block(const BitSet* const bitset, const uint64_t index)
 {
     return *(bitset->data + index);
 }
@@ -683,20 +1378,16 @@ inline uint8_t bitset_get_block(const BitSet* const bitset, const uint64_t index
  */
 inline bool bitset_all(const BitSet* const bitset)
 {
-    for (uint64_t i = 0; i < bitset->storage_size - (bitset->size % 8 ? 1 : 0); ++i)
+    BITSET_STATS_CALL(BITSET_STATS_PREDICATE, bitset->size);
+    if (!bitset->size)
+        return true;
+    for (uint64_t i = 0; i < bitset->storage_size - 1; ++i)
     {
-        if (*(bitset->data + i) != 255u)
+        if (*(bitset->data + i) != BITSET_BLOCK_FULL)
             return false;
     }
-    if (bitset->size % 8)
-    {
-        for (uint16_t i = 0; i < bitset->size % 8; ++i)
-        {
-            if (*(bitset->data + bitset->storage_size - 1) & (uint8_t)1u << i)
-                return false;
-        }
-    }
-    return true;
+    const bitset_block_t tail_mask = bitset_create_tail_block(bitset->size);
+    return (*(bitset->data + bitset->storage_size - 1) & tail_mask) == tail_mask;
 }
 
 /**
@@ -707,20 +1398,15 @@ inline bool bitset_all(const BitSet* const bitset)
  */
 inline bool bitset_any(const BitSet* const bitset)
 {
-    for (uint64_t i = 0; i < bitset->storage_size - (bitset->size % 8 ? 1 : 0); ++i)
+    BITSET_STATS_CALL(BITSET_STATS_PREDICATE, bitset->size);
+    if (!bitset->size)
+        return false;
+    for (uint64_t i = 0; i < bitset->storage_size - 1; ++i)
     {
         if (*(bitset->data + i))
             return true;
     }
-    if (bitset->size % 8)
-    {
-        for (uint16_t i = 0; i < bitset->size % 8; ++i)
-        {
-            if (*(bitset->data + bitset->storage_size - 1) & (uint8_t)1u << i)
-                return true;
-        }
-    }
-    return false;
+    return *(bitset->data + bitset->storage_size - 1) & bitset_create_tail_block(bitset->size);
 }
 
 /**
@@ -742,39 +1428,23 @@ inline bool bitset_none(const BitSet* const bitset)
  */
 inline bool bitset_all_cleared(const BitSet* const bitset)
 {
-    for (uint64_t i = 0; i < bitset->storage_size - (bitset->size % 8u ? 1 : 0); ++i)
-    {
-        if (*(bitset->data + i))
-            return false;
-    }
-    if (bitset->size % 8)
-    {
-        for (uint16_t i = 0; i < bitset->size % 8; ++i)
-        {
-            if (*(bitset->data + bitset->storage_size - 1) & (uint8_t)1u << i)
-                return false;
-        }
-    }
-    return true;
+    return !bitset_any(bitset);
 }
 
 /**
+ * Counts the set bits, whole storage is counted by the fastest popcount kernel supported by the CPU
  * @memberof BitSet
+ * @param bitset Pointer to bitset to count the bits of
  * @return the number of bits set in the bitset
  */
 inline uint64_t bitset_count(const BitSet* const bitset)
 {
-    uint64_t count = 0;
-    for (uint64_t i = 0; i < bitset->storage_size; ++i)
-    {
-        uint8_t block = *(bitset->data + i);
-        while (block)
-        {
-            count += block & (uint8_t)1u;
-            block >>= 1;
-        }
-    }
-    return count;
+    BITSET_STATS_CALL(BITSET_STATS_COUNT, bitset->size);
+    if (!bitset->size)
+        return 0;
+    // bits past the size of the bitset are not counted
+    return bitset_popcount_buffer(bitset->data, (bitset->storage_size - 1) * sizeof(bitset_block_t))
+        + bitset_block_popcount(*(bitset->data + bitset->storage_size - 1) & bitset_create_tail_block(bitset->size));
 }
 
 /**
@@ -789,138 +1459,1350 @@ inline bool bitset_empty(const BitSet* const bitset)
 }
 
 /**
- * Pushes back a bit to the bitset
- * @param bitset Pointer to bitset to modify
- * @param value Value of the bit to append (bit value)
+ * Counts the set bits in the specified range, the whole blocks in the middle are counted by the popcount kernel
+ * @param bitset Pointer to bitset to count the bits of
+ * @param begin Begin of the range to count (bit index)
+ * @param end End of the range to count (bit index)
+ * @return The number of bits set in the range
  * @memberof BitSet
  */
-void bitset_dynamic_push_back(DynamicBitSet* const bitset, const bool value)
+inline uint64_t bitset_count_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end)
 {
-	if (bitset->size % 8)
-	{
-		if (value)
-			*(bitset->data + bitset->size / 8) |= (uint8_t)1u << bitset->size % 8;
-		else
-			*(bitset->data + bitset->size / 8) &= ~((uint8_t)1u << bitset->size % 8);
-	}
-	else
-	{
-		uint8_t* new_data = (uint8_t*)malloc((bitset->storage_size + 1) * sizeof(uint8_t));
-		if (bitset->data)
-		{
-			memcpy(new_data, bitset->data, bitset->storage_size);
-			free(bitset->data);
-		}
-		bitset->data = new_data;
-		*(bitset->data + bitset->storage_size++) = value ? 1u : 0u;
-	}
-	++bitset->size;
+    BITSET_STATS_CALL(BITSET_STATS_COUNT, begin < end ? end - begin : 0u);
+    if (begin >= end)
+        return 0;
+
+    const uint64_t begin_block = begin / BITSET_BLOCK_BITS, end_block = (end - 1) / BITSET_BLOCK_BITS;
+    // masks of the affected bits in the first and the last block
+    const bitset_block_t begin_mask = bitset_create_range_block(begin % BITSET_BLOCK_BITS, BITSET_BLOCK_BITS);
+    const bitset_block_t end_mask = bitset_create_range_block(0, (end - 1) % BITSET_BLOCK_BITS + 1);
+
+    if (begin_block == end_block)
+        return bitset_block_popcount(*(bitset->data + begin_block) & begin_mask & end_mask);
+
+    return bitset_block_popcount(*(bitset->data + begin_block) & begin_mask)
+        + bitset_popcount_buffer(bitset->data + begin_block + 1, (end_block - begin_block - 1) * sizeof(bitset_block_t))
+        + bitset_block_popcount(*(bitset->data + end_block) & end_mask);
 }
 
 /**
- * Removes the last bit from the bitset
- * @param bitset Pointer to bitset to modify
+ * Finds the first bit with the specified value in the specified range, the whole blocks in the middle are skipped by
+ * the vectorized mismatch kernel, so the search stops at the first block containing a match
+ * @param bitset Pointer to bitset to search
+ * @param value Value of the bit to find (bit value)
+ * @param begin Begin of the range to search (bit index)
+ * @param end End of the range to search (bit index)
+ * @return Index of the found bit or BITSET_NPOS if there is none
  * @memberof BitSet
  */
-void bitset_dynamic_pop_back(DynamicBitSet* const bitset)
+inline uint64_t bitset_find_value_in_range_begin_end(const BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end)
 {
-    if (bitset->data)
+    if (begin >= end)
+        return BITSET_NPOS;
+
+    const bitset_block_t invert = value ? (bitset_block_t)0u : BITSET_BLOCK_FULL;
+    const uint64_t begin_block = begin / BITSET_BLOCK_BITS, end_block = (end - 1) / BITSET_BLOCK_BITS;
+    bitset_block_t begin_mask = bitset_create_range_block(begin % BITSET_BLOCK_BITS, BITSET_BLOCK_BITS);
+    const bitset_block_t end_mask = bitset_create_range_block(0, (end - 1) % BITSET_BLOCK_BITS + 1);
+
+    if (begin_block == end_block)
+        begin_mask &= end_mask;
+
+    bitset_block_t block = (*(bitset->data + begin_block) ^ invert) & begin_mask;
+    if (block)
+        return begin_block * BITSET_BLOCK_BITS + bitset_block_lowest_bit(block);
+    if (begin_block == end_block)
+        return BITSET_NPOS;
+
+    // whole blocks in the middle of the range, a block without a match equals the inverted pattern
+    const uint64_t middle_size = (end_block - begin_block - 1) * sizeof(bitset_block_t);
+    const uint64_t offset = bitset_find_mismatch_buffer(bitset->data + begin_block + 1, middle_size, value ? 0u : 255u);
+    if (offset < middle_size)
     {
-        if (!(bitset->size % 8))
-        {
-            uint8_t* new_data = (uint8_t*)malloc((bitset->storage_size - 1) * sizeof(uint8_t));
-            memcpy(new_data, bitset->data, bitset->storage_size - 1);
-            free(bitset->data);
-            bitset->data = new_data;
-        }
-        --bitset->size;
+        const uint64_t block_index = begin_block + 1 + offset / sizeof(bitset_block_t);
+        return block_index * BITSET_BLOCK_BITS + bitset_block_lowest_bit(*(bitset->data + block_index) ^ invert);
     }
-    // else throw exception in safe version
+
+    block = (*(bitset->data + end_block) ^ invert) & end_mask;
+    return block ? end_block * BITSET_BLOCK_BITS + bitset_block_lowest_bit(block) : BITSET_NPOS;
 }
 
 /**
- * Pushes back a block to the bitset, adjusting the size to the nearest multiple of sizeof(T) upwards. [e.g. 65 bits -> (+8 {block} +7 {expanded area} = +15) -> 80 bits]
- * The bits in the expanded area may be initialized by previous calls, but their values are not explicitly defined by this function.
+ * Finds the first set bit in the specified range
+ * @param bitset Pointer to bitset to search
+ * @param begin Begin of the range to search (bit index)
+ * @param end End of the range to search (bit index)
+ * @return Index of the found bit or BITSET_NPOS if there is none
  * @memberof BitSet
- * @param bitset Pointer to bitset to modify
- * @param block The block to push back (block value)
  */
-void bitset_dynamic_push_back_block(DynamicBitSet* const bitset, const uint8_t block)
+inline uint64_t bitset_find_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end)
 {
-    uint8_t* new_data = (uint8_t*)malloc(bitset->storage_size + (bitset->size % 8 ? 2 : 1));
-    if (bitset->data)
-    {
-        memcpy(new_data, bitset->data, bitset->storage_size);
-        free(bitset->data);
-    }
-    bitset->data = new_data;
-    *(bitset->data + bitset->storage_size++) = block;
-    bitset->size += 8 + (bitset->size % 8 ? 8 - bitset->size % 8 : 0);
+    BITSET_STATS_CALL(BITSET_STATS_FIND, begin < end ? end - begin : 0u);
+    return bitset_find_value_in_range_begin_end(bitset, true, begin, end);
 }
 
 /**
- * Removes the last block from the bitset, adjusting the size to the nearest lower multiple of sizeof(T). [e.g. 65 bits -> 64 bits -> 56 bits]
+ * Finds the first cleared bit in the specified range
+ * @param bitset Pointer to bitset to search
+ * @param begin Begin of the range to search (bit index)
+ * @param end End of the range to search (bit index)
+ * @return Index of the found bit or BITSET_NPOS if there is none
  * @memberof BitSet
- * @param bitset Pointer to bitset to modify
  */
-void bitset_dynamic_pop_back_block(DynamicBitSet* const bitset)
+inline uint64_t bitset_find_cleared_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end)
 {
-	if (bitset->data)
-	{
-		if (bitset->size % 8)
-		{
-			uint8_t* new_data = (uint8_t*)malloc((bitset->storage_size - 1) * sizeof(uint8_t));
-			memcpy(new_data, bitset->data, bitset->storage_size - 1);
-			free(bitset->data);
-			bitset->data = new_data;
-		}
-		bitset->size -= 8;
-	}
-	// else throw exception in safe version
+    BITSET_STATS_CALL(BITSET_STATS_FIND, begin < end ? end - begin : 0u);
+    return bitset_find_value_in_range_begin_end(bitset, false, begin, end);
 }
 
 /**
- * Resizes the bitset to the specified size
+ * Checks if any of the bits in the specified range are set, stops at the first set bit
+ * @param bitset Pointer to bitset to check
+ * @param begin Begin of the range to check (bit index)
+ * @param end End of the range to check (bit index)
+ * @return True if any of the bits in the range are set, false otherwise (false for an empty range)
  * @memberof BitSet
- * @param bitset Pointer to bitset to resize
- * @param new_size The new size of the bitset (bit size)
  */
-void bitset_dynamic_resize(DynamicBitSet* const bitset, const uint64_t new_size)
+inline bool bitset_any_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end)
 {
-	if (new_size == bitset->size)
-		return;
+    BITSET_STATS_CALL(BITSET_STATS_PREDICATE, begin < end ? end - begin : 0u);
+    return bitset_find_value_in_range_begin_end(bitset, true, begin, end) != BITSET_NPOS;
+}
 
-	const uint64_t new_storage_size = bitset_calculate_storage_size(new_size);
-	uint8_t* new_data = (uint8_t*)malloc(new_storage_size * sizeof(uint8_t));
-	if (bitset->data)
-	{
-		memcpy(new_data, bitset->data, new_storage_size);
-		free(bitset->data);
-	}
-	bitset->data = new_data;
-	bitset->storage_size = new_storage_size;
-	bitset->size = new_size;
+/**
+ * Checks if all the bits in the specified range are set, stops at the first cleared bit
+ * @param bitset Pointer to bitset to check
+ * @param begin Begin of the range to check (bit index)
+ * @param end End of the range to check (bit index)
+ * @return True if all the bits in the range are set, false otherwise (true for an empty range)
+ * @memberof BitSet
+ */
+inline bool bitset_all_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    BITSET_STATS_CALL(BITSET_STATS_PREDICATE, begin < end ? end - begin : 0u);
+    return bitset_find_value_in_range_begin_end(bitset, false, begin, end) == BITSET_NPOS;
 }
 
 /**
- * Calculates the number of bytes required to store the bitset
+ * Checks if none of the bits in the specified range are set
+ * @param bitset Pointer to bitset to check
+ * @param begin Begin of the range to check (bit index)
+ * @param end End of the range to check (bit index)
+ * @return True if none of the bits in the range are set, false otherwise (true for an empty range)
  * @memberof BitSet
- * @param size The size of the bitset
- * @return The number of bytes required to store the bitset
  */
-inline const uint64_t bitset_calculate_storage_size(const uint64_t size)
+inline bool bitset_none_in_range_begin_end(const BitSet* const bitset, const uint64_t begin, const uint64_t end)
 {
-    return size / 8u + (size % 8u ? 1 : 0);
+    return !bitset_any_in_range_begin_end(bitset, begin, end);
 }
 
 /**
- * Creates a block of type uint8_t based on the given boolean value.
- *
- * @param value A boolean value indicating whether to create the block with the maximum value or zero.
- * @return The created block of type uint8_t. If value is true, returns the maximum value representable by type uint8_t, which is 255,
- *         otherwise returns zero.
+ * Pushes back a bit to the bitset, amortized O(1)
+ * @param bitset Pointer to bitset to modify
+ * @param value Value of the bit to append (bit value)
+ * @memberof DynamicBitSet
  */
-inline const uint8_t bitset_create_filled_block(const bool value)
+inline void bitset_dynamic_push_back(DynamicBitSet* const bitset, const bool value)
 {
-    return value ? 255u : 0u;
-}
\ No newline at end of file
+    BITSET_STATS_CALL(BITSET_STATS_PUSH_BACK, 1u);
+    if (bitset->size % BITSET_BLOCK_BITS)
+    {
+        bitset_dynamic_grow(bitset, bitset->storage_size);
+        if (value)
+            *(bitset->data + bitset->size / BITSET_BLOCK_BITS) |= (bitset_block_t)1u << bitset->size % BITSET_BLOCK_BITS;
+        else
+            *(bitset->data + bitset->size / BITSET_BLOCK_BITS) &= ~((bitset_block_t)1u << bitset->size % BITSET_BLOCK_BITS);
+    }
+    else
+    {
+        bitset_dynamic_grow(bitset, bitset->storage_size + 1);
+        *(bitset->data + bitset->storage_size++) = value ? 1u : 0u;
+    }
+    ++bitset->size;
+}
+
+/**
+ * Removes the last bit from the bitset, the capacity is kept
+ * @param bitset Pointer to bitset to modify
+ * @memberof DynamicBitSet
+ */
+inline void bitset_dynamic_pop_back(DynamicBitSet* const bitset)
+{
+    BITSET_STATS_CALL(BITSET_STATS_POP_BACK, 1u);
+    if (bitset->size)
+    {
+        if (!(--bitset->size % BITSET_BLOCK_BITS))
+            --bitset->storage_size;
+    }
+    // else throw exception in safe version
+}
+
+/**
+ * Pushes back a block to the bitset, adjusting the size to the nearest multiple of the block size upwards. [e.g. 8-bit blocks: 65 bits -> (+8 {block} +7 {expanded area} = +15) -> 80 bits]
+ * The bits in the expanded area may be initialized by previous calls, but their values are not explicitly defined by this function.
+ * Amortized O(1)
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param block The block to push back (block value)
+ */
+inline void bitset_dynamic_push_back_block(DynamicBitSet* const bitset, const bitset_block_t block)
+{
+    BITSET_STATS_CALL(BITSET_STATS_PUSH_BACK, BITSET_BLOCK_BITS);
+    bitset_dynamic_grow(bitset, bitset->storage_size + 1);
+    *(bitset->data + bitset->storage_size++) = block;
+    bitset->size = bitset->storage_size * BITSET_BLOCK_BITS;
+}
+
+/**
+ * Removes the last block from the bitset, adjusting the size to the nearest lower multiple of the block size, the capacity is kept. [e.g. 8-bit blocks: 65 bits -> 64 bits -> 56 bits]
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to modify
+ */
+inline void bitset_dynamic_pop_back_block(DynamicBitSet* const bitset)
+{
+    BITSET_STATS_CALL(BITSET_STATS_POP_BACK, BITSET_BLOCK_BITS);
+    if (bitset->size)
+        bitset->size = --bitset->storage_size * BITSET_BLOCK_BITS;
+    // else throw exception in safe version
+}
+
+/**
+ * Resizes the bitset to the specified size, the bits added by growing are cleared and shrinking keeps the capacity
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to resize
+ * @param new_size The new size of the bitset (bit size)
+ */
+inline void bitset_dynamic_resize(DynamicBitSet* const bitset, const uint64_t new_size)
+{
+    BITSET_STATS_CALL(BITSET_STATS_RESIZE, new_size > bitset->size ? new_size - bitset->size : bitset->size - new_size);
+    if (new_size == bitset->size)
+        return;
+
+    const uint64_t new_storage_size = bitset_calculate_storage_size(new_size);
+    if (new_size > bitset->size)
+    {
+        bitset_dynamic_grow(bitset, new_storage_size);
+        // clear the unused bits of the old last block, they become part of the bitset
+        if (bitset->size % BITSET_BLOCK_BITS)
+            *(bitset->data + bitset->size / BITSET_BLOCK_BITS) &= bitset_create_tail_block(bitset->size);
+        memset(bitset->data + bitset->storage_size, 0, (new_storage_size - bitset->storage_size) * sizeof(bitset_block_t));
+    }
+    bitset->storage_size = new_storage_size;
+    bitset->size = new_size;
+}
+
+/**
+ * Makes sure the bitset can hold at least the specified number of bits without reallocating
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param capacity The number of bits to reserve the memory for (bit size)
+ */
+inline void bitset_dynamic_reserve(DynamicBitSet* const bitset, const uint64_t capacity)
+{
+    const uint64_t new_capacity = bitset_calculate_storage_size(capacity);
+    if (new_capacity > bitset->capacity)
+        bitset_dynamic_reallocate(bitset, new_capacity);
+}
+
+/**
+ * Releases the blocks allocated past the size of the bitset
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to modify
+ */
+inline void bitset_dynamic_shrink_to_fit(DynamicBitSet* const bitset)
+{
+    if (bitset->capacity > bitset->storage_size)
+        bitset_dynamic_reallocate(bitset, bitset->storage_size);
+}
+
+/**
+ * Changes the number of allocated blocks (realloc, so the data is moved only if it has to be)
+ * Mapped bitsets are copied to the heap and the file is unmapped
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param capacity The new number of allocated blocks, at least storage_size (block size)
+ */
+inline void bitset_dynamic_reallocate(DynamicBitSet* const bitset, const uint64_t capacity)
+{
+    BITSET_STATS_CALL(BITSET_STATS_REALLOCATE, capacity * BITSET_BLOCK_BITS);
+    BITSET_STATS_TIMER_BEGIN(timer);
+    if (bitset->mapping)
+    {
+        bitset_block_t* const data = (bitset_block_t*)bitset_allocate(bitset->allocator, capacity * sizeof(bitset_block_t), bitset->alignment);
+        BITSET_STATS_COPY_BYTES((bitset->storage_size < capacity ? bitset->storage_size : capacity) * sizeof(bitset_block_t));
+        memcpy(data, bitset->data, (bitset->storage_size < capacity ? bitset->storage_size : capacity) * sizeof(bitset_block_t));
+        bitset_unmap_memory(bitset->mapping, bitset->mapping_size);
+        bitset->mapping = NULL;
+        bitset->mapping_size = 0;
+        bitset->data = data;
+    }
+    else if (!capacity)
+    {
+        bitset_deallocate(bitset->allocator, bitset->data, bitset->capacity * sizeof(bitset_block_t), bitset->alignment);
+        bitset->data = NULL;
+    }
+    else
+    {
+#ifdef BITSET_STATS
+        // a moved storage means the reallocation copied the old blocks
+        const uintptr_t old_data = (uintptr_t)bitset->data;
+#endif
+        bitset->data = (bitset_block_t*)bitset_reallocate_memory(bitset->allocator, bitset->data, bitset->capacity * sizeof(bitset_block_t), capacity * sizeof(bitset_block_t), bitset->alignment);
+#ifdef BITSET_STATS
+        if (old_data && (uintptr_t)bitset->data != old_data)
+            BITSET_STATS_COPY_BYTES((bitset->capacity < capacity ? bitset->capacity : capacity) * sizeof(bitset_block_t));
+#endif
+    }
+    bitset->capacity = capacity;
+    BITSET_STATS_TIMER_END(BITSET_STATS_REALLOCATE, timer);
+}
+
+/**
+ * Grows the capacity geometrically (by BITSET_GROWTH_FACTOR) if it's lower than the specified number of blocks, a mapped bitset is copied to the heap so the blocks can be written
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param storage_size The number of blocks the bitset has to be able to hold (block size)
+ */
+inline void bitset_dynamic_grow(DynamicBitSet* const bitset, const uint64_t storage_size)
+{
+    if (storage_size <= bitset->capacity)
+    {
+        // the caller writes to the blocks in place, a mapping (maybe read-only) is copied to the heap first
+        if (bitset->mapping)
+            bitset_dynamic_reallocate(bitset, bitset->capacity);
+        return;
+    }
+    const uint64_t grown_capacity = bitset->capacity * BITSET_GROWTH_FACTOR;
+    bitset_dynamic_reallocate(bitset, grown_capacity > storage_size ? grown_capacity : storage_size);
+}
+
+/**
+ * Calculates the number of blocks required to store the bitset
+ * @memberof BitSet
+ * @param size The size of the bitset
+ * @return The number of blocks required to store the bitset
+ */
+inline const uint64_t bitset_calculate_storage_size(const uint64_t size)
+{
+    return size / BITSET_BLOCK_BITS + (size % BITSET_BLOCK_BITS ? 1 : 0);
+}
+
+/**
+ * Creates a block of type bitset_block_t based on the given boolean value.
+ *
+ * @param value A boolean value indicating whether to create the block with the maximum value or zero.
+ * @return The created block of type bitset_block_t. If value is true, returns the maximum value representable by bitset_block_t (all bits set),
+ *         otherwise returns zero.
+ */
+inline const bitset_block_t bitset_create_filled_block(const bool value)
+{
+    return value ? BITSET_BLOCK_FULL : (bitset_block_t)0u;
+}
+
+/**
+ * Creates a block with the bits in the specified range set
+ * @param begin Begin of the range (bit index inside the block, lower than end)
+ * @param end End of the range (bit index inside the block, at most BITSET_BLOCK_BITS)
+ * @return The block with bits [begin, end) set
+ */
+inline const bitset_block_t bitset_create_range_block(const uint64_t begin, const uint64_t end)
+{
+    return (bitset_block_t)((bitset_block_t)(BITSET_BLOCK_FULL >> (BITSET_BLOCK_BITS - (end - begin))) << begin);
+}
+
+/**
+ * Creates a mask of the bits used in the last block of a bitset
+ * @param size The size of the bitset (bit size)
+ * @return The block with the bits belonging to the bitset set
+ */
+inline const bitset_block_t bitset_create_tail_block(const uint64_t size)
+{
+    return size % BITSET_BLOCK_BITS ? bitset_create_range_block(0, size % BITSET_BLOCK_BITS) : BITSET_BLOCK_FULL;
+}
+
+/**
+ * Counts the set bits in a block
+ * @param block The block to count the bits of
+ * @return The number of set bits
+ */
+inline uint64_t bitset_block_popcount(bitset_block_t block)
+{
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < sizeof(bitset_block_t); i += 8)
+    {
+        count += bitset_popcount64((uint64_t)block);
+        // only reached for blocks wider than 64 bits
+        block >>= BITSET_BLOCK_BITS > 64 ? 64 : 0;
+    }
+    return count;
+}
+
+/**
+ * Applies the bitwise operation to two blocks
+ * @param first The first operand (block value)
+ * @param second The second operand (block value)
+ * @param operation The operation to apply
+ * @return The result of the operation
+ */
+inline bitset_block_t bitset_apply_operation_block(const bitset_block_t first, const bitset_block_t second, const BitSetOperation operation)
+{
+    switch (operation)
+    {
+    case BITSET_AND:
+        return first & second;
+    case BITSET_OR:
+        return first | second;
+    case BITSET_XOR:
+        return first ^ second;
+    default:
+        return first & ~second;
+    }
+}
+
+/**
+ * Applies the bitwise operation to two bitsets, blocks common to all the bitsets are processed by the fastest kernel supported by the CPU
+ * @param destination Pointer to bitset receiving the result (may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param operation The operation to apply
+ * @memberof BitSet
+ */
+inline void bitset_apply_operation(BitSet* const destination, const BitSet* const first, const BitSet* const second, const BitSetOperation operation)
+{
+    uint64_t storage_size = first->storage_size < second->storage_size ? first->storage_size : second->storage_size;
+    if (destination->storage_size < storage_size)
+        storage_size = destination->storage_size;
+    BITSET_STATS_CALL(BITSET_STATS_SET_OPERATION, storage_size * BITSET_BLOCK_BITS);
+    BITSET_STATS_TIMER_BEGIN(timer);
+    bitset_operation_buffer(destination->data, first->data, second->data, storage_size * sizeof(bitset_block_t), operation);
+    BITSET_STATS_TIMER_END(BITSET_STATS_SET_OPERATION, timer);
+}
+
+/**
+ * Counts the set bits in the result of the bitwise operation without storing it
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param operation The operation to apply
+ * @return The number of set bits in the result (bits common to both bitsets)
+ * @memberof BitSet
+ */
+inline uint64_t bitset_apply_operation_count(const BitSet* const first, const BitSet* const second, const BitSetOperation operation)
+{
+    const uint64_t size = first->size < second->size ? first->size : second->size;
+    BITSET_STATS_CALL(BITSET_STATS_SET_OPERATION, size);
+    BITSET_STATS_TIMER_BEGIN(timer);
+    uint64_t count = bitset_operation_count_buffer(first->data, second->data, size / BITSET_BLOCK_BITS * sizeof(bitset_block_t), operation);
+    // bits past the size of the bitsets are not counted
+    if (size % BITSET_BLOCK_BITS)
+        count += bitset_block_popcount(bitset_apply_operation_block(*(first->data + size / BITSET_BLOCK_BITS), *(second->data + size / BITSET_BLOCK_BITS), operation) & bitset_create_tail_block(size));
+    BITSET_STATS_TIMER_END(BITSET_STATS_SET_OPERATION, timer);
+    return count;
+}
+
+/**
+ * Stores the intersection of two bitsets (first & second) in the destination
+ * @param destination Pointer to bitset receiving the result (may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @memberof BitSet
+ */
+inline void bitset_and(BitSet* const destination, const BitSet* const first, const BitSet* const second)
+{
+    bitset_apply_operation(destination, first, second, BITSET_AND);
+}
+
+/**
+ * Stores the union of two bitsets (first | second) in the destination
+ * @param destination Pointer to bitset receiving the result (may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @memberof BitSet
+ */
+inline void bitset_or(BitSet* const destination, const BitSet* const first, const BitSet* const second)
+{
+    bitset_apply_operation(destination, first, second, BITSET_OR);
+}
+
+/**
+ * Stores the symmetric difference of two bitsets (first ^ second) in the destination
+ * @param destination Pointer to bitset receiving the result (may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @memberof BitSet
+ */
+inline void bitset_xor(BitSet* const destination, const BitSet* const first, const BitSet* const second)
+{
+    bitset_apply_operation(destination, first, second, BITSET_XOR);
+}
+
+/**
+ * Stores the difference of two bitsets (first & ~second) in the destination
+ * @param destination Pointer to bitset receiving the result (may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @memberof BitSet
+ */
+inline void bitset_andnot(BitSet* const destination, const BitSet* const first, const BitSet* const second)
+{
+    bitset_apply_operation(destination, first, second, BITSET_ANDNOT);
+}
+
+/**
+ * Replaces the destination with the intersection of it and the source (destination & source)
+ * @param destination Pointer to bitset to modify
+ * @param source Pointer to the second operand
+ * @memberof BitSet
+ */
+inline void bitset_and_in_place(BitSet* const destination, const BitSet* const source)
+{
+    bitset_apply_operation(destination, destination, source, BITSET_AND);
+}
+
+/**
+ * Replaces the destination with the union of it and the source (destination | source)
+ * @param destination Pointer to bitset to modify
+ * @param source Pointer to the second operand
+ * @memberof BitSet
+ */
+inline void bitset_or_in_place(BitSet* const destination, const BitSet* const source)
+{
+    bitset_apply_operation(destination, destination, source, BITSET_OR);
+}
+
+/**
+ * Replaces the destination with the symmetric difference of it and the source (destination ^ source)
+ * @param destination Pointer to bitset to modify
+ * @param source Pointer to the second operand
+ * @memberof BitSet
+ */
+inline void bitset_xor_in_place(BitSet* const destination, const BitSet* const source)
+{
+    bitset_apply_operation(destination, destination, source, BITSET_XOR);
+}
+
+/**
+ * Replaces the destination with the difference of it and the source (destination & ~source)
+ * @param destination Pointer to bitset to modify
+ * @param source Pointer to the second operand
+ * @memberof BitSet
+ */
+inline void bitset_andnot_in_place(BitSet* const destination, const BitSet* const source)
+{
+    bitset_apply_operation(destination, destination, source, BITSET_ANDNOT);
+}
+
+/**
+ * Counts the set bits in the intersection of two bitsets (first & second) without storing it
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @return The number of set bits in the result
+ * @memberof BitSet
+ */
+inline uint64_t bitset_and_count(const BitSet* const first, const BitSet* const second)
+{
+    return bitset_apply_operation_count(first, second, BITSET_AND);
+}
+
+/**
+ * Counts the set bits in the union of two bitsets (first | second) without storing it
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @return The number of set bits in the result
+ * @memberof BitSet
+ */
+inline uint64_t bitset_or_count(const BitSet* const first, const BitSet* const second)
+{
+    return bitset_apply_operation_count(first, second, BITSET_OR);
+}
+
+/**
+ * Counts the set bits in the symmetric difference of two bitsets (first ^ second) without storing it
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @return The number of set bits in the result
+ * @memberof BitSet
+ */
+inline uint64_t bitset_xor_count(const BitSet* const first, const BitSet* const second)
+{
+    return bitset_apply_operation_count(first, second, BITSET_XOR);
+}
+
+/**
+ * Counts the set bits in the difference of two bitsets (first & ~second) without storing it
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @return The number of set bits in the result
+ * @memberof BitSet
+ */
+inline uint64_t bitset_andnot_count(const BitSet* const first, const BitSet* const second)
+{
+    return bitset_apply_operation_count(first, second, BITSET_ANDNOT);
+}
+
+/**
+ * Stores the first blocks of the source shifted towards lower indices, the bits past the size of the source are read as 0
+ * The blocks are written in ascending order and each one reads only source blocks at or after it, so the destination may be the source data
+ * @param destination Pointer to the first block to store
+ * @param count Number of blocks to store (at most the storage size of the source)
+ * @param source Pointer to bitset to shift
+ * @param shift Number of bits to shift by (less than the size of the source)
+ */
+inline void bitset_shift_right_blocks(bitset_block_t* const destination, const uint64_t count, const BitSet* const source, const uint64_t shift)
+{
+    const uint64_t block_shift = shift / BITSET_BLOCK_BITS, bit_shift = shift % BITSET_BLOCK_BITS;
+    const uint64_t storage_size = source->storage_size;
+    const bitset_block_t last = *(source->data + storage_size - 1) & bitset_create_tail_block(source->size);
+    // blocks whose both source blocks are before the last one, no bounds checks so the loop vectorizes
+    const uint64_t direct = storage_size > block_shift + 1 ? storage_size - block_shift - 1 : 0;
+    const uint64_t direct_count = direct < count ? direct : count;
+    uint64_t i = 0;
+
+    if (!bit_shift)
+    {
+        memmove(destination, source->data + block_shift, direct_count * sizeof(bitset_block_t));
+        i = direct_count;
+    }
+    else
+    {
+        for (; i + 1 < direct_count; ++i)
+            *(destination + i) = (bitset_block_t)(*(source->data + i + block_shift) >> bit_shift
+                | *(source->data + i + block_shift + 1) << (BITSET_BLOCK_BITS - bit_shift));
+    }
+
+    for (; i < count; ++i)
+    {
+        const uint64_t low_index = i + block_shift;
+        const bitset_block_t low = low_index < storage_size - 1 ? *(source->data + low_index) : low_index == storage_size - 1 ? last : (bitset_block_t)0u;
+        const bitset_block_t high = low_index + 1 < storage_size - 1 ? *(source->data + low_index + 1) : low_index + 1 == storage_size - 1 ? last : (bitset_block_t)0u;
+        *(destination + i) = bit_shift ? (bitset_block_t)(low >> bit_shift | high << (BITSET_BLOCK_BITS - bit_shift)) : low;
+    }
+}
+
+/**
+ * Shifts the bits towards higher indices (bit i moves to i + shift, like std::bitset::operator<<), the vacated bits are cleared
+ * and the bits shifted past the size are dropped. Whole blocks are moved and the remaining bits are funneled between neighbouring blocks in one pass
+ * @param destination Pointer to bitset to store the result in (same size as the source, may be the source)
+ * @param source Pointer to bitset to shift
+ * @param shift Number of bits to shift by
+ * @memberof BitSet
+ */
+inline void bitset_shift_left(BitSet* const destination, const BitSet* const source, const uint64_t shift)
+{
+    BITSET_STATS_CALL(BITSET_STATS_SHIFT, source->size);
+    if (!source->size)
+        return;
+    if (shift >= source->size)
+    {
+        memset(destination->data, 0, source->storage_size * sizeof(bitset_block_t));
+        return;
+    }
+
+    const uint64_t block_shift = shift / BITSET_BLOCK_BITS, bit_shift = shift % BITSET_BLOCK_BITS;
+    const uint64_t storage_size = source->storage_size;
+    // descending order, each block reads only source blocks before it
+    if (!bit_shift)
+        memmove(destination->data + block_shift, source->data, (storage_size - block_shift) * sizeof(bitset_block_t));
+    else
+    {
+        for (uint64_t i = storage_size - 1; i > block_shift; --i)
+            *(destination->data + i) = (bitset_block_t)(*(source->data + i - block_shift) << bit_shift
+                | *(source->data + i - block_shift - 1) >> (BITSET_BLOCK_BITS - bit_shift));
+        *(destination->data + block_shift) = (bitset_block_t)(*source->data << bit_shift);
+    }
+    memset(destination->data, 0, block_shift * sizeof(bitset_block_t));
+}
+
+/**
+ * Shifts the bits towards lower indices (bit i moves to i - shift, like std::bitset::operator>>), the vacated bits are cleared
+ * and the bits shifted before the beginning are dropped. Whole blocks are moved and the remaining bits are funneled between neighbouring blocks in one pass
+ * @param destination Pointer to bitset to store the result in (same size as the source, may be the source)
+ * @param source Pointer to bitset to shift
+ * @param shift Number of bits to shift by
+ * @memberof BitSet
+ */
+inline void bitset_shift_right(BitSet* const destination, const BitSet* const source, const uint64_t shift)
+{
+    BITSET_STATS_CALL(BITSET_STATS_SHIFT, source->size);
+    if (!source->size)
+        return;
+    if (shift >= source->size)
+    {
+        memset(destination->data, 0, source->storage_size * sizeof(bitset_block_t));
+        return;
+    }
+    bitset_shift_right_blocks(destination->data, source->storage_size, source, shift);
+}
+
+/**
+ * Shifts the bits of the bitset towards higher indices (bitset <<= shift)
+ * @param bitset Pointer to bitset to modify
+ * @param shift Number of bits to shift by
+ * @memberof BitSet
+ */
+inline void bitset_shift_left_in_place(BitSet* const bitset, const uint64_t shift)
+{
+    bitset_shift_left(bitset, bitset, shift);
+}
+
+/**
+ * Shifts the bits of the bitset towards lower indices (bitset >>= shift)
+ * @param bitset Pointer to bitset to modify
+ * @param shift Number of bits to shift by
+ * @memberof BitSet
+ */
+inline void bitset_shift_right_in_place(BitSet* const bitset, const uint64_t shift)
+{
+    bitset_shift_right(bitset, bitset, shift);
+}
+
+/**
+ * Rotates the bits towards higher indices (bit i moves to (i + shift) % size), the bits shifted past the size wrap around to the beginning
+ * The wrapped bits are extracted first (only their blocks are allocated), then the rest is shifted in place
+ * @param destination Pointer to bitset to store the result in (same size as the source, may be the source)
+ * @param source Pointer to bitset to rotate
+ * @param shift Number of bits to rotate by
+ * @memberof BitSet
+ */
+inline void bitset_rotate_left(BitSet* const destination, const BitSet* const source, const uint64_t shift)
+{
+    if (!source->size)
+        return;
+    const uint64_t distance = shift % source->size;
+    if (!distance)
+    {
+        if (destination != source)
+            memcpy(destination->data, source->data, source->storage_size * sizeof(bitset_block_t));
+        return;
+    }
+
+    // the last distance bits of the source end up at the beginning
+    const uint64_t wrapped_size = bitset_calculate_storage_size(distance);
+    bitset_block_t* const wrapped = (bitset_block_t*)malloc(wrapped_size * sizeof(bitset_block_t));
+    bitset_shift_right_blocks(wrapped, wrapped_size, source, source->size - distance);
+    bitset_shift_left(destination, source, distance);
+    for (uint64_t i = 0; i < wrapped_size; ++i)
+        *(destination->data + i) |= *(wrapped + i);
+    free(wrapped);
+}
+
+/**
+ * Rotates the bits towards lower indices (bit i moves to (i - shift) % size), the bits shifted before the beginning wrap around to the end
+ * @param destination Pointer to bitset to store the result in (same size as the source, may be the source)
+ * @param source Pointer to bitset to rotate
+ * @param shift Number of bits to rotate by
+ * @memberof BitSet
+ */
+inline void bitset_rotate_right(BitSet* const destination, const BitSet* const source, const uint64_t shift)
+{
+    if (!source->size)
+        return;
+    bitset_rotate_left(destination, source, source->size - shift % source->size);
+}
+
+/**
+ * Rotates the bits of the bitset towards higher indices
+ * @param bitset Pointer to bitset to modify
+ * @param shift Number of bits to rotate by
+ * @memberof BitSet
+ */
+inline void bitset_rotate_left_in_place(BitSet* const bitset, const uint64_t shift)
+{
+    bitset_rotate_left(bitset, bitset, shift);
+}
+
+/**
+ * Rotates the bits of the bitset towards lower indices
+ * @param bitset Pointer to bitset to modify
+ * @param shift Number of bits to rotate by
+ * @memberof BitSet
+ */
+inline void bitset_rotate_right_in_place(BitSet* const bitset, const uint64_t shift)
+{
+    bitset_rotate_right(bitset, bitset, shift);
+}
+
+/**
+ * Finds the lowest set bit of a block
+ * @param block The block to scan (must not be zero)
+ * @return Index of the lowest set bit inside the block
+ */
+inline uint64_t bitset_block_lowest_bit(bitset_block_t block)
+{
+    uint64_t offset = 0;
+    // only loops for blocks wider than 64 bits
+    while (!(uint64_t)block)
+    {
+        block >>= BITSET_BLOCK_BITS > 64 ? 64 : 0;
+        offset += 64;
+    }
+    return offset + bitset_ctz64((uint64_t)block);
+}
+
+/**
+ * Finds the highest set bit of a block
+ * @param block The block to scan (must not be zero)
+ * @return Index of the highest set bit inside the block
+ */
+inline uint64_t bitset_block_highest_bit(bitset_block_t block)
+{
+    uint64_t offset = 0;
+    // only taken for blocks wider than 64 bits
+    if (BITSET_BLOCK_BITS > 64)
+    {
+        while (block >> (BITSET_BLOCK_BITS > 64 ? 64 : 0))
+        {
+            block >>= BITSET_BLOCK_BITS > 64 ? 64 : 0;
+            offset += 64;
+        }
+    }
+    return offset + 63 - bitset_clz64((uint64_t)block);
+}
+
+/**
+ * Finds the first bit with the specified value at or after the specified index, whole blocks without a match are skipped
+ * @param bitset Pointer to bitset to search
+ * @param value Value of the bit to find (bit value)
+ * @param begin Index to start the search from (bit index, inclusive)
+ * @return Index of the found bit or BITSET_NPOS if there is none
+ * @memberof BitSet
+ */
+inline uint64_t bitset_find_value_from(const BitSet* const bitset, const bool value, const uint64_t begin)
+{
+    BITSET_STATS_CALL(BITSET_STATS_FIND, begin < bitset->size ? bitset->size - begin : 0u);
+    if (begin >= bitset->size)
+        return BITSET_NPOS;
+
+    const bitset_block_t invert = value ? (bitset_block_t)0u : BITSET_BLOCK_FULL;
+    uint64_t block_index = begin / BITSET_BLOCK_BITS;
+    bitset_block_t block = (*(bitset->data + block_index) ^ invert) & bitset_create_range_block(begin % BITSET_BLOCK_BITS, BITSET_BLOCK_BITS);
+    while (!block)
+    {
+        if (++block_index >= bitset->storage_size)
+            return BITSET_NPOS;
+        block = *(bitset->data + block_index) ^ invert;
+    }
+
+    const uint64_t index = block_index * BITSET_BLOCK_BITS + bitset_block_lowest_bit(block);
+    // bits past the size of the bitset are not part of it
+    return index < bitset->size ? index : BITSET_NPOS;
+}
+
+/**
+ * Finds the last bit with the specified value before the specified index, whole blocks without a match are skipped
+ * @param bitset Pointer to bitset to search
+ * @param value Value of the bit to find (bit value)
+ * @param end Index to end the search at (bit index, exclusive)
+ * @return Index of the found bit or BITSET_NPOS if there is none
+ * @memberof BitSet
+ */
+inline uint64_t bitset_find_value_before(const BitSet* const bitset, const bool value, const uint64_t end)
+{
+    BITSET_STATS_CALL(BITSET_STATS_FIND, end < bitset->size ? end : bitset->size);
+    const uint64_t last = (end < bitset->size ? end : bitset->size);
+    if (!last)
+        return BITSET_NPOS;
+
+    const bitset_block_t invert = value ? (bitset_block_t)0u : BITSET_BLOCK_FULL;
+    uint64_t block_index = (last - 1) / BITSET_BLOCK_BITS;
+    bitset_block_t block = (*(bitset->data + block_index) ^ invert) & bitset_create_range_block(0, (last - 1) % BITSET_BLOCK_BITS + 1);
+    while (!block)
+    {
+        if (!block_index--)
+            return BITSET_NPOS;
+        block = *(bitset->data + block_index) ^ invert;
+    }
+    return block_index * BITSET_BLOCK_BITS + bitset_block_highest_bit(block);
+}
+
+/**
+ * Finds the first set bit
+ * @param bitset Pointer to bitset to search
+ * @return Index of the first set bit or BITSET_NPOS if there is none
+ * @memberof BitSet
+ */
+inline uint64_t bitset_find_first(const BitSet* const bitset)
+{
+    return bitset_find_value_from(bitset, true, 0);
+}
+
+/**
+ * Finds the next set bit after the specified index [e.g. for (i = bitset_find_first(b); i != BITSET_NPOS; i = bitset_find_next(b, i))]
+ * @param bitset Pointer to bitset to search
+ * @param index Index after which to search (bit index, exclusive)
+ * @return Index of the next set bit or BITSET_NPOS if there is none
+ * @memberof BitSet
+ */
+inline uint64_t bitset_find_next(const BitSet* const bitset, const uint64_t index)
+{
+    return index == BITSET_NPOS ? BITSET_NPOS : bitset_find_value_from(bitset, true, index + 1);
+}
+
+/**
+ * Finds the last set bit
+ * @param bitset Pointer to bitset to search
+ * @return Index of the last set bit or BITSET_NPOS if there is none
+ * @memberof BitSet
+ */
+inline uint64_t bitset_find_last(const BitSet* const bitset)
+{
+    return bitset_find_value_before(bitset, true, bitset->size);
+}
+
+/**
+ * Finds the previous set bit before the specified index
+ * @param bitset Pointer to bitset to search
+ * @param index Index before which to search (bit index, exclusive)
+ * @return Index of the previous set bit or BITSET_NPOS if there is none
+ * @memberof BitSet
+ */
+inline uint64_t bitset_find_prev(const BitSet* const bitset, const uint64_t index)
+{
+    return bitset_find_value_before(bitset, true, index);
+}
+
+/**
+ * Finds the first cleared bit
+ * @param bitset Pointer to bitset to search
+ * @return Index of the first cleared bit or BITSET_NPOS if there is none
+ * @memberof BitSet
+ */
+inline uint64_t bitset_find_first_cleared(const BitSet* const bitset)
+{
+    return bitset_find_value_from(bitset, false, 0);
+}
+
+/**
+ * Finds the next cleared bit after the specified index
+ * @param bitset Pointer to bitset to search
+ * @param index Index after which to search (bit index, exclusive)
+ * @return Index of the next cleared bit or BITSET_NPOS if there is none
+ * @memberof BitSet
+ */
+inline uint64_t bitset_find_next_cleared(const BitSet* const bitset, const uint64_t index)
+{
+    return index == BITSET_NPOS ? BITSET_NPOS : bitset_find_value_from(bitset, false, index + 1);
+}
+
+/**
+ * Finds the last cleared bit
+ * @param bitset Pointer to bitset to search
+ * @return Index of the last cleared bit or BITSET_NPOS if there is none
+ * @memberof BitSet
+ */
+inline uint64_t bitset_find_last_cleared(const BitSet* const bitset)
+{
+    return bitset_find_value_before(bitset, false, bitset->size);
+}
+
+/**
+ * Finds the previous cleared bit before the specified index
+ * @param bitset Pointer to bitset to search
+ * @param index Index before which to search (bit index, exclusive)
+ * @return Index of the previous cleared bit or BITSET_NPOS if there is none
+ * @memberof BitSet
+ */
+inline uint64_t bitset_find_prev_cleared(const BitSet* const bitset, const uint64_t index)
+{
+    return bitset_find_value_before(bitset, false, index);
+}
+
+/**
+ * Reads the bits as 64-bit words independently of the block type, bit i of word k is the bit first * 64 + k * 64 + i
+ * Bits at or past the size of the bitset are read as 0
+ * @param bitset Pointer to bitset to read from
+ * @param first Index of the first word to read (word index)
+ * @param words Array receiving the words
+ * @param count Number of words to read
+ * @memberof BitSet
+ */
+inline void bitset_load_words(const BitSet* const bitset, const uint64_t first, uint64_t* const words, const uint64_t count)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        const uint64_t bit = (first + i) * 64;
+        uint64_t word = 0;
+        if (bit < bitset->size)
+        {
+            if (BITSET_BLOCK_BITS >= 64)
+                word = (uint64_t)(*(bitset->data + bit / BITSET_BLOCK_BITS) >> bit % BITSET_BLOCK_BITS);
+            else
+                for (uint64_t j = 0; j < 64 / BITSET_BLOCK_BITS && bit / BITSET_BLOCK_BITS + j < bitset->storage_size; ++j)
+                    word |= (uint64_t)*(bitset->data + bit / BITSET_BLOCK_BITS + j) << j * BITSET_BLOCK_BITS % 64;
+            if (bitset->size - bit < 64)
+                word &= ((uint64_t)1u << (bitset->size - bit)) - 1;
+        }
+        *(words + i) = word;
+    }
+}
+
+/**
+ * Writes the bits as 64-bit words independently of the block type, bit i of word k is the bit first * 64 + k * 64 + i
+ * Words past the storage of the bitset are ignored
+ * @param bitset Pointer to bitset to modify
+ * @param first Index of the first word to write (word index)
+ * @param words Array of the words to write
+ * @param count Number of words to write
+ * @memberof BitSet
+ */
+inline void bitset_store_words(BitSet* const bitset, const uint64_t first, const uint64_t* const words, const uint64_t count)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        const uint64_t bit = (first + i) * 64;
+        if (bit / BITSET_BLOCK_BITS >= bitset->storage_size)
+            return;
+        if (BITSET_BLOCK_BITS >= 64)
+        {
+            bitset_block_t* const block = bitset->data + bit / BITSET_BLOCK_BITS;
+            const uint64_t shift = bit % BITSET_BLOCK_BITS;
+            *block = (*block & ~((bitset_block_t)UINT64_MAX << shift)) | (bitset_block_t)*(words + i) << shift;
+        }
+        else
+            for (uint64_t j = 0; j < 64 / BITSET_BLOCK_BITS && bit / BITSET_BLOCK_BITS + j < bitset->storage_size; ++j)
+                *(bitset->data + bit / BITSET_BLOCK_BITS + j) = (bitset_block_t)(*(words + i) >> j * BITSET_BLOCK_BITS % 64);
+    }
+}
+
+/**
+ * Calculates the checksum of the bits, the unused bits of the last block are ignored
+ * @param bitset Pointer to bitset to checksum
+ * @return The checksum (depends on the block type and the byte order of the machine)
+ * @memberof BitSet
+ */
+inline uint64_t bitset_checksum(const BitSet* const bitset)
+{
+    if (!bitset->storage_size)
+        return bitset_checksum_buffer(NULL, 0, 0);
+    const uint64_t checksum = bitset_checksum_buffer(bitset->data, (bitset->storage_size - 1) * sizeof(bitset_block_t), 0);
+    const bitset_block_t last = *(bitset->data + bitset->storage_size - 1) & bitset_create_tail_block(bitset->size);
+    return bitset_checksum_buffer(&last, sizeof(last), checksum);
+}
+
+/**
+ * Unmaps a file mapping created by bitset_dynamic_map_file
+ * @param mapping Start of the mapping
+ * @param size Size of the mapping in bytes
+ */
+inline void bitset_unmap_memory(void* const mapping, const uint64_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(mapping);
+#else
+    munmap(mapping, size);
+#endif
+}
+
+/**
+ * Saves the bitset to a file: a BitSetFileHeader followed by the blocks, ready to be mapped by bitset_dynamic_map_file
+ * The unused bits of the last block are stored cleared
+ * @param bitset Pointer to bitset to save
+ * @param path Path of the file to create or overwrite
+ * @return true on success, false if the file could not be written
+ * @memberof DynamicBitSet
+ */
+inline bool bitset_dynamic_save(const DynamicBitSet* const bitset, const char* const path)
+{
+    BitSetFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BITSET_FILE_MAGIC, sizeof(header.magic));
+    header.version = BITSET_FILE_VERSION;
+    header.block_bits = BITSET_BLOCK_BITS;
+    header.byte_order = BITSET_FILE_BYTE_ORDER;
+    header.size = bitset->size;
+    header.storage_size = bitset->storage_size;
+    header.checksum = bitset_checksum(UNIVERSAL_BITSET(bitset));
+
+    FILE* const file = fopen(path, "wb");
+    if (!file)
+        return false;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (bitset->storage_size)
+    {
+        const bitset_block_t last = *(bitset->data + bitset->storage_size - 1) & bitset_create_tail_block(bitset->size);
+        written = written && fwrite(bitset->data, sizeof(bitset_block_t), bitset->storage_size - 1, file) == bitset->storage_size - 1;
+        written = written && fwrite(&last, sizeof(last), 1, file) == 1;
+    }
+    return fclose(file) == 0 && written;
+}
+
+/**
+ * Initializes the bitset with the blocks of a file saved by bitset_dynamic_save, mapped in place without reading or copying them
+ * The file has to be written with the same block type on a machine with the same byte order
+ * Operations that grow the bitset copy it to the heap first, writes to a read-only mapping crash
+ * @param bitset Pointer to bitset to initialize (on failure it's initialized as an empty bitset)
+ * @param path Path of the file to map
+ * @param mode How to map the file
+ * @param verify true to check the checksum (reads the whole file), false to only check the header
+ * @return true on success, false if the file could not be mapped or is not a valid bitset file
+ * @memberof DynamicBitSet
+ */
+inline bool bitset_dynamic_map_file(DynamicBitSet* const bitset, const char* const path, const BitSetMapMode mode, const bool verify)
+{
+    bitset_dynamic_init(bitset, 0);
+    uint64_t mapping_size = 0;
+    void* mapping = NULL;
+#ifdef _WIN32
+    const HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && (uint64_t)file_size.QuadPart >= BITSET_FILE_HEADER_SIZE)
+    {
+        const HANDLE view = CreateFileMappingA(file, NULL, mode == BITSET_MAP_READ_ONLY ? PAGE_READONLY : PAGE_WRITECOPY, 0, 0, NULL);
+        if (view)
+        {
+            mapping = MapViewOfFile(view, mode == BITSET_MAP_READ_ONLY ? FILE_MAP_READ : FILE_MAP_COPY, 0, 0, 0);
+            mapping_size = (uint64_t)file_size.QuadPart;
+            CloseHandle(view);
+        }
+    }
+    CloseHandle(file);
+#else
+    const int file = open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+    struct stat status;
+    if (fstat(file, &status) == 0 && (uint64_t)status.st_size >= BITSET_FILE_HEADER_SIZE)
+    {
+        mapping = mmap(NULL, (size_t)status.st_size, mode == BITSET_MAP_READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+        if (mapping == MAP_FAILED)
+            mapping = NULL;
+        mapping_size = (uint64_t)status.st_size;
+    }
+    close(file);
+#endif
+    if (!mapping)
+        return false;
+
+    const BitSetFileHeader* const header = (const BitSetFileHeader*)mapping;
+    DynamicBitSet mapped;
+    mapped.data = (bitset_block_t*)((uint8_t*)mapping + BITSET_FILE_HEADER_SIZE);
+    mapped.size = header->size;
+    mapped.storage_size = mapped.capacity = header->storage_size;
+    mapped.mapping = mapping;
+    mapped.mapping_size = mapping_size;
+    mapped.allocator = NULL;
+    mapped.alignment = BITSET_MALLOC_ALIGNMENT;
+    if (memcmp(header->magic, BITSET_FILE_MAGIC, sizeof(header->magic)) != 0 || header->version != BITSET_FILE_VERSION ||
+        header->byte_order != BITSET_FILE_BYTE_ORDER || header->block_bits != BITSET_BLOCK_BITS ||
+        header->storage_size != bitset_calculate_storage_size(header->size) ||
+        header->storage_size > (mapping_size - BITSET_FILE_HEADER_SIZE) / sizeof(bitset_block_t) ||
+        (verify && bitset_checksum(UNIVERSAL_BITSET(&mapped)) != header->checksum))
+    {
+        bitset_unmap_memory(mapping, mapping_size);
+        return false;
+    }
+    bitset_dynamic_destroy(bitset);
+    *bitset = mapped;
+    return true;
+}
+
+/**
+ * Allocates memory with malloc, or aligned_alloc for alignments larger than BITSET_MALLOC_ALIGNMENT
+ * @param context Unused
+ * @param size Number of bytes to allocate
+ * @param alignment Alignment of the memory in bytes (power of two)
+ * @return The memory or NULL on failure
+ */
+inline void* bitset_default_allocate(void* const context, const uint64_t size, const uint64_t alignment)
+{
+    (void)context;
+    if (alignment <= BITSET_MALLOC_ALIGNMENT)
+        return malloc(size ? size : 1);
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, alignment);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment + (size ? 0 : alignment));
+#endif
+}
+
+/**
+ * Resizes memory of bitset_default_allocate (realloc when the alignment allows it)
+ * @param context Unused
+ * @param memory The memory to resize
+ * @param old_size Current size of the memory in bytes
+ * @param new_size New size of the memory in bytes
+ * @param alignment Alignment of the memory in bytes
+ * @return The resized memory or NULL on failure (the old memory is kept)
+ */
+inline void* bitset_default_reallocate(void* const context, void* const memory, const uint64_t old_size, const uint64_t new_size, const uint64_t alignment)
+{
+    if (alignment <= BITSET_MALLOC_ALIGNMENT)
+        return realloc(memory, new_size ? new_size : 1);
+#ifdef _WIN32
+    (void)context;
+    (void)old_size;
+    return _aligned_realloc(memory, new_size ? new_size : 1, alignment);
+#else
+    void* const resized = bitset_default_allocate(context, new_size, alignment);
+    if (!resized)
+        return NULL;
+    if (memory)
+        memcpy(resized, memory, old_size < new_size ? old_size : new_size);
+    free(memory);
+    return resized;
+#endif
+}
+
+/**
+ * Frees memory of bitset_default_allocate
+ * @param context Unused
+ * @param memory The memory to free (may be NULL)
+ * @param size Size of the memory in bytes
+ * @param alignment Alignment of the memory in bytes
+ */
+inline void bitset_default_deallocate(void* const context, void* const memory, const uint64_t size, const uint64_t alignment)
+{
+    (void)context;
+    (void)size;
+#ifdef _WIN32
+    if (alignment > BITSET_MALLOC_ALIGNMENT)
+    {
+        _aligned_free(memory);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    free(memory);
+}
+
+/**
+ * Allocates memory backed by huge pages (Linux), allocations of at least BITSET_HUGE_PAGE_THRESHOLD bytes are mapped directly,
+ * aligned to the page size and advised with MADV_HUGEPAGE, smaller ones use bitset_default_allocate
+ * @param context NULL for transparent huge pages of BITSET_HUGE_PAGE_SIZE, or pointer to a uint64_t page size (e.g. 1 << 30)
+ *                to ask for reserved huge pages of that size first (MAP_HUGETLB), falling back to transparent huge pages
+ * @param size Number of bytes to allocate
+ * @param alignment Alignment of the memory in bytes
+ * @return The memory or NULL on failure
+ */
+inline void* bitset_huge_page_allocate(void* const context, const uint64_t size, const uint64_t alignment)
+{
+#if defined(__linux__) && defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+    if (size >= BITSET_HUGE_PAGE_THRESHOLD)
+    {
+        const uint64_t page = context ? *(const uint64_t*)context : BITSET_HUGE_PAGE_SIZE;
+        const uint64_t rounded = (size + page - 1) / page * page;
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+        if (context)
+        {
+            void* const memory = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (int)(bitset_ctz64(page) << MAP_HUGE_SHIFT), -1, 0);
+            if (memory != MAP_FAILED)
+                return memory;
+        }
+#endif
+        // over-allocate by a page and trim, so the memory starts at a page boundary
+        uint8_t* const raw = (uint8_t*)mmap(NULL, rounded + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if ((void*)raw == MAP_FAILED)
+            return NULL;
+        uint8_t* const memory = raw + (page - (uintptr_t)raw % page) % page;
+        if (memory > raw)
+            munmap(raw, (size_t)(memory - raw));
+        munmap(memory + rounded, (size_t)(raw + rounded + page - (memory + rounded)));
+        madvise(memory, rounded, MADV_HUGEPAGE);
+        return memory;
+    }
+#endif
+    return bitset_default_allocate(context, size, alignment);
+}
+
+/**
+ * Resizes memory of bitset_huge_page_allocate
+ * @param context Context of bitset_huge_page_allocate
+ * @param memory The memory to resize
+ * @param old_size Current size of the memory in bytes
+ * @param new_size New size of the memory in bytes
+ * @param alignment Alignment of the memory in bytes
+ * @return The resized memory or NULL on failure (the old memory is kept)
+ */
+inline void* bitset_huge_page_reallocate(void* const context, void* const memory, const uint64_t old_size, const uint64_t new_size, const uint64_t alignment)
+{
+    if (old_size < BITSET_HUGE_PAGE_THRESHOLD && new_size < BITSET_HUGE_PAGE_THRESHOLD)
+        return bitset_default_reallocate(context, memory, old_size, new_size, alignment);
+    void* const resized = bitset_huge_page_allocate(context, new_size, alignment);
+    if (!resized)
+        return NULL;
+    if (memory)
+        memcpy(resized, memory, old_size < new_size ? old_size : new_size);
+    bitset_huge_page_deallocate(context, memory, old_size, alignment);
+    return resized;
+}
+
+/**
+ * Frees memory of bitset_huge_page_allocate
+ * @param context Context of bitset_huge_page_allocate
+ * @param memory The memory to free (may be NULL)
+ * @param size Size of the memory in bytes
+ * @param alignment Alignment of the memory in bytes
+ */
+inline void bitset_huge_page_deallocate(void* const context, void* const memory, const uint64_t size, const uint64_t alignment)
+{
+#if defined(__linux__) && defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+    if (size >= BITSET_HUGE_PAGE_THRESHOLD)
+    {
+        const uint64_t page = context ? *(const uint64_t*)context : BITSET_HUGE_PAGE_SIZE;
+        if (memory)
+            munmap(memory, (size_t)((size + page - 1) / page * page));
+        return;
+    }
+#endif
+    bitset_default_deallocate(context, memory, size, alignment);
+}
+
+/**
+ * Huge page allocator for bitset_dynamic_init_allocator (transparent huge pages, see bitset_huge_page_allocate)
+ */
+static const BitSetAllocator bitset_huge_page_allocator = { bitset_huge_page_allocate, bitset_huge_page_reallocate, bitset_huge_page_deallocate, NULL };
+
+/**
+ * Allocates memory with an allocator
+ * @param allocator Pointer to allocator to use (NULL for the default allocator)
+ * @param size Number of bytes to allocate
+ * @param alignment Alignment of the memory in bytes
+ * @return The memory or NULL on failure
+ */
+inline void* bitset_allocate(const BitSetAllocator* const allocator, const uint64_t size, const uint64_t alignment)
+{
+    BITSET_STATS_ALLOCATION(size);
+    if (!allocator)
+        return bitset_default_allocate(NULL, size, alignment);
+    return allocator->allocate(allocator->context, size, alignment);
+}
+
+/**
+ * Resizes memory with an allocator
+ * @param allocator Pointer to allocator the memory comes from (NULL for the default allocator)
+ * @param memory The memory to resize (may be NULL)
+ * @param old_size Current size of the memory in bytes
+ * @param new_size New size of the memory in bytes
+ * @param alignment Alignment of the memory in bytes
+ * @return The resized memory or NULL on failure
+ */
+inline void* bitset_reallocate_memory(const BitSetAllocator* const allocator, void* const memory, const uint64_t old_size, const uint64_t new_size, const uint64_t alignment)
+{
+    BITSET_STATS_ALLOCATION(new_size);
+    if (!allocator)
+        return bitset_default_reallocate(NULL, memory, old_size, new_size, alignment);
+    return allocator->reallocate(allocator->context, memory, old_size, new_size, alignment);
+}
+
+/**
+ * Frees memory with an allocator
+ * @param allocator Pointer to allocator the memory comes from (NULL for the default allocator)
+ * @param memory The memory to free (may be NULL)
+ * @param size Size of the memory in bytes
+ * @param alignment Alignment of the memory in bytes
+ */
+inline void bitset_deallocate(const BitSetAllocator* const allocator, void* const memory, const uint64_t size, const uint64_t alignment)
+{
+    if (memory)
+        BITSET_STATS_DEALLOCATION();
+    if (!allocator)
+    {
+        bitset_default_deallocate(NULL, memory, size, alignment);
+        return;
+    }
+    allocator->deallocate(allocator->context, memory, size, alignment);
+}
@@ -0,0 +1,491 @@
+#pragma once
+
+#include "BitSet.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * Number of bits updated by a single atomic instruction, the block size but at most 64 (128-bit blocks are updated as two halves)
+ */
+#define BITSET_ATOMIC_WORD_BITS (BITSET_BLOCK_BITS < 64 ? BITSET_BLOCK_BITS : 64u)
+
+/**
+ * Memory ordering of an atomic bitset operation, the values match the GCC/Clang __ATOMIC_* constants
+ * MSVC always uses full barriers
+ */
+typedef enum
+{
+    /**
+     * Only the bit update itself is atomic, no ordering with other memory accesses (e.g. marking visited nodes)
+     */
+    BITSET_MEMORY_RELAXED = 0,
+    /**
+     * Later memory accesses are not moved before the operation (e.g. claiming a slot before using it)
+     */
+    BITSET_MEMORY_ACQUIRE = 2,
+    /**
+     * Earlier memory accesses are not moved after the operation (e.g. publishing a slot after filling it)
+     */
+    BITSET_MEMORY_RELEASE = 3,
+    /**
+     * Both acquire and release
+     */
+    BITSET_MEMORY_ACQ_REL = 4,
+    /**
+     * Acquire and release plus a single total order of all sequentially consistent operations
+     */
+    BITSET_MEMORY_SEQ_CST = 5
+} BitSetMemoryOrder;
+
+inline void* bitset_atomic_word_address(const BitSet* const bitset, const uint64_t word);
+inline BitSetMemoryOrder bitset_atomic_load_order(const BitSetMemoryOrder order);
+inline BitSetMemoryOrder bitset_atomic_store_order(const BitSetMemoryOrder order);
+inline uint64_t bitset_atomic_word_load(const void* const address, const BitSetMemoryOrder order);
+inline void bitset_atomic_word_store(void* const address, const uint64_t value, const BitSetMemoryOrder order);
+inline uint64_t bitset_atomic_word_fetch_or(void* const address, const uint64_t mask, const BitSetMemoryOrder order);
+inline uint64_t bitset_atomic_word_fetch_and(void* const address, const uint64_t mask, const BitSetMemoryOrder order);
+inline uint64_t bitset_atomic_word_fetch_xor(void* const address, const uint64_t mask, const BitSetMemoryOrder order);
+inline uint64_t bitset_atomic_word_mask(const uint64_t begin, const uint64_t end);
+inline bool bitset_atomic_get(const BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order);
+inline bool bitset_atomic_test_and_set(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order);
+inline bool bitset_atomic_test_and_clear(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order);
+inline bool bitset_atomic_test_and_flip(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order);
+inline void bitset_atomic_set(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order);
+inline void bitset_atomic_clear(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order);
+inline void bitset_atomic_flip_bit(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order);
+inline void bitset_atomic_set_value(BitSet* const bitset, const bool value, const uint64_t index, const BitSetMemoryOrder order);
+inline void bitset_atomic_fill_in_range_begin_end(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end, const BitSetMemoryOrder order);
+inline void bitset_atomic_set_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end, const BitSetMemoryOrder order);
+inline void bitset_atomic_clear_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end, const BitSetMemoryOrder order);
+inline uint64_t bitset_atomic_find_first_cleared_and_set(BitSet* const bitset, const uint64_t begin, const BitSetMemoryOrder order);
+
+/**
+ * Calculates the address of an atomic word
+ * @param bitset Pointer to bitset
+ * @param word Index of the word (bit index / BITSET_ATOMIC_WORD_BITS)
+ * @return Address of the word
+ * @memberof BitSet
+ */
+inline void* bitset_atomic_word_address(const BitSet* const bitset, const uint64_t word)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    // the low half of a 128-bit block comes second
+    if (BITSET_BLOCK_BITS > 64)
+        return (uint64_t*)bitset->data + (word ^ 1);
+#endif
+    return (uint8_t*)bitset->data + word * (BITSET_ATOMIC_WORD_BITS / 8);
+}
+
+/**
+ * @param order Ordering of a read-modify-write operation
+ * @return The strongest ordering a load can have within it
+ */
+inline BitSetMemoryOrder bitset_atomic_load_order(const BitSetMemoryOrder order)
+{
+    return order == BITSET_MEMORY_RELEASE ? BITSET_MEMORY_RELAXED : order == BITSET_MEMORY_ACQ_REL ? BITSET_MEMORY_ACQUIRE : order;
+}
+
+/**
+ * @param order Ordering of a read-modify-write operation
+ * @return The strongest ordering a store can have within it
+ */
+inline BitSetMemoryOrder bitset_atomic_store_order(const BitSetMemoryOrder order)
+{
+    return order == BITSET_MEMORY_ACQUIRE ? BITSET_MEMORY_RELAXED : order == BITSET_MEMORY_ACQ_REL ? BITSET_MEMORY_RELEASE : order;
+}
+
+/**
+ * Atomically loads a word
+ * @param address Address of the word
+ * @param order Memory ordering (no release)
+ * @return Value of the word
+ */
+inline uint64_t bitset_atomic_word_load(const void* const address, const BitSetMemoryOrder order)
+{
+#ifdef _MSC_VER
+    (void)order;
+    switch (BITSET_ATOMIC_WORD_BITS)
+    {
+    case 8:
+        return *(const volatile uint8_t*)address;
+    case 16:
+        return *(const volatile uint16_t*)address;
+    case 32:
+        return *(const volatile uint32_t*)address;
+    default:
+        return *(const volatile uint64_t*)address;
+    }
+#else
+    switch (BITSET_ATOMIC_WORD_BITS)
+    {
+    case 8:
+        return __atomic_load_n((const uint8_t*)address, (int)order);
+    case 16:
+        return __atomic_load_n((const uint16_t*)address, (int)order);
+    case 32:
+        return __atomic_load_n((const uint32_t*)address, (int)order);
+    default:
+        return __atomic_load_n((const uint64_t*)address, (int)order);
+    }
+#endif
+}
+
+/**
+ * Atomically stores a word
+ * @param address Address of the word
+ * @param value The value to store
+ * @param order Memory ordering (no acquire)
+ */
+inline void bitset_atomic_word_store(void* const address, const uint64_t value, const BitSetMemoryOrder order)
+{
+#ifdef _MSC_VER
+    (void)order;
+    switch (BITSET_ATOMIC_WORD_BITS)
+    {
+    case 8:
+        _InterlockedExchange8((volatile char*)address, (char)value);
+        break;
+    case 16:
+        _InterlockedExchange16((volatile short*)address, (short)value);
+        break;
+    case 32:
+        _InterlockedExchange((volatile long*)address, (long)value);
+        break;
+    default:
+        _InterlockedExchange64((volatile __int64*)address, (__int64)value);
+    }
+#else
+    switch (BITSET_ATOMIC_WORD_BITS)
+    {
+    case 8:
+        __atomic_store_n((uint8_t*)address, (uint8_t)value, (int)order);
+        break;
+    case 16:
+        __atomic_store_n((uint16_t*)address, (uint16_t)value, (int)order);
+        break;
+    case 32:
+        __atomic_store_n((uint32_t*)address, (uint32_t)value, (int)order);
+        break;
+    default:
+        __atomic_store_n((uint64_t*)address, value, (int)order);
+    }
+#endif
+}
+
+/**
+ * Atomically ORs a mask into a word
+ * @param address Address of the word
+ * @param mask The mask to OR
+ * @param order Memory ordering
+ * @return Value of the word before the operation
+ */
+inline uint64_t bitset_atomic_word_fetch_or(void* const address, const uint64_t mask, const BitSetMemoryOrder order)
+{
+#ifdef _MSC_VER
+    (void)order;
+    switch (BITSET_ATOMIC_WORD_BITS)
+    {
+    case 8:
+        return (uint8_t)_InterlockedOr8((volatile char*)address, (char)mask);
+    case 16:
+        return (uint16_t)_InterlockedOr16((volatile short*)address, (short)mask);
+    case 32:
+        return (uint32_t)_InterlockedOr((volatile long*)address, (long)mask);
+    default:
+        return (uint64_t)_InterlockedOr64((volatile __int64*)address, (__int64)mask);
+    }
+#else
+    switch (BITSET_ATOMIC_WORD_BITS)
+    {
+    case 8:
+        return __atomic_fetch_or((uint8_t*)address, (uint8_t)mask, (int)order);
+    case 16:
+        return __atomic_fetch_or((uint16_t*)address, (uint16_t)mask, (int)order);
+    case 32:
+        return __atomic_fetch_or((uint32_t*)address, (uint32_t)mask, (int)order);
+    default:
+        return __atomic_fetch_or((uint64_t*)address, mask, (int)order);
+    }
+#endif
+}
+
+/**
+ * Atomically ANDs a mask into a word
+ * @param address Address of the word
+ * @param mask The mask to AND
+ * @param order Memory ordering
+ * @return Value of the word before the operation
+ */
+inline uint64_t bitset_atomic_word_fetch_and(void* const address, const uint64_t mask, const BitSetMemoryOrder order)
+{
+#ifdef _MSC_VER
+    (void)order;
+    switch (BITSET_ATOMIC_WORD_BITS)
+    {
+    case 8:
+        return (uint8_t)_InterlockedAnd8((volatile char*)address, (char)mask);
+    case 16:
+        return (uint16_t)_InterlockedAnd16((volatile short*)address, (short)mask);
+    case 32:
+        return (uint32_t)_InterlockedAnd((volatile long*)address, (long)mask);
+    default:
+        return (uint64_t)_InterlockedAnd64((volatile __int64*)address, (__int64)mask);
+    }
+#else
+    switch (BITSET_ATOMIC_WORD_BITS)
+    {
+    case 8:
+        return __atomic_fetch_and((uint8_t*)address, (uint8_t)mask, (int)order);
+    case 16:
+        return __atomic_fetch_and((uint16_t*)address, (uint16_t)mask, (int)order);
+    case 32:
+        return __atomic_fetch_and((uint32_t*)address, (uint32_t)mask, (int)order);
+    default:
+        return __atomic_fetch_and((uint64_t*)address, mask, (int)order);
+    }
+#endif
+}
+
+/**
+ * Atomically XORs a mask into a word
+ * @param address Address of the word
+ * @param mask The mask to XOR
+ * @param order Memory ordering
+ * @return Value of the word before the operation
+ */
+inline uint64_t bitset_atomic_word_fetch_xor(void* const address, const uint64_t mask, const BitSetMemoryOrder order)
+{
+#ifdef _MSC_VER
+    (void)order;
+    switch (BITSET_ATOMIC_WORD_BITS)
+    {
+    case 8:
+        return (uint8_t)_InterlockedXor8((volatile char*)address, (char)mask);
+    case 16:
+        return (uint16_t)_InterlockedXor16((volatile short*)address, (short)mask);
+    case 32:
+        return (uint32_t)_InterlockedXor((volatile long*)address, (long)mask);
+    default:
+        return (uint64_t)_InterlockedXor64((volatile __int64*)address, (__int64)mask);
+    }
+#else
+    switch (BITSET_ATOMIC_WORD_BITS)
+    {
+    case 8:
+        return __atomic_fetch_xor((uint8_t*)address, (uint8_t)mask, (int)order);
+    case 16:
+        return __atomic_fetch_xor((uint16_t*)address, (uint16_t)mask, (int)order);
+    case 32:
+        return __atomic_fetch_xor((uint32_t*)address, (uint32_t)mask, (int)order);
+    default:
+        return __atomic_fetch_xor((uint64_t*)address, mask, (int)order);
+    }
+#endif
+}
+
+/**
+ * Creates a mask of the bits [begin, end) of an atomic word
+ * @param begin The beginning of the range (bit index in the word, inclusive)
+ * @param end The end of the range (bit index in the word, exclusive, greater than begin and at most BITSET_ATOMIC_WORD_BITS)
+ * @return The mask
+ */
+inline uint64_t bitset_atomic_word_mask(const uint64_t begin, const uint64_t end)
+{
+    return (UINT64_MAX >> (64 - (end - begin))) << begin;
+}
+
+/**
+ * Atomically retrieves the value of a bit at a specified index
+ * @param bitset Pointer to bitset to read from
+ * @param index The index of the bit to read (bit index)
+ * @param order Memory ordering (no release)
+ * @return The value of the bit at the specified index
+ * @memberof BitSet
+ */
+inline bool bitset_atomic_get(const BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order)
+{
+    return (bitset_atomic_word_load(bitset_atomic_word_address(bitset, index / BITSET_ATOMIC_WORD_BITS), order) >> index % BITSET_ATOMIC_WORD_BITS) & 1u;
+}
+
+/**
+ * Atomically sets a bit and returns its previous value (fetch_or), e.g. if (!bitset_atomic_test_and_set(visited, node, BITSET_MEMORY_RELAXED)) visit(node);
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to set (bit index)
+ * @param order Memory ordering
+ * @return The value of the bit before it was set, exactly one of the threads setting a cleared bit gets false
+ * @memberof BitSet
+ */
+inline bool bitset_atomic_test_and_set(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order)
+{
+    const uint64_t mask = (uint64_t)1u << index % BITSET_ATOMIC_WORD_BITS;
+    return (bitset_atomic_word_fetch_or(bitset_atomic_word_address(bitset, index / BITSET_ATOMIC_WORD_BITS), mask, order) & mask) != 0;
+}
+
+/**
+ * Atomically clears a bit and returns its previous value (fetch_and)
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to clear (bit index)
+ * @param order Memory ordering
+ * @return The value of the bit before it was cleared, exactly one of the threads clearing a set bit gets true
+ * @memberof BitSet
+ */
+inline bool bitset_atomic_test_and_clear(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order)
+{
+    const uint64_t mask = (uint64_t)1u << index % BITSET_ATOMIC_WORD_BITS;
+    return (bitset_atomic_word_fetch_and(bitset_atomic_word_address(bitset, index / BITSET_ATOMIC_WORD_BITS), ~mask, order) & mask) != 0;
+}
+
+/**
+ * Atomically flips a bit and returns its previous value (fetch_xor)
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to flip (bit index)
+ * @param order Memory ordering
+ * @return The value of the bit before it was flipped
+ * @memberof BitSet
+ */
+inline bool bitset_atomic_test_and_flip(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order)
+{
+    const uint64_t mask = (uint64_t)1u << index % BITSET_ATOMIC_WORD_BITS;
+    return (bitset_atomic_word_fetch_xor(bitset_atomic_word_address(bitset, index / BITSET_ATOMIC_WORD_BITS), mask, order) & mask) != 0;
+}
+
+/**
+ * Atomically sets the value of a bit at a specified index to 1 (true)
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to set (bit index)
+ * @param order Memory ordering
+ * @memberof BitSet
+ */
+inline void bitset_atomic_set(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order)
+{
+    bitset_atomic_word_fetch_or(bitset_atomic_word_address(bitset, index / BITSET_ATOMIC_WORD_BITS), (uint64_t)1u << index % BITSET_ATOMIC_WORD_BITS, order);
+}
+
+/**
+ * Atomically sets the value of a bit at a specified index to 0 (false)
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to clear (bit index)
+ * @param order Memory ordering
+ * @memberof BitSet
+ */
+inline void bitset_atomic_clear(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order)
+{
+    bitset_atomic_word_fetch_and(bitset_atomic_word_address(bitset, index / BITSET_ATOMIC_WORD_BITS), ~((uint64_t)1u << index % BITSET_ATOMIC_WORD_BITS), order);
+}
+
+/**
+ * Atomically flips the value of a bit at a specified index
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to flip (bit index)
+ * @param order Memory ordering
+ * @memberof BitSet
+ */
+inline void bitset_atomic_flip_bit(BitSet* const bitset, const uint64_t index, const BitSetMemoryOrder order)
+{
+    bitset_atomic_word_fetch_xor(bitset_atomic_word_address(bitset, index / BITSET_ATOMIC_WORD_BITS), (uint64_t)1u << index % BITSET_ATOMIC_WORD_BITS, order);
+}
+
+/**
+ * Atomically sets the value of a bit at a specified index
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to set the bit to
+ * @param index The index of the bit to modify (bit index)
+ * @param order Memory ordering
+ * @memberof BitSet
+ */
+inline void bitset_atomic_set_value(BitSet* const bitset, const bool value, const uint64_t index, const BitSetMemoryOrder order)
+{
+    if (value)
+        bitset_atomic_set(bitset, index, order);
+    else
+        bitset_atomic_clear(bitset, index, order);
+}
+
+/**
+ * Atomically fills a range of the bitset with a specified value
+ * Every word is updated atomically (the partial edge words by fetch_or / fetch_and, the inner words by plain atomic stores),
+ * so concurrent updates of other bits are never lost, but other threads can observe the range partially filled
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the range with
+ * @param begin The beginning of the range to fill (bit index, inclusive)
+ * @param end The end of the range to fill (bit index, exclusive)
+ * @param order Memory ordering of every word update
+ * @memberof BitSet
+ */
+inline void bitset_atomic_fill_in_range_begin_end(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end, const BitSetMemoryOrder order)
+{
+    if (begin >= end)
+        return;
+    const uint64_t first = begin / BITSET_ATOMIC_WORD_BITS, last = (end - 1) / BITSET_ATOMIC_WORD_BITS;
+    for (uint64_t word = first; word <= last; ++word)
+    {
+        const uint64_t low = word == first ? begin % BITSET_ATOMIC_WORD_BITS : 0;
+        const uint64_t high = word == last ? (end - 1) % BITSET_ATOMIC_WORD_BITS + 1 : BITSET_ATOMIC_WORD_BITS;
+        void* const address = bitset_atomic_word_address(bitset, word);
+        if (low == 0 && high == BITSET_ATOMIC_WORD_BITS)
+            bitset_atomic_word_store(address, value ? UINT64_MAX : 0, bitset_atomic_store_order(order));
+        else if (value)
+            bitset_atomic_word_fetch_or(address, bitset_atomic_word_mask(low, high), order);
+        else
+            bitset_atomic_word_fetch_and(address, ~bitset_atomic_word_mask(low, high), order);
+    }
+}
+
+/**
+ * Atomically sets the bits in a range (see bitset_atomic_fill_in_range_begin_end)
+ * @param bitset Pointer to bitset to modify
+ * @param begin The beginning of the range to set (bit index, inclusive)
+ * @param end The end of the range to set (bit index, exclusive)
+ * @param order Memory ordering of every word update
+ * @memberof BitSet
+ */
+inline void bitset_atomic_set_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end, const BitSetMemoryOrder order)
+{
+    bitset_atomic_fill_in_range_begin_end(bitset, true, begin, end, order);
+}
+
+/**
+ * Atomically clears the bits in a range (see bitset_atomic_fill_in_range_begin_end)
+ * @param bitset Pointer to bitset to modify
+ * @param begin The beginning of the range to clear (bit index, inclusive)
+ * @param end The end of the range to clear (bit index, exclusive)
+ * @param order Memory ordering of every word update
+ * @memberof BitSet
+ */
+inline void bitset_atomic_clear_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end, const BitSetMemoryOrder order)
+{
+    bitset_atomic_fill_in_range_begin_end(bitset, false, begin, end, order);
+}
+
+/**
+ * Atomically finds the first cleared bit at or after an index and sets it, a lock-free slot allocator
+ * A thread losing the race for a bit retries with the next cleared bit of the same word
+ * @param bitset Pointer to bitset to modify
+ * @param begin Index to start searching at (bit index, inclusive)
+ * @param order Memory ordering of the successful update (use BITSET_MEMORY_ACQUIRE and release the slot with bitset_atomic_clear with BITSET_MEMORY_RELEASE)
+ * @return Index of the bit this call set or BITSET_NPOS if every bit from begin was set
+ * @memberof BitSet
+ */
+inline uint64_t bitset_atomic_find_first_cleared_and_set(BitSet* const bitset, const uint64_t begin, const BitSetMemoryOrder order)
+{
+    for (uint64_t word = begin / BITSET_ATOMIC_WORD_BITS; word * BITSET_ATOMIC_WORD_BITS < bitset->size; ++word)
+    {
+        void* const address = bitset_atomic_word_address(bitset, word);
+        const uint64_t low = word == begin / BITSET_ATOMIC_WORD_BITS ? begin % BITSET_ATOMIC_WORD_BITS : 0;
+        const uint64_t high = bitset->size - word * BITSET_ATOMIC_WORD_BITS < BITSET_ATOMIC_WORD_BITS ? bitset->size - word * BITSET_ATOMIC_WORD_BITS : BITSET_ATOMIC_WORD_BITS;
+        if (low >= high)
+            continue;
+        const uint64_t range = bitset_atomic_word_mask(low, high);
+        uint64_t current = bitset_atomic_word_load(address, BITSET_MEMORY_RELAXED);
+        while (~current & range)
+        {
+            const uint64_t mask = (uint64_t)1u << bitset_ctz64(~current & range);
+            current = bitset_atomic_word_fetch_or(address, mask, order);
+            if (!(current & mask))
+                return word * BITSET_ATOMIC_WORD_BITS + bitset_ctz64(mask);
+        }
+    }
+    return BITSET_NPOS;
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "BitSet.h"
+
+/**
+ * Number of 64-bit words assembled on the stack before being appended by bitset_builder_append_bitset
+ */
+#ifndef BITSET_BUILDER_BATCH_WORDS
+#define BITSET_BUILDER_BATCH_WORDS 64u
+#endif
+
+/**
+ * Appends bits, words and ranges of other bitsets at any bit offset (for C API bitset builder)
+ * Appended bits are collected in a 64-bit word, every full word is funnel shifted into the bitset (never bit by bit),
+ * the storage grows geometrically like bitset_dynamic_push_back. bitset_builder_finish hands the storage over to a
+ * DynamicBitSet without copying it
+ */
+typedef struct
+{
+    /**
+     * The full words appended so far (the size is a multiple of 64)
+     */
+    DynamicBitSet bitset;
+    /**
+     * The bits appended after the last full word, in the lowest bits
+     */
+    uint64_t word;
+    /**
+     * Number of bits in word [0, 64)
+     */
+    uint64_t bits;
+} BitSetBuilder;
+
+inline void bitset_builder_init(BitSetBuilder* const builder, const uint64_t capacity);
+inline void bitset_builder_destroy(BitSetBuilder* const builder);
+inline uint64_t bitset_builder_size(const BitSetBuilder* const builder);
+inline void bitset_builder_store_words(BitSetBuilder* const builder, const uint64_t* const words, const uint64_t count);
+inline void bitset_builder_append_bits(BitSetBuilder* const builder, uint64_t word, const uint64_t count);
+inline void bitset_builder_append_bit(BitSetBuilder* const builder, const bool value);
+inline void bitset_builder_append_words(BitSetBuilder* const builder, const uint64_t* const words, const uint64_t count);
+inline void bitset_builder_append_fill(BitSetBuilder* const builder, const bool value, uint64_t count);
+inline void bitset_builder_append_bitset(BitSetBuilder* const builder, const BitSet* const source, uint64_t begin, const uint64_t end);
+inline void bitset_builder_finish(BitSetBuilder* const builder, DynamicBitSet* const destination);
+
+/**
+ * Initializes an empty builder
+ * @param builder Pointer to builder to initialize
+ * @param capacity The number of bits to reserve the memory for (bit size, 0 to grow on demand)
+ * @memberof BitSetBuilder
+ */
+inline void bitset_builder_init(BitSetBuilder* const builder, const uint64_t capacity)
+{
+    bitset_dynamic_init(&builder->bitset, 0);
+    bitset_dynamic_reserve(&builder->bitset, capacity);
+    builder->word = 0;
+    builder->bits = 0;
+}
+
+/**
+ * Destroys the builder and the bits appended to it (not needed after bitset_builder_finish)
+ * @param builder Pointer to builder to destroy
+ * @memberof BitSetBuilder
+ */
+inline void bitset_builder_destroy(BitSetBuilder* const builder)
+{
+    bitset_dynamic_destroy(&builder->bitset);
+    builder->word = 0;
+    builder->bits = 0;
+}
+
+/**
+ * @param builder Pointer to builder
+ * @return The number of bits appended so far (bit size)
+ * @memberof BitSetBuilder
+ */
+inline uint64_t bitset_builder_size(const BitSetBuilder* const builder)
+{
+    return builder->bitset.size + builder->bits;
+}
+
+/**
+ * Stores full words after the full words of the builder (the pending bits have to be empty)
+ * @param builder Pointer to builder to modify
+ * @param words Array of the words to store
+ * @param count Number of words to store
+ * @memberof BitSetBuilder
+ */
+inline void bitset_builder_store_words(BitSetBuilder* const builder, const uint64_t* const words, const uint64_t count)
+{
+    if (!count)
+        return;
+    DynamicBitSet* const bitset = &builder->bitset;
+    const uint64_t first = bitset->size / 64;
+    const uint64_t storage_size = bitset_calculate_storage_size(bitset->size + count * 64);
+    BITSET_STATS_CALL(BITSET_STATS_PUSH_BACK, count * 64);
+    bitset_dynamic_grow(bitset, storage_size);
+    bitset->storage_size = storage_size;
+    bitset->size += count * 64;
+    if (BITSET_BLOCK_BITS == 64)
+        memcpy(bitset->data + first, words, count * sizeof(uint64_t));
+    else
+        bitset_store_words(UNIVERSAL_BITSET(bitset), first, words, count);
+}
+
+/**
+ * Appends the lowest bits of a word, amortized O(1)
+ * @param builder Pointer to builder to modify
+ * @param word The bits to append, bit 0 is appended first (the bits above count are ignored)
+ * @param count Number of bits to append [0, 64]
+ * @memberof BitSetBuilder
+ */
+inline void bitset_builder_append_bits(BitSetBuilder* const builder, uint64_t word, const uint64_t count)
+{
+    if (!count)
+        return;
+    if (count < 64)
+        word &= ((uint64_t)1u << count) - 1;
+    const uint64_t full = builder->word | word << builder->bits;
+    if (builder->bits + count < 64)
+    {
+        builder->word = full;
+        builder->bits += count;
+        return;
+    }
+    bitset_builder_store_words(builder, &full, 1);
+    // the bits of the word which did not fit, none if the pending bits were empty
+    const uint64_t rest = builder->bits + count - 64;
+    builder->word = rest ? word >> (64 - builder->bits) : 0;
+    builder->bits = rest;
+}
+
+/**
+ * Appends a bit, amortized O(1)
+ * @param builder Pointer to builder to modify
+ * @param value Value of the bit to append (bit value)
+ * @memberof BitSetBuilder
+ */
+inline void bitset_builder_append_bit(BitSetBuilder* const builder, const bool value)
+{
+    bitset_builder_append_bits(builder, value, 1);
+}
+
+/**
+ * Appends full 64-bit words at the current bit offset (funnel shifted when it's not a multiple of 64)
+ * @param builder Pointer to builder to modify
+ * @param words Array of the words to append, bit i of word k is appended as bit size + k * 64 + i
+ * @param count Number of words to append
+ * @memberof BitSetBuilder
+ */
+inline void bitset_builder_append_words(BitSetBuilder* const builder, const uint64_t* const words, const uint64_t count)
+{
+    if (!builder->bits)
+    {
+        bitset_builder_store_words(builder, words, count);
+        return;
+    }
+    uint64_t shifted[BITSET_BUILDER_BATCH_WORDS];
+    for (uint64_t begin = 0; begin < count; begin += BITSET_BUILDER_BATCH_WORDS)
+    {
+        const uint64_t batch = count - begin < BITSET_BUILDER_BATCH_WORDS ? count - begin : BITSET_BUILDER_BATCH_WORDS;
+        for (uint64_t i = 0; i < batch; ++i)
+        {
+            const uint64_t word = *(words + begin + i);
+            *(shifted + i) = builder->word | word << builder->bits;
+            builder->word = word >> (64 - builder->bits);
+        }
+        bitset_builder_store_words(builder, shifted, batch);
+    }
+}
+
+/**
+ * Appends a run of bits with the same value, O(count / 64)
+ * @param builder Pointer to builder to modify
+ * @param value Value of the bits to append (bit value)
+ * @param count Number of bits to append
+ * @memberof BitSetBuilder
+ */
+inline void bitset_builder_append_fill(BitSetBuilder* const builder, const bool value, uint64_t count)
+{
+    const uint64_t fill = value ? ~(uint64_t)0u : 0;
+    if (builder->bits)
+    {
+        const uint64_t head = count < 64 - builder->bits ? count : 64 - builder->bits;
+        bitset_builder_append_bits(builder, fill, head);
+        count -= head;
+    }
+    // the pending bits are empty now (or nothing is left to append), whole words go straight to the blocks
+    if (count >= 64)
+    {
+        DynamicBitSet* const bitset = &builder->bitset;
+        const uint64_t words = count / 64;
+        if (BITSET_BLOCK_BITS <= 64)
+        {
+            const uint64_t storage_size = bitset_calculate_storage_size(bitset->size + words * 64);
+            BITSET_STATS_CALL(BITSET_STATS_PUSH_BACK, words * 64);
+            bitset_dynamic_grow(bitset, storage_size);
+            memset(bitset->data + bitset->storage_size, value ? 0xFF : 0, (storage_size - bitset->storage_size) * sizeof(bitset_block_t));
+            bitset->storage_size = storage_size;
+            bitset->size += words * 64;
+        }
+        else
+            for (uint64_t i = 0; i < words; ++i)
+                bitset_builder_store_words(builder, &fill, 1);
+        count %= 64;
+    }
+    bitset_builder_append_bits(builder, fill, count);
+}
+
+/**
+ * Appends a range of bits of a bitset, the source words are funnel shifted to the offsets of the builder, O((end - begin) / 64)
+ * @param builder Pointer to builder to modify
+ * @param source Pointer to bitset to append from (BitSet or DynamicBitSet, not the bitset of the builder)
+ * @param begin The index of the first bit to append (bit index, inclusive)
+ * @param end The index of the last bit to append (bit index, exclusive, at most the size of the source)
+ * @memberof BitSetBuilder
+ */
+inline void bitset_builder_append_bitset(BitSetBuilder* const builder, const BitSet* const source, uint64_t begin, const uint64_t end)
+{
+    uint64_t words[BITSET_BUILDER_BATCH_WORDS + 1];
+    const uint64_t offset = begin % 64;
+    while (begin < end && end - begin >= 64)
+    {
+        const uint64_t batch = (end - begin) / 64 < BITSET_BUILDER_BATCH_WORDS ? (end - begin) / 64 : BITSET_BUILDER_BATCH_WORDS;
+        // one more source word holds the high bits of the last word when the range is not word aligned
+        const uint64_t loaded = batch + (offset != 0);
+        const uint64_t* input = words;
+        if (BITSET_BLOCK_BITS == 64 && (begin / 64 + loaded) * 64 <= source->size)
+            input = (const uint64_t*)(source->data + begin / 64);
+        else
+            bitset_load_words(source, begin / 64, words, loaded);
+        if (offset)
+        {
+            for (uint64_t i = 0; i < batch; ++i)
+                *(words + i) = *(input + i) >> offset | *(input + i + 1) << (64 - offset);
+            input = words;
+        }
+        bitset_builder_append_words(builder, input, batch);
+        begin += batch * 64;
+    }
+    if (begin < end)
+    {
+        bitset_load_words(source, begin / 64, words, 2);
+        bitset_builder_append_bits(builder, offset ? *words >> offset | *(words + 1) << (64 - offset) : *words, end - begin);
+    }
+}
+
+/**
+ * Hands the appended bits over to a bitset without copying them, the builder is empty afterwards and can be reused
+ * The capacity reserved by the builder is kept (see bitset_dynamic_shrink_to_fit)
+ * @param builder Pointer to builder to finish
+ * @param destination Pointer to bitset receiving the bits, not initialized (or destroyed before)
+ * @memberof BitSetBuilder
+ */
+inline void bitset_builder_finish(BitSetBuilder* const builder, DynamicBitSet* const destination)
+{
+    DynamicBitSet* const bitset = &builder->bitset;
+    if (builder->bits)
+    {
+        const uint64_t size = bitset->size + builder->bits;
+        bitset_builder_store_words(builder, &builder->word, 1);
+        bitset->size = size;
+        bitset->storage_size = bitset_calculate_storage_size(size);
+    }
+    if (bitset->size % BITSET_BLOCK_BITS)
+        *(bitset->data + bitset->storage_size - 1) &= bitset_create_tail_block(bitset->size);
+    bitset_dynamic_move(destination, bitset);
+    builder->word = 0;
+    builder->bits = 0;
+}
@@ -0,0 +1,925 @@
+#pragma once
+
+#include "BitSet.h"
+
+/**
+ * First bytes of every compressed stream
+ */
+#define BITSET_CODEC_MAGIC "BSCODEC1"
+
+/**
+ * Number of 64-bit words of a chunk, every chunk is compressed on its own (32 KiB of bits)
+ */
+#define BITSET_CODEC_CHUNK_WORDS 4096u
+
+/**
+ * Largest payload of a compressed chunk in bytes (the word-aligned run length encoding of a chunk never exceeds it)
+ */
+#define BITSET_CODEC_CHUNK_BYTES (BITSET_CODEC_CHUNK_WORDS * 16u)
+
+/**
+ * Number of bytes the decoder reads from its source at once
+ */
+#define BITSET_CODEC_INPUT_BYTES 4096u
+
+/**
+ * Encoding of a compressed chunk
+ * The stream is BITSET_CODEC_MAGIC, the size in bits (varint) and the chunks in order
+ * A chunk is its type (1 byte), for BITSET_CODEC_RUNS and BITSET_CODEC_DELTAS followed by its number of set bits and payload size (varints) and the payload
+ * Varints are little endian base 128, words are little endian, so the stream does not depend on the machine or the block type
+ */
+typedef enum
+{
+    /**
+     * Every bit of the chunk is cleared, no payload
+     */
+    BITSET_CODEC_EMPTY,
+    /**
+     * Every bit of the chunk is set (up to the size of the bitset), no payload
+     */
+    BITSET_CODEC_FULL,
+    /**
+     * Word-aligned run length encoding (EWAH-style): markers of a run of clean words (varint: count * 2 + value) and a number of literal words (varint) followed by the literals
+     */
+    BITSET_CODEC_RUNS,
+    /**
+     * Gaps between the set bits (varints, the first one is the index of the first set bit within the chunk, the others are index - previous index - 1)
+     */
+    BITSET_CODEC_DELTAS
+} BitSetCodecType;
+
+/**
+ * Callback consuming encoded bytes
+ * @param context Context given to the encoder
+ * @param data Bytes to write
+ * @param size Number of bytes to write
+ * @return true on success, false to stop encoding
+ */
+typedef bool (*BitSetCodecWrite)(void* context, const uint8_t* data, uint64_t size);
+
+/**
+ * Callback producing encoded bytes
+ * @param context Context given to the decoder
+ * @param data Buffer receiving the bytes
+ * @param size Number of bytes wanted
+ * @return Number of bytes read (less than size only at the end of the stream)
+ */
+typedef uint64_t (*BitSetCodecRead)(void* context, uint8_t* data, uint64_t size);
+
+/**
+ * A growable memory buffer usable as both source and destination of a stream (for C API codec)
+ */
+typedef struct
+{
+    /**
+     * Bytes of the buffer
+     */
+    uint8_t* data;
+    /**
+     * Number of bytes written
+     */
+    uint64_t size;
+    /**
+     * Number of bytes allocated
+     */
+    uint64_t capacity;
+    /**
+     * Number of bytes already read
+     */
+    uint64_t position;
+} BitSetCodecBuffer;
+
+/**
+ * Streaming encoder, words are compressed a chunk at a time as they are written (for C API codec)
+ */
+typedef struct
+{
+    /**
+     * Destination of the stream
+     */
+    BitSetCodecWrite write;
+    /**
+     * Context given to write
+     */
+    void* context;
+    /**
+     * Size of the encoded bitset in bits
+     */
+    uint64_t size;
+    /**
+     * Index of the first word of the pending chunk
+     */
+    uint64_t position;
+    /**
+     * Words of the pending chunk (BITSET_CODEC_CHUNK_WORDS)
+     */
+    uint64_t* words;
+    /**
+     * Number of pending words
+     */
+    uint64_t word_count;
+    /**
+     * Scratch space for both candidate encodings of a chunk (2 * BITSET_CODEC_CHUNK_BYTES)
+     */
+    uint8_t* output;
+    /**
+     * Set once write failed, every later call fails as well
+     */
+    bool failed;
+} BitSetCodecEncoder;
+
+/**
+ * Streaming decoder, the stream is read and decompressed a chunk at a time (for C API codec)
+ */
+typedef struct
+{
+    /**
+     * Source of the stream
+     */
+    BitSetCodecRead read;
+    /**
+     * Context given to read
+     */
+    void* context;
+    /**
+     * Size of the encoded bitset in bits
+     */
+    uint64_t size;
+    /**
+     * Index of the first word of the current chunk
+     */
+    uint64_t position;
+    /**
+     * Number of words of the current chunk (0 before the first call of bitset_codec_decoder_next)
+     */
+    uint64_t word_count;
+    /**
+     * Encoding of the current chunk
+     */
+    BitSetCodecType type;
+    /**
+     * Number of set bits of the current chunk
+     */
+    uint64_t cardinality;
+    /**
+     * Raw payload of the current chunk (BITSET_CODEC_CHUNK_BYTES)
+     */
+    uint8_t* payload;
+    /**
+     * Size of the payload of the current chunk in bytes
+     */
+    uint64_t payload_size;
+    /**
+     * Decompressed words of the current chunk (BITSET_CODEC_CHUNK_WORDS), valid once decoded is set
+     */
+    uint64_t* words;
+    /**
+     * Whether words holds the current chunk
+     */
+    bool decoded;
+    /**
+     * Bytes read from the source but not consumed yet (BITSET_CODEC_INPUT_BYTES)
+     */
+    uint8_t* input;
+    /**
+     * Number of bytes in input
+     */
+    uint64_t input_size;
+    /**
+     * Number of bytes of input already consumed
+     */
+    uint64_t input_position;
+    /**
+     * Set once the stream turned out truncated or malformed
+     */
+    bool failed;
+} BitSetCodecDecoder;
+
+inline uint64_t bitset_codec_put_varint(uint8_t* const output, uint64_t value);
+inline bool bitset_codec_get_varint(const uint8_t** const input, const uint8_t* const end, uint64_t* const value);
+inline void bitset_codec_put_word(uint8_t* const output, const uint64_t word);
+inline uint64_t bitset_codec_get_word(const uint8_t* const input);
+inline void bitset_codec_buffer_init(BitSetCodecBuffer* const buffer);
+inline void bitset_codec_buffer_destroy(BitSetCodecBuffer* const buffer);
+inline bool bitset_codec_buffer_write(void* const context, const uint8_t* const data, const uint64_t size);
+inline uint64_t bitset_codec_buffer_read(void* const context, uint8_t* const data, const uint64_t size);
+inline bool bitset_codec_file_write(void* const context, const uint8_t* const data, const uint64_t size);
+inline uint64_t bitset_codec_file_read(void* const context, uint8_t* const data, const uint64_t size);
+inline uint64_t bitset_codec_word_count(const uint64_t size);
+inline uint64_t bitset_codec_encode_runs(uint8_t* const output, const uint64_t* const words, const uint64_t count);
+inline uint64_t bitset_codec_encode_deltas(uint8_t* const output, const uint64_t* const words, const uint64_t count, const uint64_t limit);
+inline bool bitset_codec_encoder_init(BitSetCodecEncoder* const encoder, const uint64_t size, const BitSetCodecWrite write, void* const context);
+inline void bitset_codec_encoder_destroy(BitSetCodecEncoder* const encoder);
+inline bool bitset_codec_encoder_emit(BitSetCodecEncoder* const encoder, const BitSetCodecType type, const uint64_t cardinality, const uint8_t* const payload, const uint64_t payload_size);
+inline bool bitset_codec_encoder_flush(BitSetCodecEncoder* const encoder);
+inline bool bitset_codec_encoder_write_words(BitSetCodecEncoder* const encoder, const uint64_t* const words, const uint64_t count);
+inline bool bitset_codec_encoder_write_chunk(BitSetCodecEncoder* const encoder, const BitSetCodecDecoder* const decoder);
+inline bool bitset_codec_encoder_write_filled_chunk(BitSetCodecEncoder* const encoder, const bool value);
+inline bool bitset_codec_encoder_finish(BitSetCodecEncoder* const encoder);
+inline bool bitset_codec_decoder_fill(BitSetCodecDecoder* const decoder, uint8_t* const data, const uint64_t size);
+inline bool bitset_codec_decoder_varint(BitSetCodecDecoder* const decoder, uint64_t* const value);
+inline bool bitset_codec_decoder_init(BitSetCodecDecoder* const decoder, const BitSetCodecRead read, void* const context);
+inline void bitset_codec_decoder_destroy(BitSetCodecDecoder* const decoder);
+inline bool bitset_codec_decoder_next(BitSetCodecDecoder* const decoder);
+inline const uint64_t* bitset_codec_decoder_words(BitSetCodecDecoder* const decoder);
+inline bool bitset_codec_encode(const BitSet* const bitset, const BitSetCodecWrite write, void* const context);
+inline bool bitset_dynamic_init_codec(DynamicBitSet* const bitset, const BitSetCodecRead read, void* const context);
+inline bool bitset_codec_count(const BitSetCodecRead read, void* const context, uint64_t* const count);
+inline bool bitset_codec_apply_operation(const BitSetCodecRead first, void* const first_context, const BitSetCodecRead second, void* const second_context, const BitSetOperation operation, const BitSetCodecWrite write, void* const context);
+
+/**
+ * Writes a varint (little endian base 128)
+ * @param output Buffer receiving at most 10 bytes
+ * @param value The value to write
+ * @return Number of bytes written
+ */
+inline uint64_t bitset_codec_put_varint(uint8_t* const output, uint64_t value)
+{
+    uint64_t size = 0;
+    while (value >= 0x80u)
+    {
+        *(output + size++) = (uint8_t)(value | 0x80u);
+        value >>= 7;
+    }
+    *(output + size++) = (uint8_t)value;
+    return size;
+}
+
+/**
+ * Reads a varint (little endian base 128)
+ * @param input Pointer to the read position, advanced past the varint
+ * @param end End of the readable bytes
+ * @param value Receives the value
+ * @return true on success, false if the varint is truncated or longer than 64 bits
+ */
+inline bool bitset_codec_get_varint(const uint8_t** const input, const uint8_t* const end, uint64_t* const value)
+{
+    uint64_t result = 0;
+    for (uint64_t shift = 0; shift < 64 && *input < end; shift += 7)
+    {
+        const uint8_t byte = *(*input)++;
+        result |= (uint64_t)(byte & 0x7Fu) << shift;
+        if (!(byte & 0x80u))
+        {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Writes a word in little endian byte order
+ * @param output Buffer receiving 8 bytes
+ * @param word The word to write
+ */
+inline void bitset_codec_put_word(uint8_t* const output, const uint64_t word)
+{
+    for (uint64_t i = 0; i < 8; ++i)
+        *(output + i) = (uint8_t)(word >> i * 8);
+}
+
+/**
+ * Reads a word in little endian byte order
+ * @param input 8 bytes to read
+ * @return The word
+ */
+inline uint64_t bitset_codec_get_word(const uint8_t* const input)
+{
+    uint64_t word = 0;
+    for (uint64_t i = 0; i < 8; ++i)
+        word |= (uint64_t)*(input + i) << i * 8;
+    return word;
+}
+
+/**
+ * Initializes an empty buffer
+ * @param buffer Pointer to buffer to initialize
+ * @memberof BitSetCodecBuffer
+ */
+inline void bitset_codec_buffer_init(BitSetCodecBuffer* const buffer)
+{
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+    buffer->position = 0;
+}
+
+/**
+ * Destroys the buffer (frees the memory)
+ * @param buffer Pointer to buffer to destroy
+ * @memberof BitSetCodecBuffer
+ */
+inline void bitset_codec_buffer_destroy(BitSetCodecBuffer* const buffer)
+{
+    free(buffer->data);
+    bitset_codec_buffer_init(buffer);
+}
+
+/**
+ * BitSetCodecWrite appending to a BitSetCodecBuffer
+ * @param context Pointer to the BitSetCodecBuffer
+ * @param data Bytes to append
+ * @param size Number of bytes to append
+ * @return true
+ * @memberof BitSetCodecBuffer
+ */
+inline bool bitset_codec_buffer_write(void* const context, const uint8_t* const data, const uint64_t size)
+{
+    BitSetCodecBuffer* const buffer = (BitSetCodecBuffer*)context;
+    if (buffer->size + size > buffer->capacity)
+    {
+        buffer->capacity = buffer->size + size > buffer->capacity * 2 ? buffer->size + size : buffer->capacity * 2;
+        buffer->data = (uint8_t*)realloc(buffer->data, buffer->capacity);
+    }
+    if (size)
+        memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    return true;
+}
+
+/**
+ * BitSetCodecRead consuming a BitSetCodecBuffer from its read position
+ * @param context Pointer to the BitSetCodecBuffer
+ * @param data Buffer receiving the bytes
+ * @param size Number of bytes wanted
+ * @return Number of bytes read
+ * @memberof BitSetCodecBuffer
+ */
+inline uint64_t bitset_codec_buffer_read(void* const context, uint8_t* const data, const uint64_t size)
+{
+    BitSetCodecBuffer* const buffer = (BitSetCodecBuffer*)context;
+    const uint64_t count = buffer->size - buffer->position < size ? buffer->size - buffer->position : size;
+    if (count)
+        memcpy(data, buffer->data + buffer->position, count);
+    buffer->position += count;
+    return count;
+}
+
+/**
+ * BitSetCodecWrite writing to a FILE
+ * @param context The FILE* to write to
+ * @param data Bytes to write
+ * @param size Number of bytes to write
+ * @return true if every byte was written
+ */
+inline bool bitset_codec_file_write(void* const context, const uint8_t* const data, const uint64_t size)
+{
+    return fwrite(data, 1, (size_t)size, (FILE*)context) == size;
+}
+
+/**
+ * BitSetCodecRead reading from a FILE
+ * @param context The FILE* to read from
+ * @param data Buffer receiving the bytes
+ * @param size Number of bytes wanted
+ * @return Number of bytes read
+ */
+inline uint64_t bitset_codec_file_read(void* const context, uint8_t* const data, const uint64_t size)
+{
+    return fread(data, 1, (size_t)size, (FILE*)context);
+}
+
+/**
+ * Calculates the number of 64-bit words of a bitset
+ * @param size Size of the bitset in bits
+ * @return The number of words
+ */
+inline uint64_t bitset_codec_word_count(const uint64_t size)
+{
+    return size / 64 + (size % 64 != 0);
+}
+
+/**
+ * Encodes words with the word-aligned run length encoding (BITSET_CODEC_RUNS)
+ * @param output Buffer receiving the payload (at least BITSET_CODEC_CHUNK_BYTES bytes)
+ * @param words Words to encode
+ * @param count Number of words (at most BITSET_CODEC_CHUNK_WORDS)
+ * @return Size of the payload in bytes
+ */
+inline uint64_t bitset_codec_encode_runs(uint8_t* const output, const uint64_t* const words, const uint64_t count)
+{
+    uint64_t size = 0;
+    for (uint64_t i = 0; i < count;)
+    {
+        const uint64_t clean = *(words + i) == UINT64_MAX ? UINT64_MAX : 0;
+        const uint64_t run_begin = i;
+        while (i < count && *(words + i) == clean)
+            ++i;
+        const uint64_t literal_begin = i;
+        while (i < count && *(words + i) && *(words + i) != UINT64_MAX)
+            ++i;
+        size += bitset_codec_put_varint(output + size, (literal_begin - run_begin) * 2 + (clean != 0));
+        size += bitset_codec_put_varint(output + size, i - literal_begin);
+        for (uint64_t j = literal_begin; j < i; ++j, size += 8)
+            bitset_codec_put_word(output + size, *(words + j));
+    }
+    return size;
+}
+
+/**
+ * Encodes the set bits of words as gaps between their indices (BITSET_CODEC_DELTAS)
+ * @param output Buffer receiving the payload (at least limit + 10 bytes)
+ * @param words Words to encode
+ * @param count Number of words (at most BITSET_CODEC_CHUNK_WORDS)
+ * @param limit Encoding stops as soon as the payload reaches this size
+ * @return Size of the payload in bytes, at least limit if the encoding was stopped
+ */
+inline uint64_t bitset_codec_encode_deltas(uint8_t* const output, const uint64_t* const words, const uint64_t count, const uint64_t limit)
+{
+    uint64_t size = 0, next = 0;
+    for (uint64_t i = 0; i < count; ++i)
+        for (uint64_t word = *(words + i); word; word &= word - 1)
+        {
+            const uint64_t index = i * 64 + bitset_ctz64(word);
+            size += bitset_codec_put_varint(output + size, index - next);
+            if (size >= limit)
+                return size;
+            next = index + 1;
+        }
+    return size;
+}
+
+/**
+ * Initializes an encoder and writes the stream header
+ * @param encoder Pointer to encoder to initialize
+ * @param size Size of the encoded bitset in bits, exactly that many bits have to be written before bitset_codec_encoder_finish
+ * @param write Destination of the stream
+ * @param context Context given to write
+ * @return true on success, false if write failed
+ * @memberof BitSetCodecEncoder
+ */
+inline bool bitset_codec_encoder_init(BitSetCodecEncoder* const encoder, const uint64_t size, const BitSetCodecWrite write, void* const context)
+{
+    encoder->write = write;
+    encoder->context = context;
+    encoder->size = size;
+    encoder->position = 0;
+    encoder->words = (uint64_t*)malloc(BITSET_CODEC_CHUNK_WORDS * sizeof(uint64_t));
+    encoder->word_count = 0;
+    encoder->output = (uint8_t*)malloc(BITSET_CODEC_CHUNK_BYTES * 2);
+    uint8_t header[sizeof(BITSET_CODEC_MAGIC) - 1 + 10];
+    memcpy(header, BITSET_CODEC_MAGIC, sizeof(BITSET_CODEC_MAGIC) - 1);
+    const uint64_t header_size = sizeof(BITSET_CODEC_MAGIC) - 1 + bitset_codec_put_varint(header + sizeof(BITSET_CODEC_MAGIC) - 1, size);
+    encoder->failed = !write(context, header, header_size);
+    return !encoder->failed;
+}
+
+/**
+ * Destroys the encoder (frees the memory), pending words that were not finished are dropped
+ * @param encoder Pointer to encoder to destroy
+ * @memberof BitSetCodecEncoder
+ */
+inline void bitset_codec_encoder_destroy(BitSetCodecEncoder* const encoder)
+{
+    free(encoder->words);
+    free(encoder->output);
+    encoder->words = NULL;
+    encoder->output = NULL;
+}
+
+/**
+ * Writes a compressed chunk to the stream
+ * @param encoder Pointer to encoder to write with
+ * @param type Encoding of the chunk
+ * @param cardinality Number of set bits of the chunk
+ * @param payload Payload of the chunk (BITSET_CODEC_RUNS and BITSET_CODEC_DELTAS only)
+ * @param payload_size Size of the payload in bytes
+ * @return true on success, false if write failed
+ * @memberof BitSetCodecEncoder
+ */
+inline bool bitset_codec_encoder_emit(BitSetCodecEncoder* const encoder, const BitSetCodecType type, const uint64_t cardinality, const uint8_t* const payload, const uint64_t payload_size)
+{
+    uint8_t header[21];
+    uint64_t header_size = 0;
+    *header = (uint8_t)type;
+    ++header_size;
+    if (type == BITSET_CODEC_RUNS || type == BITSET_CODEC_DELTAS)
+    {
+        header_size += bitset_codec_put_varint(header + header_size, cardinality);
+        header_size += bitset_codec_put_varint(header + header_size, payload_size);
+    }
+    encoder->failed = encoder->failed || !encoder->write(encoder->context, header, header_size) || (payload_size && !encoder->write(encoder->context, payload, payload_size));
+    return !encoder->failed;
+}
+
+/**
+ * Compresses and writes the pending words as one chunk, in the smaller of both encodings
+ * @param encoder Pointer to encoder to flush
+ * @return true on success, false if write failed
+ * @memberof BitSetCodecEncoder
+ */
+inline bool bitset_codec_encoder_flush(BitSetCodecEncoder* const encoder)
+{
+    const uint64_t count = encoder->word_count;
+    const uint64_t bits = encoder->size - encoder->position * 64 < count * 64 ? encoder->size - encoder->position * 64 : count * 64;
+    if (bits % 64)
+        *(encoder->words + count - 1) &= ((uint64_t)1u << bits % 64) - 1;
+    encoder->position += count;
+    encoder->word_count = 0;
+    const uint64_t cardinality = bitset_popcount_buffer(encoder->words, count * sizeof(uint64_t));
+    if (!cardinality || cardinality == bits)
+        return bitset_codec_encoder_emit(encoder, cardinality ? BITSET_CODEC_FULL : BITSET_CODEC_EMPTY, cardinality, NULL, 0);
+    const uint64_t runs = bitset_codec_encode_runs(encoder->output, encoder->words, count);
+    uint8_t* const deltas_output = encoder->output + BITSET_CODEC_CHUNK_BYTES;
+    const uint64_t deltas = cardinality < runs ? bitset_codec_encode_deltas(deltas_output, encoder->words, count, runs) : runs;
+    if (deltas < runs)
+        return bitset_codec_encoder_emit(encoder, BITSET_CODEC_DELTAS, cardinality, deltas_output, deltas);
+    return bitset_codec_encoder_emit(encoder, BITSET_CODEC_RUNS, cardinality, encoder->output, runs);
+}
+
+/**
+ * Appends words to the stream, every full chunk is compressed and written right away
+ * Bits past the size given to bitset_codec_encoder_init are ignored
+ * @param encoder Pointer to encoder to write with
+ * @param words Words to append, bit i of word k is the bit (words written before) * 64 + k * 64 + i
+ * @param count Number of words
+ * @return true on success, false if write failed
+ * @memberof BitSetCodecEncoder
+ */
+inline bool bitset_codec_encoder_write_words(BitSetCodecEncoder* const encoder, const uint64_t* const words, const uint64_t count)
+{
+    const uint64_t total = bitset_codec_word_count(encoder->size);
+    for (uint64_t i = 0; i < count && !encoder->failed && encoder->position + encoder->word_count < total;)
+    {
+        const uint64_t left = total - encoder->position - encoder->word_count;
+        uint64_t chunk = BITSET_CODEC_CHUNK_WORDS - encoder->word_count;
+        chunk = chunk < count - i ? chunk : count - i;
+        chunk = chunk < left ? chunk : left;
+        memcpy(encoder->words + encoder->word_count, words + i, chunk * sizeof(uint64_t));
+        encoder->word_count += chunk;
+        i += chunk;
+        if (encoder->word_count == BITSET_CODEC_CHUNK_WORDS || encoder->position + encoder->word_count == total)
+            bitset_codec_encoder_flush(encoder);
+    }
+    return !encoder->failed;
+}
+
+/**
+ * Copies the current chunk of a decoder to the stream without decompressing it
+ * The encoder has to be at the same chunk boundary as the decoder (no pending words, same position)
+ * @param encoder Pointer to encoder to write with
+ * @param decoder Pointer to decoder holding the chunk
+ * @return true on success, false if write failed
+ * @memberof BitSetCodecEncoder
+ */
+inline bool bitset_codec_encoder_write_chunk(BitSetCodecEncoder* const encoder, const BitSetCodecDecoder* const decoder)
+{
+    encoder->position += decoder->word_count;
+    return bitset_codec_encoder_emit(encoder, decoder->type, decoder->cardinality, decoder->payload, decoder->payload_size);
+}
+
+/**
+ * Writes the next chunk with every bit cleared or set without building it
+ * The encoder has to be at a chunk boundary (no pending words)
+ * @param encoder Pointer to encoder to write with
+ * @param value true for a chunk of set bits, false for a chunk of cleared bits
+ * @return true on success, false if write failed
+ * @memberof BitSetCodecEncoder
+ */
+inline bool bitset_codec_encoder_write_filled_chunk(BitSetCodecEncoder* const encoder, const bool value)
+{
+    const uint64_t left = bitset_codec_word_count(encoder->size) - encoder->position;
+    encoder->position += left < BITSET_CODEC_CHUNK_WORDS ? left : BITSET_CODEC_CHUNK_WORDS;
+    return bitset_codec_encoder_emit(encoder, value ? BITSET_CODEC_FULL : BITSET_CODEC_EMPTY, 0, NULL, 0);
+}
+
+/**
+ * Completes the stream, the bits that were not written are encoded as cleared
+ * @param encoder Pointer to encoder to finish
+ * @return true on success, false if write failed
+ * @memberof BitSetCodecEncoder
+ */
+inline bool bitset_codec_encoder_finish(BitSetCodecEncoder* const encoder)
+{
+    const uint64_t total = bitset_codec_word_count(encoder->size);
+    if (encoder->word_count)
+    {
+        const uint64_t left = total - encoder->position - encoder->word_count;
+        const uint64_t chunk = BITSET_CODEC_CHUNK_WORDS - encoder->word_count < left ? BITSET_CODEC_CHUNK_WORDS - encoder->word_count : left;
+        memset(encoder->words + encoder->word_count, 0, chunk * sizeof(uint64_t));
+        encoder->word_count += chunk;
+        bitset_codec_encoder_flush(encoder);
+    }
+    while (!encoder->failed && encoder->position < total)
+        bitset_codec_encoder_write_filled_chunk(encoder, false);
+    return !encoder->failed;
+}
+
+/**
+ * Reads bytes through the input buffer of the decoder
+ * @param decoder Pointer to decoder to read with
+ * @param data Buffer receiving the bytes
+ * @param size Number of bytes to read
+ * @return true on success, false if the stream ended first
+ * @memberof BitSetCodecDecoder
+ */
+inline bool bitset_codec_decoder_fill(BitSetCodecDecoder* const decoder, uint8_t* const data, const uint64_t size)
+{
+    for (uint64_t done = 0; done < size;)
+    {
+        if (decoder->input_position == decoder->input_size)
+        {
+            decoder->input_size = decoder->read(decoder->context, decoder->input, BITSET_CODEC_INPUT_BYTES);
+            decoder->input_position = 0;
+            if (!decoder->input_size)
+                return false;
+        }
+        const uint64_t available = decoder->input_size - decoder->input_position;
+        const uint64_t count = available < size - done ? available : size - done;
+        memcpy(data + done, decoder->input + decoder->input_position, count);
+        decoder->input_position += count;
+        done += count;
+    }
+    return true;
+}
+
+/**
+ * Reads a varint through the input buffer of the decoder
+ * @param decoder Pointer to decoder to read with
+ * @param value Receives the value
+ * @return true on success, false if the stream ended first or the varint is malformed
+ * @memberof BitSetCodecDecoder
+ */
+inline bool bitset_codec_decoder_varint(BitSetCodecDecoder* const decoder, uint64_t* const value)
+{
+    uint8_t bytes[10];
+    for (uint64_t size = 0; size < sizeof(bytes); ++size)
+    {
+        if (!bitset_codec_decoder_fill(decoder, bytes + size, 1))
+            return false;
+        if (!(*(bytes + size) & 0x80u))
+        {
+            const uint8_t* input = bytes;
+            return bitset_codec_get_varint(&input, bytes + size + 1, value);
+        }
+    }
+    return false;
+}
+
+/**
+ * Initializes a decoder and reads the stream header
+ * @param decoder Pointer to decoder to initialize
+ * @param read Source of the stream
+ * @param context Context given to read
+ * @return true on success, false if the stream does not start with a valid header
+ * @memberof BitSetCodecDecoder
+ */
+inline bool bitset_codec_decoder_init(BitSetCodecDecoder* const decoder, const BitSetCodecRead read, void* const context)
+{
+    decoder->read = read;
+    decoder->context = context;
+    decoder->size = 0;
+    decoder->position = 0;
+    decoder->word_count = 0;
+    decoder->type = BITSET_CODEC_EMPTY;
+    decoder->cardinality = 0;
+    decoder->payload = (uint8_t*)malloc(BITSET_CODEC_CHUNK_BYTES);
+    decoder->payload_size = 0;
+    decoder->words = (uint64_t*)malloc(BITSET_CODEC_CHUNK_WORDS * sizeof(uint64_t));
+    decoder->decoded = false;
+    decoder->input = (uint8_t*)malloc(BITSET_CODEC_INPUT_BYTES);
+    decoder->input_size = 0;
+    decoder->input_position = 0;
+    uint8_t magic[sizeof(BITSET_CODEC_MAGIC) - 1];
+    decoder->failed = !bitset_codec_decoder_fill(decoder, magic, sizeof(magic)) || memcmp(magic, BITSET_CODEC_MAGIC, sizeof(magic)) || !bitset_codec_decoder_varint(decoder, &decoder->size);
+    return !decoder->failed;
+}
+
+/**
+ * Destroys the decoder (frees the memory), the unread rest of the stream is left alone
+ * @param decoder Pointer to decoder to destroy
+ * @memberof BitSetCodecDecoder
+ */
+inline void bitset_codec_decoder_destroy(BitSetCodecDecoder* const decoder)
+{
+    free(decoder->payload);
+    free(decoder->words);
+    free(decoder->input);
+    decoder->payload = NULL;
+    decoder->words = NULL;
+    decoder->input = NULL;
+}
+
+/**
+ * Reads the next chunk of the stream, its payload is decompressed only by bitset_codec_decoder_words
+ * @param decoder Pointer to decoder to advance
+ * @return true if a chunk was read, false at the end of the stream or if it is malformed (then failed is set)
+ * @memberof BitSetCodecDecoder
+ */
+inline bool bitset_codec_decoder_next(BitSetCodecDecoder* const decoder)
+{
+    const uint64_t total = bitset_codec_word_count(decoder->size);
+    decoder->position += decoder->word_count;
+    decoder->word_count = 0;
+    decoder->payload_size = 0;
+    decoder->decoded = false;
+    if (decoder->failed || decoder->position >= total)
+        return false;
+    uint8_t type;
+    decoder->failed = !bitset_codec_decoder_fill(decoder, &type, 1) || type > BITSET_CODEC_DELTAS;
+    if (decoder->failed)
+        return false;
+    decoder->type = (BitSetCodecType)type;
+    decoder->word_count = total - decoder->position < BITSET_CODEC_CHUNK_WORDS ? total - decoder->position : BITSET_CODEC_CHUNK_WORDS;
+    const uint64_t bits = decoder->size - decoder->position * 64 < decoder->word_count * 64 ? decoder->size - decoder->position * 64 : decoder->word_count * 64;
+    decoder->cardinality = decoder->type == BITSET_CODEC_FULL ? bits : 0;
+    if (decoder->type == BITSET_CODEC_RUNS || decoder->type == BITSET_CODEC_DELTAS)
+        decoder->failed = !bitset_codec_decoder_varint(decoder, &decoder->cardinality) || !bitset_codec_decoder_varint(decoder, &decoder->payload_size)
+            || decoder->cardinality > bits || decoder->payload_size > BITSET_CODEC_CHUNK_BYTES || !bitset_codec_decoder_fill(decoder, decoder->payload, decoder->payload_size);
+    if (decoder->failed)
+        decoder->word_count = 0;
+    return !decoder->failed;
+}
+
+/**
+ * Decompresses the current chunk
+ * @param decoder Pointer to decoder holding the chunk
+ * @return The word_count words of the chunk, NULL if the payload is malformed (then failed is set)
+ * @memberof BitSetCodecDecoder
+ */
+inline const uint64_t* bitset_codec_decoder_words(BitSetCodecDecoder* const decoder)
+{
+    if (decoder->decoded)
+        return decoder->words;
+    const uint64_t count = decoder->word_count;
+    const uint8_t* input = decoder->payload;
+    const uint8_t* const end = decoder->payload + decoder->payload_size;
+    bool valid = count != 0;
+    if (decoder->type == BITSET_CODEC_EMPTY || decoder->type == BITSET_CODEC_FULL)
+    {
+        memset(decoder->words, decoder->type == BITSET_CODEC_FULL ? 0xFF : 0, count * sizeof(uint64_t));
+        const uint64_t tail = decoder->size - decoder->position * 64 < count * 64 ? (decoder->size - decoder->position * 64) % 64 : 0;
+        if (tail)
+            *(decoder->words + count - 1) &= ((uint64_t)1u << tail) - 1;
+    }
+    else if (decoder->type == BITSET_CODEC_RUNS)
+    {
+        uint64_t i = 0;
+        while (valid && input < end)
+        {
+            uint64_t marker, literals;
+            valid = bitset_codec_get_varint(&input, end, &marker) && bitset_codec_get_varint(&input, end, &literals)
+                && marker / 2 <= count - i && literals <= count - i - marker / 2 && literals * 8 <= (uint64_t)(end - input);
+            if (!valid)
+                break;
+            for (const uint64_t clean = marker & 1u ? UINT64_MAX : 0, run_end = i + marker / 2; i < run_end; ++i)
+                *(decoder->words + i) = clean;
+            for (uint64_t j = 0; j < literals; ++j, ++i, input += 8)
+                *(decoder->words + i) = bitset_codec_get_word(input);
+        }
+        valid = valid && i == count && bitset_popcount_buffer(decoder->words, count * sizeof(uint64_t)) == decoder->cardinality;
+    }
+    else
+    {
+        memset(decoder->words, 0, count * sizeof(uint64_t));
+        uint64_t next = 0;
+        for (uint64_t i = 0; valid && i < decoder->cardinality; ++i)
+        {
+            uint64_t gap;
+            valid = bitset_codec_get_varint(&input, end, &gap) && gap < count * 64 - next;
+            if (valid)
+            {
+                next += gap;
+                *(decoder->words + next / 64) |= (uint64_t)1u << next % 64;
+                ++next;
+            }
+        }
+        valid = valid && input == end;
+    }
+    const uint64_t tail = decoder->size - decoder->position * 64 < count * 64 ? (decoder->size - decoder->position * 64) % 64 : 0;
+    if (valid && tail && *(decoder->words + count - 1) >> tail)
+        valid = false;
+    decoder->failed = !valid;
+    decoder->decoded = valid;
+    return valid ? decoder->words : NULL;
+}
+
+/**
+ * Compresses the bitset into a stream, memory use is a few chunks regardless of the size
+ * Every chunk of BITSET_CODEC_CHUNK_WORDS words is stored as empty, full, run length or gap encoded, whichever is smallest
+ * @param bitset Pointer to bitset to compress (BitSet or DynamicBitSet)
+ * @param write Destination of the stream
+ * @param context Context given to write
+ * @return true on success, false if write failed
+ * @memberof BitSet
+ */
+inline bool bitset_codec_encode(const BitSet* const bitset, const BitSetCodecWrite write, void* const context)
+{
+    BitSetCodecEncoder encoder;
+    bool result = bitset_codec_encoder_init(&encoder, bitset->size, write, context);
+    const uint64_t total = bitset_codec_word_count(bitset->size);
+    for (uint64_t first = 0; result && first < total; first += BITSET_CODEC_CHUNK_WORDS)
+    {
+        encoder.word_count = total - first < BITSET_CODEC_CHUNK_WORDS ? total - first : BITSET_CODEC_CHUNK_WORDS;
+        bitset_load_words(bitset, first, encoder.words, encoder.word_count);
+        result = bitset_codec_encoder_flush(&encoder);
+    }
+    bitset_codec_encoder_destroy(&encoder);
+    return result;
+}
+
+/**
+ * Initialization from a compressed stream
+ * @param bitset Pointer to bitset to initialize (initialized empty on failure)
+ * @param read Source of the stream
+ * @param context Context given to read
+ * @return true on success, false if the stream is truncated or malformed
+ * @memberof DynamicBitSet
+ */
+inline bool bitset_dynamic_init_codec(DynamicBitSet* const bitset, const BitSetCodecRead read, void* const context)
+{
+    BitSetCodecDecoder decoder;
+    bool result = bitset_codec_decoder_init(&decoder, read, context);
+    bitset_dynamic_init(bitset, result ? decoder.size : 0);
+    while (result && bitset_codec_decoder_next(&decoder))
+    {
+        if (decoder.type == BITSET_CODEC_FULL)
+            bitset_set_in_range_begin_end(UNIVERSAL_BITSET(bitset), decoder.position * 64, decoder.position * 64 + decoder.cardinality);
+        else if (decoder.type != BITSET_CODEC_EMPTY)
+        {
+            const uint64_t* const words = bitset_codec_decoder_words(&decoder);
+            if (words)
+                bitset_store_words(UNIVERSAL_BITSET(bitset), decoder.position, words, decoder.word_count);
+        }
+    }
+    result = result && !decoder.failed;
+    bitset_codec_decoder_destroy(&decoder);
+    if (!result)
+    {
+        bitset_dynamic_destroy(bitset);
+        bitset_dynamic_init(bitset, 0);
+    }
+    return result;
+}
+
+/**
+ * Counts the set bits of a compressed stream from the chunk headers, without decompressing anything
+ * @param read Source of the stream
+ * @param context Context given to read
+ * @param count Receives the number of set bits
+ * @return true on success, false if the stream is truncated or malformed
+ */
+inline bool bitset_codec_count(const BitSetCodecRead read, void* const context, uint64_t* const count)
+{
+    BitSetCodecDecoder decoder;
+    *count = 0;
+    const bool initialized = bitset_codec_decoder_init(&decoder, read, context);
+    while (initialized && bitset_codec_decoder_next(&decoder))
+        *count += decoder.cardinality;
+    const bool result = initialized && !decoder.failed;
+    bitset_codec_decoder_destroy(&decoder);
+    return result;
+}
+
+/**
+ * Applies a set operation to two compressed streams and writes the compressed result, memory use is a few chunks regardless of the size
+ * Chunks decided by one side (AND with an empty chunk, OR with a full chunk, an empty side for OR, XOR and ANDNOT...) are copied or emitted without decompressing them
+ * @param first Source of the first stream (left operand)
+ * @param first_context Context given to first
+ * @param second Source of the second stream (right operand)
+ * @param second_context Context given to second
+ * @param operation The operation to apply
+ * @param write Destination of the result
+ * @param context Context given to write
+ * @return true on success, false if a stream is truncated or malformed, the sizes differ or write failed
+ */
+inline bool bitset_codec_apply_operation(const BitSetCodecRead first, void* const first_context, const BitSetCodecRead second, void* const second_context, const BitSetOperation operation, const BitSetCodecWrite write, void* const context)
+{
+    BitSetCodecDecoder left, right;
+    BitSetCodecEncoder encoder;
+    const bool left_valid = bitset_codec_decoder_init(&left, first, first_context);
+    const bool right_valid = bitset_codec_decoder_init(&right, second, second_context);
+    bool result = left_valid && right_valid && left.size == right.size && bitset_codec_encoder_init(&encoder, left.size, write, context);
+    while (result && bitset_codec_decoder_next(&left) && bitset_codec_decoder_next(&right))
+    {
+        const bool left_empty = left.type == BITSET_CODEC_EMPTY, left_full = left.type == BITSET_CODEC_FULL;
+        const bool right_empty = right.type == BITSET_CODEC_EMPTY, right_full = right.type == BITSET_CODEC_FULL;
+        if ((operation == BITSET_AND && (left_empty || right_empty)) || (operation == BITSET_ANDNOT && (left_empty || right_full)))
+            result = bitset_codec_encoder_write_filled_chunk(&encoder, false);
+        else if (operation == BITSET_OR && (left_full || right_full))
+            result = bitset_codec_encoder_write_filled_chunk(&encoder, true);
+        else if ((operation == BITSET_AND && left_full) || ((operation == BITSET_OR || operation == BITSET_XOR) && left_empty))
+            result = bitset_codec_encoder_write_chunk(&encoder, &right);
+        else if ((operation == BITSET_AND && right_full) || ((operation == BITSET_OR || operation == BITSET_XOR || operation == BITSET_ANDNOT) && right_empty))
+            result = bitset_codec_encoder_write_chunk(&encoder, &left);
+        else
+        {
+            const uint64_t* const left_words = bitset_codec_decoder_words(&left);
+            const uint64_t* const right_words = bitset_codec_decoder_words(&right);
+            result = left_words && right_words;
+            if (result)
+            {
+                bitset_operation_buffer(encoder.words, left_words, right_words, left.word_count * sizeof(uint64_t), operation);
+                encoder.word_count = left.word_count;
+                result = bitset_codec_encoder_flush(&encoder);
+            }
+        }
+    }
+    result = result && !left.failed && !right.failed && encoder.position == bitset_codec_word_count(left.size);
+    if (left_valid && right_valid && left.size == right.size)
+        bitset_codec_encoder_destroy(&encoder);
+    bitset_codec_decoder_destroy(&left);
+    bitset_codec_decoder_destroy(&right);
+    return result;
+}
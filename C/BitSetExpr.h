@@ -0,0 +1,346 @@
+#pragma once
+
+#include "BitSet.h"
+
+/**
+ * Size of a tile in bytes, an expression is evaluated one tile at a time and every tile of the stack stays in the L1 cache
+ * (at least BITSET_SIMD_THRESHOLD so the operations run on the vectorized kernels, a multiple of the block size)
+ */
+#ifndef BITSET_EXPR_TILE_BYTES
+#define BITSET_EXPR_TILE_BYTES 2048u
+#endif
+
+/**
+ * Number of blocks of a tile
+ */
+#define BITSET_EXPR_TILE_BLOCKS (BITSET_EXPR_TILE_BYTES / sizeof(bitset_block_t))
+
+/**
+ * Maximal depth of the stack of an expression program
+ */
+#ifndef BITSET_EXPR_STACK_DEPTH
+#define BITSET_EXPR_STACK_DEPTH 8u
+#endif
+
+/**
+ * Operand of a binary instruction taking its second operand from the stack instead of a bitset
+ */
+#define BITSET_EXPR_STACK UINT32_MAX
+
+/**
+ * Opcode of an instruction of an expression program
+ */
+typedef enum
+{
+    /**
+     * Pushes the operand bitset onto the stack
+     */
+    BITSET_EXPR_LOAD,
+    /**
+     * Flips the top of the stack (the operand is ignored)
+     */
+    BITSET_EXPR_NOT,
+    /**
+     * Intersection of the top of the stack and the operand bitset (or the value below the top with BITSET_EXPR_STACK, popping the top)
+     */
+    BITSET_EXPR_AND,
+    /**
+     * Union of the top of the stack and the operand
+     */
+    BITSET_EXPR_OR,
+    /**
+     * Symmetric difference of the top of the stack and the operand
+     */
+    BITSET_EXPR_XOR,
+    /**
+     * Difference of the top of the stack and the operand (top & ~operand, with BITSET_EXPR_STACK: below & ~top)
+     */
+    BITSET_EXPR_ANDNOT
+} BitSetExprOpcode;
+
+/**
+ * An instruction of an expression program
+ */
+typedef struct
+{
+    /**
+     * What the instruction does
+     */
+    BitSetExprOpcode opcode;
+    /**
+     * Index of the operand bitset or BITSET_EXPR_STACK
+     */
+    uint32_t operand;
+} BitSetExprInstruction;
+
+/**
+ * An expression over bitsets of the same size in postfix form, e.g. (a & b) | ~c with operands {a, b, c} is
+ * {LOAD 0} {AND 1} {LOAD 2} {NOT} {OR BITSET_EXPR_STACK}
+ * The program runs tile by tile, so each operand is read once and no intermediate bitset is materialized
+ */
+typedef struct
+{
+    /**
+     * The instructions
+     */
+    const BitSetExprInstruction* code;
+    /**
+     * Number of instructions
+     */
+    uint64_t length;
+    /**
+     * The operands (BitSet or DynamicBitSet, through UNIVERSAL_BITSET)
+     */
+    const BitSet* const* operands;
+    /**
+     * Number of operands
+     */
+    uint64_t operand_count;
+} BitSetExpr;
+
+inline BitSetExprInstruction bitset_expr_instruction(const BitSetExprOpcode opcode, const uint32_t operand);
+inline void bitset_expr_init(BitSetExpr* const expr, const BitSetExprInstruction* const code, const uint64_t length, const BitSet* const* const operands, const uint64_t operand_count);
+inline bool bitset_expr_validate(const BitSetExpr* const expr);
+inline uint64_t bitset_expr_size(const BitSetExpr* const expr);
+inline BitSetOperation bitset_expr_operation(const BitSetExprOpcode opcode);
+inline const bitset_block_t* bitset_expr_evaluate_tile(const BitSetExpr* const expr, const uint64_t begin, const uint64_t blocks, bitset_block_t* const stack);
+inline void bitset_expr_evaluate(const BitSetExpr* const expr, BitSet* const destination);
+inline uint64_t bitset_expr_count(const BitSetExpr* const expr);
+inline bool bitset_expr_any(const BitSetExpr* const expr);
+inline uint64_t bitset_expr_find_first(const BitSetExpr* const expr);
+
+/**
+ * Creates an instruction
+ * @param opcode What the instruction does
+ * @param operand Index of the operand bitset or BITSET_EXPR_STACK (ignored by BITSET_EXPR_NOT)
+ * @return The instruction
+ * @memberof BitSetExprInstruction
+ */
+inline BitSetExprInstruction bitset_expr_instruction(const BitSetExprOpcode opcode, const uint32_t operand)
+{
+    BitSetExprInstruction instruction;
+    instruction.opcode = opcode;
+    instruction.operand = operand;
+    return instruction;
+}
+
+/**
+ * Initialization, the program and the operands are referenced, not copied
+ * @param expr Pointer to expression to initialize
+ * @param code The instructions
+ * @param length Number of instructions
+ * @param operands The operands (BitSet or DynamicBitSet, through UNIVERSAL_BITSET)
+ * @param operand_count Number of operands
+ * @memberof BitSetExpr
+ */
+inline void bitset_expr_init(BitSetExpr* const expr, const BitSetExprInstruction* const code, const uint64_t length, const BitSet* const* const operands, const uint64_t operand_count)
+{
+    expr->code = code;
+    expr->length = length;
+    expr->operands = operands;
+    expr->operand_count = operand_count;
+}
+
+/**
+ * Checks that the program leaves exactly one value on the stack without exceeding BITSET_EXPR_STACK_DEPTH,
+ * refers only to existing operands and that all the operands have the same size
+ * @param expr Pointer to expression to check
+ * @return True if the expression can be evaluated, false otherwise
+ * @memberof BitSetExpr
+ */
+inline bool bitset_expr_validate(const BitSetExpr* const expr)
+{
+    if (!expr->operand_count)
+        return false;
+    for (uint64_t i = 1; i < expr->operand_count; ++i)
+    {
+        if ((*(expr->operands + i))->size != (*expr->operands)->size)
+            return false;
+    }
+    uint64_t depth = 0;
+    for (uint64_t i = 0; i < expr->length; ++i)
+    {
+        const BitSetExprInstruction instruction = *(expr->code + i);
+        if (instruction.opcode > BITSET_EXPR_ANDNOT)
+            return false;
+        if (instruction.opcode == BITSET_EXPR_NOT)
+        {
+            if (!depth)
+                return false;
+            continue;
+        }
+        if (instruction.opcode != BITSET_EXPR_LOAD && instruction.operand == BITSET_EXPR_STACK)
+        {
+            if (depth < 2)
+                return false;
+            --depth;
+            continue;
+        }
+        if (instruction.operand >= expr->operand_count)
+            return false;
+        if (instruction.opcode == BITSET_EXPR_LOAD && ++depth > BITSET_EXPR_STACK_DEPTH)
+            return false;
+        if (instruction.opcode != BITSET_EXPR_LOAD && !depth)
+            return false;
+    }
+    return depth == 1;
+}
+
+/**
+ * Gets the size of the result
+ * @param expr Pointer to expression
+ * @return The size of the operands (bit size)
+ * @memberof BitSetExpr
+ */
+inline uint64_t bitset_expr_size(const BitSetExpr* const expr)
+{
+    return (*expr->operands)->size;
+}
+
+/**
+ * Maps a binary opcode to its bitwise operation
+ * @param opcode The opcode (BITSET_EXPR_AND to BITSET_EXPR_ANDNOT)
+ * @return The operation
+ */
+inline BitSetOperation bitset_expr_operation(const BitSetExprOpcode opcode)
+{
+    return (BitSetOperation)(opcode - BITSET_EXPR_AND + BITSET_AND);
+}
+
+/**
+ * Evaluates the expression over one tile, binary operations run on the vectorized kernels of BitSetKernels.h and
+ * a load directly followed by an operation with a bitset combines both operands without copying the first one
+ * @param expr Pointer to expression to evaluate (valid, see bitset_expr_validate)
+ * @param begin Index of the first block of the tile (block index)
+ * @param blocks Number of blocks of the tile (at most BITSET_EXPR_TILE_BLOCKS)
+ * @param stack Storage of the stack, BITSET_EXPR_STACK_DEPTH * BITSET_EXPR_TILE_BLOCKS blocks
+ * @return Pointer to the result (the bits past the size are not cleared)
+ * @memberof BitSetExpr
+ */
+inline const bitset_block_t* bitset_expr_evaluate_tile(const BitSetExpr* const expr, const uint64_t begin, const uint64_t blocks, bitset_block_t* const stack)
+{
+    const uint64_t bytes = blocks * sizeof(bitset_block_t);
+    // top is the entry of the deepest value (stack itself until the first load), depth the number of values
+    bitset_block_t* top = stack;
+    uint64_t depth = 0;
+    for (uint64_t i = 0; i < expr->length; ++i)
+    {
+        const BitSetExprInstruction instruction = *(expr->code + i);
+        switch (instruction.opcode)
+        {
+        case BITSET_EXPR_LOAD:
+        {
+            const bitset_block_t* const operand = (*(expr->operands + instruction.operand))->data + begin;
+            if (depth++)
+                top += BITSET_EXPR_TILE_BLOCKS;
+            if (i + 1 < expr->length && (expr->code + i + 1)->opcode > BITSET_EXPR_NOT && (expr->code + i + 1)->operand != BITSET_EXPR_STACK)
+            {
+                ++i;
+                bitset_operation_buffer(top, operand, (*(expr->operands + (expr->code + i)->operand))->data + begin, bytes, bitset_expr_operation((expr->code + i)->opcode));
+            }
+            else
+                memcpy(top, operand, bytes);
+            break;
+        }
+        case BITSET_EXPR_NOT:
+            for (uint64_t j = 0; j < blocks; ++j)
+                *(top + j) = ~*(top + j);
+            break;
+        default:
+            if (instruction.operand == BITSET_EXPR_STACK)
+            {
+                --depth;
+                top -= BITSET_EXPR_TILE_BLOCKS;
+                bitset_operation_buffer(top, top, top + BITSET_EXPR_TILE_BLOCKS, bytes, bitset_expr_operation(instruction.opcode));
+            }
+            else
+                bitset_operation_buffer(top, top, (*(expr->operands + instruction.operand))->data + begin, bytes, bitset_expr_operation(instruction.opcode));
+            break;
+        }
+    }
+    return top;
+}
+
+/**
+ * Evaluates the expression into a bitset in one pass over the operands, the destination may be one of the operands
+ * (e.g. a &= b & ~d is {LOAD a} {AND b} {ANDNOT d} stored into a)
+ * @param expr Pointer to expression to evaluate (valid, see bitset_expr_validate)
+ * @param destination Pointer to bitset to store the result in (of the size of the operands)
+ * @memberof BitSetExpr
+ */
+inline void bitset_expr_evaluate(const BitSetExpr* const expr, BitSet* const destination)
+{
+    BITSET_STATS_CALL(BITSET_STATS_SET_OPERATION, bitset_expr_size(expr));
+    bitset_block_t stack[BITSET_EXPR_STACK_DEPTH * BITSET_EXPR_TILE_BLOCKS];
+    const uint64_t storage_size = (*expr->operands)->storage_size;
+    for (uint64_t begin = 0; begin < storage_size; begin += BITSET_EXPR_TILE_BLOCKS)
+    {
+        const uint64_t blocks = storage_size - begin < BITSET_EXPR_TILE_BLOCKS ? storage_size - begin : BITSET_EXPR_TILE_BLOCKS;
+        memcpy(destination->data + begin, bitset_expr_evaluate_tile(expr, begin, blocks, stack), blocks * sizeof(bitset_block_t));
+    }
+    if (storage_size)
+        *(destination->data + storage_size - 1) &= bitset_create_tail_block(bitset_expr_size(expr));
+}
+
+/**
+ * Counts the set bits of the result without storing it
+ * @param expr Pointer to expression to evaluate (valid, see bitset_expr_validate)
+ * @return The number of set bits in the result
+ * @memberof BitSetExpr
+ */
+inline uint64_t bitset_expr_count(const BitSetExpr* const expr)
+{
+    BITSET_STATS_CALL(BITSET_STATS_COUNT, bitset_expr_size(expr));
+    bitset_block_t stack[BITSET_EXPR_STACK_DEPTH * BITSET_EXPR_TILE_BLOCKS];
+    const uint64_t storage_size = (*expr->operands)->storage_size;
+    uint64_t count = 0;
+    for (uint64_t begin = 0; begin < storage_size; begin += BITSET_EXPR_TILE_BLOCKS)
+    {
+        const uint64_t blocks = storage_size - begin < BITSET_EXPR_TILE_BLOCKS ? storage_size - begin : BITSET_EXPR_TILE_BLOCKS;
+        const bitset_block_t* const result = bitset_expr_evaluate_tile(expr, begin, blocks, stack);
+        if (begin + blocks < storage_size)
+            count += bitset_popcount_buffer(result, blocks * sizeof(bitset_block_t));
+        else
+            count += bitset_popcount_buffer(result, (blocks - 1) * sizeof(bitset_block_t))
+                + bitset_block_popcount(*(result + blocks - 1) & bitset_create_tail_block(bitset_expr_size(expr)));
+    }
+    return count;
+}
+
+/**
+ * Checks if any bit of the result is set, stops at the first tile containing one
+ * @param expr Pointer to expression to evaluate (valid, see bitset_expr_validate)
+ * @return True if any of the bits of the result are set, false otherwise
+ * @memberof BitSetExpr
+ */
+inline bool bitset_expr_any(const BitSetExpr* const expr)
+{
+    return bitset_expr_find_first(expr) != BITSET_NPOS;
+}
+
+/**
+ * Finds the first set bit of the result, stops at the first tile containing one
+ * @param expr Pointer to expression to evaluate (valid, see bitset_expr_validate)
+ * @return Index of the found bit or BITSET_NPOS if there is none
+ * @memberof BitSetExpr
+ */
+inline uint64_t bitset_expr_find_first(const BitSetExpr* const expr)
+{
+    BITSET_STATS_CALL(BITSET_STATS_FIND, bitset_expr_size(expr));
+    bitset_block_t stack[BITSET_EXPR_STACK_DEPTH * BITSET_EXPR_TILE_BLOCKS];
+    const uint64_t storage_size = (*expr->operands)->storage_size;
+    for (uint64_t begin = 0; begin < storage_size; begin += BITSET_EXPR_TILE_BLOCKS)
+    {
+        const uint64_t blocks = storage_size - begin < BITSET_EXPR_TILE_BLOCKS ? storage_size - begin : BITSET_EXPR_TILE_BLOCKS;
+        const bitset_block_t* const result = bitset_expr_evaluate_tile(expr, begin, blocks, stack);
+        const uint64_t found = bitset_find_mismatch_buffer(result, blocks * sizeof(bitset_block_t), 0) / sizeof(bitset_block_t);
+        if (found == blocks)
+            continue;
+        bitset_block_t block = *(result + found);
+        if (begin + found == storage_size - 1)
+            block &= bitset_create_tail_block(bitset_expr_size(expr));
+        if (block)
+            return (begin + found) * BITSET_BLOCK_BITS + bitset_block_lowest_bit(block);
+    }
+    return BITSET_NPOS;
+}
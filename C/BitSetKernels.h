@@ -0,0 +1,894 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/**
+ * Low level kernels used by the bitset API. They work on raw storage (bytes), so they don't depend on the block type.
+ * On x86 with GCC/Clang the vectorized kernels are selected at runtime based on the CPU features,
+ * define BITSET_NO_SIMD to always use the portable versions.
+ */
+
+#if !defined(BITSET_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BITSET_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+/**
+ * Minimal buffer size (in bytes) for which the vectorized kernels are used
+ */
+#ifndef BITSET_SIMD_THRESHOLD
+#define BITSET_SIMD_THRESHOLD 512u
+#endif
+
+/**
+ * Number of elements ahead of the current one the batch kernels prefetch
+ */
+#ifndef BITSET_PREFETCH_DISTANCE
+#define BITSET_PREFETCH_DISTANCE 32u
+#endif
+
+/**
+ * Hints the CPU to load the cache line of the address (write: 1 if it will be modified, 0 otherwise)
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define BITSET_PREFETCH(address, write) __builtin_prefetch((address), (write))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define BITSET_PREFETCH(address, write) _mm_prefetch((const char*)(address), _MM_HINT_T0)
+#else
+#define BITSET_PREFETCH(address, write) ((void)0)
+#endif
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Checks if the CPU (and the OS) supports the specified feature, e.g. "avx2"
+ */
+#define BITSET_CPU_SUPPORTS(feature) (__builtin_cpu_init(), __builtin_cpu_supports(feature))
+#define BITSET_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+/**
+ * Bitwise operation between two bitsets
+ */
+typedef enum
+{
+    /**
+     * Intersection (first & second)
+     */
+    BITSET_AND,
+    /**
+     * Union (first | second)
+     */
+    BITSET_OR,
+    /**
+     * Symmetric difference (first ^ second)
+     */
+    BITSET_XOR,
+    /**
+     * Difference (first & ~second)
+     */
+    BITSET_ANDNOT
+} BitSetOperation;
+
+inline uint64_t bitset_popcount64(const uint64_t word);
+inline uint64_t bitset_load64(const uint8_t* const source);
+inline uint64_t bitset_ctz64(const uint64_t word);
+inline uint64_t bitset_clz64(const uint64_t word);
+inline uint64_t bitset_popcount_buffer_portable(const uint8_t* const data, const uint64_t size);
+inline uint64_t bitset_popcount_buffer(const void* const data, const uint64_t size);
+inline uint64_t bitset_apply_operation64(const uint64_t first, const uint64_t second, const BitSetOperation operation);
+inline void bitset_operation_buffer_portable(uint8_t* const destination, const uint8_t* const first, const uint8_t* const second, const uint64_t size, const BitSetOperation operation);
+inline uint64_t bitset_operation_count_buffer_portable(const uint8_t* const first, const uint8_t* const second, const uint64_t size, const BitSetOperation operation);
+inline void bitset_operation_buffer(void* const destination, const void* const first, const void* const second, const uint64_t size, const BitSetOperation operation);
+inline uint64_t bitset_operation_count_buffer(const void* const first, const void* const second, const uint64_t size, const BitSetOperation operation);
+inline uint64_t bitset_find_mismatch_buffer_portable(const uint8_t* const data, const uint64_t size, const uint8_t fill);
+inline uint64_t bitset_find_mismatch_buffer(const void* const data, const uint64_t size, const uint8_t fill);
+inline void bitset_gather_bits_buffer_portable(const uint64_t* const words, const uint64_t* const indices, const uint64_t count, bool* const values);
+inline void bitset_gather_bits_buffer(const uint64_t* const words, const uint64_t* const indices, const uint64_t count, bool* const values);
+inline uint64_t bitset_extract_indices_buffer_portable(const uint64_t* const words, const uint64_t count, const uint64_t base, uint64_t* const indices);
+inline uint64_t bitset_extract_indices_buffer(const uint64_t* const words, const uint64_t count, const uint64_t base, uint64_t* const indices);
+inline uint64_t bitset_extract_indices32_buffer_portable(const uint64_t* const words, const uint64_t count, const uint32_t base, uint32_t* const indices);
+inline uint64_t bitset_extract_indices32_buffer(const uint64_t* const words, const uint64_t count, const uint32_t base, uint32_t* const indices);
+inline uint64_t bitset_checksum_mix64(uint64_t hash, const uint64_t word);
+inline uint64_t bitset_checksum_buffer(const void* const data, const uint64_t size, const uint64_t seed);
+
+/**
+ * Counts the set bits in a 64-bit word
+ * @param word The word to count the bits of
+ * @return The number of set bits
+ */
+inline uint64_t bitset_popcount64(const uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint64_t)__builtin_popcountll(word);
+#else
+    uint64_t x = word - ((word >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (x * 0x0101010101010101ull) >> 56;
+#endif
+}
+
+/**
+ * Counts the trailing zero bits of a 64-bit word
+ * @param word The word to scan (must not be zero)
+ * @return Index of the lowest set bit
+ */
+inline uint64_t bitset_ctz64(const uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint64_t)__builtin_ctzll(word);
+#else
+    // isolate the lowest set bit and count the bits below it
+    return bitset_popcount64((word & (0 - word)) - 1);
+#endif
+}
+
+/**
+ * Counts the leading zero bits of a 64-bit word
+ * @param word The word to scan (must not be zero)
+ * @return 63 minus the index of the highest set bit
+ */
+inline uint64_t bitset_clz64(const uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint64_t)__builtin_clzll(word);
+#else
+    uint64_t x = word;
+    x |= x >> 1;
+    x |= x >> 2;
+    x |= x >> 4;
+    x |= x >> 8;
+    x |= x >> 16;
+    x |= x >> 32;
+    return 64 - bitset_popcount64(x);
+#endif
+}
+
+/**
+ * Loads a 64-bit word from (possibly unaligned) memory
+ * @param source Pointer to the first byte of the word
+ * @return The loaded word
+ */
+inline uint64_t bitset_load64(const uint8_t* const source)
+{
+    uint64_t word;
+    memcpy(&word, source, sizeof(word));
+    return word;
+}
+
+/**
+ * Counts the set bits in a buffer, portable version
+ * @param data Pointer to the buffer
+ * @param size Size of the buffer (in bytes)
+ * @return The number of set bits
+ */
+inline uint64_t bitset_popcount_buffer_portable(const uint8_t* const data, const uint64_t size)
+{
+    uint64_t count = 0, i = 0;
+    for (; i + 8 <= size; i += 8)
+        count += bitset_popcount64(bitset_load64(data + i));
+    for (; i < size; ++i)
+        count += bitset_popcount64(*(data + i));
+    return count;
+}
+
+#ifdef BITSET_X86_DISPATCH
+
+/**
+ * Counts the set bits in a buffer using the POPCNT instruction (4 independent accumulators)
+ * @param data Pointer to the buffer
+ * @param size Size of the buffer (in bytes)
+ * @return The number of set bits
+ */
+BITSET_TARGET("popcnt") inline uint64_t bitset_popcount_buffer_popcnt(const uint8_t* const data, const uint64_t size)
+{
+    uint64_t count0 = 0, count1 = 0, count2 = 0, count3 = 0, i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        count0 += (uint64_t)__builtin_popcountll(bitset_load64(data + i));
+        count1 += (uint64_t)__builtin_popcountll(bitset_load64(data + i + 8));
+        count2 += (uint64_t)__builtin_popcountll(bitset_load64(data + i + 16));
+        count3 += (uint64_t)__builtin_popcountll(bitset_load64(data + i + 24));
+    }
+    for (; i + 8 <= size; i += 8)
+        count0 += (uint64_t)__builtin_popcountll(bitset_load64(data + i));
+    for (; i < size; ++i)
+        count0 += (uint64_t)__builtin_popcountll(*(data + i));
+    return count0 + count1 + count2 + count3;
+}
+
+/**
+ * Counts the set bits in each 64-bit lane of the vector (nibble lookup table)
+ */
+BITSET_TARGET("avx2") inline __m256i bitset_avx2_popcount_vector(const __m256i vector)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    const __m256i low = _mm256_and_si256(vector, low_mask);
+    const __m256i high = _mm256_and_si256(_mm256_srli_epi16(vector, 4), low_mask);
+    const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+/**
+ * Carry-save adder: adds a, b and c bitwise, high receives the carries, low the sums
+ */
+BITSET_TARGET("avx2") inline void bitset_avx2_csa(__m256i* const high, __m256i* const low, const __m256i a, const __m256i b, const __m256i c)
+{
+    const __m256i u = _mm256_xor_si256(a, b);
+    *high = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+    *low = _mm256_xor_si256(u, c);
+}
+
+/**
+ * Counts the set bits in a buffer using the Harley-Seal carry-save adder network over AVX2 vectors
+ * @param data Pointer to the buffer
+ * @param size Size of the buffer (in bytes)
+ * @return The number of set bits
+ */
+BITSET_TARGET("avx2,popcnt") inline uint64_t bitset_popcount_buffer_avx2(const uint8_t* const data, const uint64_t size)
+{
+    const __m256i* const vectors = (const __m256i*)data;
+    const uint64_t vector_count = size / 32;
+    __m256i total = _mm256_setzero_si256();
+    __m256i ones = _mm256_setzero_si256(), twos = _mm256_setzero_si256(), fours = _mm256_setzero_si256(),
+            eights = _mm256_setzero_si256(), sixteens = _mm256_setzero_si256();
+    __m256i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+    uint64_t i = 0;
+
+    for (; i + 16 <= vector_count; i += 16)
+    {
+        bitset_avx2_csa(&twos_a, &ones, ones, _mm256_loadu_si256(vectors + i), _mm256_loadu_si256(vectors + i + 1));
+        bitset_avx2_csa(&twos_b, &ones, ones, _mm256_loadu_si256(vectors + i + 2), _mm256_loadu_si256(vectors + i + 3));
+        bitset_avx2_csa(&fours_a, &twos, twos, twos_a, twos_b);
+        bitset_avx2_csa(&twos_a, &ones, ones, _mm256_loadu_si256(vectors + i + 4), _mm256_loadu_si256(vectors + i + 5));
+        bitset_avx2_csa(&twos_b, &ones, ones, _mm256_loadu_si256(vectors + i + 6), _mm256_loadu_si256(vectors + i + 7));
+        bitset_avx2_csa(&fours_b, &twos, twos, twos_a, twos_b);
+        bitset_avx2_csa(&eights_a, &fours, fours, fours_a, fours_b);
+        bitset_avx2_csa(&twos_a, &ones, ones, _mm256_loadu_si256(vectors + i + 8), _mm256_loadu_si256(vectors + i + 9));
+        bitset_avx2_csa(&twos_b, &ones, ones, _mm256_loadu_si256(vectors + i + 10), _mm256_loadu_si256(vectors + i + 11));
+        bitset_avx2_csa(&fours_a, &twos, twos, twos_a, twos_b);
+        bitset_avx2_csa(&twos_a, &ones, ones, _mm256_loadu_si256(vectors + i + 12), _mm256_loadu_si256(vectors + i + 13));
+        bitset_avx2_csa(&twos_b, &ones, ones, _mm256_loadu_si256(vectors + i + 14), _mm256_loadu_si256(vectors + i + 15));
+        bitset_avx2_csa(&fours_b, &twos, twos, twos_a, twos_b);
+        bitset_avx2_csa(&eights_b, &fours, fours, fours_a, fours_b);
+        bitset_avx2_csa(&sixteens, &eights, eights, eights_a, eights_b);
+        total = _mm256_add_epi64(total, bitset_avx2_popcount_vector(sixteens));
+    }
+
+    total = _mm256_slli_epi64(total, 4);
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(bitset_avx2_popcount_vector(eights), 3));
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(bitset_avx2_popcount_vector(fours), 2));
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(bitset_avx2_popcount_vector(twos), 1));
+    total = _mm256_add_epi64(total, bitset_avx2_popcount_vector(ones));
+
+    for (; i < vector_count; ++i)
+        total = _mm256_add_epi64(total, bitset_avx2_popcount_vector(_mm256_loadu_si256(vectors + i)));
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + bitset_popcount_buffer_popcnt(data + vector_count * 32, size - vector_count * 32);
+}
+
+/**
+ * Counts the set bits in a buffer using the AVX-512 VPOPCNTDQ instruction
+ * @param data Pointer to the buffer
+ * @param size Size of the buffer (in bytes)
+ * @return The number of set bits
+ */
+BITSET_TARGET("avx512f,avx512vpopcntdq,popcnt") inline uint64_t bitset_popcount_buffer_avx512(const uint8_t* const data, const uint64_t size)
+{
+    const uint64_t vector_count = size / 64;
+    __m512i total0 = _mm512_setzero_si512(), total1 = _mm512_setzero_si512();
+    uint64_t i = 0;
+    for (; i + 2 <= vector_count; i += 2)
+    {
+        total0 = _mm512_add_epi64(total0, _mm512_popcnt_epi64(_mm512_loadu_si512(data + i * 64)));
+        total1 = _mm512_add_epi64(total1, _mm512_popcnt_epi64(_mm512_loadu_si512(data + i * 64 + 64)));
+    }
+    for (; i < vector_count; ++i)
+        total0 = _mm512_add_epi64(total0, _mm512_popcnt_epi64(_mm512_loadu_si512(data + i * 64)));
+    uint64_t lanes[8];
+    _mm512_storeu_si512(lanes, _mm512_add_epi64(total0, total1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7]
+        + bitset_popcount_buffer_popcnt(data + vector_count * 64, size - vector_count * 64);
+}
+
+#endif // BITSET_X86_DISPATCH
+
+/**
+ * Counts the set bits in a buffer, the fastest kernel supported by the CPU is selected at runtime
+ * (AVX-512 VPOPCNTDQ, AVX2 Harley-Seal, POPCNT or portable)
+ * @param data Pointer to the buffer
+ * @param size Size of the buffer (in bytes)
+ * @return The number of set bits
+ */
+inline uint64_t bitset_popcount_buffer(const void* const data, const uint64_t size)
+{
+    const uint8_t* const bytes = (const uint8_t*)data;
+#ifdef BITSET_X86_DISPATCH
+    if (size >= BITSET_SIMD_THRESHOLD)
+    {
+        if (BITSET_CPU_SUPPORTS("avx512vpopcntdq"))
+            return bitset_popcount_buffer_avx512(bytes, size);
+        if (BITSET_CPU_SUPPORTS("avx2"))
+            return bitset_popcount_buffer_avx2(bytes, size);
+    }
+    if (BITSET_CPU_SUPPORTS("popcnt"))
+        return bitset_popcount_buffer_popcnt(bytes, size);
+#endif
+    return bitset_popcount_buffer_portable(bytes, size);
+}
+
+/**
+ * Applies the bitwise operation to two 64-bit words
+ * @param first The first operand
+ * @param second The second operand
+ * @param operation The operation to apply
+ * @return The result of the operation
+ */
+inline uint64_t bitset_apply_operation64(const uint64_t first, const uint64_t second, const BitSetOperation operation)
+{
+    switch (operation)
+    {
+    case BITSET_AND:
+        return first & second;
+    case BITSET_OR:
+        return first | second;
+    case BITSET_XOR:
+        return first ^ second;
+    default:
+        return first & ~second;
+    }
+}
+
+/**
+ * Applies the bitwise operation to two buffers, portable version (destination may be the same as one of the operands)
+ * @param destination Pointer to the buffer receiving the result
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param size Size of the buffers (in bytes)
+ * @param operation The operation to apply
+ */
+inline void bitset_operation_buffer_portable(uint8_t* const destination, const uint8_t* const first, const uint8_t* const second, const uint64_t size, const BitSetOperation operation)
+{
+    uint64_t i = 0, word;
+    switch (operation)
+    {
+    case BITSET_AND:
+        for (; i + 8 <= size; i += 8)
+        {
+            word = bitset_load64(first + i) & bitset_load64(second + i);
+            memcpy(destination + i, &word, sizeof(word));
+        }
+        break;
+    case BITSET_OR:
+        for (; i + 8 <= size; i += 8)
+        {
+            word = bitset_load64(first + i) | bitset_load64(second + i);
+            memcpy(destination + i, &word, sizeof(word));
+        }
+        break;
+    case BITSET_XOR:
+        for (; i + 8 <= size; i += 8)
+        {
+            word = bitset_load64(first + i) ^ bitset_load64(second + i);
+            memcpy(destination + i, &word, sizeof(word));
+        }
+        break;
+    default:
+        for (; i + 8 <= size; i += 8)
+        {
+            word = bitset_load64(first + i) & ~bitset_load64(second + i);
+            memcpy(destination + i, &word, sizeof(word));
+        }
+        break;
+    }
+    for (; i < size; ++i)
+        *(destination + i) = (uint8_t)bitset_apply_operation64(*(first + i), *(second + i), operation);
+}
+
+/**
+ * Counts the set bits in the result of the bitwise operation without storing it, portable version
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param size Size of the buffers (in bytes)
+ * @param operation The operation to apply
+ * @return The number of set bits in the result
+ */
+inline uint64_t bitset_operation_count_buffer_portable(const uint8_t* const first, const uint8_t* const second, const uint64_t size, const BitSetOperation operation)
+{
+    uint64_t count = 0, i = 0;
+    for (; i + 8 <= size; i += 8)
+        count += bitset_popcount64(bitset_apply_operation64(bitset_load64(first + i), bitset_load64(second + i), operation));
+    for (; i < size; ++i)
+        count += bitset_popcount64((uint8_t)bitset_apply_operation64(*(first + i), *(second + i), operation));
+    return count;
+}
+
+#ifdef BITSET_X86_DISPATCH
+
+/**
+ * Applies the bitwise operation to one pair of AVX2 vectors
+ */
+BITSET_TARGET("avx2") inline __m256i bitset_avx2_apply_operation(const __m256i first, const __m256i second, const BitSetOperation operation)
+{
+    switch (operation)
+    {
+    case BITSET_AND:
+        return _mm256_and_si256(first, second);
+    case BITSET_OR:
+        return _mm256_or_si256(first, second);
+    case BITSET_XOR:
+        return _mm256_xor_si256(first, second);
+    default:
+        return _mm256_andnot_si256(second, first);
+    }
+}
+
+/**
+ * Applies the bitwise operation to two buffers using AVX2 vectors
+ * @param destination Pointer to the buffer receiving the result
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param size Size of the buffers (in bytes)
+ * @param operation The operation to apply
+ */
+BITSET_TARGET("avx2") inline void bitset_operation_buffer_avx2(uint8_t* const destination, const uint8_t* const first, const uint8_t* const second, const uint64_t size, const BitSetOperation operation)
+{
+    uint64_t i = 0;
+    for (; i + 128 <= size; i += 128)
+    {
+        const __m256i result0 = bitset_avx2_apply_operation(_mm256_loadu_si256((const __m256i*)(first + i)), _mm256_loadu_si256((const __m256i*)(second + i)), operation);
+        const __m256i result1 = bitset_avx2_apply_operation(_mm256_loadu_si256((const __m256i*)(first + i + 32)), _mm256_loadu_si256((const __m256i*)(second + i + 32)), operation);
+        const __m256i result2 = bitset_avx2_apply_operation(_mm256_loadu_si256((const __m256i*)(first + i + 64)), _mm256_loadu_si256((const __m256i*)(second + i + 64)), operation);
+        const __m256i result3 = bitset_avx2_apply_operation(_mm256_loadu_si256((const __m256i*)(first + i + 96)), _mm256_loadu_si256((const __m256i*)(second + i + 96)), operation);
+        _mm256_storeu_si256((__m256i*)(destination + i), result0);
+        _mm256_storeu_si256((__m256i*)(destination + i + 32), result1);
+        _mm256_storeu_si256((__m256i*)(destination + i + 64), result2);
+        _mm256_storeu_si256((__m256i*)(destination + i + 96), result3);
+    }
+    for (; i + 32 <= size; i += 32)
+        _mm256_storeu_si256((__m256i*)(destination + i), bitset_avx2_apply_operation(_mm256_loadu_si256((const __m256i*)(first + i)), _mm256_loadu_si256((const __m256i*)(second + i)), operation));
+    bitset_operation_buffer_portable(destination + i, first + i, second + i, size - i, operation);
+}
+
+/**
+ * Counts the set bits in the result of the bitwise operation using AVX2 vectors
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param size Size of the buffers (in bytes)
+ * @param operation The operation to apply
+ * @return The number of set bits in the result
+ */
+BITSET_TARGET("avx2") inline uint64_t bitset_operation_count_buffer_avx2(const uint8_t* const first, const uint8_t* const second, const uint64_t size, const BitSetOperation operation)
+{
+    __m256i total = _mm256_setzero_si256();
+    uint64_t i = 0;
+    for (; i + 32 <= size; i += 32)
+        total = _mm256_add_epi64(total, bitset_avx2_popcount_vector(bitset_avx2_apply_operation(_mm256_loadu_si256((const __m256i*)(first + i)), _mm256_loadu_si256((const __m256i*)(second + i)), operation)));
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + bitset_operation_count_buffer_portable(first + i, second + i, size - i, operation);
+}
+
+/**
+ * Applies the bitwise operation to one pair of AVX-512 vectors
+ */
+BITSET_TARGET("avx512f") inline __m512i bitset_avx512_apply_operation(const __m512i first, const __m512i second, const BitSetOperation operation)
+{
+    switch (operation)
+    {
+    case BITSET_AND:
+        return _mm512_and_si512(first, second);
+    case BITSET_OR:
+        return _mm512_or_si512(first, second);
+    case BITSET_XOR:
+        return _mm512_xor_si512(first, second);
+    default:
+        // first & ~second as a ternary logic truth table (avoids the undefined-register form of andnot)
+        return _mm512_ternarylogic_epi64(first, second, second, 0x30);
+    }
+}
+
+/**
+ * Applies the bitwise operation to two buffers using AVX-512 vectors
+ * @param destination Pointer to the buffer receiving the result
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param size Size of the buffers (in bytes)
+ * @param operation The operation to apply
+ */
+BITSET_TARGET("avx512f") inline void bitset_operation_buffer_avx512(uint8_t* const destination, const uint8_t* const first, const uint8_t* const second, const uint64_t size, const BitSetOperation operation)
+{
+    uint64_t i = 0;
+    for (; i + 128 <= size; i += 128)
+    {
+        const __m512i result0 = bitset_avx512_apply_operation(_mm512_loadu_si512(first + i), _mm512_loadu_si512(second + i), operation);
+        const __m512i result1 = bitset_avx512_apply_operation(_mm512_loadu_si512(first + i + 64), _mm512_loadu_si512(second + i + 64), operation);
+        _mm512_storeu_si512(destination + i, result0);
+        _mm512_storeu_si512(destination + i + 64, result1);
+    }
+    for (; i + 64 <= size; i += 64)
+        _mm512_storeu_si512(destination + i, bitset_avx512_apply_operation(_mm512_loadu_si512(first + i), _mm512_loadu_si512(second + i), operation));
+    bitset_operation_buffer_portable(destination + i, first + i, second + i, size - i, operation);
+}
+
+/**
+ * Counts the set bits in the result of the bitwise operation using AVX-512 VPOPCNTDQ
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param size Size of the buffers (in bytes)
+ * @param operation The operation to apply
+ * @return The number of set bits in the result
+ */
+BITSET_TARGET("avx512f,avx512vpopcntdq") inline uint64_t bitset_operation_count_buffer_avx512(const uint8_t* const first, const uint8_t* const second, const uint64_t size, const BitSetOperation operation)
+{
+    __m512i total = _mm512_setzero_si512();
+    uint64_t i = 0;
+    for (; i + 64 <= size; i += 64)
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(bitset_avx512_apply_operation(_mm512_loadu_si512(first + i), _mm512_loadu_si512(second + i), operation)));
+    uint64_t lanes[8];
+    _mm512_storeu_si512(lanes, total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7]
+        + bitset_operation_count_buffer_portable(first + i, second + i, size - i, operation);
+}
+
+#endif // BITSET_X86_DISPATCH
+
+/**
+ * Applies the bitwise operation to two buffers, the fastest kernel supported by the CPU is selected at runtime
+ * (AVX-512, AVX2 or portable), destination may be the same as one of the operands
+ * @param destination Pointer to the buffer receiving the result
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param size Size of the buffers (in bytes)
+ * @param operation The operation to apply
+ */
+inline void bitset_operation_buffer(void* const destination, const void* const first, const void* const second, const uint64_t size, const BitSetOperation operation)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (size >= BITSET_SIMD_THRESHOLD)
+    {
+        if (BITSET_CPU_SUPPORTS("avx512f"))
+        {
+            bitset_operation_buffer_avx512((uint8_t*)destination, (const uint8_t*)first, (const uint8_t*)second, size, operation);
+            return;
+        }
+        if (BITSET_CPU_SUPPORTS("avx2"))
+        {
+            bitset_operation_buffer_avx2((uint8_t*)destination, (const uint8_t*)first, (const uint8_t*)second, size, operation);
+            return;
+        }
+    }
+#endif
+    bitset_operation_buffer_portable((uint8_t*)destination, (const uint8_t*)first, (const uint8_t*)second, size, operation);
+}
+
+/**
+ * Counts the set bits in the result of the bitwise operation without storing it,
+ * the fastest kernel supported by the CPU is selected at runtime (AVX-512 VPOPCNTDQ, AVX2 or portable)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param size Size of the buffers (in bytes)
+ * @param operation The operation to apply
+ * @return The number of set bits in the result
+ */
+inline uint64_t bitset_operation_count_buffer(const void* const first, const void* const second, const uint64_t size, const BitSetOperation operation)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (size >= BITSET_SIMD_THRESHOLD)
+    {
+        if (BITSET_CPU_SUPPORTS("avx512vpopcntdq"))
+            return bitset_operation_count_buffer_avx512((const uint8_t*)first, (const uint8_t*)second, size, operation);
+        if (BITSET_CPU_SUPPORTS("avx2"))
+            return bitset_operation_count_buffer_avx2((const uint8_t*)first, (const uint8_t*)second, size, operation);
+    }
+#endif
+    return bitset_operation_count_buffer_portable((const uint8_t*)first, (const uint8_t*)second, size, operation);
+}
+
+/**
+ * Finds the first byte different from the fill byte, portable version (32 bytes are checked at once)
+ * @param data Pointer to the buffer
+ * @param size Size of the buffer (in bytes)
+ * @param fill The expected byte (0 to find a set bit, 255 to find a cleared bit)
+ * @return Offset of the first different byte or size if there is none
+ */
+inline uint64_t bitset_find_mismatch_buffer_portable(const uint8_t* const data, const uint64_t size, const uint8_t fill)
+{
+    const uint64_t pattern = fill * 0x0101010101010101ull;
+    uint64_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        if ((bitset_load64(data + i) ^ pattern) | (bitset_load64(data + i + 8) ^ pattern)
+            | (bitset_load64(data + i + 16) ^ pattern) | (bitset_load64(data + i + 24) ^ pattern))
+            break;
+    }
+    for (; i < size; ++i)
+    {
+        if (*(data + i) != fill)
+            return i;
+    }
+    return size;
+}
+
+#ifdef BITSET_X86_DISPATCH
+
+/**
+ * Finds the first byte different from the fill byte using AVX2 (64 bytes are checked at once)
+ * @param data Pointer to the buffer
+ * @param size Size of the buffer (in bytes)
+ * @param fill The expected byte
+ * @return Offset of the first different byte or size if there is none
+ */
+BITSET_TARGET("avx2") inline uint64_t bitset_find_mismatch_buffer_avx2(const uint8_t* const data, const uint64_t size, const uint8_t fill)
+{
+    const __m256i pattern = _mm256_set1_epi8((char)fill);
+    uint64_t i = 0;
+    for (; i + 64 <= size; i += 64)
+    {
+        const __m256i difference = _mm256_or_si256(_mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(data + i)), pattern),
+                                                   _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(data + i + 32)), pattern));
+        if (!_mm256_testz_si256(difference, difference))
+            break;
+    }
+    return i + bitset_find_mismatch_buffer_portable(data + i, size - i, fill);
+}
+
+#endif // BITSET_X86_DISPATCH
+
+/**
+ * Finds the first byte different from the fill byte, stops at the first mismatch (AVX2 or portable kernel selected at runtime)
+ * @param data Pointer to the buffer
+ * @param size Size of the buffer (in bytes)
+ * @param fill The expected byte (0 to find a set bit, 255 to find a cleared bit)
+ * @return Offset of the first different byte or size if there is none
+ */
+inline uint64_t bitset_find_mismatch_buffer(const void* const data, const uint64_t size, const uint8_t fill)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (size >= BITSET_SIMD_THRESHOLD && BITSET_CPU_SUPPORTS("avx2"))
+        return bitset_find_mismatch_buffer_avx2((const uint8_t*)data, size, fill);
+#endif
+    return bitset_find_mismatch_buffer_portable((const uint8_t*)data, size, fill);
+}
+
+/**
+ * Reads the bits at the indices, portable version (prefetches BITSET_PREFETCH_DISTANCE indices ahead)
+ * @param words Pointer to the bits as 64-bit words, bit i is bit i % 64 of word i / 64
+ * @param indices Indices of the bits to read (bit index)
+ * @param count Number of indices
+ * @param values Array receiving the values of the bits
+ */
+inline void bitset_gather_bits_buffer_portable(const uint64_t* const words, const uint64_t* const indices, const uint64_t count, bool* const values)
+{
+    uint64_t i = 0;
+    for (; i + BITSET_PREFETCH_DISTANCE < count; ++i)
+    {
+        BITSET_PREFETCH(words + *(indices + i + BITSET_PREFETCH_DISTANCE) / 64, 0);
+        *(values + i) = *(words + *(indices + i) / 64) >> *(indices + i) % 64 & 1u;
+    }
+    for (; i < count; ++i)
+        *(values + i) = *(words + *(indices + i) / 64) >> *(indices + i) % 64 & 1u;
+}
+
+#ifdef BITSET_X86_DISPATCH
+
+/**
+ * Reads the bits at the indices using AVX-512 gathers (8 indices at once)
+ * @param words Pointer to the bits as 64-bit words, bit i is bit i % 64 of word i / 64
+ * @param indices Indices of the bits to read (bit index)
+ * @param count Number of indices
+ * @param values Array receiving the values of the bits
+ */
+BITSET_TARGET("avx512f,avx512bw,avx512vl") inline void bitset_gather_bits_buffer_avx512(const uint64_t* const words, const uint64_t* const indices, const uint64_t count, bool* const values)
+{
+    const __m512i one = _mm512_set1_epi64(1), low = _mm512_set1_epi64(63);
+    uint64_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        if (i + BITSET_PREFETCH_DISTANCE + 8 <= count)
+            for (uint64_t j = 0; j < 8; ++j)
+                BITSET_PREFETCH(words + *(indices + i + BITSET_PREFETCH_DISTANCE + j) / 64, 0);
+        const __m512i index = _mm512_loadu_si512(indices + i);
+        // masked forms with a zero pass-through, the unmasked ones start from an undefined vector (-Wmaybe-uninitialized)
+        const __m512i word = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), (__mmask8)0xFF, _mm512_maskz_srli_epi64((__mmask8)0xFF, index, 6), (const void*)words, 8);
+        const __mmask8 mask = _mm512_test_epi64_mask(_mm512_maskz_srlv_epi64((__mmask8)0xFF, word, _mm512_and_si512(index, low)), one);
+        _mm_storel_epi64((__m128i*)(values + i), _mm_maskz_mov_epi8(mask, _mm_set1_epi8(1)));
+    }
+    bitset_gather_bits_buffer_portable(words, indices + i, count - i, values + i);
+}
+
+#endif // BITSET_X86_DISPATCH
+
+/**
+ * Reads the bits at the indices (AVX-512 or portable kernel selected at runtime)
+ * @param words Pointer to the bits as 64-bit words, bit i is bit i % 64 of word i / 64
+ * @param indices Indices of the bits to read (bit index)
+ * @param count Number of indices
+ * @param values Array receiving the values of the bits
+ */
+inline void bitset_gather_bits_buffer(const uint64_t* const words, const uint64_t* const indices, const uint64_t count, bool* const values)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (count >= 64 && BITSET_CPU_SUPPORTS("avx512bw") && BITSET_CPU_SUPPORTS("avx512vl"))
+    {
+        bitset_gather_bits_buffer_avx512(words, indices, count, values);
+        return;
+    }
+#endif
+    bitset_gather_bits_buffer_portable(words, indices, count, values);
+}
+
+/**
+ * Writes the indices of the set bits, portable version (one trailing zero count per set bit)
+ * @param words Pointer to the bits as 64-bit words, bit i is bit i % 64 of word i / 64
+ * @param count Number of words
+ * @param base Value added to every index
+ * @param indices Array receiving the indices, room for every set bit of the words
+ * @return The number of indices written
+ */
+inline uint64_t bitset_extract_indices_buffer_portable(const uint64_t* const words, const uint64_t count, const uint64_t base, uint64_t* const indices)
+{
+    uint64_t written = 0;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        for (uint64_t word = *(words + i); word; word &= word - 1)
+            *(indices + written++) = base + i * 64 + bitset_ctz64(word);
+    }
+    return written;
+}
+
+/**
+ * Writes the indices of the set bits as 32-bit values, portable version
+ * @param words Pointer to the bits as 64-bit words, bit i is bit i % 64 of word i / 64
+ * @param count Number of words
+ * @param base Value added to every index (the indices have to fit in 32 bits)
+ * @param indices Array receiving the indices, room for every set bit of the words
+ * @return The number of indices written
+ */
+inline uint64_t bitset_extract_indices32_buffer_portable(const uint64_t* const words, const uint64_t count, const uint32_t base, uint32_t* const indices)
+{
+    uint64_t written = 0;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        for (uint64_t word = *(words + i); word; word &= word - 1)
+            *(indices + written++) = (uint32_t)(base + i * 64 + bitset_ctz64(word));
+    }
+    return written;
+}
+
+#ifdef BITSET_X86_DISPATCH
+
+/**
+ * Writes the indices of the set bits using AVX-512 compression, every byte of a word turns into up to 8 indices with one
+ * compress and one masked store (nothing is written past the last index)
+ * @param words Pointer to the bits as 64-bit words, bit i is bit i % 64 of word i / 64
+ * @param count Number of words
+ * @param base Value added to every index
+ * @param indices Array receiving the indices, room for every set bit of the words
+ * @return The number of indices written
+ */
+BITSET_TARGET("avx512f") inline uint64_t bitset_extract_indices_buffer_avx512(const uint64_t* const words, const uint64_t count, const uint64_t base, uint64_t* const indices)
+{
+    const __m512i lanes = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7), step = _mm512_set1_epi64(8);
+    uint64_t written = 0;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint64_t word = *(words + i);
+        __m512i position = _mm512_add_epi64(_mm512_set1_epi64((long long)(base + i * 64)), lanes);
+        for (; word; word >>= 8, position = _mm512_add_epi64(position, step))
+        {
+            const __mmask8 mask = (__mmask8)word;
+            const uint64_t found = bitset_popcount64(mask);
+            _mm512_mask_storeu_epi64(indices + written, (__mmask8)((1u << found) - 1), _mm512_maskz_compress_epi64(mask, position));
+            written += found;
+        }
+    }
+    return written;
+}
+
+/**
+ * Writes the indices of the set bits as 32-bit values using AVX-512 compression (16 bits of a word per compress)
+ * @param words Pointer to the bits as 64-bit words, bit i is bit i % 64 of word i / 64
+ * @param count Number of words
+ * @param base Value added to every index (the indices have to fit in 32 bits)
+ * @param indices Array receiving the indices, room for every set bit of the words
+ * @return The number of indices written
+ */
+BITSET_TARGET("avx512f") inline uint64_t bitset_extract_indices32_buffer_avx512(const uint64_t* const words, const uint64_t count, const uint32_t base, uint32_t* const indices)
+{
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), step = _mm512_set1_epi32(16);
+    uint64_t written = 0;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint64_t word = *(words + i);
+        __m512i position = _mm512_add_epi32(_mm512_set1_epi32((int)(uint32_t)(base + i * 64)), lanes);
+        for (; word; word >>= 16, position = _mm512_add_epi32(position, step))
+        {
+            const __mmask16 mask = (__mmask16)word;
+            const uint64_t found = bitset_popcount64(mask);
+            _mm512_mask_storeu_epi32(indices + written, (__mmask16)((1u << found) - 1), _mm512_maskz_compress_epi32(mask, position));
+            written += found;
+        }
+    }
+    return written;
+}
+
+#endif // BITSET_X86_DISPATCH
+
+/**
+ * Writes the indices of the set bits in increasing order (AVX-512 or portable kernel selected at runtime)
+ * @param words Pointer to the bits as 64-bit words, bit i is bit i % 64 of word i / 64
+ * @param count Number of words
+ * @param base Value added to every index
+ * @param indices Array receiving the indices, room for every set bit of the words
+ * @return The number of indices written
+ */
+inline uint64_t bitset_extract_indices_buffer(const uint64_t* const words, const uint64_t count, const uint64_t base, uint64_t* const indices)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (count >= 8 && BITSET_CPU_SUPPORTS("avx512f"))
+        return bitset_extract_indices_buffer_avx512(words, count, base, indices);
+#endif
+    return bitset_extract_indices_buffer_portable(words, count, base, indices);
+}
+
+/**
+ * Writes the indices of the set bits in increasing order as 32-bit values (AVX-512 or portable kernel selected at runtime)
+ * @param words Pointer to the bits as 64-bit words, bit i is bit i % 64 of word i / 64
+ * @param count Number of words
+ * @param base Value added to every index (the indices have to fit in 32 bits)
+ * @param indices Array receiving the indices, room for every set bit of the words
+ * @return The number of indices written
+ */
+inline uint64_t bitset_extract_indices32_buffer(const uint64_t* const words, const uint64_t count, const uint32_t base, uint32_t* const indices)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (count >= 8 && BITSET_CPU_SUPPORTS("avx512f"))
+        return bitset_extract_indices32_buffer_avx512(words, count, base, indices);
+#endif
+    return bitset_extract_indices32_buffer_portable(words, count, base, indices);
+}
+
+/**
+ * Mixes a 64-bit word into a checksum
+ * @param hash The checksum so far
+ * @param word The word to mix in
+ * @return The new checksum
+ */
+inline uint64_t bitset_checksum_mix64(uint64_t hash, const uint64_t word)
+{
+    hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+    return hash ^ hash >> 32;
+}
+
+/**
+ * Calculates a 64-bit checksum of a buffer (used to detect corrupted files, not cryptographically secure)
+ * Four independent lanes keep the multiplications pipelined, the result depends on the byte order of the machine
+ * @param data Pointer to the buffer
+ * @param size Size of the buffer (in bytes)
+ * @param seed Initial value, pass the checksum of the previous buffer to chain buffers
+ * @return The checksum
+ */
+inline uint64_t bitset_checksum_buffer(const void* const data, const uint64_t size, const uint64_t seed)
+{
+    const uint8_t* const bytes = (const uint8_t*)data;
+    uint64_t lanes[4] = { seed, seed + 1, seed + 2, seed + 3 };
+    uint64_t i = 0;
+    for (; i + 32 <= size; i += 32)
+        for (uint64_t j = 0; j < 4; ++j)
+            *(lanes + j) = bitset_checksum_mix64(*(lanes + j), bitset_load64(bytes + i + j * 8));
+    uint64_t hash = bitset_checksum_mix64(bitset_checksum_mix64(bitset_checksum_mix64(*lanes, *(lanes + 1)), *(lanes + 2)), *(lanes + 3));
+    for (; i + 8 <= size; i += 8)
+        hash = bitset_checksum_mix64(hash, bitset_load64(bytes + i));
+    for (; i < size; ++i)
+        hash = bitset_checksum_mix64(hash, *(bytes + i));
+    return bitset_checksum_mix64(hash, size);
+}
@@ -0,0 +1,638 @@
+#pragma once
+
+#include "BitSetParallel.h"
+
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+#include <sys/syscall.h>
+#if defined(SYS_mbind) && defined(SYS_sched_getaffinity) && defined(SYS_sched_setaffinity)
+/**
+ * Defined when the memory and the threads can be placed on NUMA nodes (Linux, through the raw system calls so libnuma is not needed)
+ */
+#define BITSET_NUMA_LINUX 1
+#endif
+#endif
+
+/**
+ * Maximum number of NUMA nodes (a node mask is a single 64-bit word)
+ */
+#define BITSET_NUMA_MAX_NODES 64u
+
+/**
+ * Maximum number of CPUs a thread can be bound to
+ */
+#ifndef BITSET_NUMA_MAX_CPUS
+#define BITSET_NUMA_MAX_CPUS 1024u
+#endif
+
+/**
+ * Number of 64-bit words of a CPU mask
+ */
+#define BITSET_NUMA_CPU_WORDS (BITSET_NUMA_MAX_CPUS / 64u)
+
+/**
+ * Preferred memory policy of mbind, the pages go to the node and fall back to the other nodes when it runs out of memory
+ */
+#define BITSET_NUMA_MPOL_PREFERRED 1
+
+/**
+ * NUMA nodes of the machine and their CPUs (for C API NUMA bitset)
+ */
+typedef struct
+{
+    /**
+     * Number of nodes (highest online node + 1, 1 on machines or systems without NUMA)
+     */
+    uint64_t node_count;
+    /**
+     * CPUs of every node, empty for nodes without CPUs (or when the CPUs are unknown, the threads are then not bound)
+     */
+    uint64_t cpus[BITSET_NUMA_MAX_NODES][BITSET_NUMA_CPU_WORDS];
+} BitSetNumaTopology;
+
+/**
+ * A dynamic bitset split into one segment per NUMA node (for C API NUMA bitset)
+ * The blocks are a single mapping, so the bitset works with the whole DynamicBitSet API, but the pages of segment i are
+ * bound to node i and first touched by threads running on it. Segments are page aligned and as equal as possible,
+ * bitset_numa_parallel_* run every chunk on a thread of the node holding it.
+ * Resizing moves the blocks to the heap and gives up the placement
+ */
+typedef struct
+{
+    /**
+     * The bits (destroy with bitset_numa_destroy)
+     */
+    DynamicBitSet bitset;
+    /**
+     * Topology the segments are placed on, has to outlive the bitset
+     */
+    const BitSetNumaTopology* topology;
+    /**
+     * Number of blocks of a segment, only the last one can be shorter (a multiple of the page size)
+     */
+    uint64_t segment_blocks;
+    /**
+     * Number of segments, segment i lives on node i (at most the number of nodes, fewer for small bitsets)
+     */
+    uint64_t segment_count;
+} NumaBitSet;
+
+/**
+ * State shared by the tasks of a parallel operation on a NUMA bitset
+ */
+typedef struct
+{
+    /**
+     * The operation, run on ranges of blocks
+     */
+    BitSetParallelJob* job;
+    /**
+     * Bitset whose segments decide where the chunks run
+     */
+    const NumaBitSet* layout;
+    /**
+     * Index of the next chunk of every segment
+     */
+    volatile uint64_t next_chunks[BITSET_NUMA_MAX_NODES];
+} BitSetNumaJob;
+
+/**
+ * A thread pool binding every worker to a node (worker w runs on node w % node_count), e.g. for the sieve
+ * Pass &pool.pool to the functions taking a BitSetThreadPool, the pool must not be moved after bitset_numa_pool_init
+ */
+typedef struct
+{
+    /**
+     * The pool, its run function binds the workers and runs them on the default pool
+     */
+    BitSetThreadPool pool;
+    /**
+     * Topology the workers are bound to, has to outlive the pool
+     */
+    const BitSetNumaTopology* topology;
+} BitSetNumaPool;
+
+/**
+ * A task wrapped by a BitSetNumaPool
+ */
+typedef struct
+{
+    /**
+     * The wrapped task
+     */
+    bitset_task task;
+    /**
+     * Argument of the wrapped task
+     */
+    void* argument;
+    /**
+     * Topology the workers are bound to
+     */
+    const BitSetNumaTopology* topology;
+} BitSetNumaPoolJob;
+
+inline uint64_t bitset_numa_parse_list(const char* text, uint64_t* const mask, const uint64_t bits);
+inline bool bitset_numa_read_file(const char* const path, char* const buffer, const uint64_t size);
+inline bool bitset_numa_topology_init(BitSetNumaTopology* const topology);
+inline uint64_t bitset_numa_page_size(void);
+inline bool bitset_numa_bind_thread(const BitSetNumaTopology* const topology, const uint64_t node, uint64_t* const previous);
+inline void bitset_numa_restore_thread(const uint64_t* const previous);
+inline bool bitset_numa_bind_memory(void* const memory, const uint64_t size, const uint64_t node);
+inline void bitset_numa_init(NumaBitSet* const bitset, const uint64_t size, const BitSetNumaTopology* const topology, const BitSetThreadPool* const pool);
+inline void bitset_numa_destroy(NumaBitSet* const bitset);
+inline uint64_t bitset_numa_node_of(const NumaBitSet* const bitset, const uint64_t index);
+inline uint64_t bitset_numa_segment_begin(const NumaBitSet* const bitset, const uint64_t node);
+inline uint64_t bitset_numa_segment_end(const NumaBitSet* const bitset, const uint64_t node);
+inline void bitset_numa_task(void* const argument, const uint64_t task, const uint64_t worker);
+inline void bitset_numa_parallel_run(BitSetParallelJob* const job, const NumaBitSet* const layout, const BitSetThreadPool* const pool);
+inline uint64_t bitset_numa_parallel_count(const NumaBitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline void bitset_numa_parallel_fill_all(NumaBitSet* const bitset, const bool value, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline void bitset_numa_parallel_flip_all(NumaBitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline bool bitset_numa_parallel_any(const NumaBitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline void bitset_numa_parallel_copy(NumaBitSet* const destination, const BitSet* const source, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline void bitset_numa_parallel_apply_operation(NumaBitSet* const destination, const BitSet* const first, const BitSet* const second, const BitSetOperation operation, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline uint64_t bitset_numa_parallel_apply_operation_count(const NumaBitSet* const first, const BitSet* const second, const BitSetOperation operation, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline void bitset_numa_pool_task(void* const argument, const uint64_t task, const uint64_t worker);
+inline void bitset_numa_pool_run(const BitSetThreadPool* const pool, const uint64_t task_count, bitset_task task, void* const argument);
+inline void bitset_numa_pool_init(BitSetNumaPool* const pool, const BitSetNumaTopology* const topology, const uint64_t worker_count);
+
+/**
+ * Parses a list of the sysfs format ("0-3,8,10-11")
+ * @param text The list
+ * @param mask Mask receiving the listed values, values of at least bits are ignored (may be NULL)
+ * @param bits Number of bits of the mask
+ * @return The highest listed value + 1, 0 for an empty list
+ */
+inline uint64_t bitset_numa_parse_list(const char* text, uint64_t* const mask, const uint64_t bits)
+{
+    uint64_t end = 0;
+    while (*text >= '0' && *text <= '9')
+    {
+        uint64_t first = 0, last;
+        while (*text >= '0' && *text <= '9')
+            first = first * 10 + (uint64_t)(*text++ - '0');
+        last = first;
+        if (*text == '-')
+        {
+            last = 0;
+            ++text;
+            while (*text >= '0' && *text <= '9')
+                last = last * 10 + (uint64_t)(*text++ - '0');
+        }
+        for (uint64_t i = first; i <= last && i < bits; ++i)
+        {
+            if (mask)
+                *(mask + i / 64) |= (uint64_t)1u << i % 64;
+        }
+        if (last + 1 > end)
+            end = last + 1;
+        if (*text != ',')
+            break;
+        ++text;
+    }
+    return end;
+}
+
+/**
+ * Reads a small text file (e.g. of sysfs)
+ * @param path Path of the file
+ * @param buffer Buffer receiving the text, terminated by a null character
+ * @param size Size of the buffer in bytes
+ * @return true on success, false if the file could not be read
+ */
+inline bool bitset_numa_read_file(const char* const path, char* const buffer, const uint64_t size)
+{
+    FILE* const file = fopen(path, "r");
+    if (!file)
+        return false;
+    const size_t read = fread(buffer, 1, (size_t)size - 1, file);
+    fclose(file);
+    *(buffer + read) = '\0';
+    return read != 0;
+}
+
+/**
+ * Detects the NUMA nodes and their CPUs (from /sys/devices/system/node on Linux)
+ * @param topology Pointer to topology to initialize
+ * @return true if the nodes were detected, false if the system provides no NUMA information (a single node is assumed)
+ * @memberof BitSetNumaTopology
+ */
+inline bool bitset_numa_topology_init(BitSetNumaTopology* const topology)
+{
+    memset(topology, 0, sizeof(BitSetNumaTopology));
+    topology->node_count = 1;
+#ifdef BITSET_NUMA_LINUX
+    char text[4096];
+    if (!bitset_numa_read_file("/sys/devices/system/node/online", text, sizeof(text)))
+        return false;
+    const uint64_t count = bitset_numa_parse_list(text, NULL, 0);
+    topology->node_count = count < 1 ? 1 : count < BITSET_NUMA_MAX_NODES ? count : BITSET_NUMA_MAX_NODES;
+    for (uint64_t node = 0; node < topology->node_count; ++node)
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%llu/cpulist", (unsigned long long)node);
+        if (bitset_numa_read_file(path, text, sizeof(text)))
+            bitset_numa_parse_list(text, *(topology->cpus + node), BITSET_NUMA_MAX_CPUS);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @return The size of a memory page in bytes
+ */
+inline uint64_t bitset_numa_page_size(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    const long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? (uint64_t)size : 4096u;
+#endif
+}
+
+/**
+ * Binds the calling thread to the CPUs of a node
+ * @param topology Pointer to the topology
+ * @param node The node (node index)
+ * @param previous Receives the CPUs the thread was bound to, BITSET_NUMA_CPU_WORDS words (for bitset_numa_restore_thread)
+ * @return true if the thread was bound, false if the node has no known CPUs or binding is not supported
+ */
+inline bool bitset_numa_bind_thread(const BitSetNumaTopology* const topology, const uint64_t node, uint64_t* const previous)
+{
+#ifdef BITSET_NUMA_LINUX
+    if (node >= topology->node_count)
+        return false;
+    const uint64_t* const cpus = *(topology->cpus + node);
+    bool empty = true;
+    for (uint64_t i = 0; i < BITSET_NUMA_CPU_WORDS; ++i)
+        empty &= !*(cpus + i);
+    if (empty || syscall(SYS_sched_getaffinity, 0, BITSET_NUMA_CPU_WORDS * sizeof(uint64_t), previous) < 0)
+        return false;
+    return syscall(SYS_sched_setaffinity, 0, BITSET_NUMA_CPU_WORDS * sizeof(uint64_t), cpus) == 0;
+#else
+    (void)topology;
+    (void)node;
+    (void)previous;
+    return false;
+#endif
+}
+
+/**
+ * Restores the CPUs of the calling thread after bitset_numa_bind_thread
+ * @param previous The CPUs returned by bitset_numa_bind_thread
+ */
+inline void bitset_numa_restore_thread(const uint64_t* const previous)
+{
+#ifdef BITSET_NUMA_LINUX
+    syscall(SYS_sched_setaffinity, 0, BITSET_NUMA_CPU_WORDS * sizeof(uint64_t), previous);
+#else
+    (void)previous;
+#endif
+}
+
+/**
+ * Binds memory to a node, its pages are allocated on the node when they are first touched
+ * @param memory Start of the memory, page aligned
+ * @param size Size of the memory in bytes
+ * @param node The node (node index)
+ * @return true if the memory was bound, false if binding is not supported (or the kernel has no NUMA support)
+ */
+inline bool bitset_numa_bind_memory(void* const memory, const uint64_t size, const uint64_t node)
+{
+#ifdef BITSET_NUMA_LINUX
+    const uint64_t mask = (uint64_t)1u << node % BITSET_NUMA_MAX_NODES;
+    return syscall(SYS_mbind, memory, size, BITSET_NUMA_MPOL_PREFERRED, &mask, BITSET_NUMA_MAX_NODES + 1, 0) == 0;
+#else
+    (void)memory;
+    (void)size;
+    (void)node;
+    return false;
+#endif
+}
+
+/**
+ * Size initialization, the segments are bound to their nodes and first touched (cleared) by threads running on them
+ * Without NUMA support the blocks are allocated on the heap, the segments still decide how the parallel operations split the work
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset (bit size)
+ * @param topology Pointer to topology to place the segments on, it has to outlive the bitset
+ * @param pool Pointer to thread pool that clears the segments (NULL to clear them on the calling thread, the pages still go to their nodes)
+ * @memberof NumaBitSet
+ */
+inline void bitset_numa_init(NumaBitSet* const bitset, const uint64_t size, const BitSetNumaTopology* const topology, const BitSetThreadPool* const pool)
+{
+    const uint64_t storage_size = bitset_calculate_storage_size(size);
+    const uint64_t page = bitset_numa_page_size();
+    const uint64_t page_blocks = page / sizeof(bitset_block_t) ? page / sizeof(bitset_block_t) : 1;
+    const uint64_t segment_blocks = (storage_size + topology->node_count - 1) / topology->node_count;
+    bitset->topology = topology;
+    bitset->segment_blocks = segment_blocks ? (segment_blocks + page_blocks - 1) / page_blocks * page_blocks : page_blocks;
+    bitset->segment_count = (storage_size + bitset->segment_blocks - 1) / bitset->segment_blocks;
+#ifdef BITSET_NUMA_LINUX
+    const uint64_t bytes = (storage_size * sizeof(bitset_block_t) + page - 1) / page * page;
+    void* const memory = bytes ? mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+    if (memory != MAP_FAILED)
+    {
+        const uint64_t segment_bytes = bitset->segment_blocks * sizeof(bitset_block_t);
+        for (uint64_t segment = 0; segment < bitset->segment_count; ++segment)
+            bitset_numa_bind_memory((uint8_t*)memory + segment * segment_bytes, bytes - segment * segment_bytes < segment_bytes ? bytes - segment * segment_bytes : segment_bytes, segment);
+        bitset->bitset.data = (bitset_block_t*)memory;
+        bitset->bitset.size = size;
+        bitset->bitset.storage_size = bitset->bitset.capacity = storage_size;
+        bitset->bitset.mapping = memory;
+        bitset->bitset.mapping_size = bytes;
+        bitset->bitset.allocator = NULL;
+        bitset->bitset.alignment = page;
+        bitset_numa_parallel_fill_all(bitset, false, pool, NULL);
+        return;
+    }
+#else
+    (void)pool;
+#endif
+    bitset_dynamic_init_allocator(&bitset->bitset, size, NULL, BITSET_CACHE_LINE);
+}
+
+/**
+ * Destroys the bitset (unmaps the segments)
+ * @param bitset Pointer to bitset to destroy
+ * @memberof NumaBitSet
+ */
+inline void bitset_numa_destroy(NumaBitSet* const bitset)
+{
+    bitset_dynamic_destroy(&bitset->bitset);
+    bitset->segment_count = 0;
+}
+
+/**
+ * Gets the node holding a bit
+ * @param bitset Pointer to bitset
+ * @param index The index of the bit (bit index)
+ * @return The node holding the bit (node index)
+ * @memberof NumaBitSet
+ */
+inline uint64_t bitset_numa_node_of(const NumaBitSet* const bitset, const uint64_t index)
+{
+    return index / BITSET_BLOCK_BITS / bitset->segment_blocks;
+}
+
+/**
+ * Gets the first bit held by a node
+ * @param bitset Pointer to bitset
+ * @param node The node (node index)
+ * @return Index of the first bit of the segment of the node (bit index, inclusive), the size if the node holds no bits
+ * @memberof NumaBitSet
+ */
+inline uint64_t bitset_numa_segment_begin(const NumaBitSet* const bitset, const uint64_t node)
+{
+    return node < bitset->segment_count ? node * bitset->segment_blocks * BITSET_BLOCK_BITS : bitset->bitset.size;
+}
+
+/**
+ * Gets the end of the bits held by a node
+ * @param bitset Pointer to bitset
+ * @param node The node (node index)
+ * @return Index after the last bit of the segment of the node (bit index, exclusive), the size if the node holds no bits
+ * @memberof NumaBitSet
+ */
+inline uint64_t bitset_numa_segment_end(const NumaBitSet* const bitset, const uint64_t node)
+{
+    const uint64_t end = (node + 1) * bitset->segment_blocks * BITSET_BLOCK_BITS;
+    return node < bitset->segment_count && end < bitset->bitset.size ? end : bitset->bitset.size;
+}
+
+/**
+ * Task of a parallel operation on a NUMA bitset, binds itself to its home node (task % segment_count) and processes
+ * the chunks of the home segment, then helps with the chunks left in the other segments
+ * @param argument Pointer to the BitSetNumaJob
+ * @param task Index of the task
+ * @param worker Index of the worker (unused)
+ */
+inline void bitset_numa_task(void* const argument, const uint64_t task, const uint64_t worker)
+{
+    (void)worker;
+    BitSetNumaJob* const numa = (BitSetNumaJob*)argument;
+    BitSetParallelJob* const job = numa->job;
+    const NumaBitSet* const layout = numa->layout;
+    const uint64_t home = task % layout->segment_count;
+    uint64_t previous[BITSET_NUMA_CPU_WORDS];
+    const bool bound = bitset_numa_bind_thread(layout->topology, home, previous);
+    for (uint64_t i = 0; i < layout->segment_count; ++i)
+    {
+        const uint64_t segment = (home + i) % layout->segment_count;
+        const uint64_t begin = segment * layout->segment_blocks;
+        const uint64_t end = begin + layout->segment_blocks < job->storage_size ? begin + layout->segment_blocks : job->storage_size;
+        for (uint64_t chunk = bitset_atomic_fetch_add(numa->next_chunks + segment, 1); begin + chunk * job->chunk_blocks < end; chunk = bitset_atomic_fetch_add(numa->next_chunks + segment, 1))
+            bitset_parallel_process(job, begin + chunk * job->chunk_blocks, end - begin - chunk * job->chunk_blocks < job->chunk_blocks ? end : begin + (chunk + 1) * job->chunk_blocks);
+    }
+    if (bound)
+        bitset_numa_restore_thread(previous);
+}
+
+/**
+ * Runs a parallel job with the chunks split along the segments of a NUMA bitset, at least one task per node
+ * Chunks start at segment boundaries, which are page aligned, so writers never share a cache line
+ * @param job Pointer to the job to run (the blocks it processes have the layout of the NUMA bitset)
+ * @param layout Pointer to bitset whose segments decide where the chunks run
+ * @param pool Pointer to thread pool to use (may be NULL)
+ */
+inline void bitset_numa_parallel_run(BitSetParallelJob* const job, const NumaBitSet* const layout, const BitSetThreadPool* const pool)
+{
+    const uint64_t worker_count = bitset_thread_pool_worker_count(pool);
+    if (worker_count == 1 || !layout->segment_count || job->storage_size * sizeof(bitset_block_t) < BITSET_PARALLEL_THRESHOLD)
+    {
+        bitset_parallel_process(job, 0, job->storage_size);
+        return;
+    }
+    BitSetNumaJob numa;
+    numa.job = job;
+    numa.layout = layout;
+    for (uint64_t i = 0; i < BITSET_NUMA_MAX_NODES; ++i)
+        *(numa.next_chunks + i) = 0;
+    job->chunk_blocks = BITSET_PARALLEL_CHUNK_BYTES / sizeof(bitset_block_t);
+    bitset_thread_pool_run(pool, worker_count > layout->segment_count ? worker_count : layout->segment_count, bitset_numa_task, &numa);
+}
+
+/**
+ * Counts the set bits in parallel, every segment is counted on its node
+ * @param bitset Pointer to bitset to count
+ * @param pool Pointer to thread pool to use (NULL to count on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the result is partial (may be NULL)
+ * @return The number of set bits
+ * @memberof NumaBitSet
+ */
+inline uint64_t bitset_numa_parallel_count(const NumaBitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_COUNT, bitset->bitset.size, bitset->bitset.storage_size, cancel);
+    job.first = UNIVERSAL_BITSET(&bitset->bitset);
+    bitset_numa_parallel_run(&job, bitset, pool);
+    return job.result;
+}
+
+/**
+ * Fills the bitset with a specified value in parallel, every segment is filled on its node
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the bitset with
+ * @param pool Pointer to thread pool to use (NULL to fill on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the bitset is partially filled (may be NULL)
+ * @memberof NumaBitSet
+ */
+inline void bitset_numa_parallel_fill_all(NumaBitSet* const bitset, const bool value, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_FILL, bitset->bitset.size, bitset->bitset.storage_size, cancel);
+    job.destination = UNIVERSAL_BITSET(&bitset->bitset);
+    job.first = UNIVERSAL_BITSET(&bitset->bitset);
+    job.value = value;
+    bitset_numa_parallel_run(&job, bitset, pool);
+}
+
+/**
+ * Flips all the bits in parallel, every segment is flipped on its node
+ * @param bitset Pointer to bitset to modify
+ * @param pool Pointer to thread pool to use (NULL to flip on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the bitset is partially flipped (may be NULL)
+ * @memberof NumaBitSet
+ */
+inline void bitset_numa_parallel_flip_all(NumaBitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_FLIP, bitset->bitset.size, bitset->bitset.storage_size, cancel);
+    job.destination = UNIVERSAL_BITSET(&bitset->bitset);
+    job.first = UNIVERSAL_BITSET(&bitset->bitset);
+    bitset_numa_parallel_run(&job, bitset, pool);
+}
+
+/**
+ * Checks if any of the bits are set in parallel, the remaining chunks are skipped as soon as a set bit is found
+ * @param bitset Pointer to bitset to check
+ * @param pool Pointer to thread pool to use (NULL to check on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the result only covers the checked chunks (may be NULL)
+ * @return True if any of the bits are set, false otherwise
+ * @memberof NumaBitSet
+ */
+inline bool bitset_numa_parallel_any(const NumaBitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_ANY, bitset->bitset.size, bitset->bitset.storage_size, cancel);
+    job.first = UNIVERSAL_BITSET(&bitset->bitset);
+    bitset_numa_parallel_run(&job, bitset, pool);
+    return job.result != 0;
+}
+
+/**
+ * Copies the data from a bitset in parallel (the blocks common to both bitsets), every segment of the destination is written on its node
+ * @param destination Pointer to bitset to copy to
+ * @param source Pointer to bitset to copy from
+ * @param pool Pointer to thread pool to use (NULL to copy on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the copy is partial (may be NULL)
+ * @memberof NumaBitSet
+ */
+inline void bitset_numa_parallel_copy(NumaBitSet* const destination, const BitSet* const source, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    const uint64_t storage_size = destination->bitset.storage_size < source->storage_size ? destination->bitset.storage_size : source->storage_size;
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_COPY, storage_size * BITSET_BLOCK_BITS, storage_size, cancel);
+    job.destination = UNIVERSAL_BITSET(&destination->bitset);
+    job.first = source;
+    bitset_numa_parallel_run(&job, destination, pool);
+}
+
+/**
+ * Applies the bitwise operation to two bitsets in parallel (the blocks common to all the bitsets, like bitset_apply_operation)
+ * Every segment of the destination is written on its node, operands of the same size created with the same topology share the layout
+ * @param destination Pointer to bitset receiving the result (may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param operation The operation to apply
+ * @param pool Pointer to thread pool to use (NULL to apply on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the result is partial (may be NULL)
+ * @memberof NumaBitSet
+ */
+inline void bitset_numa_parallel_apply_operation(NumaBitSet* const destination, const BitSet* const first, const BitSet* const second, const BitSetOperation operation, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    uint64_t storage_size = first->storage_size < second->storage_size ? first->storage_size : second->storage_size;
+    if (destination->bitset.storage_size < storage_size)
+        storage_size = destination->bitset.storage_size;
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_OPERATION, storage_size * BITSET_BLOCK_BITS, storage_size, cancel);
+    job.destination = UNIVERSAL_BITSET(&destination->bitset);
+    job.first = first;
+    job.second = second;
+    job.operation = operation;
+    bitset_numa_parallel_run(&job, destination, pool);
+}
+
+/**
+ * Counts the set bits in the result of the bitwise operation in parallel without storing it, every segment of the first operand is read on its node
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param operation The operation to apply
+ * @param pool Pointer to thread pool to use (NULL to count on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the result is partial (may be NULL)
+ * @return The number of set bits in the result within the smaller of the sizes
+ * @memberof NumaBitSet
+ */
+inline uint64_t bitset_numa_parallel_apply_operation_count(const NumaBitSet* const first, const BitSet* const second, const BitSetOperation operation, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    const uint64_t size = first->bitset.size < second->size ? first->bitset.size : second->size;
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_OPERATION_COUNT, size, bitset_calculate_storage_size(size), cancel);
+    job.first = UNIVERSAL_BITSET(&first->bitset);
+    job.second = second;
+    job.operation = operation;
+    bitset_numa_parallel_run(&job, first, pool);
+    return job.result;
+}
+
+/**
+ * Task of a BitSetNumaPool, binds the worker to its node for the duration of the wrapped task
+ * @param argument Pointer to the BitSetNumaPoolJob
+ * @param task Index of the task
+ * @param worker Index of the worker (selects the node)
+ */
+inline void bitset_numa_pool_task(void* const argument, const uint64_t task, const uint64_t worker)
+{
+    const BitSetNumaPoolJob* const job = (const BitSetNumaPoolJob*)argument;
+    uint64_t previous[BITSET_NUMA_CPU_WORDS];
+    const bool bound = bitset_numa_bind_thread(job->topology, worker % job->topology->node_count, previous);
+    job->task(job->argument, task, worker);
+    if (bound)
+        bitset_numa_restore_thread(previous);
+}
+
+/**
+ * Run function of the BitSetNumaPool, runs the tasks on the default pool with every worker bound to its node
+ * @param pool Pointer to the pool member of a BitSetNumaPool
+ * @param task_count Number of tasks to run
+ * @param task The task to run
+ * @param argument Argument passed to the task
+ * @memberof BitSetNumaPool
+ */
+inline void bitset_numa_pool_run(const BitSetThreadPool* const pool, const uint64_t task_count, bitset_task task, void* const argument)
+{
+    BitSetNumaPoolJob job;
+    job.task = task;
+    job.argument = argument;
+    job.topology = ((const BitSetNumaPool*)pool->context)->topology;
+    bitset_thread_pool_run_default(pool, task_count, bitset_numa_pool_task, &job);
+}
+
+/**
+ * Initializes a pool binding its workers to the nodes, so the memory a worker allocates and first touches itself (e.g. the windows of the sieve, allocated by the first task of every worker) stays on its node
+ * @param pool Pointer to pool to initialize
+ * @param topology Pointer to topology to bind the workers to, it has to outlive the pool
+ * @param worker_count Number of workers, 0 to use all the hardware threads
+ * @memberof BitSetNumaPool
+ */
+inline void bitset_numa_pool_init(BitSetNumaPool* const pool, const BitSetNumaTopology* const topology, const uint64_t worker_count)
+{
+    bitset_thread_pool_init(&pool->pool, worker_count);
+    pool->pool.run = bitset_numa_pool_run;
+    pool->pool.context = pool;
+    pool->topology = topology;
+}
@@ -0,0 +1,451 @@
+#pragma once
+
+#include "BitSet.h"
+#include "BitSetThreadPool.h"
+
+/**
+ * Number of bytes processed by a single task, chunk boundaries are aligned to cache lines so writers never share a line
+ */
+#ifndef BITSET_PARALLEL_CHUNK_BYTES
+#define BITSET_PARALLEL_CHUNK_BYTES (1u << 20)
+#endif
+
+/**
+ * Smallest bitset (in bytes) processed in parallel, smaller bitsets are not worth starting the threads for
+ */
+#ifndef BITSET_PARALLEL_THRESHOLD
+#define BITSET_PARALLEL_THRESHOLD (4u << 20)
+#endif
+
+/**
+ * Cache line size assumed for aligning the chunks
+ */
+#define BITSET_CACHE_LINE 64u
+
+/**
+ * Operation run by a parallel job
+ */
+typedef enum
+{
+    BITSET_PARALLEL_COUNT,
+    BITSET_PARALLEL_FILL,
+    BITSET_PARALLEL_FLIP,
+    BITSET_PARALLEL_ANY,
+    BITSET_PARALLEL_ALL,
+    BITSET_PARALLEL_COPY,
+    BITSET_PARALLEL_OPERATION,
+    BITSET_PARALLEL_OPERATION_COUNT
+} BitSetParallelKind;
+
+/**
+ * State shared by the tasks of a parallel operation (for C API parallel bitset)
+ */
+typedef struct
+{
+    /**
+     * Operation to run
+     */
+    BitSetParallelKind kind;
+    /**
+     * Bitset written by the operation (fill, flip, copy, operation)
+     */
+    BitSet* destination;
+    /**
+     * First bitset read by the operation
+     */
+    const BitSet* first;
+    /**
+     * Second bitset read by the operation (operation, operation count)
+     */
+    const BitSet* second;
+    /**
+     * Number of bits processed
+     */
+    uint64_t size;
+    /**
+     * Number of blocks processed
+     */
+    uint64_t storage_size;
+    /**
+     * Number of blocks in the first chunk before the first cache line boundary
+     */
+    uint64_t head;
+    /**
+     * Number of blocks in a chunk
+     */
+    uint64_t chunk_blocks;
+    /**
+     * Bitwise operation (operation, operation count)
+     */
+    BitSetOperation operation;
+    /**
+     * Fill value (fill)
+     */
+    bool value;
+    /**
+     * Cancellation flag of the caller (may be NULL)
+     */
+    const volatile bool* cancel;
+    /**
+     * Set bits counted so far (count, operation count) or 1 once a predicate is decided (any, all)
+     */
+    volatile uint64_t result;
+} BitSetParallelJob;
+
+inline bool bitset_parallel_cancelled(const volatile bool* const cancel);
+inline uint64_t bitset_parallel_chunk_count(BitSetParallelJob* const job, const void* const data, const BitSetThreadPool* const pool);
+inline DynamicBitSet bitset_parallel_view(const BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t size);
+inline void bitset_parallel_process(BitSetParallelJob* const job, const uint64_t begin, const uint64_t end);
+inline void bitset_parallel_task(void* const argument, const uint64_t task, const uint64_t worker);
+inline void bitset_parallel_run(BitSetParallelJob* const job, const void* const data, const BitSetThreadPool* const pool);
+inline void bitset_parallel_job_init(BitSetParallelJob* const job, const BitSetParallelKind kind, const uint64_t size, const uint64_t storage_size, const volatile bool* const cancel);
+inline uint64_t bitset_parallel_count(const BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline void bitset_parallel_fill_all(BitSet* const bitset, const bool value, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline void bitset_parallel_clear_all(BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline void bitset_parallel_set_all(BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline void bitset_parallel_flip_all(BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline bool bitset_parallel_any(const BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline bool bitset_parallel_all(const BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline bool bitset_parallel_none(const BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline void bitset_parallel_copy(BitSet* const destination, const BitSet* const source, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline void bitset_parallel_apply_operation(BitSet* const destination, const BitSet* const first, const BitSet* const second, const BitSetOperation operation, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+inline uint64_t bitset_parallel_apply_operation_count(const BitSet* const first, const BitSet* const second, const BitSetOperation operation, const BitSetThreadPool* const pool, const volatile bool* const cancel);
+
+/**
+ * @param cancel Cancellation flag (may be NULL)
+ * @return true if the flag is set
+ */
+inline bool bitset_parallel_cancelled(const volatile bool* const cancel)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return cancel && __atomic_load_n(cancel, __ATOMIC_RELAXED);
+#else
+    return cancel && *cancel;
+#endif
+}
+
+/**
+ * Splits the blocks of the job into chunks starting at cache line boundaries of the data
+ * @param job Pointer to the job to split (storage_size has to be set)
+ * @param data Address of the first block, the boundaries are aligned relative to it
+ * @param pool Pointer to thread pool that runs the job (may be NULL)
+ * @return Number of chunks (the first one ends at the first cache line boundary), 1 if the job should run on the calling thread
+ */
+inline uint64_t bitset_parallel_chunk_count(BitSetParallelJob* const job, const void* const data, const BitSetThreadPool* const pool)
+{
+    job->chunk_blocks = BITSET_PARALLEL_CHUNK_BYTES / sizeof(bitset_block_t);
+    job->head = (BITSET_CACHE_LINE - (uintptr_t)data % BITSET_CACHE_LINE) % BITSET_CACHE_LINE / sizeof(bitset_block_t);
+    if (bitset_thread_pool_worker_count(pool) == 1 || job->storage_size * sizeof(bitset_block_t) < BITSET_PARALLEL_THRESHOLD)
+    {
+        job->head = job->storage_size;
+        return 1;
+    }
+    return 1 + (job->storage_size - job->head + job->chunk_blocks - 1) / job->chunk_blocks;
+}
+
+/**
+ * Creates a bitset viewing a range of blocks of another bitset (no memory is allocated, the view must not be destroyed)
+ * @param bitset Pointer to the viewed bitset
+ * @param begin First block of the view (block index, inclusive)
+ * @param end Last block of the view (block index, exclusive)
+ * @param size Number of bits of the viewed bitset to include, the view ends at size if it's inside the range (bit size)
+ * @return The view
+ */
+inline DynamicBitSet bitset_parallel_view(const BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t size)
+{
+    DynamicBitSet view;
+    view.data = bitset->data + begin;
+    view.size = (size < end * BITSET_BLOCK_BITS ? size : end * BITSET_BLOCK_BITS) - begin * BITSET_BLOCK_BITS;
+    view.storage_size = view.capacity = end - begin;
+    view.mapping = NULL;
+    view.mapping_size = 0;
+    view.allocator = NULL;
+    view.alignment = BITSET_MALLOC_ALIGNMENT;
+    return view;
+}
+
+/**
+ * Runs the serial operation of a job on the views of a range of blocks
+ * @param job Pointer to the job
+ * @param begin First block of the range (block index, inclusive)
+ * @param end Last block of the range (block index, exclusive)
+ */
+inline void bitset_parallel_process(BitSetParallelJob* const job, const uint64_t begin, const uint64_t end)
+{
+    // early exit of the decided predicates and cancellation, checked once per chunk
+    if (((job->kind == BITSET_PARALLEL_ANY || job->kind == BITSET_PARALLEL_ALL) && bitset_atomic_load(&job->result)) || bitset_parallel_cancelled(job->cancel))
+        return;
+    if (begin >= end)
+        return;
+    DynamicBitSet destination, first, second;
+    if (job->destination)
+        destination = bitset_parallel_view(job->destination, begin, end, job->size);
+    first = bitset_parallel_view(job->first, begin, end, job->size);
+    if (job->second)
+        second = bitset_parallel_view(job->second, begin, end, job->size);
+
+    switch (job->kind)
+    {
+    case BITSET_PARALLEL_COUNT:
+        bitset_atomic_fetch_add(&job->result, bitset_count(UNIVERSAL_BITSET(&first)));
+        break;
+    case BITSET_PARALLEL_FILL:
+        bitset_fill_all(UNIVERSAL_BITSET(&destination), job->value);
+        break;
+    case BITSET_PARALLEL_FLIP:
+        bitset_flip_all(UNIVERSAL_BITSET(&destination));
+        break;
+    case BITSET_PARALLEL_ANY:
+        if (bitset_any(UNIVERSAL_BITSET(&first)))
+            bitset_atomic_fetch_add(&job->result, 1);
+        break;
+    case BITSET_PARALLEL_ALL:
+        if (!bitset_all(UNIVERSAL_BITSET(&first)))
+            bitset_atomic_fetch_add(&job->result, 1);
+        break;
+    case BITSET_PARALLEL_COPY:
+        bitset_copy(UNIVERSAL_BITSET(&destination), UNIVERSAL_BITSET(&first));
+        break;
+    case BITSET_PARALLEL_OPERATION:
+        bitset_apply_operation(UNIVERSAL_BITSET(&destination), UNIVERSAL_BITSET(&first), UNIVERSAL_BITSET(&second), job->operation);
+        break;
+    default:
+        bitset_atomic_fetch_add(&job->result, bitset_apply_operation_count(UNIVERSAL_BITSET(&first), UNIVERSAL_BITSET(&second), job->operation));
+    }
+}
+
+/**
+ * Task of a parallel job, runs the serial operation on the views of a single chunk
+ * @param argument Pointer to the job
+ * @param task Index of the chunk
+ * @param worker Index of the worker (unused)
+ */
+inline void bitset_parallel_task(void* const argument, const uint64_t task, const uint64_t worker)
+{
+    (void)worker;
+    BitSetParallelJob* const job = (BitSetParallelJob*)argument;
+    const uint64_t begin = task ? job->head + (task - 1) * job->chunk_blocks : 0;
+    const uint64_t end = job->head + task * job->chunk_blocks < job->storage_size ? job->head + task * job->chunk_blocks : job->storage_size;
+    bitset_parallel_process(job, begin, end);
+}
+
+/**
+ * Runs the job on the pool, one task per chunk
+ * @param job Pointer to the job to run
+ * @param data Address of the first block written by the job (or read if it writes nothing), the chunks are aligned to its cache lines
+ * @param pool Pointer to thread pool to use (may be NULL)
+ */
+inline void bitset_parallel_run(BitSetParallelJob* const job, const void* const data, const BitSetThreadPool* const pool)
+{
+    const uint64_t chunk_count = bitset_parallel_chunk_count(job, data, pool);
+    bitset_thread_pool_run(pool, chunk_count, bitset_parallel_task, job);
+}
+
+/**
+ * Initializes a parallel job with no operands
+ * @param job Pointer to the job to initialize
+ * @param kind Operation to run
+ * @param size Number of bits to process
+ * @param storage_size Number of blocks to process
+ * @param cancel Cancellation flag (may be NULL)
+ */
+inline void bitset_parallel_job_init(BitSetParallelJob* const job, const BitSetParallelKind kind, const uint64_t size, const uint64_t storage_size, const volatile bool* const cancel)
+{
+    job->kind = kind;
+    job->destination = NULL;
+    job->first = NULL;
+    job->second = NULL;
+    job->size = size;
+    job->storage_size = storage_size;
+    job->head = job->chunk_blocks = 0;
+    job->operation = BITSET_AND;
+    job->value = false;
+    job->cancel = cancel;
+    job->result = 0;
+}
+
+/**
+ * Counts the set bits in parallel
+ * @param bitset Pointer to bitset to count
+ * @param pool Pointer to thread pool to use (NULL to count on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the result is partial (may be NULL)
+ * @return The number of set bits
+ * @memberof BitSet
+ */
+inline uint64_t bitset_parallel_count(const BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_COUNT, bitset->size, bitset->storage_size, cancel);
+    job.first = bitset;
+    bitset_parallel_run(&job, bitset->data, pool);
+    return job.result;
+}
+
+/**
+ * Fills the bitset with a specified value in parallel
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the bitset with
+ * @param pool Pointer to thread pool to use (NULL to fill on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the bitset is partially filled (may be NULL)
+ * @memberof BitSet
+ */
+inline void bitset_parallel_fill_all(BitSet* const bitset, const bool value, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_FILL, bitset->size, bitset->storage_size, cancel);
+    job.destination = bitset;
+    job.first = bitset;
+    job.value = value;
+    bitset_parallel_run(&job, bitset->data, pool);
+}
+
+/**
+ * Clears all the bits in parallel
+ * @param bitset Pointer to bitset to modify
+ * @param pool Pointer to thread pool to use (NULL to clear on the calling thread)
+ * @param cancel Cancellation flag (see bitset_parallel_fill_all, may be NULL)
+ * @memberof BitSet
+ */
+inline void bitset_parallel_clear_all(BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    bitset_parallel_fill_all(bitset, false, pool, cancel);
+}
+
+/**
+ * Sets all the bits in parallel
+ * @param bitset Pointer to bitset to modify
+ * @param pool Pointer to thread pool to use (NULL to set on the calling thread)
+ * @param cancel Cancellation flag (see bitset_parallel_fill_all, may be NULL)
+ * @memberof BitSet
+ */
+inline void bitset_parallel_set_all(BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    bitset_parallel_fill_all(bitset, true, pool, cancel);
+}
+
+/**
+ * Flips all the bits in parallel
+ * @param bitset Pointer to bitset to modify
+ * @param pool Pointer to thread pool to use (NULL to flip on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the bitset is partially flipped (may be NULL)
+ * @memberof BitSet
+ */
+inline void bitset_parallel_flip_all(BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_FLIP, bitset->size, bitset->storage_size, cancel);
+    job.destination = bitset;
+    job.first = bitset;
+    bitset_parallel_run(&job, bitset->data, pool);
+}
+
+/**
+ * Checks if any of the bits are set in parallel, the remaining chunks are skipped as soon as a set bit is found
+ * @param bitset Pointer to bitset to check
+ * @param pool Pointer to thread pool to use (NULL to check on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the result only covers the checked chunks (may be NULL)
+ * @return True if any of the bits are set, false otherwise
+ * @memberof BitSet
+ */
+inline bool bitset_parallel_any(const BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_ANY, bitset->size, bitset->storage_size, cancel);
+    job.first = bitset;
+    bitset_parallel_run(&job, bitset->data, pool);
+    return job.result != 0;
+}
+
+/**
+ * Checks if all the bits are set in parallel, the remaining chunks are skipped as soon as a cleared bit is found
+ * @param bitset Pointer to bitset to check
+ * @param pool Pointer to thread pool to use (NULL to check on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the result only covers the checked chunks (may be NULL)
+ * @return True if all the bits are set, false otherwise
+ * @memberof BitSet
+ */
+inline bool bitset_parallel_all(const BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_ALL, bitset->size, bitset->storage_size, cancel);
+    job.first = bitset;
+    bitset_parallel_run(&job, bitset->data, pool);
+    return job.result == 0;
+}
+
+/**
+ * Checks if none of the bits are set in parallel
+ * @param bitset Pointer to bitset to check
+ * @param pool Pointer to thread pool to use (NULL to check on the calling thread)
+ * @param cancel Cancellation flag (see bitset_parallel_any, may be NULL)
+ * @return True if none of the bits are set, false otherwise
+ * @memberof BitSet
+ */
+inline bool bitset_parallel_none(const BitSet* const bitset, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    return !bitset_parallel_any(bitset, pool, cancel);
+}
+
+/**
+ * Copies the data from one bitset to another in parallel (the blocks common to both bitsets)
+ * @param destination Pointer to bitset to copy to
+ * @param source Pointer to bitset to copy from
+ * @param pool Pointer to thread pool to use (NULL to copy on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the copy is partial (may be NULL)
+ * @memberof BitSet
+ */
+inline void bitset_parallel_copy(BitSet* const destination, const BitSet* const source, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    const uint64_t storage_size = destination->storage_size < source->storage_size ? destination->storage_size : source->storage_size;
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_COPY, storage_size * BITSET_BLOCK_BITS, storage_size, cancel);
+    job.destination = destination;
+    job.first = source;
+    bitset_parallel_run(&job, destination->data, pool);
+}
+
+/**
+ * Applies the bitwise operation to two bitsets in parallel (the blocks common to all the bitsets, like bitset_apply_operation)
+ * @param destination Pointer to bitset receiving the result (may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param operation The operation to apply
+ * @param pool Pointer to thread pool to use (NULL to apply on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the result is partial (may be NULL)
+ * @memberof BitSet
+ */
+inline void bitset_parallel_apply_operation(BitSet* const destination, const BitSet* const first, const BitSet* const second, const BitSetOperation operation, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    uint64_t storage_size = first->storage_size < second->storage_size ? first->storage_size : second->storage_size;
+    if (destination->storage_size < storage_size)
+        storage_size = destination->storage_size;
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_OPERATION, storage_size * BITSET_BLOCK_BITS, storage_size, cancel);
+    job.destination = destination;
+    job.first = first;
+    job.second = second;
+    job.operation = operation;
+    bitset_parallel_run(&job, destination->data, pool);
+}
+
+/**
+ * Counts the set bits in the result of the bitwise operation in parallel without storing it (like bitset_apply_operation_count)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param operation The operation to apply
+ * @param pool Pointer to thread pool to use (NULL to count on the calling thread)
+ * @param cancel Flag checked before every chunk, once set the remaining chunks are skipped and the result is partial (may be NULL)
+ * @return The number of set bits in the result within the smaller of the sizes
+ * @memberof BitSet
+ */
+inline uint64_t bitset_parallel_apply_operation_count(const BitSet* const first, const BitSet* const second, const BitSetOperation operation, const BitSetThreadPool* const pool, const volatile bool* const cancel)
+{
+    const uint64_t size = first->size < second->size ? first->size : second->size;
+    BitSetParallelJob job;
+    bitset_parallel_job_init(&job, BITSET_PARALLEL_OPERATION_COUNT, size, bitset_calculate_storage_size(size), cancel);
+    job.first = first;
+    job.second = second;
+    job.operation = operation;
+    bitset_parallel_run(&job, first->data, pool);
+    return job.result;
+}
@@ -0,0 +1,345 @@
+#pragma once
+
+#include "BitSet.h"
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Number of bits covered by a superblock, every superblock stores the number of set bits before it (64 bits)
+ */
+#define BITSET_RANK_SUPERBLOCK_BITS 4096u
+
+/**
+ * Number of bits covered by a block, every block stores the number of set bits before it within its superblock (16 bits)
+ */
+#define BITSET_RANK_BLOCK_BITS 512u
+
+/**
+ * Every BITSET_SELECT_SAMPLE-th set (and cleared) bit remembers its superblock to narrow down select
+ */
+#define BITSET_SELECT_SAMPLE 8192u
+
+/**
+ * Rank/select index of a bitset (for C API rank/select)
+ * Counts per superblock and block take about 4.7% of the bitset, select samples at most 1.6% more
+ */
+typedef struct
+{
+    /**
+     * The indexed bitset (not owned, every modification has to be followed by bitset_rank_select_update)
+     */
+    const BitSet* bitset;
+    /**
+     * Number of set bits before every superblock, superblock_count + 1 entries (the last one is the total count)
+     */
+    uint64_t* superblocks;
+    /**
+     * Number of set bits before every block within its superblock
+     */
+    uint16_t* blocks;
+    /**
+     * Number of superblocks
+     */
+    uint64_t superblock_count;
+    /**
+     * Superblock of every BITSET_SELECT_SAMPLE-th set bit
+     */
+    uint64_t* select_ones;
+    /**
+     * Number of set bit samples
+     */
+    uint64_t select_one_count;
+    /**
+     * Superblock of every BITSET_SELECT_SAMPLE-th cleared bit
+     */
+    uint64_t* select_zeros;
+    /**
+     * Number of cleared bit samples
+     */
+    uint64_t select_zero_count;
+} BitSetRankSelect;
+
+inline uint64_t bitset_select64(const uint64_t word, uint64_t rank);
+inline void bitset_rank_select_init(BitSetRankSelect* const index, const BitSet* const bitset);
+inline void bitset_rank_select_destroy(BitSetRankSelect* const index);
+inline uint64_t bitset_rank_select_count_superblock(BitSetRankSelect* const index, const uint64_t superblock);
+inline uint64_t bitset_rank_select_zeros_before(const BitSetRankSelect* const index, const uint64_t superblock);
+inline void bitset_rank_select_sample(BitSetRankSelect* const index, const bool value);
+inline void bitset_rank_select_update(BitSetRankSelect* const index, const uint64_t begin, const uint64_t end);
+inline uint64_t bitset_rank1(const BitSetRankSelect* const index, const uint64_t position);
+inline uint64_t bitset_rank0(const BitSetRankSelect* const index, const uint64_t position);
+inline uint64_t bitset_select_value(const BitSetRankSelect* const index, const bool value, uint64_t rank);
+inline uint64_t bitset_select1(const BitSetRankSelect* const index, const uint64_t rank);
+inline uint64_t bitset_select0(const BitSetRankSelect* const index, const uint64_t rank);
+inline uint64_t bitset_rank_select_memory_usage(const BitSetRankSelect* const index);
+
+/**
+ * Finds the set bit of a specified rank in a 64-bit word
+ * @param word The word to search
+ * @param rank Number of set bits before the searched one (lower than the number of set bits in the word)
+ * @return Index of the bit
+ */
+inline uint64_t bitset_select64(const uint64_t word, uint64_t rank)
+{
+#if defined(__BMI2__)
+    return bitset_ctz64(_pdep_u64((uint64_t)1u << rank, word));
+#else
+    // narrow down to the byte, then to the bit
+    uint64_t shift = 0;
+    for (uint64_t count = bitset_popcount64(word & 0xFFu); rank >= count; count = bitset_popcount64((word >> shift) & 0xFFu))
+    {
+        rank -= count;
+        shift += 8;
+    }
+    uint64_t byte = (word >> shift) & 0xFFu;
+    for (; rank; --rank)
+        byte &= byte - 1;
+    return shift + bitset_ctz64(byte);
+#endif
+}
+
+/**
+ * Builds the index of a bitset
+ * @param index Pointer to index to initialize
+ * @param bitset Pointer to bitset to index (BitSet or DynamicBitSet), it has to outlive the index
+ * @memberof BitSetRankSelect
+ */
+inline void bitset_rank_select_init(BitSetRankSelect* const index, const BitSet* const bitset)
+{
+    index->bitset = bitset;
+    index->superblock_count = bitset->size / BITSET_RANK_SUPERBLOCK_BITS + (bitset->size % BITSET_RANK_SUPERBLOCK_BITS ? 1 : 0);
+    index->superblocks = (uint64_t*)malloc((index->superblock_count + 1) * sizeof(uint64_t));
+    index->blocks = (uint16_t*)malloc(index->superblock_count * (BITSET_RANK_SUPERBLOCK_BITS / BITSET_RANK_BLOCK_BITS) * sizeof(uint16_t) + 1);
+    index->select_ones = index->select_zeros = NULL;
+    index->select_one_count = index->select_zero_count = 0;
+    *index->superblocks = 0;
+    for (uint64_t i = 0; i < index->superblock_count; ++i)
+        *(index->superblocks + i + 1) = *(index->superblocks + i) + bitset_rank_select_count_superblock(index, i);
+    bitset_rank_select_sample(index, true);
+    bitset_rank_select_sample(index, false);
+}
+
+/**
+ * Destroys the index (frees the memory)
+ * @param index Pointer to index to destroy
+ * @memberof BitSetRankSelect
+ */
+inline void bitset_rank_select_destroy(BitSetRankSelect* const index)
+{
+    free(index->superblocks);
+    free(index->blocks);
+    free(index->select_ones);
+    free(index->select_zeros);
+}
+
+/**
+ * Recounts the blocks of a superblock
+ * @param index Pointer to index to modify
+ * @param superblock Index of the superblock
+ * @return Number of set bits in the superblock
+ * @memberof BitSetRankSelect
+ */
+inline uint64_t bitset_rank_select_count_superblock(BitSetRankSelect* const index, const uint64_t superblock)
+{
+    uint64_t words[BITSET_RANK_SUPERBLOCK_BITS / 64];
+    bitset_load_words(index->bitset, superblock * (BITSET_RANK_SUPERBLOCK_BITS / 64), words, BITSET_RANK_SUPERBLOCK_BITS / 64);
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < BITSET_RANK_SUPERBLOCK_BITS / BITSET_RANK_BLOCK_BITS; ++i)
+    {
+        *(index->blocks + superblock * (BITSET_RANK_SUPERBLOCK_BITS / BITSET_RANK_BLOCK_BITS) + i) = (uint16_t)count;
+        for (uint64_t j = 0; j < BITSET_RANK_BLOCK_BITS / 64; ++j)
+            count += bitset_popcount64(*(words + i * (BITSET_RANK_BLOCK_BITS / 64) + j));
+    }
+    return count;
+}
+
+/**
+ * @param index Pointer to index
+ * @param superblock Index of the superblock (at most superblock_count)
+ * @return Number of cleared bits before the superblock
+ * @memberof BitSetRankSelect
+ */
+inline uint64_t bitset_rank_select_zeros_before(const BitSetRankSelect* const index, const uint64_t superblock)
+{
+    const uint64_t bits = superblock * BITSET_RANK_SUPERBLOCK_BITS;
+    return (bits < index->bitset->size ? bits : index->bitset->size) - *(index->superblocks + superblock);
+}
+
+/**
+ * Rebuilds the select samples from the superblock counts (doesn't read the bitset)
+ * @param index Pointer to index to modify
+ * @param value true to sample the set bits, false to sample the cleared bits
+ * @memberof BitSetRankSelect
+ */
+inline void bitset_rank_select_sample(BitSetRankSelect* const index, const bool value)
+{
+    const uint64_t total = value ? *(index->superblocks + index->superblock_count) : index->bitset->size - *(index->superblocks + index->superblock_count);
+    const uint64_t count = total / BITSET_SELECT_SAMPLE + (total % BITSET_SELECT_SAMPLE ? 1 : 0);
+    uint64_t* const samples = (uint64_t*)realloc(value ? index->select_ones : index->select_zeros, count * sizeof(uint64_t) + 1);
+    uint64_t superblock = 0;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        // the last superblock whose preceding bits are not more than the sampled rank
+        while (superblock + 1 < index->superblock_count && (value ? *(index->superblocks + superblock + 1) : bitset_rank_select_zeros_before(index, superblock + 1)) <= i * BITSET_SELECT_SAMPLE)
+            ++superblock;
+        *(samples + i) = superblock;
+    }
+    if (value)
+    {
+        index->select_ones = samples;
+        index->select_one_count = count;
+    }
+    else
+    {
+        index->select_zeros = samples;
+        index->select_zero_count = count;
+    }
+}
+
+/**
+ * Updates the index after the bits in a range were modified, only the superblocks overlapping the range are recounted
+ * The size of the bitset must not change (build a new index instead)
+ * @param index Pointer to index to update
+ * @param begin The beginning of the modified range (bit index, inclusive)
+ * @param end The end of the modified range (bit index, exclusive)
+ * @memberof BitSetRankSelect
+ */
+inline void bitset_rank_select_update(BitSetRankSelect* const index, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end || begin >= index->bitset->size)
+        return;
+    const uint64_t first = begin / BITSET_RANK_SUPERBLOCK_BITS;
+    const uint64_t last = (end < index->bitset->size ? end - 1 : index->bitset->size - 1) / BITSET_RANK_SUPERBLOCK_BITS;
+    const uint64_t old_total = *(index->superblocks + last + 1);
+    for (uint64_t i = first; i <= last; ++i)
+        *(index->superblocks + i + 1) = *(index->superblocks + i) + bitset_rank_select_count_superblock(index, i);
+    // the superblocks past the range move by the same difference
+    const uint64_t difference = *(index->superblocks + last + 1) - old_total;
+    for (uint64_t i = last + 2; i <= index->superblock_count; ++i)
+        *(index->superblocks + i) += difference;
+    bitset_rank_select_sample(index, true);
+    bitset_rank_select_sample(index, false);
+}
+
+/**
+ * Counts the set bits before a position in O(1) (a superblock count, a block count and at most 8 words)
+ * @param index Pointer to index to query
+ * @param position The position to count up to (bit index, exclusive, at most the size)
+ * @return Number of set bits in [0, position)
+ * @memberof BitSetRankSelect
+ */
+inline uint64_t bitset_rank1(const BitSetRankSelect* const index, const uint64_t position)
+{
+    if (position >= index->bitset->size)
+        return *(index->superblocks + index->superblock_count);
+    const uint64_t block = position / BITSET_RANK_BLOCK_BITS;
+    uint64_t rank = *(index->superblocks + position / BITSET_RANK_SUPERBLOCK_BITS) + *(index->blocks + block);
+    uint64_t words[BITSET_RANK_BLOCK_BITS / 64];
+    const uint64_t first = block * (BITSET_RANK_BLOCK_BITS / 64), count = position / 64 - first + 1;
+    bitset_load_words(index->bitset, first, words, count);
+    for (uint64_t i = 0; i + 1 < count; ++i)
+        rank += bitset_popcount64(*(words + i));
+    return rank + bitset_popcount64(*(words + count - 1) & (((uint64_t)1u << position % 64) - 1));
+}
+
+/**
+ * Counts the cleared bits before a position in O(1)
+ * @param index Pointer to index to query
+ * @param position The position to count up to (bit index, exclusive, at most the size)
+ * @return Number of cleared bits in [0, position)
+ * @memberof BitSetRankSelect
+ */
+inline uint64_t bitset_rank0(const BitSetRankSelect* const index, const uint64_t position)
+{
+    return (position < index->bitset->size ? position : index->bitset->size) - bitset_rank1(index, position);
+}
+
+/**
+ * Finds the bit with a value of a specified rank
+ * A sample narrows the superblocks to a short binary search, then at most 8 blocks and 8 words are scanned
+ * @param index Pointer to index to query
+ * @param value The value of the searched bit
+ * @param rank Number of bits with the value before the searched one (0 for the first)
+ * @return Index of the bit or BITSET_NPOS if there are not more than rank such bits
+ * @memberof BitSetRankSelect
+ */
+inline uint64_t bitset_select_value(const BitSetRankSelect* const index, const bool value, uint64_t rank)
+{
+    const uint64_t sample = rank / BITSET_SELECT_SAMPLE;
+    if (sample >= (value ? index->select_one_count : index->select_zero_count))
+        return BITSET_NPOS;
+    const uint64_t* const samples = value ? index->select_ones : index->select_zeros;
+    uint64_t low = *(samples + sample);
+    uint64_t high = sample + 1 < (value ? index->select_one_count : index->select_zero_count) ? *(samples + sample + 1) : index->superblock_count - 1;
+    // the last superblock with at most rank bits of the value before it
+    while (low < high)
+    {
+        const uint64_t middle = low + (high - low + 1) / 2;
+        if ((value ? *(index->superblocks + middle) : bitset_rank_select_zeros_before(index, middle)) <= rank)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    rank -= value ? *(index->superblocks + low) : bitset_rank_select_zeros_before(index, low);
+    if (rank >= (value ? *(index->superblocks + low + 1) - *(index->superblocks + low) : bitset_rank_select_zeros_before(index, low + 1) - bitset_rank_select_zeros_before(index, low)))
+        return BITSET_NPOS;
+
+    uint64_t block = low * (BITSET_RANK_SUPERBLOCK_BITS / BITSET_RANK_BLOCK_BITS);
+    const uint64_t block_end = block + BITSET_RANK_SUPERBLOCK_BITS / BITSET_RANK_BLOCK_BITS;
+    for (; block + 1 < block_end && (value ? *(index->blocks + block + 1) : (block + 1 - low * (BITSET_RANK_SUPERBLOCK_BITS / BITSET_RANK_BLOCK_BITS)) * BITSET_RANK_BLOCK_BITS - *(index->blocks + block + 1)) <= rank; ++block)
+        ;
+    rank -= value ? *(index->blocks + block) : (block - low * (BITSET_RANK_SUPERBLOCK_BITS / BITSET_RANK_BLOCK_BITS)) * BITSET_RANK_BLOCK_BITS - *(index->blocks + block);
+
+    uint64_t words[BITSET_RANK_BLOCK_BITS / 64];
+    bitset_load_words(index->bitset, block * (BITSET_RANK_BLOCK_BITS / 64), words, BITSET_RANK_BLOCK_BITS / 64);
+    for (uint64_t i = 0; i < BITSET_RANK_BLOCK_BITS / 64; ++i)
+    {
+        const uint64_t word = value ? *(words + i) : ~*(words + i);
+        const uint64_t count = bitset_popcount64(word);
+        if (rank < count)
+        {
+            const uint64_t position = block * BITSET_RANK_BLOCK_BITS + i * 64 + bitset_select64(word, rank);
+            // cleared bits past the size are read as 0 and must not be found
+            return position < index->bitset->size ? position : BITSET_NPOS;
+        }
+        rank -= count;
+    }
+    return BITSET_NPOS;
+}
+
+/**
+ * Finds the set bit of a specified rank in near O(1)
+ * @param index Pointer to index to query
+ * @param rank Number of set bits before the searched one (0 for the first set bit)
+ * @return Index of the bit or BITSET_NPOS if there are not more than rank set bits
+ * @memberof BitSetRankSelect
+ */
+inline uint64_t bitset_select1(const BitSetRankSelect* const index, const uint64_t rank)
+{
+    return bitset_select_value(index, true, rank);
+}
+
+/**
+ * Finds the cleared bit of a specified rank in near O(1)
+ * @param index Pointer to index to query
+ * @param rank Number of cleared bits before the searched one (0 for the first cleared bit)
+ * @return Index of the bit or BITSET_NPOS if there are not more than rank cleared bits
+ * @memberof BitSetRankSelect
+ */
+inline uint64_t bitset_select0(const BitSetRankSelect* const index, const uint64_t rank)
+{
+    return bitset_select_value(index, false, rank);
+}
+
+/**
+ * @param index Pointer to index
+ * @return Number of bytes allocated by the index
+ * @memberof BitSetRankSelect
+ */
+inline uint64_t bitset_rank_select_memory_usage(const BitSetRankSelect* const index)
+{
+    return (index->superblock_count + 1) * sizeof(uint64_t) + index->superblock_count * (BITSET_RANK_SUPERBLOCK_BITS / BITSET_RANK_BLOCK_BITS) * sizeof(uint16_t) +
+           (index->select_one_count + index->select_zero_count) * sizeof(uint64_t);
+}
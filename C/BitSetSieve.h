@@ -0,0 +1,414 @@
+#pragma once
+
+#include "BitSet.h"
+#include "BitSetThreadPool.h"
+
+/**
+ * Number of bits in a sieve window, each bit stands for one odd number (default fits a 32 KiB L1 data cache)
+ */
+#ifndef BITSET_SIEVE_SEGMENT_BITS
+#define BITSET_SIEVE_SEGMENT_BITS (32768u * 8u)
+#endif
+
+/**
+ * Number of consecutive windows processed by a single task, prime offsets are carried between them
+ */
+#ifndef BITSET_SIEVE_SEGMENTS_PER_TASK
+#define BITSET_SIEVE_SEGMENTS_PER_TASK 8u
+#endif
+
+/**
+ * Alignment of the memory of every worker (its window, offsets and primes), a page so no two workers share one
+ * The memory is allocated and first touched by the first task of the worker, so it lives on the node the worker runs on
+ */
+#ifndef BITSET_SIEVE_WORKER_ALIGNMENT
+#define BITSET_SIEVE_WORKER_ALIGNMENT 4096u
+#endif
+
+/**
+ * Receives the primes found in one window, in ascending order
+ * With more than one worker it's called concurrently and the windows come in any order
+ * @param context The context passed to bitset_sieve_primes
+ * @param primes The primes found in the window
+ * @param count Number of the primes
+ * @param segment Index of the window (windows with lower index contain lower primes)
+ */
+typedef void (*bitset_sieve_callback)(void* const context, const uint64_t* const primes, const uint64_t count, const uint64_t segment);
+
+/**
+ * Segmented sieve of Eratosthenes over odd numbers (for C API sieve)
+ * The range [0, limit] is split into windows of BITSET_SIEVE_SEGMENT_BITS odd numbers, sieved one by one in a cache sized DynamicBitSet
+ */
+typedef struct
+{
+    /**
+     * Upper limit of the sieve (inclusive)
+     */
+    uint64_t limit;
+    /**
+     * Number of windows
+     */
+    uint64_t segment_count;
+    /**
+     * Odd primes up to the square root of the limit
+     */
+    DynamicBitSet base_primes;
+    /**
+     * Odd primes up to the square root of the limit, as numbers
+     */
+    uint64_t* sieving_primes;
+    /**
+     * Number of the sieving primes
+     */
+    uint64_t sieving_prime_count;
+    /**
+     * Number of workers the sieve is prepared for
+     */
+    uint64_t worker_count;
+    /**
+     * Window of every worker, allocated by the first task of the worker (NULL data until then)
+     */
+    DynamicBitSet* windows;
+    /**
+     * Position of the next multiple of every sieving prime in the window, for every worker (bit index),
+     * allocated by the first task of the worker together with its primes (NULL until then)
+     */
+    uint64_t** offsets;
+    /**
+     * Buffer for the primes of a window, for every worker (NULL when only counting), follows the offsets of the worker
+     */
+    uint64_t** primes;
+    /**
+     * Receives the primes, NULL to only count them
+     */
+    bitset_sieve_callback callback;
+    /**
+     * Context of the callback
+     */
+    void* context;
+    /**
+     * Number of primes found
+     */
+    volatile uint64_t count;
+} BitSetSieve;
+
+/**
+ * Collects the primes into a buffer, used by bitset_sieve_primes_to_buffer
+ */
+typedef struct
+{
+    /**
+     * Buffer receiving the primes
+     */
+    uint64_t* primes;
+    /**
+     * Size of the buffer
+     */
+    uint64_t capacity;
+    /**
+     * Number of primes written to the buffer
+     */
+    uint64_t size;
+    /**
+     * Primes of every window, when the windows come out of order (multiple workers)
+     */
+    uint64_t** segment_primes;
+    /**
+     * Number of primes in every window, when the windows come out of order (multiple workers)
+     */
+    uint64_t* segment_counts;
+} BitSetSieveCollector;
+
+inline uint64_t bitset_sieve_isqrt(const uint64_t value);
+inline void bitset_sieve_init(BitSetSieve* const sieve, const uint64_t limit, const uint64_t worker_count, bitset_sieve_callback callback, void* const context);
+inline void bitset_sieve_destroy(BitSetSieve* const sieve);
+inline uint64_t bitset_sieve_worker_bytes(const BitSetSieve* const sieve);
+inline void bitset_sieve_worker_init(BitSetSieve* const sieve, const uint64_t worker);
+inline void bitset_sieve_task(void* const argument, const uint64_t task, const uint64_t worker);
+inline uint64_t bitset_sieve_run(BitSetSieve* const sieve, const BitSetThreadPool* const pool);
+inline uint64_t bitset_sieve_primes(const uint64_t limit, const BitSetThreadPool* const pool, bitset_sieve_callback callback, void* const context);
+inline uint64_t bitset_sieve_count_primes(const uint64_t limit, const BitSetThreadPool* const pool);
+inline void bitset_sieve_write(void* const context, const uint64_t* const primes, const uint64_t count, const uint64_t segment);
+inline void bitset_sieve_collect(void* const context, const uint64_t* const primes, const uint64_t count, const uint64_t segment);
+inline uint64_t bitset_sieve_primes_to_buffer(const uint64_t limit, const BitSetThreadPool* const pool, uint64_t* const primes, const uint64_t capacity);
+
+/**
+ * @param value The value to take the square root of
+ * @return The largest integer whose square is at most value
+ */
+inline uint64_t bitset_sieve_isqrt(const uint64_t value)
+{
+    uint64_t root = 0;
+    for (uint64_t bit = (uint64_t)1u << 31; bit; bit >>= 1)
+    {
+        const uint64_t candidate = root | bit;
+        if (candidate * candidate <= value)
+            root = candidate;
+    }
+    return root;
+}
+
+/**
+ * Initializes the sieve and finds the sieving primes, the memory of every worker is allocated by its first task
+ * @param sieve Pointer to sieve to initialize
+ * @param limit Upper limit of the sieve (inclusive)
+ * @param worker_count Number of workers that will run the sieve
+ * @param callback Receives the primes, NULL to only count them
+ * @param context Context of the callback
+ * @memberof BitSetSieve
+ */
+inline void bitset_sieve_init(BitSetSieve* const sieve, const uint64_t limit, const uint64_t worker_count, bitset_sieve_callback callback, void* const context)
+{
+    sieve->limit = limit;
+    sieve->segment_count = limit < 2 ? 0 : ((limit + 1) / 2 + BITSET_SIEVE_SEGMENT_BITS - 1) / BITSET_SIEVE_SEGMENT_BITS;
+    sieve->callback = callback;
+    sieve->context = context;
+    sieve->count = 0;
+
+    // simple sieve of the odd numbers up to the square root, bit i stands for 2i + 1
+    const uint64_t root = bitset_sieve_isqrt(limit);
+    bitset_dynamic_init_block(&sieve->base_primes, (root + 1) / 2, BITSET_BLOCK_FULL);
+    BitSet* const base_primes = UNIVERSAL_BITSET(&sieve->base_primes);
+    if (base_primes->size)
+        bitset_clear(base_primes, 0);
+    for (uint64_t i = 1; (2 * i + 1) * (2 * i + 1) <= root; ++i)
+    {
+        if (bitset_get(base_primes, i))
+            bitset_clear_in_range_begin_end_step(base_primes, (2 * i + 1) * (2 * i + 1) / 2, base_primes->size, 2 * i + 1);
+    }
+    sieve->sieving_prime_count = bitset_count(base_primes);
+    sieve->sieving_primes = (uint64_t*)malloc(sieve->sieving_prime_count * sizeof(uint64_t) + 1);
+    uint64_t index = 0;
+    for (uint64_t i = bitset_find_first(base_primes); i != BITSET_NPOS; i = bitset_find_next(base_primes, i))
+        *(sieve->sieving_primes + index++) = 2 * i + 1;
+
+    sieve->worker_count = worker_count;
+    sieve->windows = (DynamicBitSet*)calloc(worker_count ? worker_count : 1, sizeof(DynamicBitSet));
+    sieve->offsets = (uint64_t**)calloc(worker_count ? worker_count : 1, sizeof(uint64_t*));
+    sieve->primes = (uint64_t**)calloc(worker_count ? worker_count : 1, sizeof(uint64_t*));
+}
+
+/**
+ * Destroys the sieve (frees the memory)
+ * @param sieve Pointer to sieve to destroy
+ * @memberof BitSetSieve
+ */
+inline void bitset_sieve_destroy(BitSetSieve* const sieve)
+{
+    for (uint64_t i = 0; i < sieve->worker_count; ++i)
+    {
+        if (!(sieve->windows + i)->data)
+            continue;
+        bitset_dynamic_destroy(sieve->windows + i);
+        bitset_deallocate(NULL, *(sieve->offsets + i), bitset_sieve_worker_bytes(sieve), BITSET_SIEVE_WORKER_ALIGNMENT);
+    }
+    free(sieve->windows);
+    free(sieve->primes);
+    free(sieve->offsets);
+    free(sieve->sieving_primes);
+    bitset_dynamic_destroy(&sieve->base_primes);
+}
+
+/**
+ * Calculates the size of the offsets and the primes of a worker
+ * @param sieve Pointer to sieve
+ * @return The size in bytes
+ * @memberof BitSetSieve
+ */
+inline uint64_t bitset_sieve_worker_bytes(const BitSetSieve* const sieve)
+{
+    // one more slot for the prime 2 in the first window
+    return (sieve->sieving_prime_count + (sieve->callback ? BITSET_SIEVE_SEGMENT_BITS + 1 : 0)) * sizeof(uint64_t);
+}
+
+/**
+ * Allocates the window, the offsets and the primes of a worker if it has none yet, called by the tasks so the memory
+ * is first touched by the thread (and the node) running the worker
+ * Tasks of the same worker never run concurrently, so no synchronization is needed
+ * @param sieve Pointer to sieve
+ * @param worker Index of the worker
+ * @memberof BitSetSieve
+ */
+inline void bitset_sieve_worker_init(BitSetSieve* const sieve, const uint64_t worker)
+{
+    if ((sieve->windows + worker)->data)
+        return;
+    // the window is cleared here, the offsets and the primes are written by the tasks before being read
+    bitset_dynamic_init_allocator(sieve->windows + worker, BITSET_SIEVE_SEGMENT_BITS, NULL, BITSET_SIEVE_WORKER_ALIGNMENT);
+    *(sieve->offsets + worker) = (uint64_t*)bitset_allocate(NULL, bitset_sieve_worker_bytes(sieve), BITSET_SIEVE_WORKER_ALIGNMENT);
+    *(sieve->primes + worker) = sieve->callback ? *(sieve->offsets + worker) + sieve->sieving_prime_count : NULL;
+}
+
+/**
+ * Sieves BITSET_SIEVE_SEGMENTS_PER_TASK consecutive windows, used as a thread pool task
+ * @param argument Pointer to the sieve
+ * @param task Index of the task
+ * @param worker Index of the worker (selects the window and the offsets)
+ * @memberof BitSetSieve
+ */
+inline void bitset_sieve_task(void* const argument, const uint64_t task, const uint64_t worker)
+{
+    BitSetSieve* const sieve = (BitSetSieve*)argument;
+    bitset_sieve_worker_init(sieve, worker);
+    DynamicBitSet* const window = sieve->windows + worker;
+    BitSet* const bits = UNIVERSAL_BITSET(window);
+    uint64_t* const offsets = *(sieve->offsets + worker);
+    uint64_t* const primes = *(sieve->primes + worker);
+
+    const uint64_t first_segment = task * BITSET_SIEVE_SEGMENTS_PER_TASK;
+    const uint64_t last_segment = first_segment + BITSET_SIEVE_SEGMENTS_PER_TASK < sieve->segment_count ? first_segment + BITSET_SIEVE_SEGMENTS_PER_TASK : sieve->segment_count;
+
+    // bit i of window s stands for the odd number low + 2i + 1, low = 2 * s * BITSET_SIEVE_SEGMENT_BITS
+    const uint64_t first_low = 2 * first_segment * BITSET_SIEVE_SEGMENT_BITS;
+    for (uint64_t i = 0; i < sieve->sieving_prime_count; ++i)
+    {
+        const uint64_t prime = *(sieve->sieving_primes + i);
+        uint64_t multiple = prime * prime;
+        if (multiple < first_low + 1)
+        {
+            multiple = (first_low + 1 + prime - 1) / prime * prime;
+            if (!(multiple % 2))
+                multiple += prime;
+        }
+        *(offsets + i) = (multiple - first_low - 1) / 2;
+    }
+
+    uint64_t count = 0;
+    for (uint64_t segment = first_segment; segment < last_segment; ++segment)
+    {
+        const uint64_t low = 2 * segment * BITSET_SIEVE_SEGMENT_BITS;
+        const uint64_t size = (sieve->limit - low + 1) / 2 < BITSET_SIEVE_SEGMENT_BITS ? (sieve->limit - low + 1) / 2 : BITSET_SIEVE_SEGMENT_BITS;
+        bitset_dynamic_resize(window, size);
+        bitset_set_all(bits);
+        if (!segment)
+            bitset_clear(bits, 0);
+
+        for (uint64_t i = 0; i < sieve->sieving_prime_count; ++i)
+        {
+            const uint64_t prime = *(sieve->sieving_primes + i);
+            uint64_t offset = *(offsets + i);
+            if (offset < size)
+            {
+                bitset_clear_in_range_begin_end_step(bits, offset, size, prime);
+                offset += (size - offset + prime - 1) / prime * prime;
+            }
+            *(offsets + i) = offset - BITSET_SIEVE_SEGMENT_BITS;
+        }
+
+        if (!sieve->callback)
+        {
+            count += bitset_count(bits) + (segment ? 0 : 1);
+            continue;
+        }
+
+        uint64_t index = 0;
+        if (!segment && sieve->limit >= 2)
+            *(primes + index++) = 2;
+        const uint64_t found = bitset_to_indices(bits, primes + index, 0);
+        for (uint64_t i = index; i < index + found; ++i)
+            *(primes + i) = low + 2 * *(primes + i) + 1;
+        index += found;
+        count += index;
+        sieve->callback(sieve->context, primes, index, segment);
+    }
+    bitset_atomic_fetch_add(&sieve->count, count);
+}
+
+/**
+ * Runs the sieve, the tasks are split across the workers of the pool
+ * @param sieve Pointer to initialized sieve
+ * @param pool Pointer to thread pool to use, the sieve has to be initialized with its worker count (NULL to use the calling thread)
+ * @return The number of primes found
+ * @memberof BitSetSieve
+ */
+inline uint64_t bitset_sieve_run(BitSetSieve* const sieve, const BitSetThreadPool* const pool)
+{
+    const uint64_t task_count = (sieve->segment_count + BITSET_SIEVE_SEGMENTS_PER_TASK - 1) / BITSET_SIEVE_SEGMENTS_PER_TASK;
+    bitset_thread_pool_run(pool, task_count, bitset_sieve_task, sieve);
+    return sieve->count;
+}
+
+/**
+ * Finds all the primes up to the limit with the segmented sieve
+ * @param limit Upper limit (inclusive)
+ * @param pool Pointer to thread pool to use (NULL to use the calling thread)
+ * @param callback Receives the primes window by window (see bitset_sieve_callback), NULL to only count them
+ * @param context Context of the callback
+ * @return The number of primes found
+ */
+inline uint64_t bitset_sieve_primes(const uint64_t limit, const BitSetThreadPool* const pool, bitset_sieve_callback callback, void* const context)
+{
+    BitSetSieve sieve;
+    const uint64_t worker_count = bitset_thread_pool_worker_count(pool);
+    bitset_sieve_init(&sieve, limit, worker_count, callback, context);
+    const uint64_t count = bitset_sieve_run(&sieve, pool);
+    bitset_sieve_destroy(&sieve);
+    return count;
+}
+
+/**
+ * Counts the primes up to the limit with the segmented sieve
+ * @param limit Upper limit (inclusive)
+ * @param pool Pointer to thread pool to use (NULL to use the calling thread)
+ * @return The number of primes up to the limit
+ */
+inline uint64_t bitset_sieve_count_primes(const uint64_t limit, const BitSetThreadPool* const pool)
+{
+    return bitset_sieve_primes(limit, pool, NULL, NULL);
+}
+
+/**
+ * Callback appending the primes to the buffer, used by bitset_sieve_primes_to_buffer when the windows come in order
+ */
+inline void bitset_sieve_write(void* const context, const uint64_t* const primes, const uint64_t count, const uint64_t segment)
+{
+    (void)segment;
+    BitSetSieveCollector* const collector = (BitSetSieveCollector*)context;
+    const uint64_t to_copy = collector->size + count < collector->capacity ? count : collector->capacity - collector->size;
+    memcpy(collector->primes + collector->size, primes, to_copy * sizeof(uint64_t));
+    collector->size += to_copy;
+}
+
+/**
+ * Callback storing a copy of the primes of every window, used by bitset_sieve_primes_to_buffer when the windows come out of order
+ */
+inline void bitset_sieve_collect(void* const context, const uint64_t* const primes, const uint64_t count, const uint64_t segment)
+{
+    BitSetSieveCollector* const collector = (BitSetSieveCollector*)context;
+    *(collector->segment_primes + segment) = (uint64_t*)malloc(count * sizeof(uint64_t) + 1);
+    memcpy(*(collector->segment_primes + segment), primes, count * sizeof(uint64_t));
+    *(collector->segment_counts + segment) = count;
+}
+
+/**
+ * Finds all the primes up to the limit with the segmented sieve and writes them to the buffer in ascending order
+ * With multiple workers the windows are finished out of order, so their primes are buffered until the sieve is done
+ * @param limit Upper limit (inclusive)
+ * @param pool Pointer to thread pool to use (NULL to use the calling thread)
+ * @param primes Buffer receiving the primes
+ * @param capacity Size of the buffer, primes past it are counted but not written
+ * @return The number of primes up to the limit
+ */
+inline uint64_t bitset_sieve_primes_to_buffer(const uint64_t limit, const BitSetThreadPool* const pool, uint64_t* const primes, const uint64_t capacity)
+{
+    BitSetSieveCollector collector;
+    collector.primes = primes;
+    collector.capacity = capacity;
+    collector.size = 0;
+
+    if (bitset_thread_pool_worker_count(pool) == 1)
+        return bitset_sieve_primes(limit, NULL, bitset_sieve_write, &collector);
+
+    const uint64_t segment_count = limit < 2 ? 0 : ((limit + 1) / 2 + BITSET_SIEVE_SEGMENT_BITS - 1) / BITSET_SIEVE_SEGMENT_BITS;
+    collector.segment_primes = (uint64_t**)calloc(segment_count + 1, sizeof(uint64_t*));
+    collector.segment_counts = (uint64_t*)calloc(segment_count + 1, sizeof(uint64_t));
+    const uint64_t count = bitset_sieve_primes(limit, pool, bitset_sieve_collect, &collector);
+    for (uint64_t i = 0; i < segment_count; ++i)
+    {
+        bitset_sieve_write(&collector, *(collector.segment_primes + i), *(collector.segment_counts + i), i);
+        free(*(collector.segment_primes + i));
+    }
+    free(collector.segment_primes);
+    free(collector.segment_counts);
+    return count;
+}
@@ -0,0 +1,345 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+
+/**
+ * Optional instrumentation of the bitset API. Define BITSET_STATS before including BitSet.h to count allocations,
+ * allocated and copied bytes, and the calls and touched bits of every operation group, define BITSET_STATS_CYCLES as well
+ * to also time the bulk operations (rdtsc on x86, nanoseconds elsewhere).
+ * Every thread updates its own counters without atomic read-modify-write instructions, bitset_stats_snapshot sums the counters of all the threads.
+ * Without BITSET_STATS the hooks expand to nothing and the snapshot is always zero, so there is no cost at all.
+ */
+
+/**
+ * Group of operations with separate counters
+ */
+typedef enum
+{
+    /**
+     * get, set, clear, set_value and flip_bit
+     */
+    BITSET_STATS_SINGLE_BIT,
+    /**
+     * Range fills (fill/set/clear_in_range_begin_end, fill/set/clear_all)
+     */
+    BITSET_STATS_FILL_RANGE,
+    /**
+     * Strided fills (fill/set/clear_in_range_begin_end_step)
+     */
+    BITSET_STATS_FILL_STEP,
+    /**
+     * Range and strided flips (flip_in_range_begin_end, flip_in_range_begin_end_step, flip_all)
+     */
+    BITSET_STATS_FLIP_RANGE,
+    /**
+     * count and count_in_range_begin_end
+     */
+    BITSET_STATS_COUNT,
+    /**
+     * all, any, none and their range versions
+     */
+    BITSET_STATS_PREDICATE,
+    /**
+     * find_* searches
+     */
+    BITSET_STATS_FIND,
+    /**
+     * Set algebra (apply_operation and apply_operation_count)
+     */
+    BITSET_STATS_SET_OPERATION,
+    /**
+     * Shifts and rotates
+     */
+    BITSET_STATS_SHIFT,
+    /**
+     * bitset_copy
+     */
+    BITSET_STATS_COPY,
+    /**
+     * push_back and push_back_block
+     */
+    BITSET_STATS_PUSH_BACK,
+    /**
+     * pop_back and pop_back_block
+     */
+    BITSET_STATS_POP_BACK,
+    /**
+     * bitset_dynamic_resize
+     */
+    BITSET_STATS_RESIZE,
+    /**
+     * bitset_dynamic_reallocate (every growth, reserve and shrink)
+     */
+    BITSET_STATS_REALLOCATE,
+    /**
+     * Number of the groups
+     */
+    BITSET_STATS_OPERATION_COUNT
+} BitSetStatsOperation;
+
+/**
+ * Snapshot of the counters
+ */
+typedef struct
+{
+    /**
+     * Number of allocations and reallocations of bitset storage
+     */
+    uint64_t allocations;
+    /**
+     * Number of freed bitset storages
+     */
+    uint64_t deallocations;
+    /**
+     * Bytes requested by the allocations and reallocations
+     */
+    uint64_t bytes_allocated;
+    /**
+     * Bytes copied by bitset_copy and by reallocations which moved the storage
+     */
+    uint64_t bytes_copied;
+    /**
+     * Calls per operation group
+     */
+    uint64_t calls[BITSET_STATS_OPERATION_COUNT];
+    /**
+     * Bits touched per operation group (the size of the range or the bitset)
+     */
+    uint64_t bits[BITSET_STATS_OPERATION_COUNT];
+    /**
+     * Time spent per operation group (cycles or nanoseconds, only with BITSET_STATS_CYCLES and only for the bulk operations)
+     */
+    uint64_t cycles[BITSET_STATS_OPERATION_COUNT];
+} BitSetStats;
+
+inline void bitset_stats_snapshot(BitSetStats* const stats);
+inline void bitset_stats_thread_snapshot(BitSetStats* const stats);
+inline void bitset_stats_reset(void);
+inline const char* bitset_stats_operation_name(const BitSetStatsOperation operation);
+inline void bitset_stats_print(FILE* const stream, const BitSetStats* const stats);
+
+#ifdef BITSET_STATS
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BITSET_STATS_THREAD_LOCAL __declspec(thread)
+#define BITSET_STATS_SHARED __declspec(selectany)
+#else
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <time.h>
+#define BITSET_STATS_THREAD_LOCAL __thread
+// weak definitions are merged by the linker, so all the translation units share one registry
+#define BITSET_STATS_SHARED __attribute__((weak))
+#endif
+
+/**
+ * Counters of one thread, never freed so a snapshot can still read the counters of finished threads
+ */
+typedef struct BitSetStatsThread
+{
+    BitSetStats stats;
+    struct BitSetStatsThread* next;
+} BitSetStatsThread;
+
+/**
+ * Registry of the counters of all the threads (push only list)
+ */
+BITSET_STATS_SHARED BitSetStatsThread* bitset_stats_threads = NULL;
+
+/**
+ * Counters of the current thread, registered on first use
+ */
+BITSET_STATS_SHARED BITSET_STATS_THREAD_LOCAL BitSetStatsThread* bitset_stats_current = NULL;
+
+inline BitSetStats* bitset_stats_thread(void);
+inline void bitset_stats_add(uint64_t* const counter, const uint64_t value);
+inline uint64_t bitset_stats_read(const uint64_t* const counter);
+inline uint64_t bitset_stats_timestamp(void);
+
+/**
+ * Gets the counters of the current thread, the first call of a thread registers them
+ * @return Pointer to the counters
+ */
+inline BitSetStats* bitset_stats_thread(void)
+{
+    if (bitset_stats_current)
+        return &bitset_stats_current->stats;
+    BitSetStatsThread* const thread = (BitSetStatsThread*)calloc(1, sizeof(BitSetStatsThread));
+#if defined(_MSC_VER)
+    do
+        thread->next = bitset_stats_threads;
+    while (_InterlockedCompareExchangePointer((void* volatile*)&bitset_stats_threads, thread, thread->next) != thread->next);
+#else
+    thread->next = __atomic_load_n(&bitset_stats_threads, __ATOMIC_ACQUIRE);
+    while (!__atomic_compare_exchange_n(&bitset_stats_threads, &thread->next, thread, true, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+        ;
+#endif
+    bitset_stats_current = thread;
+    return &thread->stats;
+}
+
+/**
+ * Adds to a counter of the current thread (relaxed load and store, only the owner thread writes)
+ * @param counter Pointer to the counter
+ * @param value Value to add
+ */
+inline void bitset_stats_add(uint64_t* const counter, const uint64_t value)
+{
+#if defined(_MSC_VER)
+    *(volatile uint64_t*)counter += value;
+#else
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * Reads a counter of any thread
+ * @param counter Pointer to the counter
+ * @return The value of the counter
+ */
+inline uint64_t bitset_stats_read(const uint64_t* const counter)
+{
+#if defined(_MSC_VER)
+    return *(const volatile uint64_t*)counter;
+#else
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * Reads the time stamp used by BITSET_STATS_CYCLES
+ * @return Cycles (x86) or nanoseconds
+ */
+inline uint64_t bitset_stats_timestamp(void)
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return (uint64_t)__rdtsc();
+#else
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
+
+#define BITSET_STATS_CALL(operation, touched) \
+    (bitset_stats_add(&bitset_stats_thread()->calls[operation], 1u), bitset_stats_add(&bitset_stats_thread()->bits[operation], (touched)))
+#define BITSET_STATS_ALLOCATION(bytes) \
+    (bitset_stats_add(&bitset_stats_thread()->allocations, 1u), bitset_stats_add(&bitset_stats_thread()->bytes_allocated, (bytes)))
+#define BITSET_STATS_DEALLOCATION() bitset_stats_add(&bitset_stats_thread()->deallocations, 1u)
+#define BITSET_STATS_COPY_BYTES(bytes) bitset_stats_add(&bitset_stats_thread()->bytes_copied, (bytes))
+
+#ifdef BITSET_STATS_CYCLES
+#define BITSET_STATS_TIMER_BEGIN(timer) const uint64_t timer = bitset_stats_timestamp()
+#define BITSET_STATS_TIMER_END(operation, timer) bitset_stats_add(&bitset_stats_thread()->cycles[operation], bitset_stats_timestamp() - (timer))
+#else
+#define BITSET_STATS_TIMER_BEGIN(timer) ((void)0)
+#define BITSET_STATS_TIMER_END(operation, timer) ((void)0)
+#endif
+
+#else // BITSET_STATS
+
+#define BITSET_STATS_CALL(operation, touched) ((void)0)
+#define BITSET_STATS_ALLOCATION(bytes) ((void)0)
+#define BITSET_STATS_DEALLOCATION() ((void)0)
+#define BITSET_STATS_COPY_BYTES(bytes) ((void)0)
+#define BITSET_STATS_TIMER_BEGIN(timer) ((void)0)
+#define BITSET_STATS_TIMER_END(operation, timer) ((void)0)
+
+#endif // BITSET_STATS
+
+/**
+ * Sums the counters of all the threads (zero without BITSET_STATS)
+ * The counters are read while other threads may update them, so a snapshot taken during work is approximate
+ * @param stats Pointer to the snapshot to fill
+ */
+inline void bitset_stats_snapshot(BitSetStats* const stats)
+{
+    memset(stats, 0, sizeof(BitSetStats));
+#ifdef BITSET_STATS
+#if defined(_MSC_VER)
+    const BitSetStatsThread* thread = *(BitSetStatsThread* const volatile*)&bitset_stats_threads;
+#else
+    const BitSetStatsThread* thread = __atomic_load_n(&bitset_stats_threads, __ATOMIC_ACQUIRE);
+#endif
+    for (; thread; thread = thread->next)
+    {
+        // the snapshot is summed as an array of counters
+        const uint64_t* const source = (const uint64_t*)&thread->stats;
+        uint64_t* const destination = (uint64_t*)stats;
+        for (uint64_t i = 0; i < sizeof(BitSetStats) / sizeof(uint64_t); ++i)
+            *(destination + i) += bitset_stats_read(source + i);
+    }
+#endif
+}
+
+/**
+ * Copies the counters of the current thread (zero without BITSET_STATS)
+ * @param stats Pointer to the snapshot to fill
+ */
+inline void bitset_stats_thread_snapshot(BitSetStats* const stats)
+{
+    memset(stats, 0, sizeof(BitSetStats));
+#ifdef BITSET_STATS
+    memcpy(stats, bitset_stats_thread(), sizeof(BitSetStats));
+#endif
+}
+
+/**
+ * Clears the counters of all the threads, updates made by other threads at the same time may be lost
+ */
+inline void bitset_stats_reset(void)
+{
+#ifdef BITSET_STATS
+#if defined(_MSC_VER)
+    BitSetStatsThread* thread = *(BitSetStatsThread* volatile*)&bitset_stats_threads;
+    for (; thread; thread = thread->next)
+        memset((void*)&thread->stats, 0, sizeof(BitSetStats));
+#else
+    BitSetStatsThread* thread = __atomic_load_n(&bitset_stats_threads, __ATOMIC_ACQUIRE);
+    for (; thread; thread = thread->next)
+    {
+        uint64_t* const counters = (uint64_t*)&thread->stats;
+        for (uint64_t i = 0; i < sizeof(BitSetStats) / sizeof(uint64_t); ++i)
+            __atomic_store_n(counters + i, 0, __ATOMIC_RELAXED);
+    }
+#endif
+#endif
+}
+
+/**
+ * Gets the name of an operation group
+ * @param operation The group
+ * @return Name of the group (e.g. "fill_step")
+ */
+inline const char* bitset_stats_operation_name(const BitSetStatsOperation operation)
+{
+    static const char* const names[BITSET_STATS_OPERATION_COUNT] = {
+        "single_bit", "fill_range", "fill_step", "flip_range", "count", "predicate", "find",
+        "set_operation", "shift", "copy", "push_back", "pop_back", "resize", "reallocate"
+    };
+    return operation < BITSET_STATS_OPERATION_COUNT ? names[operation] : "unknown";
+}
+
+/**
+ * Prints a snapshot, one "name calls bits cycles" line per used operation group after the memory counters
+ * @param stream The stream to print to (e.g. stderr)
+ * @param stats Pointer to the snapshot
+ */
+inline void bitset_stats_print(FILE* const stream, const BitSetStats* const stats)
+{
+    fprintf(stream, "allocations %llu deallocations %llu bytes_allocated %llu bytes_copied %llu\n",
+            (unsigned long long)stats->allocations, (unsigned long long)stats->deallocations,
+            (unsigned long long)stats->bytes_allocated, (unsigned long long)stats->bytes_copied);
+    for (int i = 0; i < BITSET_STATS_OPERATION_COUNT; ++i)
+    {
+        if (stats->calls[i])
+            fprintf(stream, "%s calls %llu bits %llu cycles %llu\n", bitset_stats_operation_name((BitSetStatsOperation)i),
+                    (unsigned long long)stats->calls[i], (unsigned long long)stats->bits[i], (unsigned long long)stats->cycles[i]);
+    }
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/**
+ * A task run by the thread pool
+ * @param argument The argument passed to bitset_thread_pool_run
+ * @param task Index of the task [0, task_count)
+ * @param worker Index of the worker running the task [0, worker_count), usable for per-worker buffers
+ */
+typedef void (*bitset_task)(void* const argument, const uint64_t task, const uint64_t worker);
+
+/**
+ * A pluggable thread pool used by the parallel parts of the library
+ * Plug in an existing pool by providing run, the default one creates the threads for every run
+ */
+typedef struct BitSetThreadPool
+{
+    /**
+     * Runs the tasks [0, task_count) and returns when all of them are finished
+     * Every task has to be given a worker index lower than worker_count, tasks with the same worker index must not run concurrently
+     */
+    void (*run)(const struct BitSetThreadPool* const pool, const uint64_t task_count, bitset_task task, void* const argument);
+    /**
+     * User context of the run function
+     */
+    void* context;
+    /**
+     * Number of workers (threads) of the pool
+     */
+    uint64_t worker_count;
+} BitSetThreadPool;
+
+/**
+ * State shared by the threads of the default thread pool (for C API thread pool)
+ */
+typedef struct
+{
+    /**
+     * Index of the next task to run
+     */
+    volatile uint64_t next_task;
+    /**
+     * Number of tasks to run
+     */
+    uint64_t task_count;
+    /**
+     * The task to run
+     */
+    bitset_task task;
+    /**
+     * Argument of the task
+     */
+    void* argument;
+} BitSetThreadPoolJob;
+
+/**
+ * A thread of the default thread pool
+ */
+typedef struct
+{
+    /**
+     * The job the thread works on
+     */
+    BitSetThreadPoolJob* job;
+    /**
+     * Index of the worker
+     */
+    uint64_t worker;
+} BitSetThreadPoolWorker;
+
+inline uint64_t bitset_atomic_fetch_add(volatile uint64_t* const value, const uint64_t addend);
+inline uint64_t bitset_atomic_load(const volatile uint64_t* const value);
+inline uint64_t bitset_hardware_concurrency(void);
+inline void bitset_thread_pool_init(BitSetThreadPool* const pool, const uint64_t worker_count);
+inline uint64_t bitset_thread_pool_worker_count(const BitSetThreadPool* const pool);
+inline void bitset_thread_pool_run(const BitSetThreadPool* const pool, const uint64_t task_count, bitset_task task, void* const argument);
+inline void bitset_thread_pool_work(BitSetThreadPoolJob* const job, const uint64_t worker);
+inline void bitset_thread_pool_run_default(const BitSetThreadPool* const pool, const uint64_t task_count, bitset_task task, void* const argument);
+
+/**
+ * Atomically adds to the value
+ * @param value Pointer to the value to modify
+ * @param addend The value to add
+ * @return The value before the addition
+ */
+inline uint64_t bitset_atomic_fetch_add(volatile uint64_t* const value, const uint64_t addend)
+{
+#ifdef _MSC_VER
+    return (uint64_t)InterlockedExchangeAdd64((volatile LONG64*)value, (LONG64)addend);
+#else
+    return __atomic_fetch_add(value, addend, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * Atomically loads the value (relaxed)
+ * @param value Pointer to the value to load
+ * @return The value
+ */
+inline uint64_t bitset_atomic_load(const volatile uint64_t* const value)
+{
+#ifdef _MSC_VER
+    return *value;
+#else
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * @return The number of hardware threads (at least 1)
+ */
+inline uint64_t bitset_hardware_concurrency(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (uint64_t)count : 1;
+#endif
+}
+
+/**
+ * Initializes the default thread pool
+ * @param pool Pointer to thread pool to initialize
+ * @param worker_count Number of workers, 0 to use all the hardware threads
+ * @memberof BitSetThreadPool
+ */
+inline void bitset_thread_pool_init(BitSetThreadPool* const pool, const uint64_t worker_count)
+{
+    pool->run = bitset_thread_pool_run_default;
+    pool->context = NULL;
+    pool->worker_count = worker_count ? worker_count : bitset_hardware_concurrency();
+}
+
+/**
+ * @param pool Pointer to thread pool (may be NULL)
+ * @return The number of workers of the pool, 1 if there is no pool
+ * @memberof BitSetThreadPool
+ */
+inline uint64_t bitset_thread_pool_worker_count(const BitSetThreadPool* const pool)
+{
+    return pool && pool->worker_count ? pool->worker_count : 1;
+}
+
+/**
+ * Runs the tasks [0, task_count) on the pool and waits for them, without a pool they run on the calling thread
+ * @param pool Pointer to thread pool to use (may be NULL)
+ * @param task_count Number of tasks to run
+ * @param task The task to run
+ * @param argument Argument passed to the task
+ * @memberof BitSetThreadPool
+ */
+inline void bitset_thread_pool_run(const BitSetThreadPool* const pool, const uint64_t task_count, bitset_task task, void* const argument)
+{
+    if (pool && pool->run && pool->worker_count > 1 && task_count > 1)
+    {
+        pool->run(pool, task_count, task, argument);
+        return;
+    }
+    for (uint64_t i = 0; i < task_count; ++i)
+        task(argument, i, 0);
+}
+
+/**
+ * Runs the tasks of the job until there are none left
+ * @param job Pointer to the job to work on
+ * @param worker Index of the worker
+ */
+inline void bitset_thread_pool_work(BitSetThreadPoolJob* const job, const uint64_t worker)
+{
+    for (uint64_t task = bitset_atomic_fetch_add(&job->next_task, 1); task < job->task_count; task = bitset_atomic_fetch_add(&job->next_task, 1))
+        job->task(job->argument, task, worker);
+}
+
+#ifdef _WIN32
+inline DWORD WINAPI bitset_thread_pool_thread(LPVOID argument)
+#else
+inline void* bitset_thread_pool_thread(void* argument)
+#endif
+{
+    BitSetThreadPoolWorker* const worker = (BitSetThreadPoolWorker*)argument;
+    bitset_thread_pool_work(worker->job, worker->worker);
+    return 0;
+}
+
+/**
+ * Run function of the default thread pool, starts worker_count - 1 threads and works on the calling thread as well
+ * @param pool Pointer to thread pool to use
+ * @param task_count Number of tasks to run
+ * @param task The task to run
+ * @param argument Argument passed to the task
+ * @memberof BitSetThreadPool
+ */
+inline void bitset_thread_pool_run_default(const BitSetThreadPool* const pool, const uint64_t task_count, bitset_task task, void* const argument)
+{
+    BitSetThreadPoolJob job;
+    job.next_task = 0;
+    job.task_count = task_count;
+    job.task = task;
+    job.argument = argument;
+
+    const uint64_t thread_count = (pool->worker_count < task_count ? pool->worker_count : task_count) - 1;
+    BitSetThreadPoolWorker* const workers = (BitSetThreadPoolWorker*)malloc(thread_count * sizeof(BitSetThreadPoolWorker) + 1);
+#ifdef _WIN32
+    HANDLE* const threads = (HANDLE*)malloc(thread_count * sizeof(HANDLE) + 1);
+#else
+    pthread_t* const threads = (pthread_t*)malloc(thread_count * sizeof(pthread_t) + 1);
+#endif
+    uint64_t started = 0;
+    for (; started < thread_count; ++started)
+    {
+        (workers + started)->job = &job;
+        (workers + started)->worker = started + 1;
+#ifdef _WIN32
+        *(threads + started) = CreateThread(NULL, 0, bitset_thread_pool_thread, workers + started, 0, NULL);
+        if (!*(threads + started))
+            break;
+#else
+        if (pthread_create(threads + started, NULL, bitset_thread_pool_thread, workers + started))
+            break;
+#endif
+    }
+
+    // the calling thread is worker 0, if some threads could not be started the rest of the workers pick up their tasks
+    bitset_thread_pool_work(&job, 0);
+
+    for (uint64_t i = 0; i < started; ++i)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(*(threads + i), INFINITE);
+        CloseHandle(*(threads + i));
+#else
+        pthread_join(*(threads + i), NULL);
+#endif
+    }
+    free(threads);
+    free(workers);
+}
@@ -0,0 +1,352 @@
+#pragma once
+
+#include "BitSet.h"
+
+/**
+ * Number of 64-bit words of a block of a bloom filter, a key sets one bit in every word of its block (so k = 8)
+ */
+#define BITSET_BLOOM_BLOCK_WORDS 8u
+
+/**
+ * Size of a block of a bloom filter in bits (one cache line)
+ */
+#define BITSET_BLOOM_BLOCK_BITS (BITSET_BLOOM_BLOCK_WORDS * 64u)
+
+/**
+ * Number of keys the batch operations hash and prefetch before probing any of them
+ */
+#ifndef BITSET_BLOOM_BATCH
+#define BITSET_BLOOM_BATCH 16u
+#endif
+
+/**
+ * Odd multipliers selecting the bit of every word of a block from the low half of the hash, one per word
+ * (a list for initializing local arrays, the inline functions can't refer to a static table)
+ */
+#define BITSET_BLOOM_SALTS 0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du, 0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+
+/**
+ * A cache line blocked bloom filter (for C API bloom filter)
+ * The high half of the hash of a key picks a 64-byte block, the low half one bit in each of its 8 words,
+ * so an insert or a lookup touches a single cache line however many bits it sets
+ */
+typedef struct
+{
+    /**
+     * The bits, cache line aligned, read and written as 64-bit words whatever the block type
+     */
+    DynamicBitSet bitset;
+    /**
+     * Number of blocks (at least 1, at most 2^32)
+     */
+    uint64_t blocks;
+} BloomFilter;
+
+inline void bitset_bloom_init(BloomFilter* const filter, const uint64_t keys, const uint64_t bits_per_key);
+inline void bitset_bloom_destroy(BloomFilter* const filter);
+inline void bitset_bloom_clear(BloomFilter* const filter);
+inline uint64_t bitset_bloom_hash(const uint64_t key);
+inline uint64_t* bitset_bloom_block(const BloomFilter* const filter, const uint64_t hash);
+inline void bitset_bloom_insert_hash(BloomFilter* const filter, const uint64_t hash);
+inline bool bitset_bloom_contains_hash(const BloomFilter* const filter, const uint64_t hash);
+inline void bitset_bloom_insert(BloomFilter* const filter, const uint64_t key);
+inline bool bitset_bloom_contains(const BloomFilter* const filter, const uint64_t key);
+inline void bitset_bloom_insert_many_portable(BloomFilter* const filter, const uint64_t* const keys, const uint64_t count);
+inline void bitset_bloom_contains_many_portable(const BloomFilter* const filter, const uint64_t* const keys, const uint64_t count, bool* const results);
+inline void bitset_bloom_insert_many(BloomFilter* const filter, const uint64_t* const keys, const uint64_t count);
+inline void bitset_bloom_contains_many(const BloomFilter* const filter, const uint64_t* const keys, const uint64_t count, bool* const results);
+inline void bitset_bloom_merge(BloomFilter* const destination, const BloomFilter* const source);
+
+/**
+ * Initialization for the expected number of keys, the blocks come from an allocation aligned to a cache line
+ * @param filter Pointer to filter to initialize
+ * @param keys Expected number of keys
+ * @param bits_per_key Number of bits per key (e.g. 10 for about 1% false positives, 16 for about 0.1%)
+ * @memberof BloomFilter
+ */
+inline void bitset_bloom_init(BloomFilter* const filter, const uint64_t keys, const uint64_t bits_per_key)
+{
+    const uint64_t bits = keys * bits_per_key;
+    filter->blocks = bits / BITSET_BLOOM_BLOCK_BITS + (bits % BITSET_BLOOM_BLOCK_BITS != 0);
+    if (!filter->blocks)
+        filter->blocks = 1;
+    bitset_dynamic_init_allocator(&filter->bitset, filter->blocks * BITSET_BLOOM_BLOCK_BITS, NULL, BITSET_BLOOM_BLOCK_WORDS * sizeof(uint64_t));
+}
+
+/**
+ * Destroys the filter (frees the blocks)
+ * @param filter Pointer to filter to destroy
+ * @memberof BloomFilter
+ */
+inline void bitset_bloom_destroy(BloomFilter* const filter)
+{
+    bitset_dynamic_destroy(&filter->bitset);
+    filter->blocks = 0;
+}
+
+/**
+ * Removes all the keys
+ * @param filter Pointer to filter to clear
+ * @memberof BloomFilter
+ */
+inline void bitset_bloom_clear(BloomFilter* const filter)
+{
+    bitset_clear_all(UNIVERSAL_BITSET(&filter->bitset));
+}
+
+/**
+ * Mixes a key into a hash (the finalizer of MurmurHash3), keys which are already good hashes can use the _hash functions directly
+ * @param key The key
+ * @return The hash of the key
+ */
+inline uint64_t bitset_bloom_hash(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return key;
+}
+
+/**
+ * Gets the block of a hash (the high half of the hash scaled to the number of blocks)
+ * @param filter Pointer to filter
+ * @param hash The hash of the key
+ * @return Pointer to the first word of the block
+ * @memberof BloomFilter
+ */
+inline uint64_t* bitset_bloom_block(const BloomFilter* const filter, const uint64_t hash)
+{
+    return (uint64_t*)filter->bitset.data + ((hash >> 32) * filter->blocks >> 32) * BITSET_BLOOM_BLOCK_WORDS;
+}
+
+/**
+ * Inserts a key by its hash
+ * @param filter Pointer to filter to modify
+ * @param hash The hash of the key
+ * @memberof BloomFilter
+ */
+inline void bitset_bloom_insert_hash(BloomFilter* const filter, const uint64_t hash)
+{
+    uint64_t* const block = bitset_bloom_block(filter, hash);
+    const uint32_t salts[BITSET_BLOOM_BLOCK_WORDS] = {BITSET_BLOOM_SALTS};
+    for (uint64_t i = 0; i < BITSET_BLOOM_BLOCK_WORDS; ++i)
+        *(block + i) |= (uint64_t)1u << ((uint32_t)hash * *(salts + i) >> 26);
+}
+
+/**
+ * Checks if a key may have been inserted, by its hash
+ * @param filter Pointer to filter to check
+ * @param hash The hash of the key
+ * @return False if the key was certainly not inserted, true if it probably was
+ * @memberof BloomFilter
+ */
+inline bool bitset_bloom_contains_hash(const BloomFilter* const filter, const uint64_t hash)
+{
+    const uint64_t* const block = bitset_bloom_block(filter, hash);
+    const uint32_t salts[BITSET_BLOOM_BLOCK_WORDS] = {BITSET_BLOOM_SALTS};
+    uint64_t missing = 0;
+    for (uint64_t i = 0; i < BITSET_BLOOM_BLOCK_WORDS; ++i)
+        missing |= ~*(block + i) & (uint64_t)1u << ((uint32_t)hash * *(salts + i) >> 26);
+    return !missing;
+}
+
+/**
+ * Inserts a key
+ * @param filter Pointer to filter to modify
+ * @param key The key
+ * @memberof BloomFilter
+ */
+inline void bitset_bloom_insert(BloomFilter* const filter, const uint64_t key)
+{
+    bitset_bloom_insert_hash(filter, bitset_bloom_hash(key));
+}
+
+/**
+ * Checks if a key may have been inserted
+ * @param filter Pointer to filter to check
+ * @param key The key
+ * @return False if the key was certainly not inserted, true if it probably was
+ * @memberof BloomFilter
+ */
+inline bool bitset_bloom_contains(const BloomFilter* const filter, const uint64_t key)
+{
+    return bitset_bloom_contains_hash(filter, bitset_bloom_hash(key));
+}
+
+/**
+ * Inserts keys in batches of BITSET_BLOOM_BATCH, the blocks of a batch are prefetched before any of them is modified, portable version
+ * @param filter Pointer to filter to modify
+ * @param keys The keys
+ * @param count Number of keys
+ * @memberof BloomFilter
+ */
+inline void bitset_bloom_insert_many_portable(BloomFilter* const filter, const uint64_t* const keys, const uint64_t count)
+{
+    uint64_t hashes[BITSET_BLOOM_BATCH];
+    for (uint64_t begin = 0; begin < count; begin += BITSET_BLOOM_BATCH)
+    {
+        const uint64_t batch = count - begin < BITSET_BLOOM_BATCH ? count - begin : BITSET_BLOOM_BATCH;
+        for (uint64_t i = 0; i < batch; ++i)
+        {
+            hashes[i] = bitset_bloom_hash(*(keys + begin + i));
+            BITSET_PREFETCH(bitset_bloom_block(filter, hashes[i]), 1);
+        }
+        for (uint64_t i = 0; i < batch; ++i)
+            bitset_bloom_insert_hash(filter, hashes[i]);
+    }
+}
+
+/**
+ * Checks keys in batches of BITSET_BLOOM_BATCH, the blocks of a batch are prefetched before any of them is probed, portable version
+ * @param filter Pointer to filter to check
+ * @param keys The keys
+ * @param count Number of keys
+ * @param results Receives whether each key may have been inserted
+ * @memberof BloomFilter
+ */
+inline void bitset_bloom_contains_many_portable(const BloomFilter* const filter, const uint64_t* const keys, const uint64_t count, bool* const results)
+{
+    uint64_t hashes[BITSET_BLOOM_BATCH];
+    for (uint64_t begin = 0; begin < count; begin += BITSET_BLOOM_BATCH)
+    {
+        const uint64_t batch = count - begin < BITSET_BLOOM_BATCH ? count - begin : BITSET_BLOOM_BATCH;
+        for (uint64_t i = 0; i < batch; ++i)
+        {
+            hashes[i] = bitset_bloom_hash(*(keys + begin + i));
+            BITSET_PREFETCH(bitset_bloom_block(filter, hashes[i]), 0);
+        }
+        for (uint64_t i = 0; i < batch; ++i)
+            *(results + begin + i) = bitset_bloom_contains_hash(filter, hashes[i]);
+    }
+}
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Computes the bits a hash sets in a block using AVX2 vectors (one 32-bit multiply per word, then a variable shift)
+ * @param hash The hash of the key
+ * @param low Receives the bits of the first 4 words
+ * @param high Receives the bits of the last 4 words
+ */
+BITSET_TARGET("avx2") inline void bitset_bloom_masks_avx2(const uint64_t hash, __m256i* const low, __m256i* const high)
+{
+    const uint32_t table[BITSET_BLOOM_BLOCK_WORDS] = {BITSET_BLOOM_SALTS};
+    const __m256i salts = _mm256_loadu_si256((const __m256i*)table);
+    const __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32((int)(uint32_t)hash), salts), 26);
+    const __m256i one = _mm256_set1_epi64x(1);
+    *low = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(shifts)));
+    *high = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(shifts, 1)));
+}
+
+/**
+ * Inserts keys in batches using AVX2 vectors, a block is updated with two loads and two stores
+ * @param filter Pointer to filter to modify
+ * @param keys The keys
+ * @param count Number of keys
+ * @memberof BloomFilter
+ */
+BITSET_TARGET("avx2") inline void bitset_bloom_insert_many_avx2(BloomFilter* const filter, const uint64_t* const keys, const uint64_t count)
+{
+    uint64_t hashes[BITSET_BLOOM_BATCH];
+    for (uint64_t begin = 0; begin < count; begin += BITSET_BLOOM_BATCH)
+    {
+        const uint64_t batch = count - begin < BITSET_BLOOM_BATCH ? count - begin : BITSET_BLOOM_BATCH;
+        for (uint64_t i = 0; i < batch; ++i)
+        {
+            hashes[i] = bitset_bloom_hash(*(keys + begin + i));
+            BITSET_PREFETCH(bitset_bloom_block(filter, hashes[i]), 1);
+        }
+        for (uint64_t i = 0; i < batch; ++i)
+        {
+            __m256i* const block = (__m256i*)bitset_bloom_block(filter, hashes[i]);
+            __m256i low, high;
+            bitset_bloom_masks_avx2(hashes[i], &low, &high);
+            _mm256_store_si256(block, _mm256_or_si256(_mm256_load_si256(block), low));
+            _mm256_store_si256(block + 1, _mm256_or_si256(_mm256_load_si256(block + 1), high));
+        }
+    }
+}
+
+/**
+ * Checks keys in batches using AVX2 vectors, a block is probed with two loads and two tests
+ * @param filter Pointer to filter to check
+ * @param keys The keys
+ * @param count Number of keys
+ * @param results Receives whether each key may have been inserted
+ * @memberof BloomFilter
+ */
+BITSET_TARGET("avx2") inline void bitset_bloom_contains_many_avx2(const BloomFilter* const filter, const uint64_t* const keys, const uint64_t count, bool* const results)
+{
+    uint64_t hashes[BITSET_BLOOM_BATCH];
+    for (uint64_t begin = 0; begin < count; begin += BITSET_BLOOM_BATCH)
+    {
+        const uint64_t batch = count - begin < BITSET_BLOOM_BATCH ? count - begin : BITSET_BLOOM_BATCH;
+        for (uint64_t i = 0; i < batch; ++i)
+        {
+            hashes[i] = bitset_bloom_hash(*(keys + begin + i));
+            BITSET_PREFETCH(bitset_bloom_block(filter, hashes[i]), 0);
+        }
+        for (uint64_t i = 0; i < batch; ++i)
+        {
+            const __m256i* const block = (const __m256i*)bitset_bloom_block(filter, hashes[i]);
+            __m256i low, high;
+            bitset_bloom_masks_avx2(hashes[i], &low, &high);
+            // testc: all the bits of the mask are set in the block
+            *(results + begin + i) = _mm256_testc_si256(_mm256_load_si256(block), low) & _mm256_testc_si256(_mm256_load_si256(block + 1), high);
+        }
+    }
+}
+#endif
+
+/**
+ * Inserts keys in batches, the blocks of a batch are prefetched first so their cache misses overlap,
+ * the fastest kernel supported by the CPU is selected at runtime (AVX2 or portable)
+ * @param filter Pointer to filter to modify
+ * @param keys The keys
+ * @param count Number of keys
+ * @memberof BloomFilter
+ */
+inline void bitset_bloom_insert_many(BloomFilter* const filter, const uint64_t* const keys, const uint64_t count)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (BITSET_CPU_SUPPORTS("avx2"))
+    {
+        bitset_bloom_insert_many_avx2(filter, keys, count);
+        return;
+    }
+#endif
+    bitset_bloom_insert_many_portable(filter, keys, count);
+}
+
+/**
+ * Checks keys in batches, the blocks of a batch are prefetched first so their cache misses overlap,
+ * the fastest kernel supported by the CPU is selected at runtime (AVX2 or portable)
+ * @param filter Pointer to filter to check
+ * @param keys The keys
+ * @param count Number of keys
+ * @param results Receives whether each key may have been inserted
+ * @memberof BloomFilter
+ */
+inline void bitset_bloom_contains_many(const BloomFilter* const filter, const uint64_t* const keys, const uint64_t count, bool* const results)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (BITSET_CPU_SUPPORTS("avx2"))
+    {
+        bitset_bloom_contains_many_avx2(filter, keys, count, results);
+        return;
+    }
+#endif
+    bitset_bloom_contains_many_portable(filter, keys, count, results);
+}
+
+/**
+ * Adds the keys of another filter (union), both filters have to have the same number of blocks
+ * @param destination Pointer to filter to modify
+ * @param source Pointer to filter to add
+ * @memberof BloomFilter
+ */
+inline void bitset_bloom_merge(BloomFilter* const destination, const BloomFilter* const source)
+{
+    bitset_apply_operation(UNIVERSAL_BITSET(&destination->bitset), UNIVERSAL_BITSET(&destination->bitset), UNIVERSAL_BITSET(&source->bitset), BITSET_OR);
+}
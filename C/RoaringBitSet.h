@@ -0,0 +1,1118 @@
+#pragma once
+
+#include "BitSet.h"
+
+/**
+ * Number of bits in a chunk of the roaring bitset, every chunk is stored in its own container
+ */
+#define BITSET_ROARING_CHUNK_BITS 65536u
+
+/**
+ * Number of 64-bit words of a bitmap container
+ */
+#define BITSET_ROARING_CHUNK_WORDS (BITSET_ROARING_CHUNK_BITS / 64u)
+
+/**
+ * Largest number of values kept in an array container, above it a bitmap container is smaller
+ */
+#define BITSET_ROARING_ARRAY_MAX 4096u
+
+/**
+ * Representation of a roaring container
+ */
+typedef enum
+{
+    /**
+     * Sorted array of the set bits (sparse chunks)
+     */
+    BITSET_ROARING_ARRAY,
+    /**
+     * Plain bitmap of the chunk (dense chunks)
+     */
+    BITSET_ROARING_BITMAP,
+    /**
+     * Sorted list of runs of set bits (run-heavy chunks)
+     */
+    BITSET_ROARING_RUN
+} BitSetRoaringType;
+
+/**
+ * A container holding the set bits of one chunk (for C API roaring bitset)
+ */
+typedef struct
+{
+    /**
+     * Array container: sorted set bits, run container: pairs of run start and run length - 1
+     */
+    uint16_t* values;
+    /**
+     * Bitmap container: BITSET_ROARING_CHUNK_WORDS words of bits
+     */
+    uint64_t* words;
+    /**
+     * Number of set bits in the container
+     */
+    uint32_t cardinality;
+    /**
+     * Number of values (array container) or runs (run container) in use
+     */
+    uint32_t size;
+    /**
+     * Number of values (array container) or runs (run container) allocated
+     */
+    uint32_t capacity;
+    /**
+     * Representation of the container
+     */
+    BitSetRoaringType type;
+} BitSetRoaringContainer;
+
+/**
+ * A compressed bitset structure (for C API roaring bitset)
+ * The bits are split into chunks of BITSET_ROARING_CHUNK_BITS bits, only the chunks with a set bit are stored
+ * Every chunk uses the smallest of a sorted array, a bitmap and a run list, so memory follows the content instead of the size
+ */
+typedef struct
+{
+    /**
+     * Chunk index (bit index / BITSET_ROARING_CHUNK_BITS) of every container, ascending
+     */
+    uint64_t* keys;
+    /**
+     * Containers of the stored chunks
+     */
+    BitSetRoaringContainer* containers;
+    /**
+     * Number of stored chunks
+     */
+    uint64_t container_count;
+    /**
+     * Number of chunks allocated
+     */
+    uint64_t capacity;
+    /**
+     * Size of bitset in bits
+     */
+    uint64_t size;
+} RoaringBitSet;
+
+inline void bitset_roaring_container_init(BitSetRoaringContainer* const container);
+inline void bitset_roaring_container_destroy(BitSetRoaringContainer* const container);
+inline uint32_t bitset_roaring_container_search(const uint16_t* const values, const uint32_t size, const uint32_t stride, const uint16_t value);
+inline void bitset_roaring_container_reserve(BitSetRoaringContainer* const container, const uint32_t capacity);
+inline bool bitset_roaring_container_get(const BitSetRoaringContainer* const container, const uint16_t index);
+inline void bitset_roaring_container_set(BitSetRoaringContainer* const container, const uint16_t index);
+inline void bitset_roaring_container_clear(BitSetRoaringContainer* const container, const uint16_t index);
+inline void bitset_roaring_container_to_words(const BitSetRoaringContainer* const container, uint64_t* const words);
+inline uint32_t bitset_roaring_words_run_count(const uint64_t* const words);
+inline void bitset_roaring_words_fill(uint64_t* const words, const bool value, const uint32_t begin, const uint32_t end);
+inline void bitset_roaring_container_build(BitSetRoaringContainer* const container, const uint64_t* const words, const uint32_t cardinality, const BitSetRoaringType type);
+inline void bitset_roaring_container_from_words(BitSetRoaringContainer* const container, const uint64_t* const words, const uint32_t cardinality);
+inline void bitset_roaring_container_convert(BitSetRoaringContainer* const container, const BitSetRoaringType type);
+inline void bitset_roaring_container_optimize(BitSetRoaringContainer* const container);
+inline void bitset_roaring_container_copy(BitSetRoaringContainer* const destination, const BitSetRoaringContainer* const source);
+inline void bitset_roaring_container_filter(BitSetRoaringContainer* const destination, const BitSetRoaringContainer* const values, const BitSetRoaringContainer* const filter, const bool keep);
+inline void bitset_roaring_container_merge(BitSetRoaringContainer* const destination, const BitSetRoaringContainer* const first, const BitSetRoaringContainer* const second, const BitSetOperation operation);
+inline void bitset_roaring_container_operation(BitSetRoaringContainer* const destination, const BitSetRoaringContainer* const first, const BitSetRoaringContainer* const second, const BitSetOperation operation);
+inline uint64_t bitset_roaring_container_memory_usage(const BitSetRoaringContainer* const container);
+inline void bitset_roaring_init(RoaringBitSet* const bitset, const uint64_t size);
+inline void bitset_roaring_init_bitset(RoaringBitSet* const bitset, const BitSet* const source);
+inline void bitset_dynamic_init_roaring(DynamicBitSet* const bitset, const RoaringBitSet* const source);
+inline void bitset_roaring_destroy(RoaringBitSet* const bitset);
+inline void bitset_roaring_copy(RoaringBitSet* const destination, const RoaringBitSet* const source);
+inline void bitset_roaring_move(RoaringBitSet* const destination, RoaringBitSet* const source);
+inline uint64_t bitset_roaring_find_container(const RoaringBitSet* const bitset, const uint64_t key);
+inline BitSetRoaringContainer* bitset_roaring_insert_container(RoaringBitSet* const bitset, const uint64_t position, const uint64_t key);
+inline void bitset_roaring_remove_container(RoaringBitSet* const bitset, const uint64_t position);
+inline bool bitset_roaring_get(const RoaringBitSet* const bitset, const uint64_t index);
+inline void bitset_roaring_set_value(RoaringBitSet* const bitset, const bool value, const uint64_t index);
+inline void bitset_roaring_set(RoaringBitSet* const bitset, const uint64_t index);
+inline void bitset_roaring_clear(RoaringBitSet* const bitset, const uint64_t index);
+inline void bitset_roaring_fill_in_range_begin_end(RoaringBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end);
+inline void bitset_roaring_set_in_range_begin_end(RoaringBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_roaring_clear_in_range_begin_end(RoaringBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_roaring_clear_all(RoaringBitSet* const bitset);
+inline void bitset_roaring_set_all(RoaringBitSet* const bitset);
+inline uint64_t bitset_roaring_count(const RoaringBitSet* const bitset);
+inline bool bitset_roaring_any(const RoaringBitSet* const bitset);
+inline bool bitset_roaring_none(const RoaringBitSet* const bitset);
+inline bool bitset_roaring_all(const RoaringBitSet* const bitset);
+inline void bitset_roaring_optimize(RoaringBitSet* const bitset);
+inline uint64_t bitset_roaring_memory_usage(const RoaringBitSet* const bitset);
+inline void bitset_roaring_apply_operation(RoaringBitSet* const destination, const RoaringBitSet* const first, const RoaringBitSet* const second, const BitSetOperation operation);
+inline void bitset_roaring_and(RoaringBitSet* const destination, const RoaringBitSet* const first, const RoaringBitSet* const second);
+inline void bitset_roaring_or(RoaringBitSet* const destination, const RoaringBitSet* const first, const RoaringBitSet* const second);
+inline void bitset_roaring_xor(RoaringBitSet* const destination, const RoaringBitSet* const first, const RoaringBitSet* const second);
+inline void bitset_roaring_andnot(RoaringBitSet* const destination, const RoaringBitSet* const first, const RoaringBitSet* const second);
+
+/**
+ * Initializes an empty array container
+ * @param container Pointer to container to initialize
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_init(BitSetRoaringContainer* const container)
+{
+    container->values = NULL;
+    container->words = NULL;
+    container->cardinality = 0;
+    container->size = 0;
+    container->capacity = 0;
+    container->type = BITSET_ROARING_ARRAY;
+}
+
+/**
+ * Destroys the container (frees the memory)
+ * @param container Pointer to container to destroy
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_destroy(BitSetRoaringContainer* const container)
+{
+    free(container->values);
+    free(container->words);
+    bitset_roaring_container_init(container);
+}
+
+/**
+ * Binary search in sorted values
+ * @param values The sorted values
+ * @param size Number of the values
+ * @param stride Distance between two consecutive values (1 for arrays, 2 for the starts of runs)
+ * @param value The value to search for
+ * @return Index (in strides) of the first value not lower than value, size if there is none
+ */
+inline uint32_t bitset_roaring_container_search(const uint16_t* const values, const uint32_t size, const uint32_t stride, const uint16_t value)
+{
+    uint32_t low = 0, high = size;
+    while (low < high)
+    {
+        const uint32_t middle = low + (high - low) / 2;
+        if (*(values + middle * stride) < value)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * Makes sure the array or run container can hold the specified number of values or runs
+ * @param container Pointer to container to modify
+ * @param capacity Number of values (array container) or runs (run container) needed
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_reserve(BitSetRoaringContainer* const container, const uint32_t capacity)
+{
+    if (capacity <= container->capacity)
+        return;
+    uint32_t new_capacity = container->capacity * BITSET_GROWTH_FACTOR;
+    if (new_capacity < capacity)
+        new_capacity = capacity < 4 ? 4 : capacity;
+    const uint32_t stride = container->type == BITSET_ROARING_RUN ? 2 : 1;
+    container->values = (uint16_t*)realloc(container->values, new_capacity * stride * sizeof(uint16_t));
+    container->capacity = new_capacity;
+}
+
+/**
+ * Retrieves the value of a bit of the chunk
+ * @param container Pointer to container to read from
+ * @param index The index of the bit in the chunk
+ * @return The value of the bit
+ * @memberof BitSetRoaringContainer
+ */
+inline bool bitset_roaring_container_get(const BitSetRoaringContainer* const container, const uint16_t index)
+{
+    switch (container->type)
+    {
+    case BITSET_ROARING_ARRAY:
+    {
+        const uint32_t position = bitset_roaring_container_search(container->values, container->size, 1, index);
+        return position < container->size && *(container->values + position) == index;
+    }
+    case BITSET_ROARING_BITMAP:
+        return (*(container->words + index / 64) >> index % 64) & 1u;
+    default:
+    {
+        const uint32_t position = bitset_roaring_container_search(container->values, container->size, 2, index);
+        if (position < container->size && *(container->values + position * 2) == index)
+            return true;
+        // otherwise only the previous run can contain the index
+        return position && index - *(container->values + (position - 1) * 2) <= *(container->values + (position - 1) * 2 + 1);
+    }
+    }
+}
+
+/**
+ * Sets a bit of the chunk, full array containers become bitmaps and run containers are unpacked
+ * @param container Pointer to container to modify
+ * @param index The index of the bit in the chunk
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_set(BitSetRoaringContainer* const container, const uint16_t index)
+{
+    if (container->type == BITSET_ROARING_RUN)
+    {
+        if (bitset_roaring_container_get(container, index))
+            return;
+        bitset_roaring_container_convert(container, container->cardinality < BITSET_ROARING_ARRAY_MAX ? BITSET_ROARING_ARRAY : BITSET_ROARING_BITMAP);
+    }
+    if (container->type == BITSET_ROARING_ARRAY)
+    {
+        const uint32_t position = bitset_roaring_container_search(container->values, container->size, 1, index);
+        if (position < container->size && *(container->values + position) == index)
+            return;
+        if (container->size < BITSET_ROARING_ARRAY_MAX)
+        {
+            bitset_roaring_container_reserve(container, container->size + 1);
+            memmove(container->values + position + 1, container->values + position, (container->size - position) * sizeof(uint16_t));
+            *(container->values + position) = index;
+            ++container->size;
+            ++container->cardinality;
+            return;
+        }
+        bitset_roaring_container_convert(container, BITSET_ROARING_BITMAP);
+    }
+    uint64_t* const word = container->words + index / 64;
+    const uint64_t mask = (uint64_t)1u << index % 64;
+    container->cardinality += !(*word & mask);
+    *word |= mask;
+}
+
+/**
+ * Clears a bit of the chunk, sparse bitmap containers become arrays and run containers are unpacked
+ * @param container Pointer to container to modify
+ * @param index The index of the bit in the chunk
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_clear(BitSetRoaringContainer* const container, const uint16_t index)
+{
+    if (container->type == BITSET_ROARING_RUN)
+    {
+        if (!bitset_roaring_container_get(container, index))
+            return;
+        bitset_roaring_container_convert(container, container->cardinality <= BITSET_ROARING_ARRAY_MAX ? BITSET_ROARING_ARRAY : BITSET_ROARING_BITMAP);
+    }
+    if (container->type == BITSET_ROARING_ARRAY)
+    {
+        const uint32_t position = bitset_roaring_container_search(container->values, container->size, 1, index);
+        if (position == container->size || *(container->values + position) != index)
+            return;
+        memmove(container->values + position, container->values + position + 1, (container->size - position - 1) * sizeof(uint16_t));
+        --container->size;
+        --container->cardinality;
+        return;
+    }
+    uint64_t* const word = container->words + index / 64;
+    const uint64_t mask = (uint64_t)1u << index % 64;
+    if (!(*word & mask))
+        return;
+    *word &= ~mask;
+    if (--container->cardinality <= BITSET_ROARING_ARRAY_MAX)
+        bitset_roaring_container_convert(container, BITSET_ROARING_ARRAY);
+}
+
+/**
+ * Writes the chunk as a plain bitmap
+ * @param container Pointer to container to read from
+ * @param words Array of BITSET_ROARING_CHUNK_WORDS words receiving the bits
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_to_words(const BitSetRoaringContainer* const container, uint64_t* const words)
+{
+    if (container->type == BITSET_ROARING_BITMAP)
+    {
+        memcpy(words, container->words, BITSET_ROARING_CHUNK_WORDS * sizeof(uint64_t));
+        return;
+    }
+    memset(words, 0, BITSET_ROARING_CHUNK_WORDS * sizeof(uint64_t));
+    if (container->type == BITSET_ROARING_ARRAY)
+        for (uint32_t i = 0; i < container->size; ++i)
+            *(words + *(container->values + i) / 64) |= (uint64_t)1u << *(container->values + i) % 64;
+    else
+        for (uint32_t i = 0; i < container->size; ++i)
+            bitset_roaring_words_fill(words, true, *(container->values + i * 2), (uint32_t)*(container->values + i * 2) + *(container->values + i * 2 + 1) + 1);
+}
+
+/**
+ * Counts the runs of set bits in a chunk bitmap
+ * @param words Array of BITSET_ROARING_CHUNK_WORDS words
+ * @return The number of runs
+ */
+inline uint32_t bitset_roaring_words_run_count(const uint64_t* const words)
+{
+    uint64_t count = 0, carry = 0;
+    for (uint32_t i = 0; i < BITSET_ROARING_CHUNK_WORDS; ++i)
+    {
+        // a run starts at every set bit whose lower neighbour is cleared
+        count += bitset_popcount64(*(words + i) & ~(*(words + i) << 1 | carry));
+        carry = *(words + i) >> 63;
+    }
+    return (uint32_t)count;
+}
+
+/**
+ * Fills a range of a chunk bitmap with a value
+ * @param words Array of BITSET_ROARING_CHUNK_WORDS words
+ * @param value The value to fill the range with
+ * @param begin The beginning of the range (bit index, inclusive)
+ * @param end The end of the range (bit index, exclusive)
+ */
+inline void bitset_roaring_words_fill(uint64_t* const words, const bool value, const uint32_t begin, const uint32_t end)
+{
+    if (begin >= end)
+        return;
+    const uint32_t first = begin / 64, last = (end - 1) / 64;
+    const uint64_t first_mask = UINT64_MAX << begin % 64, last_mask = UINT64_MAX >> (63 - (end - 1) % 64);
+    if (first == last)
+    {
+        if (value)
+            *(words + first) |= first_mask & last_mask;
+        else
+            *(words + first) &= ~(first_mask & last_mask);
+        return;
+    }
+    if (value)
+    {
+        *(words + first) |= first_mask;
+        *(words + last) |= last_mask;
+    }
+    else
+    {
+        *(words + first) &= ~first_mask;
+        *(words + last) &= ~last_mask;
+    }
+    memset(words + first + 1, value ? 0xFF : 0, (last - first - 1) * sizeof(uint64_t));
+}
+
+/**
+ * Replaces the content of the container with a chunk bitmap stored in the specified representation
+ * @param container Pointer to container to modify (initialized)
+ * @param words Array of BITSET_ROARING_CHUNK_WORDS words (may not alias the container)
+ * @param cardinality Number of set bits in the words
+ * @param type Representation to use (an array has to hold at most BITSET_ROARING_ARRAY_MAX values)
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_build(BitSetRoaringContainer* const container, const uint64_t* const words, const uint32_t cardinality, const BitSetRoaringType type)
+{
+    bitset_roaring_container_destroy(container);
+    container->type = type;
+    container->cardinality = cardinality;
+    if (type == BITSET_ROARING_BITMAP)
+    {
+        container->words = (uint64_t*)malloc(BITSET_ROARING_CHUNK_WORDS * sizeof(uint64_t));
+        memcpy(container->words, words, BITSET_ROARING_CHUNK_WORDS * sizeof(uint64_t));
+        return;
+    }
+    if (type == BITSET_ROARING_ARRAY)
+    {
+        bitset_roaring_container_reserve(container, cardinality);
+        for (uint32_t i = 0; i < BITSET_ROARING_CHUNK_WORDS; ++i)
+            for (uint64_t word = *(words + i); word; word &= word - 1)
+                *(container->values + container->size++) = (uint16_t)(i * 64 + bitset_ctz64(word));
+        return;
+    }
+    bitset_roaring_container_reserve(container, bitset_roaring_words_run_count(words));
+    bool open = false;
+    uint32_t start = 0;
+    for (uint32_t i = 0; i < BITSET_ROARING_CHUNK_WORDS; ++i)
+    {
+        // alternately look for the next set bit (run start) and the next cleared bit (run end) in the word
+        for (uint32_t position = 0; position < 64;)
+        {
+            const uint64_t rest = (open ? ~*(words + i) : *(words + i)) >> position;
+            if (!rest)
+                break;
+            position += (uint32_t)bitset_ctz64(rest);
+            if (open)
+            {
+                *(container->values + container->size * 2) = (uint16_t)start;
+                *(container->values + container->size * 2 + 1) = (uint16_t)(i * 64 + position - 1 - start);
+                ++container->size;
+            }
+            else
+                start = i * 64 + position;
+            open = !open;
+        }
+    }
+    if (open)
+    {
+        *(container->values + container->size * 2) = (uint16_t)start;
+        *(container->values + container->size * 2 + 1) = (uint16_t)(BITSET_ROARING_CHUNK_BITS - 1 - start);
+        ++container->size;
+    }
+}
+
+/**
+ * Replaces the content of the container with a chunk bitmap stored in its smallest representation
+ * @param container Pointer to container to modify (initialized)
+ * @param words Array of BITSET_ROARING_CHUNK_WORDS words (may not alias the container)
+ * @param cardinality Number of set bits in the words
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_from_words(BitSetRoaringContainer* const container, const uint64_t* const words, const uint32_t cardinality)
+{
+    // sizes in bytes: array 2 per value, bitmap 8192, run 4 per run
+    const uint64_t run_bytes = (uint64_t)bitset_roaring_words_run_count(words) * 4;
+    const uint64_t other_bytes = cardinality <= BITSET_ROARING_ARRAY_MAX ? (uint64_t)cardinality * 2 : BITSET_ROARING_CHUNK_WORDS * sizeof(uint64_t);
+    if (run_bytes < other_bytes)
+        bitset_roaring_container_build(container, words, cardinality, BITSET_ROARING_RUN);
+    else
+        bitset_roaring_container_build(container, words, cardinality, cardinality <= BITSET_ROARING_ARRAY_MAX ? BITSET_ROARING_ARRAY : BITSET_ROARING_BITMAP);
+}
+
+/**
+ * Changes the representation of the container
+ * @param container Pointer to container to modify
+ * @param type The new representation (an array has to hold at most BITSET_ROARING_ARRAY_MAX values)
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_convert(BitSetRoaringContainer* const container, const BitSetRoaringType type)
+{
+    if (container->type == type)
+        return;
+    uint64_t words[BITSET_ROARING_CHUNK_WORDS];
+    bitset_roaring_container_to_words(container, words);
+    bitset_roaring_container_build(container, words, container->cardinality, type);
+}
+
+/**
+ * Stores the container in its smallest representation (including run lists)
+ * @param container Pointer to container to modify
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_optimize(BitSetRoaringContainer* const container)
+{
+    uint64_t words[BITSET_ROARING_CHUNK_WORDS];
+    bitset_roaring_container_to_words(container, words);
+    bitset_roaring_container_from_words(container, words, container->cardinality);
+}
+
+/**
+ * Copies the container
+ * @param destination Pointer to container to copy to (initialized, its content is replaced)
+ * @param source Pointer to container to copy from
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_copy(BitSetRoaringContainer* const destination, const BitSetRoaringContainer* const source)
+{
+    bitset_roaring_container_destroy(destination);
+    destination->type = source->type;
+    destination->cardinality = source->cardinality;
+    if (source->type == BITSET_ROARING_BITMAP)
+    {
+        destination->words = (uint64_t*)malloc(BITSET_ROARING_CHUNK_WORDS * sizeof(uint64_t));
+        memcpy(destination->words, source->words, BITSET_ROARING_CHUNK_WORDS * sizeof(uint64_t));
+        return;
+    }
+    const uint32_t stride = source->type == BITSET_ROARING_RUN ? 2 : 1;
+    bitset_roaring_container_reserve(destination, source->size);
+    memcpy(destination->values, source->values, source->size * stride * sizeof(uint16_t));
+    destination->size = source->size;
+}
+
+/**
+ * Keeps the values of an array container that are (or are not) set in another container
+ * @param destination Pointer to container receiving the result (initialized, may not be one of the operands)
+ * @param values Pointer to array container to filter
+ * @param filter Pointer to container filtering the values
+ * @param keep true to keep the values set in filter (and), false to keep the values cleared in filter (andnot)
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_filter(BitSetRoaringContainer* const destination, const BitSetRoaringContainer* const values, const BitSetRoaringContainer* const filter, const bool keep)
+{
+    bitset_roaring_container_destroy(destination);
+    bitset_roaring_container_reserve(destination, values->size);
+    for (uint32_t i = 0; i < values->size; ++i)
+        if (bitset_roaring_container_get(filter, *(values->values + i)) == keep)
+            *(destination->values + destination->size++) = *(values->values + i);
+    destination->cardinality = destination->size;
+}
+
+/**
+ * Applies the bitwise operation to two array containers by merging the sorted values
+ * @param destination Pointer to container receiving the result (initialized, may not be one of the operands)
+ * @param first Pointer to the first array container
+ * @param second Pointer to the second array container
+ * @param operation The operation to apply
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_merge(BitSetRoaringContainer* const destination, const BitSetRoaringContainer* const first, const BitSetRoaringContainer* const second, const BitSetOperation operation)
+{
+    const bool keep_first = operation != BITSET_AND, keep_second = operation == BITSET_OR || operation == BITSET_XOR, keep_both = operation == BITSET_AND || operation == BITSET_OR;
+    uint16_t values[BITSET_ROARING_ARRAY_MAX * 2];
+    uint32_t size = 0, i = 0, j = 0;
+    while (i < first->size && j < second->size)
+    {
+        const uint16_t a = *(first->values + i), b = *(second->values + j);
+        if (a < b)
+        {
+            if (keep_first)
+                *(values + size++) = a;
+            ++i;
+        }
+        else if (b < a)
+        {
+            if (keep_second)
+                *(values + size++) = b;
+            ++j;
+        }
+        else
+        {
+            if (keep_both)
+                *(values + size++) = a;
+            ++i;
+            ++j;
+        }
+    }
+    for (; keep_first && i < first->size; ++i)
+        *(values + size++) = *(first->values + i);
+    for (; keep_second && j < second->size; ++j)
+        *(values + size++) = *(second->values + j);
+
+    bitset_roaring_container_destroy(destination);
+    if (size <= BITSET_ROARING_ARRAY_MAX)
+    {
+        bitset_roaring_container_reserve(destination, size);
+        memcpy(destination->values, values, size * sizeof(uint16_t));
+        destination->size = destination->cardinality = size;
+        return;
+    }
+    uint64_t words[BITSET_ROARING_CHUNK_WORDS];
+    memset(words, 0, sizeof(words));
+    for (uint32_t k = 0; k < size; ++k)
+        *(words + *(values + k) / 64) |= (uint64_t)1u << *(values + k) % 64;
+    bitset_roaring_container_from_words(destination, words, size);
+}
+
+/**
+ * Applies the bitwise operation to two containers
+ * Arrays are merged or filtered, everything else is expanded to bitmaps and combined by the fastest kernel supported by the CPU
+ * @param destination Pointer to container receiving the result (initialized, may not be one of the operands), its cardinality may be 0
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param operation The operation to apply
+ * @memberof BitSetRoaringContainer
+ */
+inline void bitset_roaring_container_operation(BitSetRoaringContainer* const destination, const BitSetRoaringContainer* const first, const BitSetRoaringContainer* const second, const BitSetOperation operation)
+{
+    if (first->type == BITSET_ROARING_ARRAY && second->type == BITSET_ROARING_ARRAY)
+    {
+        bitset_roaring_container_merge(destination, first, second, operation);
+        return;
+    }
+    if (first->type == BITSET_ROARING_ARRAY && (operation == BITSET_AND || operation == BITSET_ANDNOT))
+    {
+        bitset_roaring_container_filter(destination, first, second, operation == BITSET_AND);
+        return;
+    }
+    if (second->type == BITSET_ROARING_ARRAY && operation == BITSET_AND)
+    {
+        bitset_roaring_container_filter(destination, second, first, true);
+        return;
+    }
+    uint64_t first_words[BITSET_ROARING_CHUNK_WORDS], second_words[BITSET_ROARING_CHUNK_WORDS];
+    bitset_roaring_container_to_words(first, first_words);
+    bitset_roaring_container_to_words(second, second_words);
+    bitset_operation_buffer(first_words, first_words, second_words, sizeof(first_words), operation);
+    bitset_roaring_container_from_words(destination, first_words, (uint32_t)bitset_popcount_buffer(first_words, sizeof(first_words)));
+}
+
+/**
+ * @param container Pointer to container
+ * @return Number of bytes allocated by the container
+ * @memberof BitSetRoaringContainer
+ */
+inline uint64_t bitset_roaring_container_memory_usage(const BitSetRoaringContainer* const container)
+{
+    if (container->type == BITSET_ROARING_BITMAP)
+        return BITSET_ROARING_CHUNK_WORDS * sizeof(uint64_t);
+    return (uint64_t)container->capacity * (container->type == BITSET_ROARING_RUN ? 2 : 1) * sizeof(uint16_t);
+}
+
+/**
+ * Size initialization, all the bits are cleared and no memory is allocated
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset to be initialized
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_init(RoaringBitSet* const bitset, const uint64_t size)
+{
+    bitset->keys = NULL;
+    bitset->containers = NULL;
+    bitset->container_count = 0;
+    bitset->capacity = 0;
+    bitset->size = size;
+}
+
+/**
+ * Initialization from an uncompressed bitset, every chunk is stored in its smallest representation
+ * @param bitset Pointer to bitset to initialize
+ * @param source Pointer to bitset to compress (BitSet or DynamicBitSet)
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_init_bitset(RoaringBitSet* const bitset, const BitSet* const source)
+{
+    bitset_roaring_init(bitset, source->size);
+    uint64_t words[BITSET_ROARING_CHUNK_WORDS];
+    for (uint64_t key = 0; key * BITSET_ROARING_CHUNK_BITS < source->size; ++key)
+    {
+        bitset_load_words(source, key * BITSET_ROARING_CHUNK_WORDS, words, BITSET_ROARING_CHUNK_WORDS);
+        const uint64_t cardinality = bitset_popcount_buffer(words, sizeof(words));
+        if (cardinality)
+            bitset_roaring_container_from_words(bitset_roaring_insert_container(bitset, bitset->container_count, key), words, (uint32_t)cardinality);
+    }
+}
+
+/**
+ * Initialization from a roaring bitset, the result has the same size and bits
+ * @param bitset Pointer to bitset to initialize
+ * @param source Pointer to bitset to decompress
+ * @memberof DynamicBitSet
+ */
+inline void bitset_dynamic_init_roaring(DynamicBitSet* const bitset, const RoaringBitSet* const source)
+{
+    bitset_dynamic_init(bitset, source->size);
+    uint64_t words[BITSET_ROARING_CHUNK_WORDS];
+    for (uint64_t i = 0; i < source->container_count; ++i)
+    {
+        const BitSetRoaringContainer* const container = source->containers + i;
+        const uint64_t offset = *(source->keys + i) * BITSET_ROARING_CHUNK_BITS;
+        if (container->type == BITSET_ROARING_ARRAY)
+            for (uint32_t j = 0; j < container->size; ++j)
+                bitset_set(UNIVERSAL_BITSET(bitset), offset + *(container->values + j));
+        else if (container->type == BITSET_ROARING_RUN)
+            for (uint32_t j = 0; j < container->size; ++j)
+                bitset_set_in_range_begin_end(UNIVERSAL_BITSET(bitset), offset + *(container->values + j * 2), offset + *(container->values + j * 2) + *(container->values + j * 2 + 1) + 1);
+        else
+        {
+            bitset_roaring_container_to_words(container, words);
+            bitset_store_words(UNIVERSAL_BITSET(bitset), *(source->keys + i) * BITSET_ROARING_CHUNK_WORDS, words, BITSET_ROARING_CHUNK_WORDS);
+        }
+    }
+}
+
+/**
+ * Destroys the bitset (frees the memory)
+ * @param bitset Pointer to bitset to destroy
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_destroy(RoaringBitSet* const bitset)
+{
+    for (uint64_t i = 0; i < bitset->container_count; ++i)
+        bitset_roaring_container_destroy(bitset->containers + i);
+    free(bitset->containers);
+    free(bitset->keys);
+    bitset_roaring_init(bitset, 0);
+}
+
+/**
+ * Copies the content and the size of one bitset to another
+ * @param destination Pointer to bitset to copy to (initialized, its content is replaced)
+ * @param source Pointer to bitset to copy from
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_copy(RoaringBitSet* const destination, const RoaringBitSet* const source)
+{
+    if (destination == source)
+        return;
+    bitset_roaring_destroy(destination);
+    destination->size = source->size;
+    for (uint64_t i = 0; i < source->container_count; ++i)
+        bitset_roaring_container_copy(bitset_roaring_insert_container(destination, i, *(source->keys + i)), source->containers + i);
+}
+
+/**
+ * Moves the data from one bitset to another
+ * @param destination Pointer to bitset to move to (its previous content is not freed)
+ * @param source Pointer to bitset to move from
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_move(RoaringBitSet* const destination, RoaringBitSet* const source)
+{
+    *destination = *source;
+    bitset_roaring_init(source, 0);
+}
+
+/**
+ * Finds the position of a chunk in the bitset
+ * @param bitset Pointer to bitset to search
+ * @param key Index of the chunk (bit index / BITSET_ROARING_CHUNK_BITS)
+ * @return Position of the first stored chunk with a key not lower than key, container_count if there is none
+ * @memberof RoaringBitSet
+ */
+inline uint64_t bitset_roaring_find_container(const RoaringBitSet* const bitset, const uint64_t key)
+{
+    uint64_t low = 0, high = bitset->container_count;
+    // appending at the end is the common case
+    if (high && *(bitset->keys + high - 1) < key)
+        return high;
+    while (low < high)
+    {
+        const uint64_t middle = low + (high - low) / 2;
+        if (*(bitset->keys + middle) < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * Inserts an empty array container for a chunk
+ * @param bitset Pointer to bitset to modify
+ * @param position Position of the new container (keeps the keys ascending)
+ * @param key Index of the chunk
+ * @return Pointer to the new container (valid until the next insertion or removal)
+ * @memberof RoaringBitSet
+ */
+inline BitSetRoaringContainer* bitset_roaring_insert_container(RoaringBitSet* const bitset, const uint64_t position, const uint64_t key)
+{
+    if (bitset->container_count == bitset->capacity)
+    {
+        bitset->capacity = bitset->capacity ? bitset->capacity * BITSET_GROWTH_FACTOR : 4;
+        bitset->keys = (uint64_t*)realloc(bitset->keys, bitset->capacity * sizeof(uint64_t));
+        bitset->containers = (BitSetRoaringContainer*)realloc(bitset->containers, bitset->capacity * sizeof(BitSetRoaringContainer));
+    }
+    memmove(bitset->keys + position + 1, bitset->keys + position, (bitset->container_count - position) * sizeof(uint64_t));
+    memmove(bitset->containers + position + 1, bitset->containers + position, (bitset->container_count - position) * sizeof(BitSetRoaringContainer));
+    ++bitset->container_count;
+    *(bitset->keys + position) = key;
+    bitset_roaring_container_init(bitset->containers + position);
+    return bitset->containers + position;
+}
+
+/**
+ * Removes (and destroys) a container
+ * @param bitset Pointer to bitset to modify
+ * @param position Position of the container to remove
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_remove_container(RoaringBitSet* const bitset, const uint64_t position)
+{
+    bitset_roaring_container_destroy(bitset->containers + position);
+    --bitset->container_count;
+    memmove(bitset->keys + position, bitset->keys + position + 1, (bitset->container_count - position) * sizeof(uint64_t));
+    memmove(bitset->containers + position, bitset->containers + position + 1, (bitset->container_count - position) * sizeof(BitSetRoaringContainer));
+}
+
+/**
+ * Retrieves the value of a bit at a specified index
+ * @param bitset Pointer to bitset to read from
+ * @param index The index of the bit to read (bit index)
+ * @return The value of the bit at the specified index
+ * @memberof RoaringBitSet
+ */
+inline bool bitset_roaring_get(const RoaringBitSet* const bitset, const uint64_t index)
+{
+    const uint64_t key = index / BITSET_ROARING_CHUNK_BITS;
+    const uint64_t position = bitset_roaring_find_container(bitset, key);
+    return position < bitset->container_count && *(bitset->keys + position) == key && bitset_roaring_container_get(bitset->containers + position, (uint16_t)(index % BITSET_ROARING_CHUNK_BITS));
+}
+
+/**
+ * Sets the value of a bit at a specified index
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to set the bit to
+ * @param index The index of the bit to modify (bit index)
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_set_value(RoaringBitSet* const bitset, const bool value, const uint64_t index)
+{
+    if (value)
+        bitset_roaring_set(bitset, index);
+    else
+        bitset_roaring_clear(bitset, index);
+}
+
+/**
+ * Sets the value of a bit at a specified index to 1 (true)
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to set (bit index)
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_set(RoaringBitSet* const bitset, const uint64_t index)
+{
+    const uint64_t key = index / BITSET_ROARING_CHUNK_BITS;
+    const uint64_t position = bitset_roaring_find_container(bitset, key);
+    BitSetRoaringContainer* const container = position < bitset->container_count && *(bitset->keys + position) == key ? bitset->containers + position : bitset_roaring_insert_container(bitset, position, key);
+    bitset_roaring_container_set(container, (uint16_t)(index % BITSET_ROARING_CHUNK_BITS));
+}
+
+/**
+ * Sets the value of a bit at a specified index to 0 (false), chunks left empty are freed
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to clear (bit index)
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_clear(RoaringBitSet* const bitset, const uint64_t index)
+{
+    const uint64_t key = index / BITSET_ROARING_CHUNK_BITS;
+    const uint64_t position = bitset_roaring_find_container(bitset, key);
+    if (position == bitset->container_count || *(bitset->keys + position) != key)
+        return;
+    bitset_roaring_container_clear(bitset->containers + position, (uint16_t)(index % BITSET_ROARING_CHUNK_BITS));
+    if (!(bitset->containers + position)->cardinality)
+        bitset_roaring_remove_container(bitset, position);
+}
+
+/**
+ * Fills a range of the bitset with a specified value, whole chunks become single runs (set) or are freed (clear)
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the range with
+ * @param begin The beginning of the range to fill (bit index, inclusive)
+ * @param end The end of the range to fill (bit index, exclusive)
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_fill_in_range_begin_end(RoaringBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end)
+{
+    uint64_t words[BITSET_ROARING_CHUNK_WORDS];
+    for (uint64_t key = begin / BITSET_ROARING_CHUNK_BITS; begin < end && key <= (end - 1) / BITSET_ROARING_CHUNK_BITS; ++key)
+    {
+        const uint64_t chunk = key * BITSET_ROARING_CHUNK_BITS;
+        const uint32_t low = begin > chunk ? (uint32_t)(begin - chunk) : 0;
+        const uint32_t high = end - chunk < BITSET_ROARING_CHUNK_BITS ? (uint32_t)(end - chunk) : BITSET_ROARING_CHUNK_BITS;
+        uint64_t position = bitset_roaring_find_container(bitset, key);
+        const bool found = position < bitset->container_count && *(bitset->keys + position) == key;
+        if (!found && !value)
+            continue;
+        if (low == 0 && high == BITSET_ROARING_CHUNK_BITS)
+        {
+            if (!value)
+            {
+                bitset_roaring_remove_container(bitset, position);
+                continue;
+            }
+            BitSetRoaringContainer* const container = found ? bitset->containers + position : bitset_roaring_insert_container(bitset, position, key);
+            bitset_roaring_container_destroy(container);
+            container->type = BITSET_ROARING_RUN;
+            bitset_roaring_container_reserve(container, 1);
+            *container->values = 0;
+            *(container->values + 1) = (uint16_t)(BITSET_ROARING_CHUNK_BITS - 1);
+            container->size = 1;
+            container->cardinality = BITSET_ROARING_CHUNK_BITS;
+            continue;
+        }
+        BitSetRoaringContainer* const container = found ? bitset->containers + position : bitset_roaring_insert_container(bitset, position, key);
+        bitset_roaring_container_to_words(container, words);
+        bitset_roaring_words_fill(words, value, low, high);
+        const uint64_t cardinality = bitset_popcount_buffer(words, sizeof(words));
+        if (cardinality)
+            bitset_roaring_container_from_words(container, words, (uint32_t)cardinality);
+        else
+            bitset_roaring_remove_container(bitset, position);
+    }
+}
+
+/**
+ * Sets the bits in a range
+ * @param bitset Pointer to bitset to modify
+ * @param begin The beginning of the range to set (bit index, inclusive)
+ * @param end The end of the range to set (bit index, exclusive)
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_set_in_range_begin_end(RoaringBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_roaring_fill_in_range_begin_end(bitset, true, begin, end);
+}
+
+/**
+ * Clears the bits in a range
+ * @param bitset Pointer to bitset to modify
+ * @param begin The beginning of the range to clear (bit index, inclusive)
+ * @param end The end of the range to clear (bit index, exclusive)
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_clear_in_range_begin_end(RoaringBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_roaring_fill_in_range_begin_end(bitset, false, begin, end);
+}
+
+/**
+ * Clears all the bits (frees the containers)
+ * @param bitset Pointer to bitset to modify
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_clear_all(RoaringBitSet* const bitset)
+{
+    const uint64_t size = bitset->size;
+    bitset_roaring_destroy(bitset);
+    bitset->size = size;
+}
+
+/**
+ * Sets all the bits (one run per chunk)
+ * @param bitset Pointer to bitset to modify
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_set_all(RoaringBitSet* const bitset)
+{
+    bitset_roaring_fill_in_range_begin_end(bitset, true, 0, bitset->size);
+}
+
+/**
+ * Counts the set bits, the cardinality of every container is kept up to date so this is O(number of chunks)
+ * @param bitset Pointer to bitset to count
+ * @return The number of set bits
+ * @memberof RoaringBitSet
+ */
+inline uint64_t bitset_roaring_count(const RoaringBitSet* const bitset)
+{
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < bitset->container_count; ++i)
+        count += (bitset->containers + i)->cardinality;
+    return count;
+}
+
+/**
+ * Checks if any bit is set, empty chunks are never stored so this is O(1)
+ * @param bitset Pointer to bitset to check
+ * @return true if any bit is set, false otherwise
+ * @memberof RoaringBitSet
+ */
+inline bool bitset_roaring_any(const RoaringBitSet* const bitset)
+{
+    return bitset->container_count != 0;
+}
+
+/**
+ * Checks if none of the bits are set
+ * @param bitset Pointer to bitset to check
+ * @return true if no bit is set, false otherwise
+ * @memberof RoaringBitSet
+ */
+inline bool bitset_roaring_none(const RoaringBitSet* const bitset)
+{
+    return bitset->container_count == 0;
+}
+
+/**
+ * Checks if all the bits are set
+ * @param bitset Pointer to bitset to check
+ * @return true if all the bits are set, false otherwise
+ * @memberof RoaringBitSet
+ */
+inline bool bitset_roaring_all(const RoaringBitSet* const bitset)
+{
+    // every stored chunk has to be full and every chunk has to be stored
+    if (bitset->container_count != bitset->size / BITSET_ROARING_CHUNK_BITS + (bitset->size % BITSET_ROARING_CHUNK_BITS ? 1 : 0))
+        return false;
+    return bitset_roaring_count(bitset) == bitset->size;
+}
+
+/**
+ * Stores every container in its smallest representation, converting run-heavy chunks to run lists
+ * Point updates only switch between arrays and bitmaps, so call this after building the bitset bit by bit
+ * @param bitset Pointer to bitset to modify
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_optimize(RoaringBitSet* const bitset)
+{
+    for (uint64_t i = 0; i < bitset->container_count; ++i)
+        bitset_roaring_container_optimize(bitset->containers + i);
+}
+
+/**
+ * @param bitset Pointer to bitset
+ * @return Number of bytes allocated by the bitset (excluding the structure itself)
+ * @memberof RoaringBitSet
+ */
+inline uint64_t bitset_roaring_memory_usage(const RoaringBitSet* const bitset)
+{
+    uint64_t bytes = bitset->capacity * (sizeof(uint64_t) + sizeof(BitSetRoaringContainer));
+    for (uint64_t i = 0; i < bitset->container_count; ++i)
+        bytes += bitset_roaring_container_memory_usage(bitset->containers + i);
+    return bytes;
+}
+
+/**
+ * Applies the bitwise operation to two bitsets chunk by chunk, chunks missing from both operands are skipped
+ * The result has the size of the smaller operand
+ * @param destination Pointer to bitset receiving the result (initialized, may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param operation The operation to apply
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_apply_operation(RoaringBitSet* const destination, const RoaringBitSet* const first, const RoaringBitSet* const second, const BitSetOperation operation)
+{
+    RoaringBitSet result;
+    bitset_roaring_init(&result, first->size < second->size ? first->size : second->size);
+    uint64_t i = 0, j = 0;
+    while (i < first->container_count || j < second->container_count)
+    {
+        const uint64_t first_key = i < first->container_count ? *(first->keys + i) : UINT64_MAX;
+        const uint64_t second_key = j < second->container_count ? *(second->keys + j) : UINT64_MAX;
+        const uint64_t key = first_key < second_key ? first_key : second_key;
+        if (key * BITSET_ROARING_CHUNK_BITS >= result.size)
+            break;
+        BitSetRoaringContainer* const container = bitset_roaring_insert_container(&result, result.container_count, key);
+        if (first_key == second_key)
+            bitset_roaring_container_operation(container, first->containers + i++, second->containers + j++, operation);
+        else if (first_key < second_key)
+        {
+            if (operation != BITSET_AND)
+                bitset_roaring_container_copy(container, first->containers + i);
+            ++i;
+        }
+        else
+        {
+            if (operation == BITSET_OR || operation == BITSET_XOR)
+                bitset_roaring_container_copy(container, second->containers + j);
+            ++j;
+        }
+        if (!container->cardinality)
+            bitset_roaring_remove_container(&result, result.container_count - 1);
+    }
+    // bits of the larger operand past the size of the result
+    if (result.size % BITSET_ROARING_CHUNK_BITS)
+        bitset_roaring_clear_in_range_begin_end(&result, result.size, (result.size / BITSET_ROARING_CHUNK_BITS + 1) * BITSET_ROARING_CHUNK_BITS);
+    bitset_roaring_destroy(destination);
+    bitset_roaring_move(destination, &result);
+}
+
+/**
+ * Stores the intersection of two bitsets (first & second)
+ * @param destination Pointer to bitset receiving the result (initialized, may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_and(RoaringBitSet* const destination, const RoaringBitSet* const first, const RoaringBitSet* const second)
+{
+    bitset_roaring_apply_operation(destination, first, second, BITSET_AND);
+}
+
+/**
+ * Stores the union of two bitsets (first | second)
+ * @param destination Pointer to bitset receiving the result (initialized, may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_or(RoaringBitSet* const destination, const RoaringBitSet* const first, const RoaringBitSet* const second)
+{
+    bitset_roaring_apply_operation(destination, first, second, BITSET_OR);
+}
+
+/**
+ * Stores the symmetric difference of two bitsets (first ^ second)
+ * @param destination Pointer to bitset receiving the result (initialized, may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_xor(RoaringBitSet* const destination, const RoaringBitSet* const first, const RoaringBitSet* const second)
+{
+    bitset_roaring_apply_operation(destination, first, second, BITSET_XOR);
+}
+
+/**
+ * Stores the difference of two bitsets (first & ~second)
+ * @param destination Pointer to bitset receiving the result (initialized, may be the same as one of the operands)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @memberof RoaringBitSet
+ */
+inline void bitset_roaring_andnot(RoaringBitSet* const destination, const RoaringBitSet* const first, const RoaringBitSet* const second)
+{
+    bitset_roaring_apply_operation(destination, first, second, BITSET_ANDNOT);
+}
@@ -0,0 +1,578 @@
+#pragma once
+
+#include "BitSet.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * Size of a chunk of a shared bitset in bytes, copy-on-write duplicates one chunk at a time (a multiple of the page size and of the block size)
+ */
+#ifndef BITSET_SHARED_CHUNK_BYTES
+#define BITSET_SHARED_CHUNK_BYTES 65536u
+#endif
+
+/**
+ * Number of blocks of a chunk
+ */
+#define BITSET_SHARED_CHUNK_BLOCKS (BITSET_SHARED_CHUNK_BYTES / sizeof(bitset_block_t))
+
+/**
+ * Number of bits of a chunk
+ */
+#define BITSET_SHARED_CHUNK_BITS ((uint64_t)BITSET_SHARED_CHUNK_BYTES * 8u)
+
+/**
+ * Alignment of the chunks in bytes, the blocks start one alignment after the reference count
+ */
+#define BITSET_SHARED_ALIGNMENT 64u
+
+/**
+ * A reference counted chunk of blocks, followed by BITSET_SHARED_CHUNK_BLOCKS blocks (for C API shared bitset)
+ */
+typedef struct
+{
+    /**
+     * Number of tables pointing to the chunk (atomic)
+     */
+    uint64_t references;
+    /**
+     * Zeros up to BITSET_SHARED_ALIGNMENT
+     */
+    uint8_t padding[BITSET_SHARED_ALIGNMENT - sizeof(uint64_t)];
+} BitSetSharedChunk;
+
+/**
+ * A reference counted array of chunks (for C API shared bitset)
+ */
+typedef struct
+{
+    /**
+     * Number of shared bitsets pointing to the table (atomic)
+     */
+    uint64_t references;
+    /**
+     * Number of chunks
+     */
+    uint64_t count;
+    /**
+     * The chunks, cleared chunks all point to one zero chunk until they are written
+     */
+    BitSetSharedChunk** chunks;
+} BitSetSharedTable;
+
+/**
+ * A bitset with copy-on-write storage (for C API shared bitset)
+ * The bits past the size are always cleared, so whole chunks can be counted and combined
+ * A snapshot only takes a reference to the table, the first write after it copies the table (one pointer per chunk)
+ * and every write copies the chunk it touches if another snapshot still uses it, so a snapshot costs the chunks written afterwards, not the size
+ * One thread writes (and takes snapshots), any thread may read and destroy its own snapshots
+ */
+typedef struct
+{
+    /**
+     * The table of chunks
+     */
+    BitSetSharedTable* table;
+    /**
+     * Size of bitset in bits
+     */
+    uint64_t size;
+} SharedBitSet;
+
+inline uint64_t bitset_shared_reference_load(const uint64_t* const references);
+inline uint64_t bitset_shared_reference_add(uint64_t* const references, const int64_t delta);
+inline bitset_block_t* bitset_shared_chunk_data(const BitSetSharedChunk* const chunk);
+inline uint64_t bitset_shared_chunk_count(const uint64_t size);
+inline BitSetSharedChunk* bitset_shared_chunk_allocate(const uint64_t references);
+inline void bitset_shared_chunk_release(BitSetSharedChunk* const chunk);
+inline BitSetSharedTable* bitset_shared_table_allocate(const uint64_t count);
+inline void bitset_shared_table_release(BitSetSharedTable* const table);
+inline void bitset_shared_init(SharedBitSet* const bitset, const uint64_t size);
+inline void bitset_shared_init_bitset(SharedBitSet* const bitset, const BitSet* const source);
+inline void bitset_dynamic_init_shared(DynamicBitSet* const bitset, const SharedBitSet* const source);
+inline void bitset_shared_destroy(SharedBitSet* const bitset);
+inline void bitset_shared_snapshot(SharedBitSet* const destination, const SharedBitSet* const source);
+inline BitSetSharedTable* bitset_shared_own_table(SharedBitSet* const bitset);
+inline bitset_block_t* bitset_shared_writable_chunk(SharedBitSet* const bitset, const uint64_t chunk);
+inline DynamicBitSet bitset_shared_chunk_view(const SharedBitSet* const bitset, const uint64_t chunk);
+inline DynamicBitSet bitset_shared_writable_chunk_view(SharedBitSet* const bitset, const uint64_t chunk);
+inline bool bitset_shared_get(const SharedBitSet* const bitset, const uint64_t index);
+inline void bitset_shared_set_value(SharedBitSet* const bitset, const bool value, const uint64_t index);
+inline void bitset_shared_set(SharedBitSet* const bitset, const uint64_t index);
+inline void bitset_shared_clear(SharedBitSet* const bitset, const uint64_t index);
+inline void bitset_shared_flip_bit(SharedBitSet* const bitset, const uint64_t index);
+inline void bitset_shared_fill_in_range_begin_end(SharedBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end);
+inline void bitset_shared_set_in_range_begin_end(SharedBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_shared_clear_in_range_begin_end(SharedBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_shared_clear_all(SharedBitSet* const bitset);
+inline uint64_t bitset_shared_count(const SharedBitSet* const bitset);
+inline void bitset_shared_apply_operation(SharedBitSet* const destination, const SharedBitSet* const first, const SharedBitSet* const second, const BitSetOperation operation);
+
+/**
+ * Loads a reference count (acquire, writes by the releasing thread happen before)
+ * @param references Pointer to the reference count
+ * @return The reference count
+ */
+inline uint64_t bitset_shared_reference_load(const uint64_t* const references)
+{
+#ifdef _MSC_VER
+    return (uint64_t)_InterlockedOr64((volatile __int64*)references, 0);
+#else
+    return __atomic_load_n(references, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/**
+ * Changes a reference count (acquire and release)
+ * @param references Pointer to the reference count
+ * @param delta Value to add
+ * @return The new reference count
+ */
+inline uint64_t bitset_shared_reference_add(uint64_t* const references, const int64_t delta)
+{
+#ifdef _MSC_VER
+    return (uint64_t)(_InterlockedExchangeAdd64((volatile __int64*)references, delta) + delta);
+#else
+    return __atomic_add_fetch(references, (uint64_t)delta, __ATOMIC_ACQ_REL);
+#endif
+}
+
+/**
+ * Returns the blocks of a chunk
+ * @param chunk Pointer to the chunk
+ * @return Pointer to the first of BITSET_SHARED_CHUNK_BLOCKS blocks
+ * @memberof BitSetSharedChunk
+ */
+inline bitset_block_t* bitset_shared_chunk_data(const BitSetSharedChunk* const chunk)
+{
+    return (bitset_block_t*)(chunk + 1);
+}
+
+/**
+ * Calculates the number of chunks of a shared bitset
+ * @param size Size of the bitset in bits
+ * @return The number of chunks
+ */
+inline uint64_t bitset_shared_chunk_count(const uint64_t size)
+{
+    return size / BITSET_SHARED_CHUNK_BITS + (size % BITSET_SHARED_CHUNK_BITS != 0);
+}
+
+/**
+ * Allocates a chunk with every bit cleared
+ * @param references Initial reference count
+ * @return The chunk
+ * @memberof BitSetSharedChunk
+ */
+inline BitSetSharedChunk* bitset_shared_chunk_allocate(const uint64_t references)
+{
+    BitSetSharedChunk* const chunk = (BitSetSharedChunk*)bitset_allocate(NULL, sizeof(BitSetSharedChunk) + BITSET_SHARED_CHUNK_BYTES, BITSET_SHARED_ALIGNMENT);
+    memset(chunk, 0, sizeof(BitSetSharedChunk) + BITSET_SHARED_CHUNK_BYTES);
+    chunk->references = references;
+    return chunk;
+}
+
+/**
+ * Drops a reference to a chunk, the last one frees it
+ * @param chunk Pointer to the chunk
+ * @memberof BitSetSharedChunk
+ */
+inline void bitset_shared_chunk_release(BitSetSharedChunk* const chunk)
+{
+    if (!bitset_shared_reference_add(&chunk->references, -1))
+        bitset_deallocate(NULL, chunk, sizeof(BitSetSharedChunk) + BITSET_SHARED_CHUNK_BYTES, BITSET_SHARED_ALIGNMENT);
+}
+
+/**
+ * Allocates a table with one reference, the chunks are not set
+ * @param count Number of chunks
+ * @return The table
+ * @memberof BitSetSharedTable
+ */
+inline BitSetSharedTable* bitset_shared_table_allocate(const uint64_t count)
+{
+    BitSetSharedTable* const table = (BitSetSharedTable*)malloc(sizeof(BitSetSharedTable));
+    table->references = 1;
+    table->count = count;
+    table->chunks = (BitSetSharedChunk**)malloc((count ? count : 1) * sizeof(BitSetSharedChunk*));
+    BITSET_STATS_ALLOCATION(count * sizeof(BitSetSharedChunk*));
+    return table;
+}
+
+/**
+ * Drops a reference to a table, the last one releases its chunks and frees it
+ * @param table Pointer to the table
+ * @memberof BitSetSharedTable
+ */
+inline void bitset_shared_table_release(BitSetSharedTable* const table)
+{
+    if (bitset_shared_reference_add(&table->references, -1))
+        return;
+    for (uint64_t i = 0; i < table->count; ++i)
+        bitset_shared_chunk_release(*(table->chunks + i));
+    BITSET_STATS_DEALLOCATION();
+    free(table->chunks);
+    free(table);
+}
+
+/**
+ * Size initialization, every chunk points to a single zero chunk
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset (bit size)
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_init(SharedBitSet* const bitset, const uint64_t size)
+{
+    const uint64_t count = bitset_shared_chunk_count(size);
+    bitset->size = size;
+    bitset->table = bitset_shared_table_allocate(count);
+    if (!count)
+        return;
+    BitSetSharedChunk* const zero = bitset_shared_chunk_allocate(count);
+    for (uint64_t i = 0; i < count; ++i)
+        *(bitset->table->chunks + i) = zero;
+}
+
+/**
+ * Initialization from a bitset, chunks without a set bit share one zero chunk
+ * @param bitset Pointer to bitset to initialize
+ * @param source Pointer to bitset to copy (BitSet or DynamicBitSet)
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_init_bitset(SharedBitSet* const bitset, const BitSet* const source)
+{
+    bitset_shared_init(bitset, source->size);
+    for (uint64_t i = 0; i < bitset->table->count; ++i)
+    {
+        const uint64_t begin = i * BITSET_SHARED_CHUNK_BLOCKS;
+        const uint64_t blocks = source->storage_size - begin < BITSET_SHARED_CHUNK_BLOCKS ? source->storage_size - begin : BITSET_SHARED_CHUNK_BLOCKS;
+        if (bitset_find_mismatch_buffer(source->data + begin, blocks * sizeof(bitset_block_t), 0) == blocks * sizeof(bitset_block_t))
+            continue;
+        bitset_block_t* const data = bitset_shared_writable_chunk(bitset, i);
+        memcpy(data, source->data + begin, blocks * sizeof(bitset_block_t));
+        if (begin + blocks == source->storage_size)
+            *(data + blocks - 1) &= bitset_create_tail_block(source->size);
+    }
+}
+
+/**
+ * Initialization from a shared bitset (a plain copy of its current bits)
+ * @param bitset Pointer to bitset to initialize
+ * @param source Pointer to bitset to copy
+ * @memberof DynamicBitSet
+ */
+inline void bitset_dynamic_init_shared(DynamicBitSet* const bitset, const SharedBitSet* const source)
+{
+    bitset_dynamic_init(bitset, source->size);
+    for (uint64_t i = 0; i < source->table->count; ++i)
+    {
+        const uint64_t begin = i * BITSET_SHARED_CHUNK_BLOCKS;
+        const uint64_t blocks = bitset->storage_size - begin < BITSET_SHARED_CHUNK_BLOCKS ? bitset->storage_size - begin : BITSET_SHARED_CHUNK_BLOCKS;
+        memcpy(bitset->data + begin, bitset_shared_chunk_data(*(source->table->chunks + i)), blocks * sizeof(bitset_block_t));
+    }
+}
+
+/**
+ * Destroys the bitset or snapshot (drops its reference to the table)
+ * @param bitset Pointer to bitset to destroy
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_destroy(SharedBitSet* const bitset)
+{
+    bitset_shared_table_release(bitset->table);
+    bitset->table = NULL;
+    bitset->size = 0;
+}
+
+/**
+ * Takes a snapshot in O(1), the snapshot keeps the current bits while the source is modified (it can also be modified itself)
+ * Has to be called by the thread writing the source (or while it does not write)
+ * @param destination Pointer to bitset to initialize with the snapshot
+ * @param source Pointer to bitset to snapshot
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_snapshot(SharedBitSet* const destination, const SharedBitSet* const source)
+{
+    bitset_shared_reference_add(&source->table->references, 1);
+    destination->table = source->table;
+    destination->size = source->size;
+}
+
+/**
+ * Makes the table of the bitset exclusive, a table shared with snapshots is copied (one pointer and one reference per chunk)
+ * @param bitset Pointer to bitset to modify
+ * @return The exclusive table
+ * @memberof SharedBitSet
+ */
+inline BitSetSharedTable* bitset_shared_own_table(SharedBitSet* const bitset)
+{
+    BitSetSharedTable* const table = bitset->table;
+    if (bitset_shared_reference_load(&table->references) == 1)
+        return table;
+    BitSetSharedTable* const copy = bitset_shared_table_allocate(table->count);
+    BITSET_STATS_COPY_BYTES(table->count * sizeof(BitSetSharedChunk*));
+    for (uint64_t i = 0; i < table->count; ++i)
+    {
+        *(copy->chunks + i) = *(table->chunks + i);
+        bitset_shared_reference_add(&(*(copy->chunks + i))->references, 1);
+    }
+    bitset_shared_table_release(table);
+    bitset->table = copy;
+    return copy;
+}
+
+/**
+ * Makes a chunk exclusive for writing, a chunk shared with snapshots (or the zero chunk) is copied first
+ * @param bitset Pointer to bitset to modify
+ * @param chunk Index of the chunk (bit index / BITSET_SHARED_CHUNK_BITS)
+ * @return Pointer to the blocks of the chunk, valid until the next snapshot
+ * @memberof SharedBitSet
+ */
+inline bitset_block_t* bitset_shared_writable_chunk(SharedBitSet* const bitset, const uint64_t chunk)
+{
+    BitSetSharedTable* const table = bitset_shared_own_table(bitset);
+    BitSetSharedChunk* const current = *(table->chunks + chunk);
+    if (bitset_shared_reference_load(&current->references) == 1)
+        return bitset_shared_chunk_data(current);
+    BitSetSharedChunk* const copy = (BitSetSharedChunk*)bitset_allocate(NULL, sizeof(BitSetSharedChunk) + BITSET_SHARED_CHUNK_BYTES, BITSET_SHARED_ALIGNMENT);
+    BITSET_STATS_COPY_BYTES(BITSET_SHARED_CHUNK_BYTES);
+    // only the blocks, the reference count of the original may be changed by other threads
+    memset(copy, 0, sizeof(BitSetSharedChunk));
+    copy->references = 1;
+    memcpy(bitset_shared_chunk_data(copy), bitset_shared_chunk_data(current), BITSET_SHARED_CHUNK_BYTES);
+    *(table->chunks + chunk) = copy;
+    bitset_shared_chunk_release(current);
+    return bitset_shared_chunk_data(copy);
+}
+
+/**
+ * Creates a read-only view of one chunk, usable with every const BitSet function (no memory is allocated, the view must not be destroyed)
+ * @param bitset Pointer to the viewed bitset
+ * @param chunk Index of the chunk (bit index / BITSET_SHARED_CHUNK_BITS)
+ * @return The view, bit i of the view is bit chunk * BITSET_SHARED_CHUNK_BITS + i
+ * @memberof SharedBitSet
+ */
+inline DynamicBitSet bitset_shared_chunk_view(const SharedBitSet* const bitset, const uint64_t chunk)
+{
+    DynamicBitSet view;
+    const uint64_t begin = chunk * BITSET_SHARED_CHUNK_BITS;
+    view.data = bitset_shared_chunk_data(*(bitset->table->chunks + chunk));
+    view.size = bitset->size - begin < BITSET_SHARED_CHUNK_BITS ? bitset->size - begin : BITSET_SHARED_CHUNK_BITS;
+    view.storage_size = view.capacity = bitset_calculate_storage_size(view.size);
+    view.mapping = NULL;
+    view.mapping_size = 0;
+    view.allocator = NULL;
+    view.alignment = BITSET_SHARED_ALIGNMENT;
+    return view;
+}
+
+/**
+ * Creates a writable view of one chunk after making it exclusive, usable with every BitSet function (the view must not be destroyed)
+ * @param bitset Pointer to the viewed bitset
+ * @param chunk Index of the chunk (bit index / BITSET_SHARED_CHUNK_BITS)
+ * @return The view, valid until the next snapshot
+ * @memberof SharedBitSet
+ */
+inline DynamicBitSet bitset_shared_writable_chunk_view(SharedBitSet* const bitset, const uint64_t chunk)
+{
+    bitset_shared_writable_chunk(bitset, chunk);
+    return bitset_shared_chunk_view(bitset, chunk);
+}
+
+/**
+ * Gets the value of a bit
+ * @param bitset Pointer to bitset to read from
+ * @param index The index of the bit (bit index)
+ * @return The value of the bit
+ * @memberof SharedBitSet
+ */
+inline bool bitset_shared_get(const SharedBitSet* const bitset, const uint64_t index)
+{
+    const bitset_block_t* const data = bitset_shared_chunk_data(*(bitset->table->chunks + index / BITSET_SHARED_CHUNK_BITS));
+    return *(data + index % BITSET_SHARED_CHUNK_BITS / BITSET_BLOCK_BITS) >> index % BITSET_BLOCK_BITS & 1u;
+}
+
+/**
+ * Sets the value of a bit, copies its chunk if a snapshot uses it
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to set the bit to
+ * @param index The index of the bit (bit index)
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_set_value(SharedBitSet* const bitset, const bool value, const uint64_t index)
+{
+    if (bitset_shared_get(bitset, index) == value)
+        return;
+    bitset_block_t* const data = bitset_shared_writable_chunk(bitset, index / BITSET_SHARED_CHUNK_BITS);
+    *(data + index % BITSET_SHARED_CHUNK_BITS / BITSET_BLOCK_BITS) ^= (bitset_block_t)1u << index % BITSET_BLOCK_BITS;
+}
+
+/**
+ * Sets a bit to 1 (true), copies its chunk if a snapshot uses it and the bit changes
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit (bit index)
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_set(SharedBitSet* const bitset, const uint64_t index)
+{
+    bitset_shared_set_value(bitset, true, index);
+}
+
+/**
+ * Sets a bit to 0 (false), copies its chunk if a snapshot uses it and the bit changes
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit (bit index)
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_clear(SharedBitSet* const bitset, const uint64_t index)
+{
+    bitset_shared_set_value(bitset, false, index);
+}
+
+/**
+ * Flips a bit, copies its chunk if a snapshot uses it
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit (bit index)
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_flip_bit(SharedBitSet* const bitset, const uint64_t index)
+{
+    bitset_block_t* const data = bitset_shared_writable_chunk(bitset, index / BITSET_SHARED_CHUNK_BITS);
+    *(data + index % BITSET_SHARED_CHUNK_BITS / BITSET_BLOCK_BITS) ^= (bitset_block_t)1u << index % BITSET_BLOCK_BITS;
+}
+
+/**
+ * Fills the bits in a range, chunks cleared as a whole are replaced by one shared zero chunk instead of being written
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the bits with
+ * @param begin The index of the first bit to fill (bit index, inclusive)
+ * @param end The index of the last bit to fill (bit index, exclusive)
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_fill_in_range_begin_end(SharedBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end)
+{
+    BitSetSharedChunk* zero = NULL;
+    for (uint64_t chunk = begin / BITSET_SHARED_CHUNK_BITS; begin < end && chunk * BITSET_SHARED_CHUNK_BITS < end; ++chunk)
+    {
+        const uint64_t offset = chunk * BITSET_SHARED_CHUNK_BITS;
+        const uint64_t first = begin > offset ? begin - offset : 0, last = end - offset < BITSET_SHARED_CHUNK_BITS ? end - offset : BITSET_SHARED_CHUNK_BITS;
+        if (!value && !first && last == BITSET_SHARED_CHUNK_BITS)
+        {
+            BitSetSharedTable* const table = bitset_shared_own_table(bitset);
+            if (zero)
+                bitset_shared_reference_add(&zero->references, 1);
+            else
+                zero = bitset_shared_chunk_allocate(1);
+            bitset_shared_chunk_release(*(table->chunks + chunk));
+            *(table->chunks + chunk) = zero;
+            continue;
+        }
+        DynamicBitSet view = bitset_shared_writable_chunk_view(bitset, chunk);
+        bitset_fill_in_range_begin_end(UNIVERSAL_BITSET(&view), value, first, last);
+    }
+}
+
+/**
+ * Sets the bits in a range to 1 (true)
+ * @param bitset Pointer to bitset to modify
+ * @param begin The index of the first bit to set (bit index, inclusive)
+ * @param end The index of the last bit to set (bit index, exclusive)
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_set_in_range_begin_end(SharedBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_shared_fill_in_range_begin_end(bitset, true, begin, end);
+}
+
+/**
+ * Sets the bits in a range to 0 (false)
+ * @param bitset Pointer to bitset to modify
+ * @param begin The index of the first bit to clear (bit index, inclusive)
+ * @param end The index of the last bit to clear (bit index, exclusive)
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_clear_in_range_begin_end(SharedBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_shared_fill_in_range_begin_end(bitset, false, begin, end);
+}
+
+/**
+ * Sets all the bits to 0 (false) without writing any chunk
+ * @param bitset Pointer to bitset to modify
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_clear_all(SharedBitSet* const bitset)
+{
+    const uint64_t size = bitset->size;
+    bitset_shared_destroy(bitset);
+    bitset_shared_init(bitset, size);
+}
+
+/**
+ * Counts the set bits, a run of consecutive references to the same chunk (e.g. a filled range) is popcounted once
+ * @param bitset Pointer to bitset to count the bits of
+ * @return The number of set bits
+ * @memberof SharedBitSet
+ */
+inline uint64_t bitset_shared_count(const SharedBitSet* const bitset)
+{
+    uint64_t count = 0, previous_count = 0;
+    const BitSetSharedChunk* previous = NULL;
+    for (uint64_t i = 0; i < bitset->table->count; ++i)
+    {
+        const BitSetSharedChunk* const chunk = *(bitset->table->chunks + i);
+        if (chunk != previous)
+        {
+            previous_count = bitset_popcount_buffer(bitset_shared_chunk_data(chunk), BITSET_SHARED_CHUNK_BYTES);
+            previous = chunk;
+        }
+        count += previous_count;
+    }
+    return count;
+}
+
+/**
+ * Applies a set operation chunk by chunk, chunks that are the same in both operands are shared by the result instead of computed
+ * (AND and OR share them, XOR and ANDNOT share one zero chunk)
+ * @param destination Pointer to bitset receiving the result (same size as the operands, may be one of them)
+ * @param first Pointer to the first operand
+ * @param second Pointer to the second operand
+ * @param operation The operation to apply
+ * @memberof SharedBitSet
+ */
+inline void bitset_shared_apply_operation(SharedBitSet* const destination, const SharedBitSet* const first, const SharedBitSet* const second, const BitSetOperation operation)
+{
+    const uint64_t count = first->table->count;
+    BitSetSharedTable* const table = bitset_shared_table_allocate(count);
+    BitSetSharedChunk* zero = NULL;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        BitSetSharedChunk* const left = *(first->table->chunks + i);
+        BitSetSharedChunk* const right = *(second->table->chunks + i);
+        BitSetSharedChunk* result;
+        if (left == right && (operation == BITSET_AND || operation == BITSET_OR))
+        {
+            result = left;
+            bitset_shared_reference_add(&result->references, 1);
+        }
+        else if (left == right)
+        {
+            if (zero)
+                bitset_shared_reference_add(&zero->references, 1);
+            else
+                zero = bitset_shared_chunk_allocate(1);
+            result = zero;
+        }
+        else
+        {
+            result = bitset_shared_chunk_allocate(1);
+            bitset_operation_buffer(bitset_shared_chunk_data(result), bitset_shared_chunk_data(left), bitset_shared_chunk_data(right), BITSET_SHARED_CHUNK_BYTES, operation);
+        }
+        *(table->chunks + i) = result;
+    }
+    bitset_shared_table_release(destination->table);
+    destination->table = table;
+    destination->size = first->size;
+}
@@ -0,0 +1,582 @@
+#pragma once
+
+#include "BitSet.h"
+
+/**
+ * Maximum number of summary levels, enough for 2^64 bits (2^58 words, every level divides the count by 64)
+ */
+#define BITSET_SUMMARY_MAX_LEVELS 10u
+
+/**
+ * A dynamic bitset with a hierarchical summary for O(log64 n) searches on huge sparse (or dense) bitsets (for C API summary bitset)
+ * The bits are grouped into 64-bit words, level 0 of a summary has one bit per word and every higher level one bit per
+ * word of the level below, up to a single word. Two summaries are kept: nonempty (the word contains a set bit, used by
+ * find_first / find_next) and nonfull (the word contains a cleared bit, used by find_first_zero / find_next_zero).
+ * Single bit modifications update the summaries incrementally (O(levels) at most, usually O(1)), range modifications
+ * rebuild the covered part of the summaries (O(range / 64))
+ * Writes done directly to the underlying bitset have to be reported by bitset_summary_refresh_in_range_begin_end
+ */
+typedef struct
+{
+    /**
+     * The bits, can be read (and written, see bitset_summary_refresh_in_range_begin_end) through the DynamicBitSet API
+     */
+    DynamicBitSet bitset;
+    /**
+     * All the levels of the nonempty summary, level after level
+     */
+    uint64_t* nonempty;
+    /**
+     * All the levels of the nonfull summary, level after level (same layout as nonempty)
+     */
+    uint64_t* nonfull;
+    /**
+     * Offset of the first word of every level within a summary (offsets[levels] is the number of words of a summary)
+     */
+    uint64_t offsets[BITSET_SUMMARY_MAX_LEVELS + 1];
+    /**
+     * Number of bits of every level (the number of words of the level below, the number of words of the bitset for level 0)
+     */
+    uint64_t bits[BITSET_SUMMARY_MAX_LEVELS];
+    /**
+     * Number of levels
+     */
+    uint32_t levels;
+} SummaryBitSet;
+
+inline void bitset_summary_init(SummaryBitSet* const bitset, const uint64_t size);
+inline void bitset_summary_init_bitset(SummaryBitSet* const bitset, const BitSet* const source);
+inline void bitset_summary_destroy(SummaryBitSet* const bitset);
+inline uint64_t bitset_summary_word(const SummaryBitSet* const bitset, const uint64_t word);
+inline uint64_t bitset_summary_word_mask(const SummaryBitSet* const bitset, const uint64_t word);
+inline void bitset_summary_mark(const SummaryBitSet* const bitset, uint64_t* const summary, uint64_t index, const bool value);
+inline void bitset_summary_update_word(SummaryBitSet* const bitset, const uint64_t word);
+inline void bitset_summary_refresh_in_range_begin_end(SummaryBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_summary_refresh_all(SummaryBitSet* const bitset);
+inline bool bitset_summary_get(const SummaryBitSet* const bitset, const uint64_t index);
+inline void bitset_summary_set_value(SummaryBitSet* const bitset, const bool value, const uint64_t index);
+inline void bitset_summary_set(SummaryBitSet* const bitset, const uint64_t index);
+inline void bitset_summary_clear(SummaryBitSet* const bitset, const uint64_t index);
+inline void bitset_summary_flip_bit(SummaryBitSet* const bitset, const uint64_t index);
+inline void bitset_summary_fill_in_range_begin_end(SummaryBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end);
+inline void bitset_summary_set_in_range_begin_end(SummaryBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_summary_clear_in_range_begin_end(SummaryBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_summary_flip_in_range_begin_end(SummaryBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_summary_fill_all(SummaryBitSet* const bitset, const bool value);
+inline void bitset_summary_set_all(SummaryBitSet* const bitset);
+inline void bitset_summary_clear_all(SummaryBitSet* const bitset);
+inline uint64_t bitset_summary_find_word(const SummaryBitSet* const bitset, const uint64_t* const summary, uint64_t index);
+inline uint64_t bitset_summary_find_value_from(const SummaryBitSet* const bitset, const bool value, const uint64_t begin);
+inline uint64_t bitset_summary_find_first(const SummaryBitSet* const bitset);
+inline uint64_t bitset_summary_find_next(const SummaryBitSet* const bitset, const uint64_t index);
+inline uint64_t bitset_summary_find_first_zero(const SummaryBitSet* const bitset);
+inline uint64_t bitset_summary_find_next_zero(const SummaryBitSet* const bitset, const uint64_t index);
+inline bool bitset_summary_any(const SummaryBitSet* const bitset);
+inline bool bitset_summary_all(const SummaryBitSet* const bitset);
+inline bool bitset_summary_none(const SummaryBitSet* const bitset);
+inline uint64_t bitset_summary_acquire(SummaryBitSet* const bitset);
+inline uint64_t bitset_summary_acquire_from(SummaryBitSet* const bitset, const uint64_t begin);
+inline void bitset_summary_release(SummaryBitSet* const bitset, const uint64_t index);
+inline uint64_t bitset_summary_pop_first(SummaryBitSet* const bitset);
+
+/**
+ * Size initialization, all the bits are cleared
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset (bit size)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_init(SummaryBitSet* const bitset, const uint64_t size)
+{
+    uint64_t bits = size / 64 + (size % 64 != 0), offset = 0, words;
+    bitset_dynamic_init(&bitset->bitset, size);
+    bitset->levels = 0;
+    do
+    {
+        words = bits / 64 + (bits % 64 != 0);
+        if (!words)
+            words = 1;
+        *(bitset->bits + bitset->levels) = bits;
+        *(bitset->offsets + bitset->levels++) = offset;
+        offset += words;
+        bits = words;
+    } while (words > 1);
+    *(bitset->offsets + bitset->levels) = offset;
+    bitset->nonempty = (uint64_t*)calloc(offset, sizeof(uint64_t));
+    bitset->nonfull = (uint64_t*)calloc(offset, sizeof(uint64_t));
+    BITSET_STATS_ALLOCATION(2 * offset * sizeof(uint64_t));
+    bitset_summary_refresh_all(bitset);
+}
+
+/**
+ * Initialization from a bitset, the summaries are built once
+ * @param bitset Pointer to bitset to initialize
+ * @param source Pointer to bitset to copy (BitSet or DynamicBitSet)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_init_bitset(SummaryBitSet* const bitset, const BitSet* const source)
+{
+    bitset_summary_init(bitset, source->size);
+    memcpy(bitset->bitset.data, source->data, source->storage_size * sizeof(bitset_block_t));
+    bitset_summary_refresh_all(bitset);
+}
+
+/**
+ * Destroys the bitset (frees the bits and the summaries)
+ * @param bitset Pointer to bitset to destroy
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_destroy(SummaryBitSet* const bitset)
+{
+    bitset_dynamic_destroy(&bitset->bitset);
+    BITSET_STATS_DEALLOCATION();
+    free(bitset->nonempty);
+    free(bitset->nonfull);
+    bitset->nonempty = bitset->nonfull = NULL;
+    bitset->levels = 0;
+}
+
+/**
+ * Gets a 64-bit word of the bits (independent of the block type), the bits past the size are cleared
+ * @param bitset Pointer to bitset to read from
+ * @param word The index of the word (bit index / 64)
+ * @return The word
+ * @memberof SummaryBitSet
+ */
+inline uint64_t bitset_summary_word(const SummaryBitSet* const bitset, const uint64_t word)
+{
+    uint64_t value;
+    if (BITSET_BLOCK_BITS == 64 && (word + 1) * 64 <= bitset->bitset.size)
+        return (uint64_t)*(bitset->bitset.data + word);
+    bitset_load_words(UNIVERSAL_BITSET(&bitset->bitset), word, &value, 1);
+    return value;
+}
+
+/**
+ * Gets the mask of the bits of a word which are within the size (only the last word is partial)
+ * @param bitset Pointer to bitset
+ * @param word The index of the word (bit index / 64)
+ * @return The mask
+ * @memberof SummaryBitSet
+ */
+inline uint64_t bitset_summary_word_mask(const SummaryBitSet* const bitset, const uint64_t word)
+{
+    const uint64_t rest = bitset->bitset.size - word * 64;
+    return rest < 64 ? ((uint64_t)1u << rest) - 1 : ~(uint64_t)0u;
+}
+
+/**
+ * Sets or clears a bit of level 0 of a summary and propagates the change up while a word becomes empty or stops being empty
+ * @param bitset Pointer to bitset
+ * @param summary The summary to modify (nonempty or nonfull)
+ * @param index The index of the bit of level 0 (word index of the bitset)
+ * @param value The new value of the bit
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_mark(const SummaryBitSet* const bitset, uint64_t* const summary, uint64_t index, const bool value)
+{
+    for (uint32_t level = 0; level < bitset->levels; ++level, index /= 64)
+    {
+        uint64_t* const word = summary + *(bitset->offsets + level) + index / 64;
+        const uint64_t bit = (uint64_t)1u << index % 64;
+        if (!(*word & bit) != value)
+            return;
+        const bool was_empty = !*word;
+        *word ^= bit;
+        if (value ? !was_empty : *word != 0)
+            return;
+    }
+}
+
+/**
+ * Updates the summaries after a change of a word of the bits
+ * @param bitset Pointer to bitset
+ * @param word The index of the changed word (bit index / 64)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_update_word(SummaryBitSet* const bitset, const uint64_t word)
+{
+    const uint64_t value = bitset_summary_word(bitset, word);
+    bitset_summary_mark(bitset, bitset->nonempty, word, value != 0);
+    bitset_summary_mark(bitset, bitset->nonfull, word, value != bitset_summary_word_mask(bitset, word));
+}
+
+/**
+ * Rebuilds the part of the summaries covering a range, e.g. after writing directly to the underlying bitset (O(range / 64 + levels))
+ * @param bitset Pointer to bitset
+ * @param begin The index of the first bit written (bit index, inclusive)
+ * @param end The index of the last bit written (bit index, exclusive)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_refresh_in_range_begin_end(SummaryBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end)
+        return;
+    uint64_t first = begin / 64, last = (end - 1) / 64;
+    uint64_t words[64];
+    for (uint64_t index = first / 64; index <= last / 64; ++index)
+    {
+        const uint64_t from = index * 64 > first ? index * 64 : first, to = index * 64 + 63 < last ? index * 64 + 63 : last;
+        uint64_t nonempty = 0, nonfull = 0;
+        bitset_load_words(UNIVERSAL_BITSET(&bitset->bitset), from, words, to - from + 1);
+        for (uint64_t word = from; word <= to; ++word)
+        {
+            nonempty |= (uint64_t)(*(words + word - from) != 0) << word % 64;
+            nonfull |= (uint64_t)(*(words + word - from) != bitset_summary_word_mask(bitset, word)) << word % 64;
+        }
+        const uint64_t mask = (~(uint64_t)0u >> (63 - to % 64)) & ~(uint64_t)0u << from % 64;
+        *(bitset->nonempty + index) = (*(bitset->nonempty + index) & ~mask) | nonempty;
+        *(bitset->nonfull + index) = (*(bitset->nonfull + index) & ~mask) | nonfull;
+    }
+    for (uint32_t level = 1; level < bitset->levels; ++level)
+    {
+        const uint64_t* const nonempty_below = bitset->nonempty + *(bitset->offsets + level - 1);
+        const uint64_t* const nonfull_below = bitset->nonfull + *(bitset->offsets + level - 1);
+        uint64_t* const nonempty = bitset->nonempty + *(bitset->offsets + level);
+        uint64_t* const nonfull = bitset->nonfull + *(bitset->offsets + level);
+        first /= 64;
+        last /= 64;
+        for (uint64_t index = first; index <= last; ++index)
+        {
+            const uint64_t bit = (uint64_t)1u << index % 64;
+            *(nonempty + index / 64) = *(nonempty_below + index) ? *(nonempty + index / 64) | bit : *(nonempty + index / 64) & ~bit;
+            *(nonfull + index / 64) = *(nonfull_below + index) ? *(nonfull + index / 64) | bit : *(nonfull + index / 64) & ~bit;
+        }
+    }
+}
+
+/**
+ * Rebuilds the whole summaries (O(size / 64))
+ * @param bitset Pointer to bitset
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_refresh_all(SummaryBitSet* const bitset)
+{
+    bitset_summary_refresh_in_range_begin_end(bitset, 0, bitset->bitset.size);
+}
+
+/**
+ * Gets the value of a bit
+ * @param bitset Pointer to bitset to read from
+ * @param index The index of the bit (bit index)
+ * @return The value of the bit
+ * @memberof SummaryBitSet
+ */
+inline bool bitset_summary_get(const SummaryBitSet* const bitset, const uint64_t index)
+{
+    return *(bitset->bitset.data + index / BITSET_BLOCK_BITS) >> index % BITSET_BLOCK_BITS & 1u;
+}
+
+/**
+ * Sets the value of a bit and updates the summaries
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to set the bit to
+ * @param index The index of the bit (bit index)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_set_value(SummaryBitSet* const bitset, const bool value, const uint64_t index)
+{
+    if (bitset_summary_get(bitset, index) == value)
+        return;
+    bitset_summary_flip_bit(bitset, index);
+}
+
+/**
+ * Sets a bit to 1 (true) and updates the summaries
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit (bit index)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_set(SummaryBitSet* const bitset, const uint64_t index)
+{
+    bitset_summary_set_value(bitset, true, index);
+}
+
+/**
+ * Sets a bit to 0 (false) and updates the summaries
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit (bit index)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_clear(SummaryBitSet* const bitset, const uint64_t index)
+{
+    bitset_summary_set_value(bitset, false, index);
+}
+
+/**
+ * Flips a bit and updates the summaries
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit (bit index)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_flip_bit(SummaryBitSet* const bitset, const uint64_t index)
+{
+    bitset_flip_bit(UNIVERSAL_BITSET(&bitset->bitset), index);
+    bitset_summary_update_word(bitset, index / 64);
+}
+
+/**
+ * Fills the bits in a range and rebuilds the covered part of the summaries
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the bits with
+ * @param begin The index of the first bit to fill (bit index, inclusive)
+ * @param end The index of the last bit to fill (bit index, exclusive)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_fill_in_range_begin_end(SummaryBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end)
+{
+    bitset_fill_in_range_begin_end(UNIVERSAL_BITSET(&bitset->bitset), value, begin, end);
+    bitset_summary_refresh_in_range_begin_end(bitset, begin, end);
+}
+
+/**
+ * Sets the bits in a range and rebuilds the covered part of the summaries
+ * @param bitset Pointer to bitset to modify
+ * @param begin The index of the first bit to set (bit index, inclusive)
+ * @param end The index of the last bit to set (bit index, exclusive)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_set_in_range_begin_end(SummaryBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_summary_fill_in_range_begin_end(bitset, true, begin, end);
+}
+
+/**
+ * Clears the bits in a range and rebuilds the covered part of the summaries
+ * @param bitset Pointer to bitset to modify
+ * @param begin The index of the first bit to clear (bit index, inclusive)
+ * @param end The index of the last bit to clear (bit index, exclusive)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_clear_in_range_begin_end(SummaryBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_summary_fill_in_range_begin_end(bitset, false, begin, end);
+}
+
+/**
+ * Flips the bits in a range and rebuilds the covered part of the summaries
+ * @param bitset Pointer to bitset to modify
+ * @param begin The index of the first bit to flip (bit index, inclusive)
+ * @param end The index of the last bit to flip (bit index, exclusive)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_flip_in_range_begin_end(SummaryBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_flip_in_range_begin_end(UNIVERSAL_BITSET(&bitset->bitset), begin, end);
+    bitset_summary_refresh_in_range_begin_end(bitset, begin, end);
+}
+
+/**
+ * Fills all the bits and rebuilds the summaries
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the bits with
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_fill_all(SummaryBitSet* const bitset, const bool value)
+{
+    bitset_summary_fill_in_range_begin_end(bitset, value, 0, bitset->bitset.size);
+}
+
+/**
+ * Sets all the bits and rebuilds the summaries
+ * @param bitset Pointer to bitset to modify
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_set_all(SummaryBitSet* const bitset)
+{
+    bitset_summary_fill_all(bitset, true);
+}
+
+/**
+ * Clears all the bits and rebuilds the summaries
+ * @param bitset Pointer to bitset to modify
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_clear_all(SummaryBitSet* const bitset)
+{
+    bitset_summary_fill_all(bitset, false);
+}
+
+/**
+ * Finds the first word starting at an index whose bit is set in a summary, climbs the levels until a word has a bit
+ * at or after the position and descends along the lowest set bits (O(levels))
+ * @param bitset Pointer to bitset to search
+ * @param summary The summary to search (nonempty or nonfull)
+ * @param index The index of the first word to consider (bit index / 64, inclusive)
+ * @return Index of the found word or BITSET_NPOS if there is none
+ * @memberof SummaryBitSet
+ */
+inline uint64_t bitset_summary_find_word(const SummaryBitSet* const bitset, const uint64_t* const summary, uint64_t index)
+{
+    uint32_t level = 0;
+    uint64_t word;
+    for (;;)
+    {
+        if (index >= *(bitset->bits + level))
+            return BITSET_NPOS;
+        word = *(summary + *(bitset->offsets + level) + index / 64) & ~(uint64_t)0u << index % 64;
+        if (word)
+            break;
+        if (++level == bitset->levels)
+            return BITSET_NPOS;
+        index = index / 64 + 1;
+    }
+    index = index / 64 * 64 + bitset_ctz64(word);
+    while (level--)
+        index = index * 64 + bitset_ctz64(*(summary + *(bitset->offsets + level) + index));
+    return index;
+}
+
+/**
+ * Finds the first bit with a value starting at an index (O(log64 size))
+ * @param bitset Pointer to bitset to search
+ * @param value The value to search for
+ * @param begin Index at which to start searching (bit index, inclusive)
+ * @return Index of the found bit or BITSET_NPOS if there is none
+ * @memberof SummaryBitSet
+ */
+inline uint64_t bitset_summary_find_value_from(const SummaryBitSet* const bitset, const bool value, const uint64_t begin)
+{
+    if (begin >= bitset->bitset.size)
+        return BITSET_NPOS;
+    uint64_t word = begin / 64, bits = bitset_summary_word(bitset, word);
+    bits = (value ? bits : ~bits & bitset_summary_word_mask(bitset, word)) & ~(uint64_t)0u << begin % 64;
+    if (!bits)
+    {
+        word = bitset_summary_find_word(bitset, value ? bitset->nonempty : bitset->nonfull, word + 1);
+        if (word == BITSET_NPOS)
+            return BITSET_NPOS;
+        bits = bitset_summary_word(bitset, word);
+        bits = value ? bits : ~bits & bitset_summary_word_mask(bitset, word);
+    }
+    return word * 64 + bitset_ctz64(bits);
+}
+
+/**
+ * Finds the first set bit
+ * @param bitset Pointer to bitset to search
+ * @return Index of the first set bit or BITSET_NPOS if there is none
+ * @memberof SummaryBitSet
+ */
+inline uint64_t bitset_summary_find_first(const SummaryBitSet* const bitset)
+{
+    return bitset_summary_find_value_from(bitset, true, 0);
+}
+
+/**
+ * Finds the next set bit after the specified index
+ * @param bitset Pointer to bitset to search
+ * @param index Index after which to search (bit index, exclusive)
+ * @return Index of the next set bit or BITSET_NPOS if there is none
+ * @memberof SummaryBitSet
+ */
+inline uint64_t bitset_summary_find_next(const SummaryBitSet* const bitset, const uint64_t index)
+{
+    return index == BITSET_NPOS ? BITSET_NPOS : bitset_summary_find_value_from(bitset, true, index + 1);
+}
+
+/**
+ * Finds the first cleared bit
+ * @param bitset Pointer to bitset to search
+ * @return Index of the first cleared bit or BITSET_NPOS if there is none
+ * @memberof SummaryBitSet
+ */
+inline uint64_t bitset_summary_find_first_zero(const SummaryBitSet* const bitset)
+{
+    return bitset_summary_find_value_from(bitset, false, 0);
+}
+
+/**
+ * Finds the next cleared bit after the specified index
+ * @param bitset Pointer to bitset to search
+ * @param index Index after which to search (bit index, exclusive)
+ * @return Index of the next cleared bit or BITSET_NPOS if there is none
+ * @memberof SummaryBitSet
+ */
+inline uint64_t bitset_summary_find_next_zero(const SummaryBitSet* const bitset, const uint64_t index)
+{
+    return index == BITSET_NPOS ? BITSET_NPOS : bitset_summary_find_value_from(bitset, false, index + 1);
+}
+
+/**
+ * Checks if any of the bits are set (O(1), reads the top level)
+ * @param bitset Pointer to bitset to check
+ * @return True if any of the bits are set, false otherwise
+ * @memberof SummaryBitSet
+ */
+inline bool bitset_summary_any(const SummaryBitSet* const bitset)
+{
+    return *(bitset->nonempty + *(bitset->offsets + bitset->levels - 1)) != 0;
+}
+
+/**
+ * Checks if all the bits are set (O(1), reads the top level)
+ * @param bitset Pointer to bitset to check
+ * @return True if all the bits are set, false otherwise
+ * @memberof SummaryBitSet
+ */
+inline bool bitset_summary_all(const SummaryBitSet* const bitset)
+{
+    return *(bitset->nonfull + *(bitset->offsets + bitset->levels - 1)) == 0;
+}
+
+/**
+ * Checks if none of the bits are set (O(1), reads the top level)
+ * @param bitset Pointer to bitset to check
+ * @return True if none of the bits are set, false otherwise
+ * @memberof SummaryBitSet
+ */
+inline bool bitset_summary_none(const SummaryBitSet* const bitset)
+{
+    return !bitset_summary_any(bitset);
+}
+
+/**
+ * Allocates the lowest free slot (e.g. of an ID allocator), the lowest cleared bit is set
+ * @param bitset Pointer to bitset to allocate from
+ * @return Index of the allocated bit or BITSET_NPOS if all the bits are set
+ * @memberof SummaryBitSet
+ */
+inline uint64_t bitset_summary_acquire(SummaryBitSet* const bitset)
+{
+    return bitset_summary_acquire_from(bitset, 0);
+}
+
+/**
+ * Allocates the lowest free slot starting at an index, the found cleared bit is set
+ * @param bitset Pointer to bitset to allocate from
+ * @param begin Index at which to start searching (bit index, inclusive)
+ * @return Index of the allocated bit or BITSET_NPOS if all the bits starting at the index are set
+ * @memberof SummaryBitSet
+ */
+inline uint64_t bitset_summary_acquire_from(SummaryBitSet* const bitset, const uint64_t begin)
+{
+    const uint64_t index = bitset_summary_find_value_from(bitset, false, begin);
+    if (index != BITSET_NPOS)
+        bitset_summary_flip_bit(bitset, index);
+    return index;
+}
+
+/**
+ * Frees a slot allocated by bitset_summary_acquire (clears the bit)
+ * @param bitset Pointer to bitset to free to
+ * @param index The index of the slot (bit index)
+ * @memberof SummaryBitSet
+ */
+inline void bitset_summary_release(SummaryBitSet* const bitset, const uint64_t index)
+{
+    bitset_summary_clear(bitset, index);
+}
+
+/**
+ * Removes the lowest set bit (e.g. of a priority queue or a timer wheel), the bit is cleared
+ * @param bitset Pointer to bitset to remove from
+ * @return Index of the removed bit or BITSET_NPOS if none of the bits are set
+ * @memberof SummaryBitSet
+ */
+inline uint64_t bitset_summary_pop_first(SummaryBitSet* const bitset)
+{
+    const uint64_t index = bitset_summary_find_first(bitset);
+    if (index != BITSET_NPOS)
+        bitset_summary_flip_bit(bitset, index);
+    return index;
+}
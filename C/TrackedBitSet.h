@@ -0,0 +1,463 @@
+#pragma once
+
+#include "BitSet.h"
+
+/**
+ * Number of bits of a chunk of a tracked bitset, every chunk keeps its own count (a multiple of the block size, less than 2^32 so the counts fit chunk_counts)
+ */
+#ifndef BITSET_TRACKED_CHUNK_BITS
+#define BITSET_TRACKED_CHUNK_BITS 4096u
+#endif
+
+#if BITSET_TRACKED_CHUNK_BITS >= 4294967296u
+#error "BITSET_TRACKED_CHUNK_BITS has to be less than 2^32"
+#endif
+
+/**
+ * A dynamic bitset keeping a running count of its set bits (for C API tracked bitset)
+ * Single bit and range modifications update the counts as they go, so count, any and all are O(1)
+ * Writes done directly to the underlying bitset have to be reported by bitset_tracked_touch_in_range_begin_end,
+ * the touched chunks are marked dirty and recounted by the next count, any or all (O(dirty chunks))
+ */
+typedef struct
+{
+    /**
+     * The bits, can be read (and written, see bitset_tracked_touch_in_range_begin_end) through the DynamicBitSet API
+     */
+    DynamicBitSet bitset;
+    /**
+     * The number of set bits in the chunks which are not dirty
+     */
+    uint64_t count;
+    /**
+     * The number of set bits of every chunk, valid for chunks which are not dirty (less than 2^32, see BITSET_TRACKED_CHUNK_BITS)
+     */
+    uint32_t* chunk_counts;
+    /**
+     * Dirty flag of every chunk
+     */
+    uint8_t* dirty;
+    /**
+     * Indices of the dirty chunks (chunk indices)
+     */
+    uint64_t* dirty_chunks;
+    /**
+     * Number of dirty chunks
+     */
+    uint64_t dirty_count;
+} TrackedBitSet;
+
+inline uint64_t bitset_tracked_chunk_count(const uint64_t size);
+inline uint64_t bitset_tracked_chunk_size(const TrackedBitSet* const bitset, const uint64_t chunk);
+inline void bitset_tracked_init(TrackedBitSet* const bitset, const uint64_t size);
+inline void bitset_tracked_init_bitset(TrackedBitSet* const bitset, const BitSet* const source);
+inline void bitset_tracked_destroy(TrackedBitSet* const bitset);
+inline void bitset_tracked_mark_dirty(TrackedBitSet* const bitset, const uint64_t chunk);
+inline void bitset_tracked_touch_in_range_begin_end(TrackedBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_tracked_touch_all(TrackedBitSet* const bitset);
+inline bool bitset_tracked_get(const TrackedBitSet* const bitset, const uint64_t index);
+inline void bitset_tracked_set_value(TrackedBitSet* const bitset, const bool value, const uint64_t index);
+inline void bitset_tracked_set(TrackedBitSet* const bitset, const uint64_t index);
+inline void bitset_tracked_clear(TrackedBitSet* const bitset, const uint64_t index);
+inline void bitset_tracked_flip_bit(TrackedBitSet* const bitset, const uint64_t index);
+inline void bitset_tracked_update_in_range_begin_end(TrackedBitSet* const bitset, const bool flip, const bool value, const uint64_t begin, const uint64_t end);
+inline void bitset_tracked_fill_in_range_begin_end(TrackedBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end);
+inline void bitset_tracked_set_in_range_begin_end(TrackedBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_tracked_clear_in_range_begin_end(TrackedBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_tracked_flip_in_range_begin_end(TrackedBitSet* const bitset, const uint64_t begin, const uint64_t end);
+inline void bitset_tracked_fill_all(TrackedBitSet* const bitset, const bool value);
+inline void bitset_tracked_set_all(TrackedBitSet* const bitset);
+inline void bitset_tracked_clear_all(TrackedBitSet* const bitset);
+inline void bitset_tracked_flip_all(TrackedBitSet* const bitset);
+inline void bitset_tracked_apply_operation(TrackedBitSet* const destination, const BitSet* const first, const BitSet* const second, const BitSetOperation operation);
+inline void bitset_tracked_refresh(TrackedBitSet* const bitset);
+inline uint64_t bitset_tracked_count(TrackedBitSet* const bitset);
+inline bool bitset_tracked_any(TrackedBitSet* const bitset);
+inline bool bitset_tracked_all(TrackedBitSet* const bitset);
+inline bool bitset_tracked_none(TrackedBitSet* const bitset);
+
+/**
+ * Calculates the number of chunks of a tracked bitset
+ * @param size Size of the bitset in bits
+ * @return The number of chunks
+ */
+inline uint64_t bitset_tracked_chunk_count(const uint64_t size)
+{
+    return size / BITSET_TRACKED_CHUNK_BITS + (size % BITSET_TRACKED_CHUNK_BITS != 0);
+}
+
+/**
+ * Calculates the number of bits of a chunk (only the last one can be shorter)
+ * @param bitset Pointer to bitset
+ * @param chunk The index of the chunk (chunk index)
+ * @return The number of bits of the chunk
+ * @memberof TrackedBitSet
+ */
+inline uint64_t bitset_tracked_chunk_size(const TrackedBitSet* const bitset, const uint64_t chunk)
+{
+    const uint64_t rest = bitset->bitset.size - chunk * BITSET_TRACKED_CHUNK_BITS;
+    return rest < BITSET_TRACKED_CHUNK_BITS ? rest : BITSET_TRACKED_CHUNK_BITS;
+}
+
+/**
+ * Size initialization, all the bits are cleared
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset (bit size)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_init(TrackedBitSet* const bitset, const uint64_t size)
+{
+    const uint64_t chunks = bitset_tracked_chunk_count(size);
+    bitset_dynamic_init(&bitset->bitset, size);
+    bitset->count = 0;
+    bitset->chunk_counts = (uint32_t*)calloc(chunks ? chunks : 1, sizeof(uint32_t));
+    bitset->dirty = (uint8_t*)calloc(chunks ? chunks : 1, sizeof(uint8_t));
+    bitset->dirty_chunks = (uint64_t*)malloc((chunks ? chunks : 1) * sizeof(uint64_t));
+    BITSET_STATS_ALLOCATION(chunks * (sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint64_t)));
+    bitset->dirty_count = 0;
+}
+
+/**
+ * Initialization from a bitset, the bits are counted once
+ * @param bitset Pointer to bitset to initialize
+ * @param source Pointer to bitset to copy (BitSet or DynamicBitSet)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_init_bitset(TrackedBitSet* const bitset, const BitSet* const source)
+{
+    bitset_tracked_init(bitset, source->size);
+    memcpy(bitset->bitset.data, source->data, source->storage_size * sizeof(bitset_block_t));
+    bitset_tracked_touch_all(bitset);
+    bitset_tracked_refresh(bitset);
+}
+
+/**
+ * Destroys the bitset (frees the bits and the counts)
+ * @param bitset Pointer to bitset to destroy
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_destroy(TrackedBitSet* const bitset)
+{
+    bitset_dynamic_destroy(&bitset->bitset);
+    BITSET_STATS_DEALLOCATION();
+    free(bitset->chunk_counts);
+    free(bitset->dirty);
+    free(bitset->dirty_chunks);
+    bitset->chunk_counts = NULL;
+    bitset->dirty = NULL;
+    bitset->dirty_chunks = NULL;
+    bitset->count = bitset->dirty_count = 0;
+}
+
+/**
+ * Marks a chunk dirty, its count is dropped until the next refresh
+ * @param bitset Pointer to bitset
+ * @param chunk The index of the chunk (chunk index)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_mark_dirty(TrackedBitSet* const bitset, const uint64_t chunk)
+{
+    if (*(bitset->dirty + chunk))
+        return;
+    *(bitset->dirty + chunk) = 1u;
+    bitset->count -= *(bitset->chunk_counts + chunk);
+    *(bitset->dirty_chunks + bitset->dirty_count++) = chunk;
+}
+
+/**
+ * Reports a write done directly to the underlying bitset (e.g. through a view or the batch operations), the chunks of the range are recounted lazily
+ * @param bitset Pointer to bitset
+ * @param begin The index of the first bit written (bit index, inclusive)
+ * @param end The index of the last bit written (bit index, exclusive)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_touch_in_range_begin_end(TrackedBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end)
+        return;
+    for (uint64_t chunk = begin / BITSET_TRACKED_CHUNK_BITS; chunk <= (end - 1) / BITSET_TRACKED_CHUNK_BITS; ++chunk)
+        bitset_tracked_mark_dirty(bitset, chunk);
+}
+
+/**
+ * Reports a write done directly to the whole underlying bitset, every chunk is recounted lazily
+ * @param bitset Pointer to bitset
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_touch_all(TrackedBitSet* const bitset)
+{
+    bitset_tracked_touch_in_range_begin_end(bitset, 0, bitset->bitset.size);
+}
+
+/**
+ * Gets the value of a bit
+ * @param bitset Pointer to bitset to read from
+ * @param index The index of the bit (bit index)
+ * @return The value of the bit
+ * @memberof TrackedBitSet
+ */
+inline bool bitset_tracked_get(const TrackedBitSet* const bitset, const uint64_t index)
+{
+    return *(bitset->bitset.data + index / BITSET_BLOCK_BITS) >> index % BITSET_BLOCK_BITS & 1u;
+}
+
+/**
+ * Sets the value of a bit and updates the count of its chunk
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to set the bit to
+ * @param index The index of the bit (bit index)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_set_value(TrackedBitSet* const bitset, const bool value, const uint64_t index)
+{
+    if (bitset_tracked_get(bitset, index) == value)
+        return;
+    bitset_tracked_flip_bit(bitset, index);
+}
+
+/**
+ * Sets a bit to 1 (true) and updates the count of its chunk
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit (bit index)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_set(TrackedBitSet* const bitset, const uint64_t index)
+{
+    bitset_tracked_set_value(bitset, true, index);
+}
+
+/**
+ * Sets a bit to 0 (false) and updates the count of its chunk
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit (bit index)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_clear(TrackedBitSet* const bitset, const uint64_t index)
+{
+    bitset_tracked_set_value(bitset, false, index);
+}
+
+/**
+ * Flips a bit and updates the count of its chunk
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit (bit index)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_flip_bit(TrackedBitSet* const bitset, const uint64_t index)
+{
+    const uint64_t chunk = index / BITSET_TRACKED_CHUNK_BITS;
+    const bool value = !bitset_tracked_get(bitset, index);
+    bitset_flip_bit(UNIVERSAL_BITSET(&bitset->bitset), index);
+    if (*(bitset->dirty + chunk))
+        return;
+    if (value)
+    {
+        ++*(bitset->chunk_counts + chunk);
+        ++bitset->count;
+    }
+    else
+    {
+        --*(bitset->chunk_counts + chunk);
+        --bitset->count;
+    }
+}
+
+/**
+ * Fills or flips the bits in a range and updates the counts, whole chunks take their new count from the old one
+ * and only the partially covered chunks at the ends are counted
+ * @param bitset Pointer to bitset to modify
+ * @param flip Whether to flip the bits instead of filling them
+ * @param value The value to fill the bits with (ignored when flipping)
+ * @param begin The index of the first bit (bit index, inclusive)
+ * @param end The index of the last bit (bit index, exclusive)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_update_in_range_begin_end(TrackedBitSet* const bitset, const bool flip, const bool value, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end)
+        return;
+    for (uint64_t chunk = begin / BITSET_TRACKED_CHUNK_BITS; chunk <= (end - 1) / BITSET_TRACKED_CHUNK_BITS; ++chunk)
+    {
+        if (*(bitset->dirty + chunk))
+            continue;
+        const uint64_t offset = chunk * BITSET_TRACKED_CHUNK_BITS, size = bitset_tracked_chunk_size(bitset, chunk);
+        const uint64_t first = begin > offset ? begin : offset, last = end < offset + size ? end : offset + size;
+        const uint64_t before = first == offset && last == offset + size ? *(bitset->chunk_counts + chunk)
+            : bitset_count_in_range_begin_end(UNIVERSAL_BITSET(&bitset->bitset), first, last);
+        const uint64_t after = flip ? last - first - before : value ? last - first : 0;
+        *(bitset->chunk_counts + chunk) += (uint32_t)(after - before);
+        bitset->count += after - before;
+    }
+    if (flip)
+        bitset_flip_in_range_begin_end(UNIVERSAL_BITSET(&bitset->bitset), begin, end);
+    else
+        bitset_fill_in_range_begin_end(UNIVERSAL_BITSET(&bitset->bitset), value, begin, end);
+}
+
+/**
+ * Fills the bits in a range and updates the counts
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the bits with
+ * @param begin The index of the first bit to fill (bit index, inclusive)
+ * @param end The index of the last bit to fill (bit index, exclusive)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_fill_in_range_begin_end(TrackedBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end)
+{
+    bitset_tracked_update_in_range_begin_end(bitset, false, value, begin, end);
+}
+
+/**
+ * Sets the bits in a range and updates the counts
+ * @param bitset Pointer to bitset to modify
+ * @param begin The index of the first bit to set (bit index, inclusive)
+ * @param end The index of the last bit to set (bit index, exclusive)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_set_in_range_begin_end(TrackedBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_tracked_update_in_range_begin_end(bitset, false, true, begin, end);
+}
+
+/**
+ * Clears the bits in a range and updates the counts
+ * @param bitset Pointer to bitset to modify
+ * @param begin The index of the first bit to clear (bit index, inclusive)
+ * @param end The index of the last bit to clear (bit index, exclusive)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_clear_in_range_begin_end(TrackedBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_tracked_update_in_range_begin_end(bitset, false, false, begin, end);
+}
+
+/**
+ * Flips the bits in a range and updates the counts
+ * @param bitset Pointer to bitset to modify
+ * @param begin The index of the first bit to flip (bit index, inclusive)
+ * @param end The index of the last bit to flip (bit index, exclusive)
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_flip_in_range_begin_end(TrackedBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_tracked_update_in_range_begin_end(bitset, true, false, begin, end);
+}
+
+/**
+ * Fills all the bits and updates the counts
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the bits with
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_fill_all(TrackedBitSet* const bitset, const bool value)
+{
+    bitset_tracked_update_in_range_begin_end(bitset, false, value, 0, bitset->bitset.size);
+}
+
+/**
+ * Sets all the bits and updates the counts
+ * @param bitset Pointer to bitset to modify
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_set_all(TrackedBitSet* const bitset)
+{
+    bitset_tracked_fill_all(bitset, true);
+}
+
+/**
+ * Clears all the bits and updates the counts
+ * @param bitset Pointer to bitset to modify
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_clear_all(TrackedBitSet* const bitset)
+{
+    bitset_tracked_fill_all(bitset, false);
+}
+
+/**
+ * Flips all the bits and updates the counts
+ * @param bitset Pointer to bitset to modify
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_flip_all(TrackedBitSet* const bitset)
+{
+    bitset_tracked_update_in_range_begin_end(bitset, true, false, 0, bitset->bitset.size);
+}
+
+/**
+ * Applies an operation to two bitsets and stores the result, every chunk is recounted lazily
+ * @param destination Pointer to bitset to store the result in
+ * @param first Pointer to the first operand (BitSet, DynamicBitSet or another tracked bitset's bitset)
+ * @param second Pointer to the second operand (BitSet, DynamicBitSet or another tracked bitset's bitset)
+ * @param operation The operation to apply
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_apply_operation(TrackedBitSet* const destination, const BitSet* const first, const BitSet* const second, const BitSetOperation operation)
+{
+    bitset_apply_operation(UNIVERSAL_BITSET(&destination->bitset), first, second, operation);
+    bitset_tracked_touch_all(destination);
+}
+
+/**
+ * Recounts the dirty chunks (O(dirty chunks)), afterwards every count is valid
+ * @param bitset Pointer to bitset
+ * @memberof TrackedBitSet
+ */
+inline void bitset_tracked_refresh(TrackedBitSet* const bitset)
+{
+    for (uint64_t i = 0; i < bitset->dirty_count; ++i)
+    {
+        const uint64_t chunk = *(bitset->dirty_chunks + i), offset = chunk * BITSET_TRACKED_CHUNK_BITS;
+        const uint64_t count = bitset_count_in_range_begin_end(UNIVERSAL_BITSET(&bitset->bitset), offset, offset + bitset_tracked_chunk_size(bitset, chunk));
+        *(bitset->chunk_counts + chunk) = (uint32_t)count;
+        *(bitset->dirty + chunk) = 0;
+        bitset->count += count;
+    }
+    bitset->dirty_count = 0;
+}
+
+/**
+ * Counts the set bits, O(1) unless chunks were touched since the last call
+ * @param bitset Pointer to bitset to count the bits of
+ * @return The number of bits set in the bitset
+ * @memberof TrackedBitSet
+ */
+inline uint64_t bitset_tracked_count(TrackedBitSet* const bitset)
+{
+    BITSET_STATS_CALL(BITSET_STATS_COUNT, bitset->dirty_count * BITSET_TRACKED_CHUNK_BITS);
+    bitset_tracked_refresh(bitset);
+    return bitset->count;
+}
+
+/**
+ * Checks if any of the bits are set, the dirty chunks are recounted only if the others are all clear
+ * @param bitset Pointer to bitset to check
+ * @return True if any of the bits are set, false otherwise
+ * @memberof TrackedBitSet
+ */
+inline bool bitset_tracked_any(TrackedBitSet* const bitset)
+{
+    return bitset->count || bitset_tracked_count(bitset);
+}
+
+/**
+ * Checks if all the bits are set
+ * @param bitset Pointer to bitset to check
+ * @return True if all the bits are set, false otherwise
+ * @memberof TrackedBitSet
+ */
+inline bool bitset_tracked_all(TrackedBitSet* const bitset)
+{
+    return bitset_tracked_count(bitset) == bitset->bitset.size;
+}
+
+/**
+ * Checks if none of the bits are set
+ * @param bitset Pointer to bitset to check
+ * @return True if none of the bits are set, false otherwise
+ * @memberof TrackedBitSet
+ */
+inline bool bitset_tracked_none(TrackedBitSet* const bitset)
+{
+    return !bitset_tracked_any(bitset);
+}
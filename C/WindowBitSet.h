@@ -0,0 +1,379 @@
+#pragma once
+
+#include "BitSet.h"
+
+/**
+ * A sliding window of bits over an unbounded logical index space, stored in a ring buffer (for C API window bitset)
+ * The window covers the logical indices [base, base + size), logical index i lives at bit i % size of the ring,
+ * so sliding the window only clears the bits of the expired indices (they become the newly entered ones)
+ */
+typedef struct
+{
+    /**
+     * The ring of bits, its size is the size of the window
+     */
+    DynamicBitSet bitset;
+    /**
+     * The first logical index of the window (logical index)
+     */
+    uint64_t base;
+} WindowBitSet;
+
+inline void bitset_window_init(WindowBitSet* const window, const uint64_t size);
+inline void bitset_window_destroy(WindowBitSet* const window);
+inline uint64_t bitset_window_size(const WindowBitSet* const window);
+inline uint64_t bitset_window_end(const WindowBitSet* const window);
+inline bool bitset_window_contains(const WindowBitSet* const window, const uint64_t index);
+inline uint64_t bitset_window_physical(const WindowBitSet* const window, const uint64_t index);
+inline void bitset_window_slide_to(WindowBitSet* const window, const uint64_t base);
+inline void bitset_window_slide(WindowBitSet* const window, const uint64_t count);
+inline bool bitset_window_get(const WindowBitSet* const window, const uint64_t index);
+inline void bitset_window_set_value(WindowBitSet* const window, const bool value, const uint64_t index);
+inline void bitset_window_set(WindowBitSet* const window, const uint64_t index);
+inline void bitset_window_clear(WindowBitSet* const window, const uint64_t index);
+inline void bitset_window_flip_bit(WindowBitSet* const window, const uint64_t index);
+inline bool bitset_window_clip(const WindowBitSet* const window, uint64_t* const begin, uint64_t* const end);
+inline void bitset_window_fill_in_range_begin_end(WindowBitSet* const window, const bool value, uint64_t begin, uint64_t end);
+inline void bitset_window_set_in_range_begin_end(WindowBitSet* const window, const uint64_t begin, const uint64_t end);
+inline void bitset_window_clear_in_range_begin_end(WindowBitSet* const window, const uint64_t begin, const uint64_t end);
+inline void bitset_window_clear_all(WindowBitSet* const window);
+inline uint64_t bitset_window_count(const WindowBitSet* const window);
+inline uint64_t bitset_window_count_in_range_begin_end(const WindowBitSet* const window, uint64_t begin, uint64_t end);
+inline bool bitset_window_any(const WindowBitSet* const window);
+inline bool bitset_window_any_in_range_begin_end(const WindowBitSet* const window, const uint64_t begin, const uint64_t end);
+inline uint64_t bitset_window_find_first_in_range_begin_end(const WindowBitSet* const window, uint64_t begin, uint64_t end);
+inline uint64_t bitset_window_find_first(const WindowBitSet* const window);
+inline uint64_t bitset_window_find_next(const WindowBitSet* const window, const uint64_t index);
+
+/**
+ * Size initialization, the window starts at logical index 0 with all the bits cleared
+ * @param window Pointer to window to initialize
+ * @param size The size of the window (bit size, greater than 0)
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_init(WindowBitSet* const window, const uint64_t size)
+{
+    bitset_dynamic_init(&window->bitset, size);
+    window->base = 0;
+}
+
+/**
+ * Destroys the window (frees the ring)
+ * @param window Pointer to window to destroy
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_destroy(WindowBitSet* const window)
+{
+    bitset_dynamic_destroy(&window->bitset);
+    window->base = 0;
+}
+
+/**
+ * Gets the size of the window
+ * @param window Pointer to window
+ * @return The number of logical indices covered by the window (bit size)
+ * @memberof WindowBitSet
+ */
+inline uint64_t bitset_window_size(const WindowBitSet* const window)
+{
+    return window->bitset.size;
+}
+
+/**
+ * Gets the end of the window
+ * @param window Pointer to window
+ * @return The first logical index past the window (logical index)
+ * @memberof WindowBitSet
+ */
+inline uint64_t bitset_window_end(const WindowBitSet* const window)
+{
+    return window->base + window->bitset.size;
+}
+
+/**
+ * Checks if a logical index is inside the window
+ * @param window Pointer to window
+ * @param index The logical index
+ * @return True if base <= index < base + size
+ * @memberof WindowBitSet
+ */
+inline bool bitset_window_contains(const WindowBitSet* const window, const uint64_t index)
+{
+    return index >= window->base && index - window->base < window->bitset.size;
+}
+
+/**
+ * Maps a logical index to its bit in the ring
+ * @param window Pointer to window
+ * @param index The logical index
+ * @return The index of the bit in the ring (bit index)
+ * @memberof WindowBitSet
+ */
+inline uint64_t bitset_window_physical(const WindowBitSet* const window, const uint64_t index)
+{
+    return index % window->bitset.size;
+}
+
+/**
+ * Moves the start of the window forward, only the bits of the expired indices are cleared (O(expired bits), at most O(size))
+ * @param window Pointer to window to move
+ * @param base The new first logical index (logical index, lower than the current one is ignored)
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_slide_to(WindowBitSet* const window, const uint64_t base)
+{
+    if (base <= window->base)
+        return;
+    // the expired indices [old base, base) re-enter the window as [old end, base + size)
+    if (base - window->base >= window->bitset.size)
+        bitset_clear_all(UNIVERSAL_BITSET(&window->bitset));
+    else
+    {
+        const uint64_t expired = base - window->base, physical = bitset_window_physical(window, window->base);
+        const uint64_t head = window->bitset.size - physical < expired ? window->bitset.size - physical : expired;
+        bitset_clear_in_range_begin_end(UNIVERSAL_BITSET(&window->bitset), physical, physical + head);
+        if (head < expired)
+            bitset_clear_in_range_begin_end(UNIVERSAL_BITSET(&window->bitset), 0, expired - head);
+    }
+    window->base = base;
+}
+
+/**
+ * Moves the start of the window forward by the specified number of indices
+ * @param window Pointer to window to move
+ * @param count Number of logical indices to expire
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_slide(WindowBitSet* const window, const uint64_t count)
+{
+    bitset_window_slide_to(window, window->base + count);
+}
+
+/**
+ * Gets the value of a bit
+ * @param window Pointer to window to read from
+ * @param index The logical index of the bit
+ * @return The value of the bit, false outside the window
+ * @memberof WindowBitSet
+ */
+inline bool bitset_window_get(const WindowBitSet* const window, const uint64_t index)
+{
+    if (!bitset_window_contains(window, index))
+        return false;
+    const uint64_t physical = bitset_window_physical(window, index);
+    return *(window->bitset.data + physical / BITSET_BLOCK_BITS) >> physical % BITSET_BLOCK_BITS & 1u;
+}
+
+/**
+ * Sets the value of a bit
+ * @param window Pointer to window to modify
+ * @param value The value to set the bit to
+ * @param index The logical index of the bit (inside the window)
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_set_value(WindowBitSet* const window, const bool value, const uint64_t index)
+{
+    bitset_set_value(UNIVERSAL_BITSET(&window->bitset), value, bitset_window_physical(window, index));
+}
+
+/**
+ * Sets a bit to 1 (true)
+ * @param window Pointer to window to modify
+ * @param index The logical index of the bit (inside the window)
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_set(WindowBitSet* const window, const uint64_t index)
+{
+    bitset_set(UNIVERSAL_BITSET(&window->bitset), bitset_window_physical(window, index));
+}
+
+/**
+ * Sets a bit to 0 (false)
+ * @param window Pointer to window to modify
+ * @param index The logical index of the bit (inside the window)
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_clear(WindowBitSet* const window, const uint64_t index)
+{
+    bitset_clear(UNIVERSAL_BITSET(&window->bitset), bitset_window_physical(window, index));
+}
+
+/**
+ * Flips a bit
+ * @param window Pointer to window to modify
+ * @param index The logical index of the bit (inside the window)
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_flip_bit(WindowBitSet* const window, const uint64_t index)
+{
+    bitset_flip_bit(UNIVERSAL_BITSET(&window->bitset), bitset_window_physical(window, index));
+}
+
+/**
+ * Clips a logical range to the window
+ * @param window Pointer to window
+ * @param begin Pointer to the begin of the range (logical index, inclusive), updated
+ * @param end Pointer to the end of the range (logical index, exclusive), updated
+ * @return False if nothing of the range is inside the window
+ * @memberof WindowBitSet
+ */
+inline bool bitset_window_clip(const WindowBitSet* const window, uint64_t* const begin, uint64_t* const end)
+{
+    if (*begin < window->base)
+        *begin = window->base;
+    if (*end > bitset_window_end(window))
+        *end = bitset_window_end(window);
+    return *begin < *end;
+}
+
+/**
+ * Fills the bits in a logical range, the part outside the window is ignored (the wraparound of the ring splits it in at most two ranges)
+ * @param window Pointer to window to modify
+ * @param value The value to fill the bits with
+ * @param begin The first logical index (inclusive)
+ * @param end The last logical index (exclusive)
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_fill_in_range_begin_end(WindowBitSet* const window, const bool value, uint64_t begin, uint64_t end)
+{
+    if (!bitset_window_clip(window, &begin, &end))
+        return;
+    const uint64_t length = end - begin, physical = bitset_window_physical(window, begin);
+    const uint64_t head = window->bitset.size - physical < length ? window->bitset.size - physical : length;
+    bitset_fill_in_range_begin_end(UNIVERSAL_BITSET(&window->bitset), value, physical, physical + head);
+    if (head < length)
+        bitset_fill_in_range_begin_end(UNIVERSAL_BITSET(&window->bitset), value, 0, length - head);
+}
+
+/**
+ * Sets the bits in a logical range, the part outside the window is ignored
+ * @param window Pointer to window to modify
+ * @param begin The first logical index (inclusive)
+ * @param end The last logical index (exclusive)
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_set_in_range_begin_end(WindowBitSet* const window, const uint64_t begin, const uint64_t end)
+{
+    bitset_window_fill_in_range_begin_end(window, true, begin, end);
+}
+
+/**
+ * Clears the bits in a logical range, the part outside the window is ignored
+ * @param window Pointer to window to modify
+ * @param begin The first logical index (inclusive)
+ * @param end The last logical index (exclusive)
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_clear_in_range_begin_end(WindowBitSet* const window, const uint64_t begin, const uint64_t end)
+{
+    bitset_window_fill_in_range_begin_end(window, false, begin, end);
+}
+
+/**
+ * Clears all the bits of the window (the window does not move)
+ * @param window Pointer to window to modify
+ * @memberof WindowBitSet
+ */
+inline void bitset_window_clear_all(WindowBitSet* const window)
+{
+    bitset_clear_all(UNIVERSAL_BITSET(&window->bitset));
+}
+
+/**
+ * Counts the set bits of the window
+ * @param window Pointer to window to count the bits of
+ * @return The number of set bits
+ * @memberof WindowBitSet
+ */
+inline uint64_t bitset_window_count(const WindowBitSet* const window)
+{
+    return bitset_count(UNIVERSAL_BITSET(&window->bitset));
+}
+
+/**
+ * Counts the set bits in a logical range, the part outside the window is ignored
+ * @param window Pointer to window to count the bits of
+ * @param begin The first logical index (inclusive)
+ * @param end The last logical index (exclusive)
+ * @return The number of set bits in the range
+ * @memberof WindowBitSet
+ */
+inline uint64_t bitset_window_count_in_range_begin_end(const WindowBitSet* const window, uint64_t begin, uint64_t end)
+{
+    if (!bitset_window_clip(window, &begin, &end))
+        return 0;
+    const uint64_t length = end - begin, physical = bitset_window_physical(window, begin);
+    const uint64_t head = window->bitset.size - physical < length ? window->bitset.size - physical : length;
+    return bitset_count_in_range_begin_end(UNIVERSAL_BITSET(&window->bitset), physical, physical + head)
+        + (head < length ? bitset_count_in_range_begin_end(UNIVERSAL_BITSET(&window->bitset), 0, length - head) : 0);
+}
+
+/**
+ * Checks if any of the bits of the window are set
+ * @param window Pointer to window to check
+ * @return True if any of the bits are set, false otherwise
+ * @memberof WindowBitSet
+ */
+inline bool bitset_window_any(const WindowBitSet* const window)
+{
+    return bitset_any(UNIVERSAL_BITSET(&window->bitset));
+}
+
+/**
+ * Checks if any of the bits in a logical range are set, the part outside the window is ignored
+ * @param window Pointer to window to check
+ * @param begin The first logical index (inclusive)
+ * @param end The last logical index (exclusive)
+ * @return True if any of the bits in the range are set, false otherwise
+ * @memberof WindowBitSet
+ */
+inline bool bitset_window_any_in_range_begin_end(const WindowBitSet* const window, const uint64_t begin, const uint64_t end)
+{
+    return bitset_window_find_first_in_range_begin_end(window, begin, end) != BITSET_NPOS;
+}
+
+/**
+ * Finds the first set bit in a logical range, the part outside the window is ignored
+ * @param window Pointer to window to search
+ * @param begin The first logical index (inclusive)
+ * @param end The last logical index (exclusive)
+ * @return The logical index of the found bit or BITSET_NPOS if there is none
+ * @memberof WindowBitSet
+ */
+inline uint64_t bitset_window_find_first_in_range_begin_end(const WindowBitSet* const window, uint64_t begin, uint64_t end)
+{
+    if (!bitset_window_clip(window, &begin, &end))
+        return BITSET_NPOS;
+    const uint64_t length = end - begin, physical = bitset_window_physical(window, begin);
+    const uint64_t head = window->bitset.size - physical < length ? window->bitset.size - physical : length;
+    uint64_t found = bitset_find_value_in_range_begin_end(UNIVERSAL_BITSET(&window->bitset), true, physical, physical + head);
+    if (found != BITSET_NPOS)
+        return begin + (found - physical);
+    if (head == length)
+        return BITSET_NPOS;
+    found = bitset_find_value_in_range_begin_end(UNIVERSAL_BITSET(&window->bitset), true, 0, length - head);
+    return found != BITSET_NPOS ? begin + head + found : BITSET_NPOS;
+}
+
+/**
+ * Finds the first set bit of the window
+ * @param window Pointer to window to search
+ * @return The logical index of the found bit or BITSET_NPOS if there is none
+ * @memberof WindowBitSet
+ */
+inline uint64_t bitset_window_find_first(const WindowBitSet* const window)
+{
+    return bitset_window_find_first_in_range_begin_end(window, window->base, bitset_window_end(window));
+}
+
+/**
+ * Finds the first set bit after a logical index
+ * @param window Pointer to window to search
+ * @param index The logical index to search after
+ * @return The logical index of the found bit or BITSET_NPOS if there is none
+ * @memberof WindowBitSet
+ */
+inline uint64_t bitset_window_find_next(const WindowBitSet* const window, const uint64_t index)
+{
+    return bitset_window_find_first_in_range_begin_end(window, index + 1, bitset_window_end(window));
+}